@@ -45,6 +45,12 @@ App1::~App1()
 		terrainShader = nullptr;
 	}
 
+	if (treeShader)
+	{
+		delete treeShader;
+		treeShader = nullptr;
+	}
+
 	if (dirLight)
 	{
 		delete dirLight;
@@ -107,6 +113,7 @@ void App1::initShaders(HWND& hwnd)
 	terrainShader = new TerrainShader(renderer->getDevice(), hwnd);
 	leafShader = new LeafShader(renderer->getDevice(), hwnd);
 	lightShader = new LightShader(renderer->getDevice(), hwnd);
+	treeShader = new TreeShader(renderer->getDevice(), hwnd);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -157,27 +164,50 @@ void App1::initGUIVars()
 	// For Perlin Noise and fBm
 	newRandomNoise = false;
 	addFixedNoise = false;
+	addWarpedNoise = false;
 	ridgedPerlinToggle = false;
 	terracedPerlinToggle = false;
 	fBmToggle = false;
 	fBmValsSet = false;
 	runSingleOctave = false;
 	runAllOctaves = false;
+	runErodedfBm = false;
 
 	// For Hydr Eros
 	haveEroded = false;
 
+	// For Terrain LOD
+	terrainLODToggle = true;
+	frustumCullingToggle = true;
+	terrainMaxPixelError = 2.0f;
+
+	// For Height Map Layout
+	heightMapLayout = HeightMap::ROW_MAJOR;
+	batchResults = BatchResults{ 0, 0, 0, 0, 0, 0.0f };
+
 	// INTS
 	terrainResolution = 512;
 	faultingIterations = 0;
 	smoothingIterations = 0;
 	particleDepoIterations = 0;
 	fBmOctaves = 0;
+	warpLevels = 1;
+	noiseSeed = 0;
+	perlinTileX = 0;
+	perlinTileZ = 0;
+	tilesPerPeriod = 0;
+	worleyMetric = 0;
+	worleyFeature = 0;
+	worleySeed = 0;
 
 	// FLOATS
 	perlinFreq = 0.2f;
 	perlinScale = 0.2f;
 	amplitude = 5.0f;
+	warpStrength = 1.5f;
+	worleyFreq = 0.05f;
+	worleyAmplitude = 5.0f;
+	worleyJitter = 1.0f;
 
 	N_waterLowerBound = 0.0f;
 	N_waterUpperbound = 3.0f;
@@ -198,6 +228,43 @@ void App1::updateTerrain()
 	checkFaulting();
 	checkSmoothing();
 	checkParticleDepo();
+	checkErosionSession();
+	checkUndoHistory();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::checkErosionSession()
+{
+	ErosionSession* session = terrainMesh->getErosionSession();
+
+	if (session->getState() != ErosionSession::RUNNING)
+	{
+		return;
+	}
+
+	terrainMesh->advanceErosion(erosionSliceMs);
+	terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+
+	if (session->getState() == ErosionSession::FINISHED)
+	{
+		// Hard set the texture bounds for a textured terrain with white shorelines to imitate sea foam
+		adjustedTextureBounds();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::checkUndoHistory()
+{
+	// Wait until a run of edits is over, so one undo takes back a whole faulting loop rather than a single fault
+	bool editing = loopFaulting || runFaultingIterations || runSmoothingIterations || loopParticleDepo || runParticleDepoIterations;
+	editing = editing || terrainMesh->getErosionSession()->isActive();
+
+	if (!editing)
+	{
+		terrainMesh->recordHistory();
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -278,6 +345,14 @@ void App1::checkPerlinNoise()
 		addFixedNoise = false;
 	}
 
+	if (addWarpedNoise)
+	{
+		terrainMesh->setPNFreqScaleAmp(perlinFreq, perlinScale, amplitude);
+		terrainMesh->genDomainWarpedNoise(warpLevels, warpStrength);
+		terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+		addWarpedNoise = false;
+	}
+
 	if (newRandomNoise)
 	{
 		// Get a blank terrain with 0 for height values
@@ -316,6 +391,14 @@ void App1::checkPerlinNoise()
 		runSingleOctave = false;
 	}
 
+	if (runErodedfBm)
+	{
+		terrainMesh->setPNFreqScaleAmp(perlinFreq, perlinScale, amplitude);
+		terrainMesh->generateErodedfBm(fBmOctaves);
+		terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+		runErodedfBm = false;
+	}
+
 	if (runAllOctaves && fBmOctaves > 0)
 	{
 		terrainMesh->generatefBm();
@@ -341,6 +424,82 @@ void App1::checkPerlinNoise()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void App1::followTerrain()
+{
+	if (!walkOnTerrain && !stayAboveTerrain)
+	{
+		return;
+	}
+
+	// Into the terrain's local space, the same translation renderTerrain() uses
+	XMFLOAT3 camPos = camera->getPosition();
+	float localX = camPos.x + 125.0f;
+	float localZ = camPos.z + 125.0f;
+
+	// Off the edge of the terrain the camera can go anywhere
+	if (localX < 0.0f || localX > 250.0f || localZ < 0.0f || localZ > 250.0f)
+	{
+		return;
+	}
+
+	float groundHeight;
+
+	if (walkOnTerrain)
+	{
+		groundHeight = terrainMesh->getGroundHeight(localX, localZ);
+	}
+	else
+	{
+		// The highest point anywhere close, so the near plane can't dip into a slope in front of the camera either
+		float lowest;
+		terrainMesh->getGroundHeightRange(localX - eyeHeight, localZ - eyeHeight, localX + eyeHeight, localZ + eyeHeight, lowest, groundHeight);
+	}
+
+	float minY = groundHeight + eyeHeight + 2.0f;
+
+	if (walkOnTerrain || camPos.y < minY)
+	{
+		camera->setPosition(camPos.x, minY, camPos.z);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::pickTerrain()
+{
+	// Only on the frame the button goes down, and not if the click was meant for the GUI
+	bool leftMouseDown = input->isLeftMouseDown();
+	bool clicked = leftMouseDown && !leftMouseWasDown;
+	leftMouseWasDown = leftMouseDown;
+
+	if (!clicked || ImGui::GetIO().WantCaptureMouse)
+	{
+		return;
+	}
+
+	// The mouse on the near and far planes, back through the projection and the view
+	float ndcX = 2.0f * input->getMouseX() / sWidth - 1.0f;
+	float ndcY = 1.0f - 2.0f * input->getMouseY() / sHeight;
+	XMMATRIX inverseViewProjection = XMMatrixInverse(nullptr, camera->getViewMatrix() * renderer->getProjectionMatrix());
+	XMVECTOR nearPoint = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 0.0f, 1.0f), inverseViewProjection);
+	XMVECTOR farPoint = XMVector3TransformCoord(XMVectorSet(ndcX, ndcY, 1.0f, 1.0f), inverseViewProjection);
+
+	// Into the terrain's local space and back out again, the same translation renderTerrain() uses
+	XMVECTOR terrainOffset = XMVectorSet(-125.0f, 2.0f, -125.0f, 0.0f);
+	XMFLOAT3 origin, direction;
+	XMStoreFloat3(&origin, XMVectorSubtract(nearPoint, terrainOffset));
+	XMStoreFloat3(&direction, XMVectorSubtract(farPoint, nearPoint));
+
+	terrainPicked = terrainMesh->rayCastTerrain(origin, direction, pickedPoint);
+
+	if (terrainPicked)
+	{
+		XMStoreFloat3(&pickedPoint, XMVectorAdd(XMLoadFloat3(&pickedPoint), terrainOffset));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void App1::buildLSystem()
 {
 	//Get the current L-System string, right now we have a place holder
@@ -447,6 +606,12 @@ void App1::addCylinder(XMVECTOR& pos, XMMATRIX& currRot, XMVECTOR branchLen, flo
 	m_Cylinder = new CylinderMesh(renderer->getDevice(), renderer->getDeviceContext(), 1.0f, 6.0f, len, btmRadius, topRadius);
 	m_Cylinder->m_Transform = currRot * XMMatrixTranslationFromVector(pos);
 	m_CylinderList.push_back(m_Cylinder);
+
+	// World space bounds for culling, must use the same world matrix as renderLSystem
+	float maxRadius = (btmRadius > topRadius) ? btmRadius : topRadius;
+	XMFLOAT3 worldMin, worldMax;
+	Frustum::transformBox(m_Cylinder->m_Transform * XMMatrixScaling(20.0f, 20.0f, 20.0f), XMFLOAT3(-maxRadius, 0.0f, -maxRadius), XMFLOAT3(maxRadius, len, maxRadius), worldMin, worldMax);
+	cylinderBounds.add(worldMin, worldMax);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -459,6 +624,21 @@ void App1::addLeaf(XMVECTOR& pos, XMMATRIX& currRot)
 	quadLeaf = new Leaf(renderer->getDevice(), renderer->getDeviceContext(), pos, leafScale);
 	quadLeaf->m_transform = currRot;
 	leafList.push_back(quadLeaf);
+
+	// World space bounds for culling, the leaf quad is built around its position, see Leaf::initBuffers
+	XMFLOAT3 localMin(XMVectorGetX(pos) - leafScale, XMVectorGetY(pos) - leafScale, XMVectorGetZ(pos));
+	XMFLOAT3 localMax(XMVectorGetX(pos) + leafScale, XMVectorGetY(pos) + leafScale, XMVectorGetZ(pos));
+	XMFLOAT3 worldMin, worldMax;
+	Frustum::transformBox(XMMatrixRotationAxis(quadLeaf->m_position, -5.0f) * XMMatrixScaling(20.0f, 20.0f, 20.0f), localMin, localMax, worldMin, worldMax);
+	leafBounds.add(worldMin, worldMax);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::buildTreeTemplates()
+{
+	treeTemplates.build(renderer->getDevice(), renderer->getDeviceContext(), treeVariants, (unsigned int)treeVariantSeed, treeVariantIterations);
+	forestBoundsChanged = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -483,6 +663,8 @@ void App1::resetLSystem()
 
 	m_CylinderList.clear();
 	leafList.clear();
+	cylinderBounds.clear();
+	leafBounds.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -499,6 +681,8 @@ bool App1::frame()
 	}
 
 	updateTerrain();
+	followTerrain();
+	pickTerrain();
 	
 	// Render the graphics.
 	result = render();
@@ -530,6 +714,7 @@ bool App1::render()
 	// Send geometry data, set shader parameters, render object with shader
 	renderTerrain();
 	renderLSystem();
+	renderForest();
 
 	// Render GUI
 	gui();
@@ -558,14 +743,28 @@ void App1::renderTerrain()
 
 	worldMatrix *= XMMatrixTranslation(-125.0f, 2.0f, -125.0f);
 
+	// Pick the chunk LODs using the camera position relative to the terrain
+	XMFLOAT3 localCamPos = camera->getPosition();
+	localCamPos.x += 125.0f;
+	localCamPos.y -= 2.0f;
+	localCamPos.z += 125.0f;
+
+	// The chunk bounds are in the terrain's local space, so include the world matrix in the planes
+	frustum.extractPlanes(worldMatrix * viewMatrix * projectionMatrix);
+
+	terrainMesh->getDrawRanges(localCamPos, (float)sHeight, (float)XM_PI / 4.0f, terrainMaxPixelError, terrainLODToggle,
+		frustumCullingToggle ? &frustum : nullptr, terrainDrawRanges);
+
 	terrainMesh->sendData(renderer->getDeviceContext());
 
 	terrainShader->setShaderParameters(renderer->getDeviceContext(),
 		worldMatrix, viewMatrix, projectionMatrix,
 		textureMgr->getTexture(L"snow"), textureMgr->getTexture(L"grass"), textureMgr->getTexture(L"water"),
-		dirLight, noiseStyleValue, normalTextBoundValues, ridgedTextBoundValues);
+		useErosionMaps ? terrainMesh->getErosionMapTexture() : nullptr,
+		dirLight, noiseStyleValue, erosionMapStrength, normalTextBoundValues, ridgedTextBoundValues,
+		terrainMesh->getTerrainRes(), terrainMesh->getGridScale(), terrainMesh->getUVIncrement());
 
-	terrainShader->render(renderer->getDeviceContext(), terrainMesh->getIndexCount());
+	terrainShader->renderRanges(renderer->getDeviceContext(), terrainDrawRanges);
 
 	worldMatrix = XMMatrixIdentity();
 }
@@ -574,9 +773,15 @@ void App1::renderTerrain()
 
 void App1::renderLSystem()
 {
+	// The tree bounds are already in world space
+	frustum.extractPlanes(viewMatrix * projectionMatrix);
+	cullLSystem();
+
 	// FOR CYL TREE
-	for (int i = 0; i < m_CylinderList.size(); ++i)
+	for (int v = 0; v < (int)visibleCylinders.size(); ++v)
 	{
+		int i = visibleCylinders[v];
+
 		if (m_CylinderList[i]->getIndexCount() > 0)
 		{
 			worldMatrix = XMMatrixMultiply(m_CylinderList[i]->m_Transform, worldMatrix);	
@@ -592,22 +797,143 @@ void App1::renderLSystem()
 	}
 			
 	// FOR CUSTOM LEAF
-	for (int i = 0; i < leafList.size(); ++i)
+	for (int v = 0; v < (int)visibleLeaves.size(); ++v)
 	{
-		if (leafList.size() > 0)
+		int i = visibleLeaves[v];
+
+		if (leafList[i]->getIndexCount() > 0)
 		{
-			if (leafList[i]->getIndexCount() > 0)
-			{
-				worldMatrix = XMMatrixRotationAxis(leafList[i]->m_position, -5.0f);				
-				worldMatrix *= XMMatrixScaling(20.0f, 20.0f, 20.0f);
+			worldMatrix = XMMatrixRotationAxis(leafList[i]->m_position, -5.0f);				
+			worldMatrix *= XMMatrixScaling(20.0f, 20.0f, 20.0f);
 
-				leafList[i]->sendData(renderer->getDeviceContext());
-				leafShader->setShaderParameters(renderer->getDeviceContext(), worldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(L"leaf"), dirLight);				
-				//leafShader->setShaderParameters(renderer->getDeviceContext(), worldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(L"goldLeaf"), dirLight);				
-				leafShader->render(renderer->getDeviceContext(), leafList[i]->getIndexCount());
+			leafList[i]->sendData(renderer->getDeviceContext());
+			leafShader->setShaderParameters(renderer->getDeviceContext(), worldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(L"leaf"), dirLight);				
+			//leafShader->setShaderParameters(renderer->getDeviceContext(), worldMatrix, viewMatrix, projectionMatrix, textureMgr->getTexture(L"goldLeaf"), dirLight);				
+			leafShader->render(renderer->getDeviceContext(), leafList[i]->getIndexCount());
 
-				worldMatrix = XMMatrixIdentity();
-			}
+			worldMatrix = XMMatrixIdentity();
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Fill the visible cylinder and leaf lists, everything is visible when culling is turned off
+void App1::cullLSystem()
+{
+	if (frustumCullingToggle)
+	{
+		frustum.cullBoxes(cylinderBounds, visibleCylinders);
+		frustum.cullBoxes(leafBounds, visibleLeaves);
+		return;
+	}
+
+	visibleCylinders.resize(m_CylinderList.size());
+	visibleLeaves.resize(leafList.size());
+
+	for (int i = 0; i < (int)visibleCylinders.size(); ++i)
+	{
+		visibleCylinders[i] = i;
+	}
+
+	for (int i = 0; i < (int)visibleLeaves.size(); ++i)
+	{
+		visibleLeaves[i] = i;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::renderForest()
+{
+	if (!drawForest || vegetationInstances.empty() || treeTemplates.getTemplateCount() == 0)
+	{
+		visibleTrees.clear();
+		return;
+	}
+
+	// The trees are placed in the terrain's local space, so they go into the world the same way it does
+	const XMMATRIX terrainTransform = XMMatrixTranslation(-125.0f, 2.0f, -125.0f);
+
+	if (forestBoundsChanged)
+	{
+		treeTemplates.buildInstanceBounds(vegetationInstances, forestTreeScale, terrainTransform, forestBounds);
+		forestBoundsChanged = false;
+	}
+
+	// The tree bounds are already in world space
+	frustum.extractPlanes(viewMatrix * projectionMatrix);
+
+	if (frustumCullingToggle)
+	{
+		frustum.cullBoxes(forestBounds, visibleTrees);
+	}
+	else
+	{
+		visibleTrees.resize(vegetationInstances.size());
+
+		for (int i = 0; i < (int)visibleTrees.size(); ++i)
+		{
+			visibleTrees[i] = i;
+		}
+	}
+
+	if (visibleTrees.empty())
+	{
+		return;
+	}
+
+	// Grouped by variant (a counting sort), so each variant's trees are one run of the instance buffer and one draw
+	const int variantCount = treeTemplates.getTemplateCount();
+	visibleForestStarts.assign(variantCount + 1, 0);
+
+	for (int v = 0; v < (int)visibleTrees.size(); ++v)
+	{
+		++visibleForestStarts[vegetationInstances[visibleTrees[v]].variant % variantCount + 1];
+	}
+
+	for (int t = 0; t < variantCount; ++t)
+	{
+		visibleForestStarts[t + 1] += visibleForestStarts[t];
+	}
+
+	std::vector<int> next(visibleForestStarts.begin(), visibleForestStarts.end() - 1);
+	visibleForest.resize(visibleTrees.size());
+
+	for (int v = 0; v < (int)visibleTrees.size(); ++v)
+	{
+		const VegetationInstance& instance = vegetationInstances[visibleTrees[v]];
+		visibleForest[next[instance.variant % variantCount]++] = instance;
+	}
+
+	treeShader->setInstances(renderer->getDeviceContext(), visibleForest);
+
+	// All the bark, then all the leaves, the shader's buffers are only set once for each
+	treeShader->setShaderParameters(renderer->getDeviceContext(), terrainTransform, viewMatrix, projectionMatrix, textureMgr->getTexture(L"bark"), dirLight, forestTreeScale, false);
+
+	for (int t = 0; t < variantCount; ++t)
+	{
+		const TreeTemplate& tree = treeTemplates.getTemplate(t);
+		const int treeCount = visibleForestStarts[t + 1] - visibleForestStarts[t];
+
+		if (treeCount > 0 && tree.bark->getIndexCount() > 0)
+		{
+			tree.bark->sendData(renderer->getDeviceContext());
+			treeShader->renderInstances(renderer->getDeviceContext(), tree.bark->getIndexCount(), treeCount, visibleForestStarts[t]);
+		}
+	}
+
+	treeShader->setShaderParameters(renderer->getDeviceContext(), terrainTransform, viewMatrix, projectionMatrix, textureMgr->getTexture(L"leaf"), dirLight, forestTreeScale, true);
+
+	for (int t = 0; t < variantCount; ++t)
+	{
+		const TreeTemplate& tree = treeTemplates.getTemplate(t);
+		const int treeCount = visibleForestStarts[t + 1] - visibleForestStarts[t];
+
+		if (treeCount > 0 && tree.leaves->getIndexCount() > 0)
+		{
+			tree.leaves->sendData(renderer->getDeviceContext());
+			treeShader->renderInstances(renderer->getDeviceContext(), tree.leaves->getIndexCount(), treeCount, visibleForestStarts[t]);
 		}
 	}
 }
@@ -638,7 +964,6 @@ void App1::gui()
 		{
 			terrainMesh->resize(terrainResolution);
 			terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
-			terrainMesh->updateHeightMap();
 		}
 	}*/
 
@@ -649,6 +974,7 @@ void App1::gui()
 		terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
 	}
 
+	buildUndoGui();
 	buildSmoothingGui();
 	buildAllGuiOptions();
 
@@ -667,6 +993,13 @@ void App1::buildAllGuiOptions()
 
 		ImGui::TreePop();
 	}
+
+	if (ImGui::TreeNode("Thermal Erosion"))
+	{
+		buildThermalErosionGui();
+
+		ImGui::TreePop();
+	}
 	
 	if (ImGui::TreeNode("Build Complete Terrain"))
 	{
@@ -682,11 +1015,61 @@ void App1::buildAllGuiOptions()
 		ImGui::TreePop();
 	}
 
+	if (ImGui::TreeNode("Terrain LOD"))
+	{
+		buildTerrainLODGui();
+
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Height Map Layout"))
+	{
+		buildHeightMapLayoutGui();
+
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Import Height Map"))
+	{
+		buildImportGui();
+
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Export Height Map"))
+	{
+		buildExportGui();
+
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Batch Terrains"))
+	{
+		buildBatchGui();
+
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Camera and Picking"))
+	{
+		buildCameraGui();
+
+		ImGui::TreePop();
+	}
+
+	if (ImGui::TreeNode("Scatter Vegetation"))
+	{
+		buildVegetationGui();
+
+		ImGui::TreePop();
+	}
+
 	if (ImGui::TreeNode("Play with Terrain Features"))
 	{
 		buildFaultingGui();
 		buildParticleDepoGui();
 		buildPerlinNoiseGui();
+		buildWorleyNoiseGui();
 
 		ImGui::TreePop();
 	}
@@ -694,6 +1077,302 @@ void App1::buildAllGuiOptions()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void App1::buildTerrainLODGui()
+{
+	ImGui::Checkbox("Chunked LOD", &terrainLODToggle);
+	ImGui::Checkbox("Frustum Culling", &frustumCullingToggle);
+	ImGui::SliderFloat("Max Pixel Error", &terrainMaxPixelError, 0.5f, 16.0f);
+
+	// Count what was drawn last frame
+	const std::vector<TerrainDrawItem>& drawList = terrainMesh->getDrawList();
+	int lodCounts[MAX_TERRAIN_LODS] = { 0 };
+	unsigned int drawnIndices = 0;
+
+	for (int i = 0; i < (int)drawList.size(); ++i)
+	{
+		++lodCounts[drawList[i].lod];
+	}
+
+	for (int i = 0; i < (int)terrainDrawRanges.size(); ++i)
+	{
+		drawnIndices += terrainDrawRanges[i].count;
+	}
+
+	ImGui::Text("Chunks: %d, Max LOD: %d", terrainMesh->getQuadtree().getChunkCount(), terrainMesh->getQuadtree().getMaxLOD());
+	ImGui::Text("Triangles Drawn: %u / %u", drawnIndices / 3, (terrainMesh->getTerrainRes() - 1) * (terrainMesh->getTerrainRes() - 1) * 2);
+	ImGui::Text("Draw Calls: %d", (int)terrainDrawRanges.size());
+	ImGui::Text("Visible Chunks: %d / %d", terrainMesh->getVisibleChunkCount(), terrainMesh->getQuadtree().getChunkCount());
+	ImGui::Text("Visible Cylinders: %d / %d", (int)visibleCylinders.size(), (int)m_CylinderList.size());
+	ImGui::Text("Visible Leaves: %d / %d", (int)visibleLeaves.size(), (int)leafList.size());
+
+	for (int i = 0; i <= terrainMesh->getQuadtree().getMaxLOD(); ++i)
+	{
+		ImGui::Text("Chunks at LOD %d: %d", i, lodCounts[i]);
+	}
+
+	// Simulated vertex cache results for the full resolution terrain, see MeshOptimiser
+	const VertexCacheStats& originalStats = terrainMesh->getQuadtree().getOriginalCacheStats();
+	const VertexCacheStats& optimisedStats = terrainMesh->getQuadtree().getOptimisedCacheStats();
+	ImGui::Text("Vertex Cache ACMR: %.3f -> %.3f", originalStats.acmr, optimisedStats.acmr);
+	ImGui::Text("Vertex Cache ATVR: %.3f -> %.3f", originalStats.atvr, optimisedStats.atvr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::buildHeightMapLayoutGui()
+{
+	ImGui::Text("* NOTE *	THE LAYOUT ONLY CHANGES HOW THE HEIGHTS ARE STORED, NOT THE TERRAIN");
+
+	if (ImGui::RadioButton("Row-Major", &heightMapLayout, HeightMap::ROW_MAJOR))
+	{
+		terrainMesh->setHeightMapLayout(HeightMap::ROW_MAJOR);
+	}
+
+	ImGui::SameLine();
+
+	if (ImGui::RadioButton("Tiled (Morton)", &heightMapLayout, HeightMap::TILED))
+	{
+		terrainMesh->setHeightMapLayout(HeightMap::TILED);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::buildUndoGui()
+{
+	const HeightMapHistory& history = terrainMesh->getHistory();
+
+	if (ImGui::Button("Undo") && terrainMesh->undo())
+	{
+		terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+	}
+
+	ImGui::SameLine();
+
+	if (ImGui::Button("Redo") && terrainMesh->redo())
+	{
+		terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+	}
+
+	ImGui::SameLine();
+	ImGui::Text("History: %d Snapshots, %.1f MB", history.getSnapshotCount(), history.getMemoryBytes() / (1024.0f * 1024.0f));
+
+	// Keep two versions, then flip between them to compare, each flip can be undone
+	if (ImGui::Button("Keep as A"))
+	{
+		snapshotA = terrainMesh->getSnapshot();
+	}
+
+	ImGui::SameLine();
+
+	if (ImGui::Button("Keep as B"))
+	{
+		snapshotB = terrainMesh->getSnapshot();
+	}
+
+	ImGui::SameLine();
+
+	if (ImGui::Button("Show A") && terrainMesh->restoreSnapshot(snapshotA))
+	{
+		terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+	}
+
+	ImGui::SameLine();
+
+	if (ImGui::Button("Show B") && terrainMesh->restoreSnapshot(snapshotB))
+	{
+		terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::buildImportGui()
+{
+	ImGui::Text("Reads a .png, .r16, .r32, .raw or .hmt, resampled to the current resolution\n");
+
+	ImGui::InputText("File", importFilename, sizeof(importFilename));
+	ImGui::RadioButton("Bilinear", &importFilter, HeightMapImporter::BILINEAR);
+	ImGui::SameLine();
+	ImGui::RadioButton("Bicubic", &importFilter, HeightMapImporter::BICUBIC);
+
+	// PNGs written by the export below, and .hmt files, carry their own range
+	ImGui::DragFloat2("Height Range (16 Bit Files)", importHeightRange, 0.1f);
+
+	if (ImGui::Button("Import"))
+	{
+		heightMapImporter.setFilter((HeightMapImporter::Filter)importFilter);
+		heightMapImporter.setHeightRange(importHeightRange[0], importHeightRange[1]);
+
+		if (terrainMesh->importHeightMap(heightMapImporter, importFilename))
+		{
+			terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+
+			importMessage = "Read " + std::to_string(heightMapImporter.getSourceWidth()) + " x " + std::to_string(heightMapImporter.getSourceHeight())
+				+ ", resampled to " + std::to_string(terrainResolution) + " x " + std::to_string(terrainResolution);
+		}
+		else
+		{
+			importMessage = heightMapImporter.getError();
+		}
+	}
+
+	ImGui::Text("%s", importMessage.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::buildExportGui()
+{
+	ImGui::Text("Written next to the executable as heightmap.png, .r16, .r32 or .hmt\n");
+
+	ImGui::RadioButton("PNG 16 Bit", &exportFormat, HeightMapExporter::PNG_16);
+	ImGui::SameLine();
+	ImGui::RadioButton("Raw 16 Bit", &exportFormat, HeightMapExporter::RAW_16);
+	ImGui::SameLine();
+	ImGui::RadioButton("Raw 32 Bit Float", &exportFormat, HeightMapExporter::RAW_32);
+
+	ImGui::RadioButton("Tiles 16 Bit", &exportFormat, HeightMapExporter::TILED_16);
+	ImGui::SameLine();
+	ImGui::RadioButton("Tiles 32 Bit Float", &exportFormat, HeightMapExporter::TILED_32);
+
+	if (ImGui::Button("Export"))
+	{
+		HeightMapExporter::Format format = (HeightMapExporter::Format)exportFormat;
+		std::string filename = std::string("heightmap") + HeightMapExporter::getExtension(format);
+
+		exportMessage = terrainMesh->exportHeightMap(filename, format) ? "Written " + filename : "Couldn't write " + filename;
+	}
+
+	ImGui::Text("%s", exportMessage.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::buildCameraGui()
+{
+	ImGui::Text("Left click the terrain to pick a point on it\n");
+
+	ImGui::Checkbox("Walk On Terrain", &walkOnTerrain);
+	ImGui::Checkbox("Stay Above Terrain", &stayAboveTerrain);
+	ImGui::SliderFloat("Eye Height", &eyeHeight, 0.5f, 20.0f);
+
+	if (terrainPicked)
+	{
+		ImGui::Text("Picked: (%.2f, %.2f, %.2f)", pickedPoint.x, pickedPoint.y, pickedPoint.z);
+	}
+	else
+	{
+		ImGui::Text("Nothing picked");
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::buildVegetationGui()
+{
+	ImGui::Text("Trees grow between the water and grass upper bounds, scatter again after changing the terrain\n");
+	ImGui::Text("Record the erosion maps while eroding for the flow to have any effect\n");
+
+	ImGui::InputInt("Vegetation Seed", &vegetationSeed);
+	ImGui::SliderFloat("Tree Spacing", &treeSpacing, 0.5f, 10.0f);
+	ImGui::SliderFloat("Max Slope", &treeMaxSlope, 5.0f, 80.0f);
+	ImGui::SliderFloat("Band Fade", &treeBandFade, 0.0f, 5.0f);
+	ImGui::SliderFloat("Flow Weight", &treeFlowWeight, -1.0f, 1.0f);
+	ImGui::SliderFloat2("Scale Range", treeScaleRange, 0.25f, 3.0f);
+
+	if (ImGui::Button("Scatter Trees"))
+	{
+		VegetationScatter::Params params = vegetationScatter.getParams();
+		params.seed = (unsigned int)vegetationSeed;
+		params.spacing = treeSpacing;
+		params.maxSlope = treeMaxSlope;
+		params.lowHeight = noiseStyleValue == 1 ? R_waterUpperbound : N_waterUpperbound;
+		params.highHeight = noiseStyleValue == 1 ? R_grassUpperBound : N_grassUpperBound;
+		params.bandFade = treeBandFade;
+		params.flowWeight = treeFlowWeight;
+		params.minScale = treeScaleRange[0];
+		params.maxScale = treeScaleRange[1];
+		params.variants = treeVariants;
+
+		vegetationScatter.setParams(params);
+		terrainMesh->scatterVegetation(vegetationScatter, vegetationInstances);
+
+		if (treeTemplates.getTemplateCount() == 0)
+		{
+			buildTreeTemplates();
+		}
+
+		forestBoundsChanged = true;
+	}
+
+	ImGui::SameLine();
+
+	if (ImGui::Button("Clear Trees"))
+	{
+		vegetationInstances.clear();
+		forestBoundsChanged = true;
+	}
+
+	ImGui::Text("Trees: %d of %d candidates, %.1f KB", (int)vegetationInstances.size(), vegetationScatter.getCandidateCount(),
+		vegetationInstances.size() * sizeof(VegetationInstance) / 1024.0f);
+
+	// Only this many trees are ever grown, however many are placed
+	ImGui::Text("Tree Variants\n");
+	ImGui::SliderInt("Variants", &treeVariants, 1, 16);
+	ImGui::SliderInt("Variant Iterations", &treeVariantIterations, 1, 8);
+	ImGui::InputInt("Variant Seed", &treeVariantSeed);
+
+	if (ImGui::Button("Build Tree Variants"))
+	{
+		buildTreeTemplates();
+	}
+
+	ImGui::Checkbox("Draw Forest", &drawForest);
+
+	if (ImGui::SliderFloat("Forest Tree Scale", &forestTreeScale, 0.25f, 10.0f))
+	{
+		forestBoundsChanged = true;
+	}
+
+	ImGui::Text("Variants: %d, %d branches and %d vertices between them", treeTemplates.getTemplateCount(), treeTemplates.getBranchCount(), treeTemplates.getVertexCount());
+	ImGui::Text("Trees drawn: %d", drawForest ? (int)visibleTrees.size() : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::buildBatchGui()
+{
+	ImGui::Text("Builds every job in batch_manifest.txt, next to the executable, see TerrainBatch.h for the format\n");
+	ImGui::Text("Each job is written out as batch_<job name>.png, the terrain on screen is left as it is\n");
+
+	ImGui::Checkbox("Start From Current Terrain", &batchFromCurrentTerrain);
+
+	if (ImGui::Button("Run Batch"))
+	{
+		if (terrainBatch.loadManifest("batch_manifest.txt"))
+		{
+			if (batchFromCurrentTerrain)
+			{
+				terrainBatch.setStartSnapshot(terrainMesh->getSnapshot());
+			}
+
+			terrainBatch.run(0, batchResults);
+			batchMessage = terrainBatch.exportResults("batch_") ? "Done" : "Couldn't write every height map";
+		}
+		else
+		{
+			batchMessage = terrainBatch.getError();
+		}
+	}
+
+	ImGui::Text("%s", batchMessage.c_str());
+	ImGui::Text("Jobs Finished: %d	Over Memory Limit: %d	Time: %.0f ms", batchResults.jobsFinished, batchResults.jobsOverLimit, batchResults.totalMs);
+	ImGui::Text("Stages: %d	Run: %d (the rest shared)	Height Map Copies: %d", batchResults.stagesInJobs, batchResults.stagesRun, batchResults.heightMapCopies);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void App1::buildHydErosionGui()
 {
 	ImGui::Text("* NOTE *	YOU MUST BUILD A TERRAIN FIRST!");
@@ -703,6 +1382,32 @@ void App1::buildHydErosionGui()
 	ImGui::Text(" ");
 	ImGui::Text("Change these values to change the look of the erosion\n");
 
+	// Droplets carve finer channels, the shallow water model runs every point at once so it scales with cores
+	ImGui::RadioButton("Droplets", &erosionMode, 0); ImGui::SameLine();
+	ImGui::RadioButton("Shallow Water", &erosionMode, 1);
+
+	if (erosionMode == 1)
+	{
+		ImGui::SliderInt("Time Steps", &shallowWaterSteps, 50, 5000);
+		ImGui::SliderFloat("Rain Rate", &rainRate, 0.01f, 1.0f);
+		ImGui::SliderFloat("Evaporation Rate", &waterEvaporationRate, 0.01f, 2.0f);
+		ImGui::SliderFloat("Water Sediment Capacity", &waterSedimentCapacity, 0.01f, 1.0f);
+		ImGui::SliderFloat("Dissolve Rate", &dissolveRate, 0.01f, 0.9f);
+		ImGui::SliderFloat("Sediment Deposit Rate", &sedimentDepositRate, 0.01f, 0.9f);
+
+		terrainMesh->setShallowWaterParams(rainRate, waterEvaporationRate, waterSedimentCapacity, dissolveRate, sedimentDepositRate);
+
+		if (ImGui::Button("Erode Terrain"))
+		{
+			terrainMesh->shallowWaterErodeTerrain(shallowWaterSteps);
+			terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+
+			adjustedTextureBounds();
+		}
+
+		return;
+	}
+
 	ImGui::SliderInt("Cycles", &erosionIterations, 250000, 500000);
 	ImGui::SliderInt("Erosion Radius", &erosionRadius, 2.0, 10.0);
 	ImGui::SliderFloat("Inertia", &inertia, 0.001, 0.999);
@@ -731,6 +1436,99 @@ void App1::buildHydErosionGui()
 		// Hard set the texture bounds for a textured terrain with white shorelines to imitate sea foam
 		adjustedTextureBounds();
 	}
+
+	// Coarse levels first for the big valleys, each half the resolution of the last, then fewer droplets at full resolution
+	ImGui::Text(" ");
+	ImGui::SliderInt("Pyramid Levels", &pyramidLevels, 1, 4);
+	ImGui::SliderInt("Droplets Per Level", &pyramidDropletsPerLevel, 10000, 300000);
+	ImGui::SliderInt("Full Resolution Droplets", &pyramidFineDroplets, 10000, 300000);
+
+	if (ImGui::Button("Pyramid Erode Terrain"))
+	{
+		terrainMesh->pyramidErodeTerrain(pyramidLevels, pyramidDropletsPerLevel, pyramidFineDroplets);
+		terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+
+		adjustedTextureBounds();
+	}
+
+	// The same droplets as above, but a few milliseconds each frame so the terrain can be watched as it erodes
+	ErosionSession* session = terrainMesh->getErosionSession();
+	ImGui::SliderFloat("Milliseconds Per Frame", &erosionSliceMs, 1.0f, 50.0f);
+
+	if (!session->isActive())
+	{
+		if (ImGui::Button("Erode Over Time"))
+		{
+			terrainMesh->startErosion(erosionIterations, (unsigned int)rand());
+		}
+	}
+	else
+	{
+		ImGui::ProgressBar(session->getProgress());
+
+		if (session->getState() == ErosionSession::PAUSED)
+		{
+			if (ImGui::Button("Resume Erosion"))
+			{
+				terrainMesh->resumeErosion();
+			}
+		}
+		else if (ImGui::Button("Pause Erosion"))
+		{
+			terrainMesh->pauseErosion();
+		}
+
+		ImGui::SameLine();
+
+		// Whatever has been eroded so far stays
+		if (ImGui::Button("Cancel Erosion"))
+		{
+			terrainMesh->cancelErosion();
+			terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+		}
+	}
+
+	// Where the droplets flowed, eroded and deposited, summed over every erosion run until cleared
+	ImGui::Text(" ");
+	ImGui::Checkbox("Record Erosion Maps", &recordErosionMaps);
+	terrainMesh->setRecordErosionMaps(recordErosionMaps);
+
+	ImGui::Checkbox("Texture From Erosion Maps", &useErosionMaps);
+	ImGui::SliderFloat("Erosion Map Strength", &erosionMapStrength, 0.0f, 2.0f);
+
+	if (ImGui::Button("Clear Erosion Maps"))
+	{
+		terrainMesh->clearErosionMaps();
+		terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+	}
+
+	ImGui::SameLine();
+
+	// Written next to the executable as erosion_flow.pgm, erosion_eroded.pgm and erosion_deposited.pgm
+	if (ImGui::Button("Export Erosion Maps"))
+	{
+		terrainMesh->exportErosionMaps("erosion");
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::buildThermalErosionGui()
+{
+	ImGui::Text("Slides material down any slope steeper than the talus angle, i.e. to wear down faulting cliffs\n");
+
+	ImGui::SliderInt("Thermal Iterations", &thermalIterations, 1, 500);
+	ImGui::SliderFloat("Talus Angle", &talusAngle, 5.0f, 80.0f);
+	ImGui::SliderFloat("Thermal Erosion Rate", &thermalErosionRate, 0.01f, 0.5f);
+
+	terrainMesh->setTalusAngle(talusAngle);
+	terrainMesh->setThermalErosionRate(thermalErosionRate);
+
+	if (ImGui::Button("Thermal Erode Terrain"))
+	{
+		terrainMesh->thermalErodeTerrain(thermalIterations);
+		terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1027,8 +1825,14 @@ void App1::buildPerlinNoiseGui()
 		static int algoState = 0;
 
 		ImGui::RadioButton("Old PN Algo", &algoState, 0); ImGui::SameLine(); ImGui::RadioButton("Improved PN Algo", &algoState, 1);
+		ImGui::SameLine(); ImGui::RadioButton("Simplex Algo", &algoState, 2);
 
-		if (algoState)
+		if (algoState == 2)
+		{
+			// 'S' == Simplex algorithm
+			terrainMesh->setPerlinAlgoType('S');
+		}
+		else if (algoState)
 		{
 			// 'I' == Improved algorithm
 			terrainMesh->setPerlinAlgoType('I');
@@ -1039,6 +1843,18 @@ void App1::buildPerlinNoiseGui()
 			terrainMesh->setPerlinAlgoType('O');
 		}
 
+		// 0 is the original noise, the same seed always gives the same terrain
+		ImGui::InputInt("Noise Seed", &noiseSeed);
+		noiseSeed = noiseSeed < 0 ? 0 : noiseSeed;
+		terrainMesh->setPerlinSeed((unsigned int)noiseSeed);
+
+		// Which tile of a bigger world this is, the same tile with the same settings always joins up with its neighbours
+		ImGui::InputInt("Tile X", &perlinTileX);
+		ImGui::InputInt("Tile Z", &perlinTileZ);
+		// 0 for no wrapping, otherwise the noise repeats after this many tiles
+		ImGui::SliderInt("Tiles Per Period", &tilesPerPeriod, 0, 8);
+		terrainMesh->setPerlinTile(perlinTileX, perlinTileZ, tilesPerPeriod);
+
 		static int noiseStyle = 0;
 
 		if (ImGui::RadioButton("Normal Noise", &noiseStyle, 0))
@@ -1076,6 +1892,16 @@ void App1::buildPerlinNoiseGui()
 			addFixedNoise = true;
 		}
 
+		// The same, but with the sample positions pushed around by more noise first
+		ImGui::SliderInt("Warp Levels", &warpLevels, 1, 2);
+		ImGui::SliderFloat("Warp Strength", &warpStrength, 0.0f, 4.0f);
+		if (ImGui::Button("Add Domain Warped Noise Using Current Freq/Scale Values"))
+		{
+			initialTextureBounds();
+
+			addWarpedNoise = true;
+		}
+
 		//ImGui::SameLine();
 
 		// Generate a new random map
@@ -1112,6 +1938,49 @@ void App1::buildPerlinNoiseGui()
 			{
 				runAllOctaves = true;
 			}
+
+			// Every octave in one pass, with the slopes dampening the detail, the Old PN algo uses Improved PN for this
+			if (ImGui::Button("Run Eroded fBm Octaves (One Pass)"))
+			{
+				runErodedfBm = true;
+			}
+		}
+
+		ImGui::Text("Normals: %s", terrainMesh->hasAnalyticNormals() ? "Analytic (Noise Derivatives)" : "Finite Differences");
+
+		ImGui::TreePop();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void App1::buildWorleyNoiseGui()
+{
+	if (ImGui::TreeNode("Worley Noise"))
+	{
+		// A negative amplitude gives pits (craters) at the feature points rather than cones
+		ImGui::SliderFloat("Worley Amplitude", &worleyAmplitude, -15.0f, 15.0f);
+		ImGui::SliderFloat("Worley Frequency", &worleyFreq, 0.01f, 0.2f);
+		ImGui::SliderFloat("Jitter", &worleyJitter, 0.0f, 1.0f);
+		ImGui::InputInt("Worley Seed", &worleySeed);
+
+		ImGui::RadioButton("Euclidean", &worleyMetric, 0); ImGui::SameLine();
+		ImGui::RadioButton("Manhattan", &worleyMetric, 1); ImGui::SameLine();
+		ImGui::RadioButton("Chebyshev", &worleyMetric, 2);
+
+		ImGui::RadioButton("F1", &worleyFeature, 0); ImGui::SameLine();
+		ImGui::RadioButton("F2", &worleyFeature, 1); ImGui::SameLine();
+		ImGui::RadioButton("F2 - F1 (Cracks)", &worleyFeature, 2);
+
+		// Cumulatively add the cellular noise to the existing map
+		if (ImGui::Button("Add Worley Noise"))
+		{
+			// Reset the texture bounds to defaults when generating a new terrian
+			initialTextureBounds();
+
+			terrainMesh->setWorleyParams(worleyFreq, worleyAmplitude, worleyJitter, (WorleyNoise::Metric)worleyMetric, (WorleyNoise::Feature)worleyFeature, (unsigned int)worleySeed);
+			terrainMesh->genWorleyNoise();
+			terrainMesh->generateTerrain(renderer->getDevice(), renderer->getDeviceContext());
 		}
 
 		ImGui::TreePop();
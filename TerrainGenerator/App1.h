@@ -6,8 +6,11 @@
  *		- Initialisation of all lights
  *
  *		- Processing GUI input to render various terrain features
+ *		- Running batches of terrain jobs from a manifest
+ *		- Picking the terrain with the mouse, and walking on or staying above it with the camera
+ *		- Scattering trees over the terrain, and drawing them from a few cached tree variants
  *
- *		- Rendering of the terrain, and L-System
+ *		- Rendering of the terrain, L-System and forest
  *		- Rendering and updating the GUI
  *
  * Original @author Abertay University.
@@ -26,13 +29,17 @@
 #include "DXF.h"	// include dxframework
 #include <memory>
 #include "Terrain.h"
+#include "TerrainBatch.h"
 #include "TerrainShader.h"
 #include "CylinderMesh.h"
 #include "Leaf.h"
 #include "LSystem.h"
+#include "TreeTemplateCache.h"
 #include <stack>
 #include "LeafShader.h"
+#include "TreeShader.h"
 #include "LightShader.h"
+#include "FrustumCulling.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -53,6 +60,7 @@ public:
 protected:
 	bool render();
 	void renderLSystem();
+	void renderForest();
 	void gui();
 
 private:
@@ -70,7 +78,11 @@ private:
 	void checkFaulting();
 	void checkSmoothing();
 	void checkParticleDepo();
+	void checkErosionSession();
+	void checkUndoHistory();
 	void checkPerlinNoise();
+	void followTerrain();
+	void pickTerrain();
 	void adjustedTextureBounds();
 	void initialTextureBounds();
 
@@ -80,21 +92,84 @@ private:
 	void addCylinder(XMVECTOR& pos, XMMATRIX& currRot, XMVECTOR branchLen, float btmRadius, float topRadius);
 	void addLeaf(XMVECTOR& pos, XMMATRIX& currRot);
 	void resetLSystem();
+	void buildTreeTemplates();
+	void cullLSystem();
 
 	// Render functions
 	void buildAllGuiOptions();
 	void buildHydErosionGui();
+	void buildThermalErosionGui();
 	void buildCompleteTerrainGui();
 	void buildSmoothingGui();
 	void buildLSystemGUI();
 	void buildFaultingGui();
 	void buildParticleDepoGui();
 	void buildPerlinNoiseGui();
+	void buildWorleyNoiseGui();
+	void buildTerrainLODGui();
+	void buildHeightMapLayoutGui();
+	void buildBatchGui();
+	void buildUndoGui();
+	void buildImportGui();
+	void buildExportGui();
+	void buildCameraGui();
+	void buildVegetationGui();
 	void renderTerrain();
 
 	// Terrain objects
 	Terrain* terrainMesh;
 	TerrainShader* terrainShader;
+	std::vector<TerrainIndexRange> terrainDrawRanges;
+	TerrainBatch terrainBatch;
+	BatchResults batchResults;
+	std::string batchMessage;
+	bool batchFromCurrentTerrain = false;
+
+	// Two versions of the terrain kept to flip between, they only cost the pages that differ from the history
+	std::shared_ptr<const HeightMapSnapshot> snapshotA;
+	std::shared_ptr<const HeightMapSnapshot> snapshotB;
+
+	// Height map import and export
+	HeightMapImporter heightMapImporter;
+	char importFilename[256] = "heightmap.png";
+	int importFilter = HeightMapImporter::BILINEAR;
+	float importHeightRange[2] = { 0.0f, 20.0f };
+	std::string importMessage;
+	int exportFormat = HeightMapExporter::PNG_16;
+	std::string exportMessage;
+
+	// Picking and following the ground, in world space
+	bool walkOnTerrain = false;
+	bool stayAboveTerrain = false;
+	float eyeHeight = 2.0f;
+	bool leftMouseWasDown = false;
+	bool terrainPicked = false;
+	XMFLOAT3 pickedPoint = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+	// Vegetation, the height band comes from the texture bounds of whichever noise style is in use
+	VegetationScatter vegetationScatter;
+	std::vector<VegetationInstance> vegetationInstances;
+	int vegetationSeed = 0;
+	float treeSpacing = 2.0f;
+	float treeMaxSlope = 35.0f;
+	float treeBandFade = 1.0f;
+	float treeFlowWeight = 0.0f;
+	float treeScaleRange[2] = { 0.75f, 1.25f };
+
+	// Forest, every scattered tree is drawn as one of the cached variants, picked by its variant ID
+	TreeTemplateCache treeTemplates;
+	int treeVariants = 8;
+	int treeVariantIterations = 5;
+	int treeVariantSeed = 0;
+	float forestTreeScale = 1.5f;
+	bool drawForest = true;
+	bool forestBoundsChanged = false;		// The bounds are only rebuilt when the trees, variants or scale change
+	BoundingBoxList forestBounds;
+	std::vector<int> visibleTrees;
+	std::vector<VegetationInstance> visibleForest;		// The visible trees grouped by variant, as uploaded for instancing
+	std::vector<int> visibleForestStarts;				// Where each variant's run in visibleForest starts, plus one past the end
+
+	Frustum frustum;
 	Light* dirLight;
 	XMMATRIX worldMatrix, viewMatrix, projectionMatrix;
 
@@ -103,6 +178,8 @@ private:
 	bool smoothingValsSet;
 	bool fBmValsSet;
 	bool haveEroded;
+	bool terrainLODToggle;
+	bool frustumCullingToggle;
 
 	// For Smoothing
 	bool loopSmoothing;
@@ -119,17 +196,28 @@ private:
 	// For Perlin Noise and fBm
 	bool newRandomNoise;
 	bool addFixedNoise;
+	bool addWarpedNoise;
 	bool ridgedPerlinToggle;
 	bool terracedPerlinToggle;
 	bool fBmToggle;
 	bool runSingleOctave;
 	bool runAllOctaves;
+	bool runErodedfBm;
 
 	int terrainResolution;
+	int heightMapLayout;
 	int faultingIterations;
 	int particleDepoIterations;
 	int smoothingIterations;
 	int fBmOctaves;
+	int warpLevels;
+	int noiseSeed;
+	int perlinTileX;
+	int perlinTileZ;
+	int tilesPerPeriod;
+	int worleyMetric;
+	int worleyFeature;
+	int worleySeed;
 
 	float N_waterLowerBound;
 	float N_waterUpperbound;
@@ -147,9 +235,14 @@ private:
 	LSystem l_System;
 	LeafShader* leafShader;
 	LightShader* lightShader;
+	TreeShader* treeShader;
 
 	std::vector<CylinderMesh*> m_CylinderList;
 	std::vector<Leaf*> leafList;	
+	BoundingBoxList cylinderBounds;
+	BoundingBoxList leafBounds;
+	std::vector<int> visibleCylinders;
+	std::vector<int> visibleLeaves;
 	std::map<std::string, bool> systems;
 	std::stack<XMVECTOR> position;
 	std::stack<XMMATRIX> rotation;
@@ -180,10 +273,42 @@ private:
 	//float initialWaterVolume = 1.0f;		// This part of the particle
 	//float initialSpeed = 1.0f;
 
+	// Pyramid (coarse to fine) erosion
+	int pyramidLevels = 2;
+	int pyramidDropletsPerLevel = 75000;
+	int pyramidFineDroplets = 75000;
+
+	// Eroding over time, a slice each frame
+	float erosionSliceMs = 8.0f;
+
+	// Erosion maps, recorded while the droplets erode and used to texture the terrain
+	bool recordErosionMaps = false;
+	bool useErosionMaps = false;
+	float erosionMapStrength = 1.0f;
+
+	// Shallow Water (grid based) Hydraulic Erosion
+	int erosionMode = 0;					// 0 for droplets, 1 for shallow water
+	int shallowWaterSteps = 500;
+	float rainRate = 0.2f;
+	float waterEvaporationRate = 0.5f;
+	float waterSedimentCapacity = 0.2f;
+	float dissolveRate = 0.3f;
+	float sedimentDepositRate = 0.3f;
+
+	// Thermal Erosion
+	int thermalIterations = 50;
+	float talusAngle = 35.0f;				// The steepest slope material can rest at, in degrees
+	float thermalErosionRate = 0.25f;		// How much of the material over the talus angle moves each iteration
+
 	// GUI vals
+	float terrainMaxPixelError;
 	float perlinFreq;
 	float perlinScale;
 	float amplitude;
+	float warpStrength;
+	float worleyFreq;
+	float worleyAmplitude;
+	float worleyJitter;
 	float noiseStyleValue;
 };
 
@@ -0,0 +1,107 @@
+/*
+ * This is the Erosion Brush Cache class it handles:
+ *		- Building the erosion brush, i.e. which points around a droplet it erodes from and by how much
+ *		- Keeping every brush it has built, one for each resolution and radius, so switching between them is free
+ *
+ * A brush is only the offsets and weights around a droplet, the same everywhere on the map, so one brush is
+ * tiny whatever the resolution. Near the edges the points off the map are skipped and the rest reweighted
+ * as the droplet uses it, see HydraulicErosion::simulateDroplet().
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "ErosionBrushCache.h"
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+ErosionBrushCache::ErosionBrushCache()
+{
+
+}
+
+ErosionBrushCache::~ErosionBrushCache()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+const ErosionBrush& ErosionBrushCache::getBrush(int resolution, int radius)
+{
+	std::pair<int, int> key(resolution, radius);
+	auto found = brushes.find(key);
+
+	if (found != brushes.end())
+	{
+		return found->second;
+	}
+
+	ErosionBrush& brush = brushes[key];
+	brush.resolution = resolution;
+	brush.radius = radius;
+	buildBrush(brush);
+
+	return brush;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ErosionBrushCache::clear()
+{
+	brushes.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int ErosionBrushCache::getBrushCount()
+{
+	return (int)brushes.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ErosionBrushCache::buildBrush(ErosionBrush& brush)
+{
+	const int radius = brush.radius;
+	float weightSum = 0;
+
+	// Start from negative radius, i.e. to the top of the droplet's node
+	// Moving through the node, and outwards again to the bottom
+	for (int z = -radius; z <= radius; z++)
+	{
+		// Start from negative radius, i.e. to the left of the droplet's node
+		// Moving through the node, and outwards again to the right
+		for (int x = -radius; x <= radius; x++)
+		{
+			// Get the straight line distance from the node to some point within the radius
+			float straightLineDist = x * x + z * z;
+
+			if (straightLineDist < radius * radius)
+			{
+				float weight = 1 - (sqrt(straightLineDist) / radius);
+
+				// Sum the weight so we can normalise later
+				weightSum += weight;
+				brush.weights.push_back(weight);
+				brush.offsetX.push_back(x);
+				brush.offsetZ.push_back(z);
+				brush.rowMajorOffset.push_back(z * brush.resolution + x);
+			}
+		}
+	}
+
+	for (int i = 0; i < (int)brush.weights.size(); ++i)
+	{
+		brush.weights[i] /= weightSum;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
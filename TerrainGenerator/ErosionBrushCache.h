@@ -0,0 +1,58 @@
+/*
+ * This is the Erosion Brush Cache class it handles:
+ *		- Building the erosion brush, i.e. which points around a droplet it erodes from and by how much
+ *		- Keeping every brush it has built, one for each resolution and radius, so switching between them is free
+ *
+ * A brush is only the offsets and weights around a droplet, the same everywhere on the map, so one brush is
+ * tiny whatever the resolution. Near the edges the points off the map are skipped and the rest reweighted
+ * as the droplet uses it, see HydraulicErosion::simulateDroplet().
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <map>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct ErosionBrush
+{
+	int resolution;
+	int radius;
+
+	// Every point within the radius of the droplet's node, and how much of the erosion it takes, the weights add up to 1
+	std::vector<int> offsetX;
+	std::vector<int> offsetZ;
+	std::vector<int> rowMajorOffset;		// offsetZ * resolution + offsetX, so a row-major height map can skip index()
+	std::vector<float> weights;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ErosionBrushCache
+{
+public:
+	ErosionBrushCache();
+	~ErosionBrushCache();
+
+	// Built the first time each resolution and radius is asked for, the reference is good until clear()
+	const ErosionBrush& getBrush(int resolution, int radius);
+	// Throw every brush away, i.e. when the terrain is resized and the old resolution's brushes are no use
+	void clear();
+	int getBrushCount();
+
+private:
+	void buildBrush(ErosionBrush& brush);
+
+	// A map so the brushes never move as more are added
+	std::map<std::pair<int, int>, ErosionBrush> brushes;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
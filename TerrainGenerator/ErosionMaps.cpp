@@ -0,0 +1,217 @@
+/*
+ * This is the Erosion Maps class it handles:
+ *		- Recording what the droplet (hydraulic) erosion did at each grid point, on top of the heights it changed:
+ *			* Flow, how many droplet steps passed through the point
+ *			* Eroded, the total height the droplets took away
+ *			* Deposited, the total height the droplets laid down
+ *		- Adding one set of maps into another, so each run (or thread) can record into its own maps and be summed after
+ *		- Exporting the maps as 16 bit greyscale images
+ *		- Packing the maps into RGBA8 texels, so the terrain shader can use them as splat masks
+ *
+ * The maps use the same layout as the height map, so the erosion can record into them with the
+ * storage indices it already has, i.e. from the erosion brush.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "ErosionMaps.h"
+#include "ParallelFor.h"
+#include <cmath>
+#include <fstream>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+ErosionMaps::ErosionMaps()
+{
+
+}
+
+ErosionMaps::~ErosionMaps()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void ErosionMaps::resize(int res, HeightMap::Layout layout)
+{
+	flow.resize(res, layout);
+	eroded.resize(res, layout);
+	deposited.resize(res, layout);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ErosionMaps::setLayout(HeightMap::Layout layout)
+{
+	flow.setLayout(layout);
+	eroded.setLayout(layout);
+	deposited.setLayout(layout);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ErosionMaps::clear()
+{
+	flow.fill(0.0f);
+	eroded.fill(0.0f);
+	deposited.fill(0.0f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ErosionMaps::add(const ErosionMaps& other)
+{
+	float* flowTotals = flow.data();
+	float* erodedTotals = eroded.data();
+	float* depositedTotals = deposited.data();
+	const float* otherFlow = other.flow.data();
+	const float* otherEroded = other.eroded.data();
+	const float* otherDeposited = other.deposited.data();
+
+	// Every point is independent, so the storage can just be split into blocks
+	ParallelFor::run(flow.getStorageSize(), [&](int start, int end)
+	{
+		for (int i = start; i < end; ++i)
+		{
+			flowTotals[i] += otherFlow[i];
+			erodedTotals[i] += otherEroded[i];
+			depositedTotals[i] += otherDeposited[i];
+		}
+	}, 4096);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ErosionMaps::exportMaps(const std::string& prefix) const
+{
+	bool exported = exportMap(flow, prefix + "_flow.pgm", true);
+	exported = exportMap(eroded, prefix + "_eroded.pgm", false) && exported;
+	exported = exportMap(deposited, prefix + "_deposited.pgm", false) && exported;
+
+	return exported;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ErosionMaps::exportMap(const HeightMap& map, const std::string& filename, bool logScale) const
+{
+	std::ofstream file(filename, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	const int res = map.getResolution();
+	float largest = findLargest(map);
+
+	// Scale so the largest value is white, an empty map stays black
+	float scale = 0.0f;
+
+	if (largest > 0.0f)
+	{
+		scale = 65535.0f / (logScale ? log1pf(largest) : largest);
+	}
+
+	// Binary PGM, 16 bit samples are big endian
+	file << "P5\n" << res << " " << res << "\n65535\n";
+
+	std::vector<unsigned char> row(res * 2);
+
+	for (int z = 0; z < res; ++z)
+	{
+		for (int x = 0; x < res; ++x)
+		{
+			float value = map.at(x, z);
+			value = (logScale ? log1pf(value) : value) * scale;
+
+			unsigned int sample = (unsigned int)fminf(fmaxf(value + 0.5f, 0.0f), 65535.0f);
+			row[x * 2] = (unsigned char)(sample >> 8);
+			row[x * 2 + 1] = (unsigned char)(sample & 0xFF);
+		}
+
+		file.write((const char*)row.data(), row.size());
+	}
+
+	return (bool)file;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ErosionMaps::buildSplatTexels(std::vector<unsigned int>& texels) const
+{
+	const int res = flow.getResolution();
+	texels.resize(res * res);
+
+	float largestFlow = findLargest(flow);
+	float largestEroded = findLargest(eroded);
+	float largestDeposited = findLargest(deposited);
+
+	float flowScale = largestFlow > 0.0f ? 255.0f / log1pf(largestFlow) : 0.0f;
+	float erodedScale = largestEroded > 0.0f ? 255.0f / largestEroded : 0.0f;
+	float depositedScale = largestDeposited > 0.0f ? 255.0f / largestDeposited : 0.0f;
+
+	ParallelFor::run(res, [&](int startZ, int endZ)
+	{
+		for (int z = startZ; z < endZ; ++z)
+		{
+			for (int x = 0; x < res; ++x)
+			{
+				int i = flow.index(x, z);
+
+				unsigned int r = (unsigned int)(log1pf(flow[i]) * flowScale + 0.5f);
+				unsigned int g = (unsigned int)(fmaxf(eroded[i], 0.0f) * erodedScale + 0.5f);
+				unsigned int b = (unsigned int)(fmaxf(deposited[i], 0.0f) * depositedScale + 0.5f);
+
+				// DXGI_FORMAT_R8G8B8A8_UNORM, r is the lowest byte
+				texels[z * res + x] = r | (g << 8) | (b << 16) | 0xFF000000;
+			}
+		}
+	});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float ErosionMaps::findLargest(const HeightMap& map) const
+{
+	float largest = 0.0f;
+	const float* values = map.data();
+
+	for (int i = 0; i < map.getStorageSize(); ++i)
+	{
+		largest = fmaxf(largest, values[i]);
+	}
+
+	return largest;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightMap& ErosionMaps::getFlow()
+{
+	return flow;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightMap& ErosionMaps::getEroded()
+{
+	return eroded;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightMap& ErosionMaps::getDeposited()
+{
+	return deposited;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
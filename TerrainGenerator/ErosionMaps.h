@@ -0,0 +1,61 @@
+/*
+ * This is the Erosion Maps class it handles:
+ *		- Recording what the droplet (hydraulic) erosion did at each grid point, on top of the heights it changed:
+ *			* Flow, how many droplet steps passed through the point
+ *			* Eroded, the total height the droplets took away
+ *			* Deposited, the total height the droplets laid down
+ *		- Adding one set of maps into another, so each run (or thread) can record into its own maps and be summed after
+ *		- Exporting the maps as 16 bit greyscale images
+ *		- Packing the maps into RGBA8 texels, so the terrain shader can use them as splat masks
+ *
+ * The maps use the same layout as the height map, so the erosion can record into them with the
+ * storage indices it already has, i.e. from the erosion brush.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <string>
+#include <vector>
+#include "HeightMap.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ErosionMaps
+{
+public:
+	ErosionMaps();
+	~ErosionMaps();
+
+	// Clears the maps, they MUST match the height map's resolution and layout to be recorded into
+	void resize(int res, HeightMap::Layout layout);
+	void setLayout(HeightMap::Layout layout);
+	void clear();
+	// Sum other's maps into these, other MUST be the same size and layout
+	void add(const ErosionMaps& other);
+
+	// Writes <prefix>_flow.pgm, <prefix>_eroded.pgm and <prefix>_deposited.pgm, each scaled to the full 16 bit range
+	bool exportMaps(const std::string& prefix) const;
+	// One RGBA8 texel per grid point in row-major order, r = flow, g = eroded, b = deposited, a unused
+	// Each is scaled to 0 -> 255 by its largest value, flow on a log scale as the main channels carry far more than the rest
+	void buildSplatTexels(std::vector<unsigned int>& texels) const;
+
+	HeightMap& getFlow();
+	HeightMap& getEroded();
+	HeightMap& getDeposited();
+
+private:
+	bool exportMap(const HeightMap& map, const std::string& filename, bool logScale) const;
+	float findLargest(const HeightMap& map) const;
+
+	HeightMap flow;
+	HeightMap eroded;
+	HeightMap deposited;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,47 @@
+/*
+ * This is the Erosion Random struct it handles:
+ *		- Giving out a repeatable stream of random numbers from a seed, with nothing shared between generators
+ *
+ * Each erosion run has its own so its droplets don't depend on whatever else calls rand(), and the vegetation
+ * scatter and tree templates use it for the same reason, so the same seed always gives the same result.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A small xorshift generator
+struct ErosionRandom
+{
+	unsigned int state;
+
+	explicit ErosionRandom(unsigned int seed = 0)
+	{
+		// xorshift must never be given 0
+		state = seed * 0x9E3779B9u + 0x6A09E667u;
+		state = state ? state : 0x6A09E667u;
+	}
+
+	inline unsigned int next()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// 0 -> 1, not including 1
+	inline float nextFloat()
+	{
+		return (next() >> 8) * (1.0f / 16777216.0f);
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,218 @@
+/*
+ * This is the Erosion Session class it handles:
+ *		- Running a hydraulic (droplet) erosion run a slice at a time, i.e. a few milliseconds each frame
+ *		  rather than every droplet at once
+ *		- Keeping the run's random number generator, settings and droplet count between slices
+ *		- Pausing, resuming and cancelling the run
+ *
+ * Droplets are only ever run whole and in order, from the session's own generator, so however the run is
+ * sliced up the terrain is exactly the same at the end as running every droplet in one go.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "ErosionSession.h"
+#include <chrono>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// How many droplets to run between looking at the clock
+const int DROPLETS_PER_TIME_CHECK = 64;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+ErosionSession::ErosionSession(HydraulicErosion& erosion) : hydraulicErosion(erosion)
+{
+	// Default values
+	params = hydraulicErosion.getParams();
+	totalMaps = nullptr;
+	state = IDLE;
+	dropletCount = 0;
+	dropletsRun = 0;
+}
+
+ErosionSession::~ErosionSession()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void ErosionSession::start(int droplets, unsigned int seed, ErosionMaps* maps)
+{
+	if (isActive())
+	{
+		cancel();
+	}
+
+	params = hydraulicErosion.getParams();
+	random = ErosionRandom(seed);
+	totalMaps = maps;
+
+	if (totalMaps)
+	{
+		HeightMap& flow = totalMaps->getFlow();
+		sessionMaps.resize(flow.getResolution(), flow.getLayout());
+	}
+
+	dropletCount = droplets;
+	dropletsRun = 0;
+	state = RUNNING;
+
+	if (dropletCount <= 0)
+	{
+		end(FINISHED);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int ErosionSession::runDroplets(int count)
+{
+	if (state != RUNNING)
+	{
+		return 0;
+	}
+
+	float* flowCounts = nullptr;
+	float* erodedTotals = nullptr;
+	float* depositedTotals = nullptr;
+
+	if (totalMaps)
+	{
+		flowCounts = sessionMaps.getFlow().data();
+		erodedTotals = sessionMaps.getEroded().data();
+		depositedTotals = sessionMaps.getDeposited().data();
+	}
+
+	int toRun = count < dropletCount - dropletsRun ? count : dropletCount - dropletsRun;
+
+	for (int i = 0; i < toRun; ++i)
+	{
+		hydraulicErosion.simulateDroplet(random, params, flowCounts, erodedTotals, depositedTotals);
+	}
+
+	dropletsRun += toRun;
+
+	if (dropletsRun >= dropletCount)
+	{
+		end(FINISHED);
+	}
+
+	return toRun;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int ErosionSession::runFor(float milliseconds)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	int totalRun = 0;
+
+	while (state == RUNNING)
+	{
+		totalRun += runDroplets(DROPLETS_PER_TIME_CHECK);
+
+		auto now = std::chrono::high_resolution_clock::now();
+
+		if (std::chrono::duration<float, std::milli>(now - start).count() >= milliseconds)
+		{
+			break;
+		}
+	}
+
+	return totalRun;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ErosionSession::pause()
+{
+	if (state == RUNNING)
+	{
+		state = PAUSED;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ErosionSession::resume()
+{
+	if (state == PAUSED)
+	{
+		state = RUNNING;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ErosionSession::cancel()
+{
+	if (isActive())
+	{
+		end(CANCELLED);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ErosionSession::end(State endState)
+{
+	// Whatever was eroded is in the height map now, so it's recorded in the maps too
+	if (totalMaps)
+	{
+		totalMaps->add(sessionMaps);
+		totalMaps = nullptr;
+	}
+
+	state = endState;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ErosionSession::State ErosionSession::getState()
+{
+	return state;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ErosionSession::isActive()
+{
+	return state == RUNNING || state == PAUSED;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int ErosionSession::getDropletsRun()
+{
+	return dropletsRun;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int ErosionSession::getDropletCount()
+{
+	return dropletCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float ErosionSession::getProgress()
+{
+	if (dropletCount <= 0)
+	{
+		return state == FINISHED ? 1.0f : 0.0f;
+	}
+
+	return (float)dropletsRun / (float)dropletCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,75 @@
+/*
+ * This is the Erosion Session class it handles:
+ *		- Running a hydraulic (droplet) erosion run a slice at a time, i.e. a few milliseconds each frame
+ *		  rather than every droplet at once
+ *		- Keeping the run's random number generator, settings and droplet count between slices
+ *		- Pausing, resuming and cancelling the run
+ *
+ * Droplets are only ever run whole and in order, from the session's own generator, so however the run is
+ * sliced up the terrain is exactly the same at the end as running every droplet in one go.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include "HydraulicErosion.h"
+#include "ErosionMaps.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ErosionSession
+{
+public:
+	enum State
+	{
+		IDLE,
+		RUNNING,
+		PAUSED,
+		FINISHED,
+		CANCELLED
+	};
+
+	ErosionSession(HydraulicErosion& erosion);
+	~ErosionSession();
+
+	// Takes a copy of the erosion's current settings, any session still going is cancelled first
+	// If maps is given the session records into its own maps and adds them to these once it finishes or is cancelled,
+	// they MUST be the height map's size and layout, and stay that way until then
+	void start(int droplets, unsigned int seed, ErosionMaps* maps = nullptr);
+	// Runs up to count droplets, returns how many were run, always 0 unless RUNNING
+	int runDroplets(int count);
+	// Runs droplets until the time is used up, only whole droplets, so it can go over by up to one droplet
+	int runFor(float milliseconds);
+	void pause();
+	void resume();
+	// Stops where it is, what has been eroded so far stays
+	void cancel();
+
+	State getState();
+	bool isActive();				// Running or paused, i.e. there are droplets left to run
+	int getDropletsRun();
+	int getDropletCount();
+	float getProgress();			// 0 -> 1
+
+private:
+	void end(State endState);
+
+	HydraulicErosion& hydraulicErosion;
+
+	HydraulicErosion::DropletParams params;
+	ErosionRandom random;
+
+	ErosionMaps sessionMaps;
+	ErosionMaps* totalMaps;
+
+	State state;
+	int dropletCount;
+	int dropletsRun;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -16,7 +16,7 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // CONSTRUCTOR / DESTRUCTOR
-Faulting::Faulting(int& res, float* heightmp) : resolution(res), heightmap(heightmp)
+Faulting::Faulting(int& res, HeightMap& heightmp) : resolution(res), heightmap(heightmp)
 {
 
 }
@@ -108,12 +108,12 @@ void Faulting::createFault()
 			if (returnVec.y > 0)
 			{
 				// Increment the current index pos value;
-				heightmap[(z * resolution) + x] = heightmap[(z * resolution) + x] + 1.0f;
+				heightmap.at(x, z) = heightmap.at(x, z) + 1.0f;
 			}
 			else
 			{
 				// Decrement the current index pos value;
-				heightmap[(z * resolution) + x] = heightmap[(z * resolution) + x] - 1.0f;
+				heightmap.at(x, z) = heightmap.at(x, z) - 1.0f;
 			}
 		}
 	}
@@ -121,13 +121,6 @@ void Faulting::createFault()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void Faulting::updateHeightMap(float* newHeightMap)
-{
-	heightmap = newHeightMap;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
 Coord* Faulting::getPosition(int prevEdge)
 {
 	Coord* position = new Coord;
@@ -12,6 +12,7 @@
 // INCLUDES
 #pragma once
 #include <DirectXMath.h>
+#include "HeightMap.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -40,18 +41,17 @@ struct Line
 class Faulting
 {
 public:
-	Faulting(int& res, float* heightmp);
+	Faulting(int& res, HeightMap& heightmp);
 	~Faulting();
 
 	void createFault();
-	void updateHeightMap(float* newHeightMap);
 
 private:
 	
 	Coord* getPosition(int prevEdge = 0);
 
 	int& resolution;
-	float* heightmap;
+	HeightMap& heightmap;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -0,0 +1,262 @@
+/*
+ * This is the Frustum Culling class it handles:
+ *		- Extracting the six frustum planes from a (world) view projection matrix
+ *		- Storing axis aligned bounding boxes as seperate min/max arrays (SoA) so they can be loaded 4 at a time
+ *		- Testing batches of boxes against the frustum with SSE, 4 boxes at a time
+ *		- Writing out a compacted list of the indices of the visible boxes
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "FrustumCulling.h"
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// BOUNDING BOX LIST
+void BoundingBoxList::clear()
+{
+	minX.clear();
+	minY.clear();
+	minZ.clear();
+	maxX.clear();
+	maxY.clear();
+	maxZ.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void BoundingBoxList::reserve(int count)
+{
+	minX.reserve(count);
+	minY.reserve(count);
+	minZ.reserve(count);
+	maxX.reserve(count);
+	maxY.reserve(count);
+	maxZ.reserve(count);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void BoundingBoxList::add(const XMFLOAT3& min, const XMFLOAT3& max)
+{
+	minX.push_back(min.x);
+	minY.push_back(min.y);
+	minZ.push_back(min.z);
+	maxX.push_back(max.x);
+	maxY.push_back(max.y);
+	maxZ.push_back(max.z);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int BoundingBoxList::size() const
+{
+	return (int)minX.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+Frustum::Frustum()
+{
+	for (int i = 0; i < PLANE_COUNT; ++i)
+	{
+		planes[i] = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+	}
+}
+
+Frustum::~Frustum()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void Frustum::extractPlanes(const XMMATRIX& viewProjection)
+{
+	// Ref:
+	// Gribb, G. and Hartmann, K. (2001) Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix
+
+	/*
+	* DirectX multiplies row vectors, so clip = v * M and each clip component is v dotted with a column of M.
+	* A point is inside when -w <= x <= w, -w <= y <= w and 0 <= z <= w, which gives:
+	*	left = col3 + col0,		right = col3 - col0
+	*	bottom = col3 + col1,	top = col3 - col1
+	*	near = col2,			far = col3 - col2
+	*/
+
+	XMFLOAT4X4 m;
+	XMStoreFloat4x4(&m, viewProjection);
+
+	planes[LEFT] = XMFLOAT4(m._14 + m._11, m._24 + m._21, m._34 + m._31, m._44 + m._41);
+	planes[RIGHT] = XMFLOAT4(m._14 - m._11, m._24 - m._21, m._34 - m._31, m._44 - m._41);
+	planes[BOTTOM] = XMFLOAT4(m._14 + m._12, m._24 + m._22, m._34 + m._32, m._44 + m._42);
+	planes[TOP] = XMFLOAT4(m._14 - m._12, m._24 - m._22, m._34 - m._32, m._44 - m._42);
+	planes[NEAR_PLANE] = XMFLOAT4(m._13, m._23, m._33, m._43);
+	planes[FAR_PLANE] = XMFLOAT4(m._14 - m._13, m._24 - m._23, m._34 - m._33, m._44 - m._43);
+
+	// Normalise, so the plane equation gives a true distance
+	for (int i = 0; i < PLANE_COUNT; ++i)
+	{
+		float mag = sqrtf(planes[i].x * planes[i].x + planes[i].y * planes[i].y + planes[i].z * planes[i].z);
+
+		if (mag > 0.0f)
+		{
+			planes[i].x /= mag;
+			planes[i].y /= mag;
+			planes[i].z /= mag;
+			planes[i].w /= mag;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Frustum::isBoxVisible(const XMFLOAT3& min, const XMFLOAT3& max) const
+{
+	// Only the corner furthest along the plane normal (the 'positive vertex') needs tested,
+	// if that is behind any one plane then the whole box is outside
+	for (int i = 0; i < PLANE_COUNT; ++i)
+	{
+		const XMFLOAT4& plane = planes[i];
+
+		float px = plane.x >= 0.0f ? max.x : min.x;
+		float py = plane.y >= 0.0f ? max.y : min.y;
+		float pz = plane.z >= 0.0f ? max.z : min.z;
+
+		if (plane.x * px + plane.y * py + plane.z * pz + plane.w < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int Frustum::cullBoxes(const BoundingBoxList& boxes, std::vector<int>& visibleIndices) const
+{
+	/*
+	* Same test as isBoxVisible, but for 4 boxes at a time.
+	* The plane normal is the same for all 4 boxes, so which of min/max is the positive vertex is picked once per plane
+	* and is just a choice of which array to load from, there is no per box select.
+	*/
+
+	int count = boxes.size();
+
+	// Room for a full block of 4 to be written before the count is known
+	visibleIndices.resize(count + 4);
+
+	const float* positiveX[PLANE_COUNT];
+	const float* positiveY[PLANE_COUNT];
+	const float* positiveZ[PLANE_COUNT];
+	__m128 planeX[PLANE_COUNT], planeY[PLANE_COUNT], planeZ[PLANE_COUNT], planeW[PLANE_COUNT];
+
+	for (int p = 0; p < PLANE_COUNT; ++p)
+	{
+		positiveX[p] = planes[p].x >= 0.0f ? boxes.maxX.data() : boxes.minX.data();
+		positiveY[p] = planes[p].y >= 0.0f ? boxes.maxY.data() : boxes.minY.data();
+		positiveZ[p] = planes[p].z >= 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+
+		planeX[p] = _mm_set1_ps(planes[p].x);
+		planeY[p] = _mm_set1_ps(planes[p].y);
+		planeZ[p] = _mm_set1_ps(planes[p].z);
+		planeW[p] = _mm_set1_ps(planes[p].w);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	int* out = visibleIndices.data();
+	int visibleCount = 0;
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 outside = _mm_setzero_ps();
+
+		for (int p = 0; p < PLANE_COUNT; ++p)
+		{
+			__m128 distance = _mm_add_ps(_mm_mul_ps(planeX[p], _mm_loadu_ps(positiveX[p] + i)), planeW[p]);
+			distance = _mm_add_ps(distance, _mm_mul_ps(planeY[p], _mm_loadu_ps(positiveY[p] + i)));
+			distance = _mm_add_ps(distance, _mm_mul_ps(planeZ[p], _mm_loadu_ps(positiveZ[p] + i)));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero));
+		}
+
+		int visibleMask = ~_mm_movemask_ps(outside) & 0xF;
+
+		// Branchless compaction, always write the index but only move on if it was visible
+		out[visibleCount] = i;
+		visibleCount += visibleMask & 1;
+		out[visibleCount] = i + 1;
+		visibleCount += (visibleMask >> 1) & 1;
+		out[visibleCount] = i + 2;
+		visibleCount += (visibleMask >> 2) & 1;
+		out[visibleCount] = i + 3;
+		visibleCount += (visibleMask >> 3) & 1;
+	}
+
+	// Any remaining boxes
+	for (; i < count; ++i)
+	{
+		XMFLOAT3 min(boxes.minX[i], boxes.minY[i], boxes.minZ[i]);
+		XMFLOAT3 max(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]);
+
+		if (isBoxVisible(min, max))
+		{
+			out[visibleCount] = i;
+			++visibleCount;
+		}
+	}
+
+	visibleIndices.resize(visibleCount);
+
+	return visibleCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Frustum::transformBox(const XMMATRIX& transform, const XMFLOAT3& min, const XMFLOAT3& max, XMFLOAT3& outMin, XMFLOAT3& outMax)
+{
+	// Ref:
+	// Arvo, J. (1990) Transforming Axis-Aligned Bounding Boxes, Graphics Gems
+
+	XMFLOAT4X4 m;
+	XMStoreFloat4x4(&m, transform);
+
+	const float boxMin[3] = { min.x, min.y, min.z };
+	const float boxMax[3] = { max.x, max.y, max.z };
+	float newMin[3] = { m._41, m._42, m._43 };
+	float newMax[3] = { m._41, m._42, m._43 };
+
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			float a = m.m[i][j] * boxMin[i];
+			float b = m.m[i][j] * boxMax[i];
+			newMin[j] += std::min(a, b);
+			newMax[j] += std::max(a, b);
+		}
+	}
+
+	outMin = XMFLOAT3(newMin[0], newMin[1], newMin[2]);
+	outMax = XMFLOAT3(newMax[0], newMax[1], newMax[2]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const XMFLOAT4& Frustum::getPlane(int plane) const
+{
+	return planes[plane];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,73 @@
+/*
+ * This is the Frustum Culling class it handles:
+ *		- Extracting the six frustum planes from a (world) view projection matrix
+ *		- Storing axis aligned bounding boxes as seperate min/max arrays (SoA) so they can be loaded 4 at a time
+ *		- Testing batches of boxes against the frustum with SSE, 4 boxes at a time
+ *		- Writing out a compacted list of the indices of the visible boxes
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace DirectX;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A list of AABBs, each component has its own array
+struct BoundingBoxList
+{
+	std::vector<float> minX, minY, minZ;
+	std::vector<float> maxX, maxY, maxZ;
+
+	void clear();
+	void reserve(int count);
+	void add(const XMFLOAT3& min, const XMFLOAT3& max);
+	int size() const;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class Frustum
+{
+public:
+	enum FrustumPlane
+	{
+		LEFT = 0,
+		RIGHT,
+		BOTTOM,
+		TOP,
+		NEAR_PLANE,
+		FAR_PLANE,
+		PLANE_COUNT
+	};
+
+	Frustum();
+	~Frustum();
+
+	// Pass in world * view * projection to get the planes in that object's local space
+	void extractPlanes(const XMMATRIX& viewProjection);
+
+	bool isBoxVisible(const XMFLOAT3& min, const XMFLOAT3& max) const;
+	// Fills visibleIndices with the index of every box that is at least partly inside, returns how many
+	int cullBoxes(const BoundingBoxList& boxes, std::vector<int>& visibleIndices) const;
+
+	// The AABB that encloses a transformed AABB
+	static void transformBox(const XMMATRIX& transform, const XMFLOAT3& min, const XMFLOAT3& max, XMFLOAT3& outMin, XMFLOAT3& outMax);
+
+	const XMFLOAT4& getPlane(int plane) const;
+
+private:
+	XMFLOAT4 planes[PLANE_COUNT];		// xyz = normal pointing into the frustum, w = distance
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
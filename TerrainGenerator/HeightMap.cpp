@@ -0,0 +1,160 @@
+/*
+ * This is the Height Map class it handles:
+ *		- Storing the terrain heights in either a row-major or a tiled (Z-order/Morton) layout
+ *		- Mapping (x, z) grid coords to a storage index for whichever layout is in use
+ *		- Switching between layouts without losing the heights
+ *		- Copying the heights to/from plain row-major arrays, i.e. for the vertex buffer
+ *
+ * In the tiled layout the map is split into 8x8 tiles stored one after another,
+ * with the 64 heights inside a tile stored in Morton order. This keeps the z +/- 1
+ * neighbours of a point close by in memory, rather than a whole row apart.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "HeightMap.h"
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const int HeightMap::mortonSpread[HeightMap::TILE_SIZE] = { 0, 1, 4, 5, 16, 17, 20, 21 };
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+HeightMap::HeightMap()
+{
+	resolution = 0;
+	tilesPerRow = 0;
+	layout = ROW_MAJOR;
+}
+
+HeightMap::~HeightMap()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void HeightMap::resize(int res, Layout newLayout)
+{
+	resolution = res;
+	layout = newLayout;
+	tilesPerRow = (resolution + TILE_SIZE - 1) / TILE_SIZE;
+
+	if (layout == ROW_MAJOR)
+	{
+		heights.assign(resolution * resolution, 0.0f);
+	}
+	else
+	{
+		heights.assign(tilesPerRow * tilesPerRow * TILE_SIZE * TILE_SIZE, 0.0f);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMap::setLayout(Layout newLayout)
+{
+	if (newLayout == layout)
+	{
+		return;
+	}
+
+	std::vector<float> rowMajor(resolution * resolution);
+	copyToRowMajor(rowMajor.data());
+
+	resize(resolution, newLayout);
+	copyFromRowMajor(rowMajor.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMap::fill(float height)
+{
+	for (int i = 0; i < (int)heights.size(); ++i)
+	{
+		heights[i] = height;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMap::copyToRowMajor(float* outHeights) const
+{
+	if (layout == ROW_MAJOR)
+	{
+		memcpy(outHeights, heights.data(), sizeof(float) * resolution * resolution);
+		return;
+	}
+
+	for (int z = 0; z < resolution; ++z)
+	{
+		for (int x = 0; x < resolution; ++x)
+		{
+			outHeights[z * resolution + x] = heights[index(x, z)];
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMap::copyFromRowMajor(const float* inHeights)
+{
+	if (layout == ROW_MAJOR)
+	{
+		memcpy(heights.data(), inHeights, sizeof(float) * resolution * resolution);
+		return;
+	}
+
+	for (int z = 0; z < resolution; ++z)
+	{
+		for (int x = 0; x < resolution; ++x)
+		{
+			heights[index(x, z)] = inHeights[z * resolution + x];
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int HeightMap::getResolution() const
+{
+	return resolution;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightMap::Layout HeightMap::getLayout() const
+{
+	return layout;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int HeightMap::getStorageSize() const
+{
+	return (int)heights.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float* HeightMap::data()
+{
+	return heights.data();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const float* HeightMap::data() const
+{
+	return heights.data();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,101 @@
+/*
+ * This is the Height Map class it handles:
+ *		- Storing the terrain heights in either a row-major or a tiled (Z-order/Morton) layout
+ *		- Mapping (x, z) grid coords to a storage index for whichever layout is in use
+ *		- Switching between layouts without losing the heights
+ *		- Copying the heights to/from plain row-major arrays, i.e. for the vertex buffer
+ *
+ * In the tiled layout the map is split into 8x8 tiles stored one after another,
+ * with the 64 heights inside a tile stored in Morton order. This keeps the z +/- 1
+ * neighbours of a point close by in memory, rather than a whole row apart.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HeightMap
+{
+public:
+	enum Layout
+	{
+		ROW_MAJOR = 0,
+		TILED
+	};
+
+	HeightMap();
+	~HeightMap();
+
+	// Any existing heights are lost, the new map is flat
+	void resize(int res, Layout newLayout);
+	// The heights are kept, only where they are stored changes
+	void setLayout(Layout newLayout);
+
+	void fill(float height);
+	void copyToRowMajor(float* outHeights) const;
+	void copyFromRowMajor(const float* heights);
+
+	// Storage index of grid point (x, z), x and z MUST be within 0 -> resolution - 1
+	inline int index(int x, int z) const
+	{
+		if (layout == ROW_MAJOR)
+		{
+			return z * resolution + x;
+		}
+
+		// Start of the tile, then the interleaved bits of x and z within it
+		int tile = (z >> TILE_SHIFT) * tilesPerRow + (x >> TILE_SHIFT);
+		return (tile << (TILE_SHIFT * 2)) + (mortonSpread[x & TILE_MASK] | (mortonSpread[z & TILE_MASK] << 1));
+	}
+
+	inline float& at(int x, int z)
+	{
+		return heights[index(x, z)];
+	}
+
+	inline float at(int x, int z) const
+	{
+		return heights[index(x, z)];
+	}
+
+	// Direct access by storage index, i.e. from index() or when every height is treated the same
+	inline float& operator[](int storageIndex)
+	{
+		return heights[storageIndex];
+	}
+
+	inline float operator[](int storageIndex) const
+	{
+		return heights[storageIndex];
+	}
+
+	int getResolution() const;
+	Layout getLayout() const;
+	// The tiled layout pads the map out to whole tiles, so this can be more than resolution * resolution
+	int getStorageSize() const;
+	float* data();
+	const float* data() const;
+
+private:
+	static const int TILE_SHIFT = 3;
+	static const int TILE_SIZE = 1 << TILE_SHIFT;
+	static const int TILE_MASK = TILE_SIZE - 1;
+
+	// The bits of a 3 bit number spread out to every other bit, 0b111 -> 0b10101
+	static const int mortonSpread[TILE_SIZE];
+
+	std::vector<float> heights;
+	int resolution;
+	int tilesPerRow;
+	Layout layout;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
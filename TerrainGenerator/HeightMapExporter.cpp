@@ -0,0 +1,647 @@
+/*
+ * This is the Height Map Exporter class it handles:
+ *		- Writing a height map out as a 16 bit greyscale PNG
+ *		- Writing a height map out as raw little endian 16 bit (.r16) or 32 bit float (.r32) heights
+ *		- Writing a height map out as a tiled container, where each tile is compressed on its own
+ *
+ * Every format is streamed, a band of rows (or a row of tiles) is converted on all threads, written, then the next
+ * band reuses the same buffer, so there's never a second copy of the whole map in memory.
+ *
+ * The PNG is uncompressed (stored deflate blocks), there's no zlib here and it keeps the export at disk speed, any
+ * image tool will happily recompress it. The 16 bit formats map the height range (the map's lowest to highest point,
+ * unless set) to 0 -> 65535, the PNG keeps the range in a tEXt chunk so it can be read back to the same heights.
+ *
+ * Tiled container (.hmt), everything little endian:
+ *		Header:		"HMT1", resolution, tile size, tiles per row, sample format (0 = 16 bit, 1 = 32 bit float),
+ *					height low, height high (floats), index offset (64 bit)
+ *		Tiles:		one after another, row by row, each one compressed or raw, see the index
+ *		Index:		per tile, offset (64 bit), size in bytes, compression (0 = raw, 1 = delta)
+ *
+ * Delta compression stores each sample as the zigzagged difference from the one before it, in as few 7 bit bytes as
+ * it needs, a tile is only kept raw if that doesn't make it any smaller.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "HeightMapExporter.h"
+#include "ParallelFor.h"
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The most a stored deflate block can hold
+const int MAX_STORED_BLOCK = 65535;
+
+// Bytes in a tiled container's header and in each tile's index entry
+const int TILED_HEADER_SIZE = 36;
+const int TILED_INDEX_ENTRY_SIZE = 16;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+HeightMapExporter::HeightMapExporter()
+{
+	// Default values
+	fixedRange = false;
+	heightLow = 0.0f;
+	heightHigh = 0.0f;
+	sampleScale = 0.0f;
+	tileSize = 256;
+	rowsPerBand = 64;
+}
+
+HeightMapExporter::~HeightMapExporter()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+bool HeightMapExporter::exportHeightMap(const HeightMap& heightmap, const std::string& filename, Format format)
+{
+	switch (format)
+	{
+		case PNG_16:
+		{
+			return exportPNG(heightmap, filename);
+		}
+		case RAW_16:
+		{
+			return exportRaw(heightmap, filename, false);
+		}
+		case RAW_32:
+		{
+			return exportRaw(heightmap, filename, true);
+		}
+		case TILED_16:
+		{
+			return exportTiled(heightmap, filename, false);
+		}
+		case TILED_32:
+		{
+			return exportTiled(heightmap, filename, true);
+		}
+	}
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapExporter::exportPNG(const HeightMap& heightmap, const std::string& filename)
+{
+	std::ofstream file(filename, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	findHeightRange(heightmap);
+
+	const int res = heightmap.getResolution();
+	const size_t rowBytes = 1 + (size_t)res * 2;		// The filter type (0, none) and then the big endian samples
+
+	static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write((const char*)signature, 8);
+
+	// Width, height, 16 bits, greyscale, deflate, no filtering, not interlaced
+	unsigned char header[13] =
+	{
+		(unsigned char)(res >> 24), (unsigned char)(res >> 16), (unsigned char)(res >> 8), (unsigned char)res,
+		(unsigned char)(res >> 24), (unsigned char)(res >> 16), (unsigned char)(res >> 8), (unsigned char)res,
+		16, 0, 0, 0, 0
+	};
+
+	writeChunk(file, "IHDR", header, 13);
+
+	// So the real heights can be got back when the PNG is read in again
+	char range[128];
+	int rangeLength = snprintf(range, sizeof(range), "HeightRange%c%.9g %.9g", '\0', heightLow, heightHigh);
+	writeChunk(file, "tEXt", (const unsigned char*)range, rangeLength);
+
+	std::vector<unsigned char> rows;
+	std::vector<unsigned char> idat;
+	unsigned int adler = 1;
+	bool zlibHeaderWritten = false;
+
+	for (int bandStart = 0; bandStart < res; bandStart += rowsPerBand)
+	{
+		int bandRows = res - bandStart < rowsPerBand ? res - bandStart : rowsPerBand;
+		rows.resize(bandRows * rowBytes);
+
+		ParallelFor::run(bandRows, [&](int startRow, int endRow)
+		{
+			for (int row = startRow; row < endRow; ++row)
+			{
+				unsigned char* out = &rows[row * rowBytes];
+				*out++ = 0;
+
+				for (int x = 0; x < res; ++x)
+				{
+					unsigned short sample = toSample16(heightmap.at(x, bandStart + row));
+					*out++ = (unsigned char)(sample >> 8);
+					*out++ = (unsigned char)(sample & 0xFF);
+				}
+			}
+		}, 4);
+
+		adler = updateAdler(adler, rows.data(), rows.size());
+
+		// The band as stored deflate blocks, each one byte aligned so no bit packing is needed
+		idat.clear();
+
+		if (!zlibHeaderWritten)
+		{
+			// Deflate, 32K window, no dictionary, the check bits make 0x7801 a multiple of 31
+			idat.push_back(0x78);
+			idat.push_back(0x01);
+			zlibHeaderWritten = true;
+		}
+
+		const bool lastBand = bandStart + bandRows >= res;
+
+		for (size_t offset = 0; offset < rows.size(); offset += MAX_STORED_BLOCK)
+		{
+			size_t length = rows.size() - offset < (size_t)MAX_STORED_BLOCK ? rows.size() - offset : (size_t)MAX_STORED_BLOCK;
+			bool finalBlock = lastBand && offset + length >= rows.size();
+
+			idat.push_back(finalBlock ? 1 : 0);
+			idat.push_back((unsigned char)(length & 0xFF));
+			idat.push_back((unsigned char)(length >> 8));
+			idat.push_back((unsigned char)(~length & 0xFF));
+			idat.push_back((unsigned char)((~length >> 8) & 0xFF));
+			idat.insert(idat.end(), rows.begin() + offset, rows.begin() + offset + length);
+		}
+
+		if (lastBand)
+		{
+			idat.push_back((unsigned char)(adler >> 24));
+			idat.push_back((unsigned char)(adler >> 16));
+			idat.push_back((unsigned char)(adler >> 8));
+			idat.push_back((unsigned char)adler);
+		}
+
+		writeChunk(file, "IDAT", idat.data(), idat.size());
+	}
+
+	writeChunk(file, "IEND", nullptr, 0);
+
+	return (bool)file;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapExporter::exportRaw(const HeightMap& heightmap, const std::string& filename, bool floatSamples)
+{
+	std::ofstream file(filename, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	if (!floatSamples)
+	{
+		findHeightRange(heightmap);
+	}
+
+	const int res = heightmap.getResolution();
+	const int sampleBytes = floatSamples ? 4 : 2;
+	const size_t rowBytes = (size_t)res * sampleBytes;
+
+	std::vector<unsigned char> rows;
+
+	for (int bandStart = 0; bandStart < res; bandStart += rowsPerBand)
+	{
+		int bandRows = res - bandStart < rowsPerBand ? res - bandStart : rowsPerBand;
+		rows.resize(bandRows * rowBytes);
+
+		ParallelFor::run(bandRows, [&](int startRow, int endRow)
+		{
+			for (int row = startRow; row < endRow; ++row)
+			{
+				unsigned char* out = &rows[row * rowBytes];
+
+				for (int x = 0; x < res; ++x)
+				{
+					float height = heightmap.at(x, bandStart + row);
+					unsigned int sample = 0;
+
+					if (floatSamples)
+					{
+						memcpy(&sample, &height, 4);
+					}
+					else
+					{
+						sample = toSample16(height);
+					}
+
+					// Little endian, whatever the machine is
+					for (int b = 0; b < sampleBytes; ++b)
+					{
+						*out++ = (unsigned char)(sample >> (b * 8));
+					}
+				}
+			}
+		}, 4);
+
+		file.write((const char*)rows.data(), rows.size());
+	}
+
+	return (bool)file;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapExporter::exportTiled(const HeightMap& heightmap, const std::string& filename, bool floatSamples)
+{
+	std::ofstream file(filename, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	if (!floatSamples)
+	{
+		findHeightRange(heightmap);
+	}
+
+	const int res = heightmap.getResolution();
+	const int tilesPerRow = (res + tileSize - 1) / tileSize;
+
+	// Little endian values for the header and index
+	auto put32 = [](std::vector<unsigned char>& out, unsigned int value)
+	{
+		for (int b = 0; b < 4; ++b)
+		{
+			out.push_back((unsigned char)(value >> (b * 8)));
+		}
+	};
+
+	auto put64 = [&](std::vector<unsigned char>& out, unsigned long long value)
+	{
+		put32(out, (unsigned int)value);
+		put32(out, (unsigned int)(value >> 32));
+	};
+
+	auto putFloat = [&](std::vector<unsigned char>& out, float value)
+	{
+		unsigned int bits;
+		memcpy(&bits, &value, 4);
+		put32(out, bits);
+	};
+
+	// The index offset isn't known until the tiles are written, it's filled in at the end
+	std::vector<unsigned char> header;
+	header.insert(header.end(), { 'H', 'M', 'T', '1' });
+	put32(header, res);
+	put32(header, tileSize);
+	put32(header, tilesPerRow);
+	put32(header, floatSamples ? 1 : 0);
+	putFloat(header, heightLow);
+	putFloat(header, heightHigh);
+	put64(header, 0);
+	file.write((const char*)header.data(), header.size());
+
+	std::vector<unsigned char> index;
+	index.reserve((size_t)tilesPerRow * tilesPerRow * TILED_INDEX_ENTRY_SIZE);
+
+	std::vector<std::vector<unsigned char>> tiles(tilesPerRow);
+	std::vector<unsigned int> compression(tilesPerRow);
+	unsigned long long offset = TILED_HEADER_SIZE;
+
+	// A row of tiles at a time, each tile compressed on its own thread, then written in order
+	for (int tileZ = 0; tileZ < tilesPerRow; ++tileZ)
+	{
+		ParallelFor::run(tilesPerRow, [&](int startTile, int endTile)
+		{
+			for (int tileX = startTile; tileX < endTile; ++tileX)
+			{
+				compressTile(heightmap, tileZ * tilesPerRow + tileX, floatSamples, tiles[tileX], compression[tileX]);
+			}
+		}, 1);
+
+		for (int tileX = 0; tileX < tilesPerRow; ++tileX)
+		{
+			file.write((const char*)tiles[tileX].data(), tiles[tileX].size());
+
+			put64(index, offset);
+			put32(index, (unsigned int)tiles[tileX].size());
+			put32(index, compression[tileX]);
+
+			offset += tiles[tileX].size();
+		}
+	}
+
+	file.write((const char*)index.data(), index.size());
+
+	// Back to fill in where the index is
+	std::vector<unsigned char> indexOffset;
+	put64(indexOffset, offset);
+	file.seekp(TILED_HEADER_SIZE - 8);
+	file.write((const char*)indexOffset.data(), 8);
+
+	return (bool)file;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapExporter::compressTile(const HeightMap& heightmap, int tile, bool floatSamples, std::vector<unsigned char>& out, unsigned int& compression)
+{
+	const int res = heightmap.getResolution();
+	const int tilesPerRow = (res + tileSize - 1) / tileSize;
+	const int startX = (tile % tilesPerRow) * tileSize;
+	const int startZ = (tile / tilesPerRow) * tileSize;
+	const int width = res - startX < tileSize ? res - startX : tileSize;
+	const int height = res - startZ < tileSize ? res - startZ : tileSize;
+	const int sampleBytes = floatSamples ? 4 : 2;
+	const size_t rawSize = (size_t)width * height * sampleBytes;
+
+	out.clear();
+	out.reserve(rawSize);
+
+	// Delta first, the first sample of each row is predicted from the one above rather than the end of the last row
+	unsigned int rowStart = 0;
+
+	for (int z = 0; z < height; ++z)
+	{
+		unsigned int previous = rowStart;
+
+		for (int x = 0; x < width; ++x)
+		{
+			float value = heightmap.at(startX + x, startZ + z);
+			unsigned int sample = 0;
+
+			if (floatSamples)
+			{
+				memcpy(&sample, &value, 4);
+			}
+			else
+			{
+				sample = toSample16(value);
+			}
+
+			if (x == 0)
+			{
+				rowStart = sample;
+			}
+
+			// Zigzag, so small steps down are as small as small steps up
+			long long delta = (long long)sample - (long long)previous;
+			unsigned long long zigzag = delta < 0 ? ((unsigned long long)(-delta) << 1) - 1 : (unsigned long long)delta << 1;
+
+			do
+			{
+				unsigned char byte = (unsigned char)(zigzag & 0x7F);
+				zigzag >>= 7;
+				out.push_back(zigzag ? (byte | 0x80) : byte);
+			}
+			while (zigzag);
+
+			previous = sample;
+
+			// No smaller than raw, so give up on it
+			if (out.size() >= rawSize)
+			{
+				break;
+			}
+		}
+
+		if (out.size() >= rawSize)
+		{
+			break;
+		}
+	}
+
+	if (out.size() < rawSize)
+	{
+		compression = TILE_DELTA;
+		return;
+	}
+
+	out.clear();
+
+	for (int z = 0; z < height; ++z)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			float value = heightmap.at(startX + x, startZ + z);
+			unsigned int sample = 0;
+
+			if (floatSamples)
+			{
+				memcpy(&sample, &value, 4);
+			}
+			else
+			{
+				sample = toSample16(value);
+			}
+
+			for (int b = 0; b < sampleBytes; ++b)
+			{
+				out.push_back((unsigned char)(sample >> (b * 8)));
+			}
+		}
+	}
+
+	compression = TILE_RAW;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapExporter::writeChunk(std::ofstream& file, const char* type, const unsigned char* data, size_t size)
+{
+	unsigned char length[4] = { (unsigned char)(size >> 24), (unsigned char)(size >> 16), (unsigned char)(size >> 8), (unsigned char)size };
+	file.write((const char*)length, 4);
+	file.write(type, 4);
+
+	if (size > 0)
+	{
+		file.write((const char*)data, size);
+	}
+
+	// The CRC covers the type and the data, not the length
+	unsigned int crc = updateCrc(0xFFFFFFFFu, (const unsigned char*)type, 4);
+	crc = updateCrc(crc, data, size) ^ 0xFFFFFFFFu;
+
+	unsigned char crcBytes[4] = { (unsigned char)(crc >> 24), (unsigned char)(crc >> 16), (unsigned char)(crc >> 8), (unsigned char)crc };
+	file.write((const char*)crcBytes, 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int HeightMapExporter::updateCrc(unsigned int crc, const unsigned char* data, size_t size)
+{
+	// Built the first time it's needed, C++11 makes sure only one thread builds it
+	static const std::array<unsigned int, 256> table = []()
+	{
+		std::array<unsigned int, 256> values;
+
+		for (unsigned int n = 0; n < 256; ++n)
+		{
+			unsigned int c = n;
+
+			for (int k = 0; k < 8; ++k)
+			{
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+
+			values[n] = c;
+		}
+
+		return values;
+	}();
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return crc;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int HeightMapExporter::updateAdler(unsigned int adler, const unsigned char* data, size_t size)
+{
+	const unsigned int base = 65521;
+	unsigned int a = adler & 0xFFFF;
+	unsigned int b = adler >> 16;
+
+	while (size > 0)
+	{
+		// The most bytes that can be summed before b could overflow
+		size_t block = size < 5552 ? size : 5552;
+		size -= block;
+
+		while (block--)
+		{
+			a += *data++;
+			b += a;
+		}
+
+		a %= base;
+		b %= base;
+	}
+
+	return (b << 16) | a;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapExporter::findHeightRange(const HeightMap& heightmap)
+{
+	if (!fixedRange)
+	{
+		const int res = heightmap.getResolution();
+		std::vector<float> lowest(res);
+		std::vector<float> highest(res);
+
+		// Each row on its own, then the rows together
+		ParallelFor::run(res, [&](int startZ, int endZ)
+		{
+			for (int z = startZ; z < endZ; ++z)
+			{
+				float low = heightmap.at(0, z);
+				float high = low;
+
+				for (int x = 1; x < res; ++x)
+				{
+					float height = heightmap.at(x, z);
+					low = height < low ? height : low;
+					high = height > high ? height : high;
+				}
+
+				lowest[z] = low;
+				highest[z] = high;
+			}
+		});
+
+		heightLow = lowest[0];
+		heightHigh = highest[0];
+
+		for (int z = 1; z < res; ++z)
+		{
+			heightLow = lowest[z] < heightLow ? lowest[z] : heightLow;
+			heightHigh = highest[z] > heightHigh ? highest[z] : heightHigh;
+		}
+	}
+
+	// A flat map is all 0
+	sampleScale = heightHigh > heightLow ? 65535.0f / (heightHigh - heightLow) : 0.0f;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapExporter::setHeightRange(float low, float high)
+{
+	fixedRange = true;
+	heightLow = low;
+	heightHigh = high;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapExporter::useMapHeightRange()
+{
+	fixedRange = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapExporter::getHeightRange(float& low, float& high)
+{
+	low = heightLow;
+	high = heightHigh;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapExporter::setTileSize(int size)
+{
+	tileSize = size > 8 ? size : 8;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapExporter::setRowsPerBand(int rows)
+{
+	rowsPerBand = rows > 1 ? rows : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const char* HeightMapExporter::getExtension(Format format)
+{
+	switch (format)
+	{
+		case PNG_16:
+		{
+			return ".png";
+		}
+		case RAW_16:
+		{
+			return ".r16";
+		}
+		case RAW_32:
+		{
+			return ".r32";
+		}
+		default:
+		{
+			return ".hmt";
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,104 @@
+/*
+ * This is the Height Map Exporter class it handles:
+ *		- Writing a height map out as a 16 bit greyscale PNG
+ *		- Writing a height map out as raw little endian 16 bit (.r16) or 32 bit float (.r32) heights
+ *		- Writing a height map out as a tiled container, where each tile is compressed on its own
+ *
+ * Every format is streamed, a band of rows (or a row of tiles) is converted on all threads, written, then the next
+ * band reuses the same buffer, so there's never a second copy of the whole map in memory.
+ *
+ * The PNG is uncompressed (stored deflate blocks), there's no zlib here and it keeps the export at disk speed, any
+ * image tool will happily recompress it. The 16 bit formats map the height range (the map's lowest to highest point,
+ * unless set) to 0 -> 65535, the PNG keeps the range in a tEXt chunk so it can be read back to the same heights.
+ *
+ * Tiled container (.hmt), everything little endian:
+ *		Header:		"HMT1", resolution, tile size, tiles per row, sample format (0 = 16 bit, 1 = 32 bit float),
+ *					height low, height high (floats), index offset (64 bit)
+ *		Tiles:		one after another, row by row, each one compressed or raw, see the index
+ *		Index:		per tile, offset (64 bit), size in bytes, compression (0 = raw, 1 = delta)
+ *
+ * Delta compression stores each sample as the zigzagged difference from the one before it, in as few 7 bit bytes as
+ * it needs, a tile is only kept raw if that doesn't make it any smaller.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <fstream>
+#include <string>
+#include <vector>
+#include "HeightMap.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HeightMapExporter
+{
+public:
+	enum Format
+	{
+		PNG_16 = 0,
+		RAW_16,
+		RAW_32,
+		TILED_16,
+		TILED_32
+	};
+
+	enum TileCompression
+	{
+		TILE_RAW = 0,
+		TILE_DELTA
+	};
+
+	HeightMapExporter();
+	~HeightMapExporter();
+
+	// Picks the writer from the format, false if the file can't be written
+	bool exportHeightMap(const HeightMap& heightmap, const std::string& filename, Format format);
+	bool exportPNG(const HeightMap& heightmap, const std::string& filename);
+	bool exportRaw(const HeightMap& heightmap, const std::string& filename, bool floatSamples);
+	bool exportTiled(const HeightMap& heightmap, const std::string& filename, bool floatSamples);
+
+	// The heights that become 0 and 65535 in the 16 bit formats, by default the map's own lowest and highest points
+	void setHeightRange(float low, float high);
+	void useMapHeightRange();
+	void getHeightRange(float& low, float& high);
+	void setTileSize(int size);
+	void setRowsPerBand(int rows);
+
+	// The usual file extension for each format, including the dot
+	static const char* getExtension(Format format);
+
+	// PNG's CRC-32, start from 0xFFFFFFFF and flip the bits of the result, the importer checks chunks with it too
+	static unsigned int updateCrc(unsigned int crc, const unsigned char* data, size_t size);
+
+private:
+	void findHeightRange(const HeightMap& heightmap);
+	inline unsigned short toSample16(float height)
+	{
+		float sample = (height - heightLow) * sampleScale + 0.5f;
+		sample = sample < 0.0f ? 0.0f : (sample > 65535.0f ? 65535.0f : sample);
+
+		return (unsigned short)sample;
+	}
+
+	// PNG
+	void writeChunk(std::ofstream& file, const char* type, const unsigned char* data, size_t size);
+	static unsigned int updateAdler(unsigned int adler, const unsigned char* data, size_t size);
+
+	// Tiled container
+	void compressTile(const HeightMap& heightmap, int tile, bool floatSamples, std::vector<unsigned char>& out, unsigned int& compression);
+
+	bool fixedRange;
+	float heightLow;
+	float heightHigh;
+	float sampleScale;
+	int tileSize;
+	int rowsPerBand;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,193 @@
+/*
+ * This is the Height Map History class it handles:
+ *		- Recording a snapshot of the height map after each edit, for undo and redo
+ *		- Stepping the height map backwards and forwards through the snapshots
+ *		- Restoring any snapshot kept elsewhere, i.e. flipping between two versions to compare them
+ *
+ * Each snapshot shares every page that didn't change with the one before it, see HeightMapSnapshot, so the history
+ * only costs as much memory as the edits actually touched.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "HeightMapHistory.h"
+#include <unordered_set>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+HeightMapHistory::HeightMapHistory()
+{
+	// Default values
+	current = -1;
+	maxSnapshots = 64;
+	memoryBytes = 0;
+}
+
+HeightMapHistory::~HeightMapHistory()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+bool HeightMapHistory::record(const HeightMap& heightmap)
+{
+	const HeightMapSnapshot* previous = current >= 0 ? snapshots[current].get() : nullptr;
+	auto snapshot = std::make_shared<const HeightMapSnapshot>(heightmap, previous);
+
+	// Every page shared, so nothing has changed
+	if (previous && snapshot->countSharedPages(*previous) == snapshot->getPageCount())
+	{
+		return false;
+	}
+
+	push(snapshot);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapHistory::undo(HeightMap& heightmap)
+{
+	if (!canUndo())
+	{
+		return false;
+	}
+
+	snapshots[current - 1]->copyTo(heightmap, snapshots[current].get());
+	--current;
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapHistory::redo(HeightMap& heightmap)
+{
+	if (!canRedo())
+	{
+		return false;
+	}
+
+	snapshots[current + 1]->copyTo(heightmap, snapshots[current].get());
+	++current;
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapHistory::restore(HeightMap& heightmap, const std::shared_ptr<const HeightMapSnapshot>& snapshot)
+{
+	if (!snapshot || snapshot->getResolution() != heightmap.getResolution())
+	{
+		return false;
+	}
+
+	snapshot->copyTo(heightmap, current >= 0 ? snapshots[current].get() : nullptr);
+
+	if (current < 0 || snapshots[current] != snapshot)
+	{
+		push(snapshot);
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapHistory::clear()
+{
+	snapshots.clear();
+	current = -1;
+	memoryBytes = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapHistory::canUndo() const
+{
+	return current > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapHistory::canRedo() const
+{
+	return current >= 0 && current < (int)snapshots.size() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const HeightMapSnapshot> HeightMapHistory::getCurrent() const
+{
+	return current >= 0 ? snapshots[current] : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int HeightMapHistory::getSnapshotCount() const
+{
+	return (int)snapshots.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t HeightMapHistory::getMemoryBytes() const
+{
+	return memoryBytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapHistory::countMemory()
+{
+	std::unordered_set<const HeightMapSnapshot::Page*> counted;
+	memoryBytes = 0;
+
+	for (const auto& snapshot : snapshots)
+	{
+		for (int page = 0; page < snapshot->getPageCount(); ++page)
+		{
+			const HeightMapSnapshot::Page* heights = snapshot->getPage(page);
+
+			if (counted.insert(heights).second)
+			{
+				memoryBytes += heights->size() * sizeof(float);
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapHistory::setMaxSnapshots(int count)
+{
+	maxSnapshots = count > 1 ? count : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapHistory::push(const std::shared_ptr<const HeightMapSnapshot>& snapshot)
+{
+	// Anything after the current snapshot could only have been redone, a new edit replaces it
+	snapshots.resize(current + 1);
+	snapshots.push_back(snapshot);
+
+	if ((int)snapshots.size() > maxSnapshots)
+	{
+		snapshots.erase(snapshots.begin(), snapshots.begin() + (snapshots.size() - maxSnapshots));
+	}
+
+	current = (int)snapshots.size() - 1;
+	countMemory();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,62 @@
+/*
+ * This is the Height Map History class it handles:
+ *		- Recording a snapshot of the height map after each edit, for undo and redo
+ *		- Stepping the height map backwards and forwards through the snapshots
+ *		- Restoring any snapshot kept elsewhere, i.e. flipping between two versions to compare them
+ *
+ * Each snapshot shares every page that didn't change with the one before it, see HeightMapSnapshot, so the history
+ * only costs as much memory as the edits actually touched.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <memory>
+#include <vector>
+#include "HeightMap.h"
+#include "HeightMapSnapshot.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HeightMapHistory
+{
+public:
+	HeightMapHistory();
+	~HeightMapHistory();
+
+	// Snapshots the height map, unless it's the same as the current snapshot, anything that could be redone is lost
+	// Returns true if a snapshot was taken
+	bool record(const HeightMap& heightmap);
+	// The height map MUST still hold the current snapshot's heights, i.e. record() any edits first
+	bool undo(HeightMap& heightmap);
+	bool redo(HeightMap& heightmap);
+	// Puts a snapshot's heights into the height map and records it, so it can be undone like any other edit
+	bool restore(HeightMap& heightmap, const std::shared_ptr<const HeightMapSnapshot>& snapshot);
+	void clear();
+
+	bool canUndo() const;
+	bool canRedo() const;
+	// nullptr until the first record()
+	std::shared_ptr<const HeightMapSnapshot> getCurrent() const;
+	int getSnapshotCount() const;
+	// Every page held by the history, each shared page only counted once
+	size_t getMemoryBytes() const;
+	// The oldest snapshots are dropped once there are more than this
+	void setMaxSnapshots(int count);
+
+private:
+	void push(const std::shared_ptr<const HeightMapSnapshot>& snapshot);
+	void countMemory();
+
+	std::vector<std::shared_ptr<const HeightMapSnapshot>> snapshots;
+	int current;			// Index of the snapshot the height map holds, -1 if there isn't one
+	int maxSnapshots;
+	size_t memoryBytes;		// Counted whenever the snapshots change, rather than every time it's asked for
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
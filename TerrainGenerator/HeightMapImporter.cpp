@@ -0,0 +1,928 @@
+/*
+ * This is the Height Map Importer class it handles:
+ *		- Reading a height map in from a PNG (8 or 16 bit), raw little endian 16 bit (.r16) or 32 bit float (.r32) heights,
+ *		  or a tiled container written by HeightMapExporter (.hmt)
+ *		- Resampling it to the resolution of the height map it's read into, bilinear or bicubic (Catmull-Rom)
+ *
+ * Nothing is read in whole, the file is decoded a row at a time into a window only a band of rows tall, and each band
+ * is resampled on all threads and written straight into the height map (whatever its layout), then the window slides
+ * on down the file. The filter is separable, a vertical pass blends the source rows 4 floats at a time with SSE, then
+ * a horizontal pass picks the taps out of that, both using taps and weights worked out once up front.
+ *
+ * The corners of the file land on the corners of the map. Bicubic is smoother when scaling up, but can overshoot a
+ * little either side of a cliff, bilinear never goes outside the heights around it.
+ *
+ * A PNG's grey (or red) channel is used, any alpha is ignored. 16 bit files are mapped from 0 -> 65535 (255 for an 8
+ * bit PNG) onto the height range, unless the file has its own, i.e. a PNG with a HeightRange tEXt chunk or a .hmt.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "HeightMapImporter.h"
+#include "HeightMapExporter.h"
+#include "Inflater.h"
+#include "ParallelFor.h"
+#include <cctype>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+#include <sstream>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Bytes in a tiled container's header and in each tile's index entry, see HeightMapExporter
+const int TILED_HEADER_SIZE = 36;
+const int TILED_INDEX_ENTRY_SIZE = 16;
+// The biggest file read, the same as the biggest map TerrainBatch makes, a header saying more than this is broken
+const int MAX_IMPORT_SIZE = 8192;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+HeightMapImporter::HeightMapImporter()
+{
+	// Default values
+	filter = BILINEAR;
+	heightLow = 0.0f;
+	heightHigh = 20.0f;
+	rowsPerBand = 64;
+	sourceWidth = 0;
+	sourceHeight = 0;
+}
+
+HeightMapImporter::~HeightMapImporter()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+bool HeightMapImporter::importHeightMap(HeightMap& heightmap, const std::string& filename)
+{
+	std::string extension = filename.size() >= 4 ? filename.substr(filename.size() - 4) : "";
+
+	for (char& c : extension)
+	{
+		c = (char)tolower((unsigned char)c);
+	}
+
+	if (extension == ".png")
+	{
+		return importPNG(heightmap, filename);
+	}
+
+	// .raw is nearly always 16 bit, i.e. from a game engine's terrain tools
+	if (extension == ".r16" || extension == ".raw")
+	{
+		return importRaw(heightmap, filename, false);
+	}
+
+	if (extension == ".r32")
+	{
+		return importRaw(heightmap, filename, true);
+	}
+
+	if (extension == ".hmt")
+	{
+		return importTiled(heightmap, filename);
+	}
+
+	error = "Don't know how to read " + filename + ", it should end in .png, .r16, .r32, .raw or .hmt";
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapImporter::importPNG(HeightMap& heightmap, const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+
+	if (!file)
+	{
+		error = "Can't open " + filename;
+		return false;
+	}
+
+	static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	unsigned char bytes[8];
+	file.read((char*)bytes, 8);
+
+	if (!file || memcmp(bytes, signature, 8) != 0)
+	{
+		error = filename + " isn't a PNG";
+		return false;
+	}
+
+	auto getBig32 = [](const unsigned char* data)
+	{
+		return ((unsigned int)data[0] << 24) | ((unsigned int)data[1] << 16) | ((unsigned int)data[2] << 8) | (unsigned int)data[3];
+	};
+
+	int width = 0;
+	int height = 0;
+	int bitDepth = 0;
+	int colourType = -1;
+	int interlace = 0;
+	float low = heightLow;
+	float high = heightHigh;
+	unsigned int chunkLeft = 0;
+	unsigned int chunkCrc = 0;
+
+	// Everything up to the first IDAT, only the header and the height range matter
+	while (true)
+	{
+		unsigned char chunkHeader[8];
+		file.read((char*)chunkHeader, 8);
+
+		if (!file || memcmp(chunkHeader + 4, "IEND", 4) == 0)
+		{
+			error = filename + " ends before its image data";
+			return false;
+		}
+
+		unsigned int length = getBig32(chunkHeader);
+		// The CRC covers the type and the data, not the length
+		unsigned int crc = HeightMapExporter::updateCrc(0xFFFFFFFFu, chunkHeader + 4, 4);
+
+		if (memcmp(chunkHeader + 4, "IDAT", 4) == 0)
+		{
+			chunkLeft = length;
+			chunkCrc = crc;
+			break;
+		}
+
+		bool header = memcmp(chunkHeader + 4, "IHDR", 4) == 0;
+		bool text = memcmp(chunkHeader + 4, "tEXt", 4) == 0;
+		// Only the chunks that matter are kept, the rest are still read through to check their CRCs
+		bool keep = (header || text) && length <= 65536;
+
+		std::vector<unsigned char> data(keep ? length : 0);
+
+		if (keep)
+		{
+			file.read((char*)data.data(), length);
+			crc = HeightMapExporter::updateCrc(crc, data.data(), length);
+		}
+		else
+		{
+			unsigned char skipped[4096];
+
+			for (unsigned int left = length; left > 0 && file;)
+			{
+				unsigned int count = left < sizeof(skipped) ? left : (unsigned int)sizeof(skipped);
+				file.read((char*)skipped, count);
+				crc = HeightMapExporter::updateCrc(crc, skipped, count);
+				left -= count;
+			}
+		}
+
+		unsigned char crcBytes[4];
+		file.read((char*)crcBytes, 4);
+
+		if (!file || getBig32(crcBytes) != (crc ^ 0xFFFFFFFFu))
+		{
+			error = filename + " has a broken " + std::string((const char*)chunkHeader + 4, 4) + " chunk";
+			return false;
+		}
+
+		if (!keep)
+		{
+			continue;
+		}
+
+		if (header && length >= 13)
+		{
+			width = (int)getBig32(&data[0]);
+			height = (int)getBig32(&data[4]);
+			bitDepth = data[8];
+			colourType = data[9];
+			interlace = data[12];
+		}
+		else if (text)
+		{
+			// Written by HeightMapExporter, "HeightRange" then a 0 then "low high"
+			std::string keyword((const char*)data.data(), strnlen((const char*)data.data(), length));
+
+			if (keyword == "HeightRange" && keyword.size() < length)
+			{
+				std::istringstream range(std::string(data.begin() + keyword.size() + 1, data.end()));
+				float rangeLow, rangeHigh;
+
+				if (range >> rangeLow >> rangeHigh)
+				{
+					low = rangeLow;
+					high = rangeHigh;
+				}
+			}
+		}
+	}
+
+	// Grey, colour, grey with alpha and colour with alpha, the first channel is used either way
+	int channels = colourType == 0 ? 1 : (colourType == 2 ? 3 : (colourType == 4 ? 2 : (colourType == 6 ? 4 : 0)));
+
+	// Negative if the header's width or height didn't fit in an int
+	if (width < 2 || height < 2 || width > MAX_IMPORT_SIZE || height > MAX_IMPORT_SIZE || (bitDepth != 8 && bitDepth != 16) || channels == 0 || interlace != 0)
+	{
+		error = filename + " has to be an 8 or 16 bit, grey or colour, non interlaced PNG, at least 2x2 and at most " +
+			std::to_string(MAX_IMPORT_SIZE) + "x" + std::to_string(MAX_IMPORT_SIZE);
+		return false;
+	}
+
+	// Each IDAT's CRC follows its data, so it's checked once all of that has been read
+	bool crcPending = true;
+	bool crcBroken = false;
+
+	auto checkChunkCrc = [&]() -> bool
+	{
+		if (crcPending)
+		{
+			unsigned char crcBytes[4];
+			file.read((char*)crcBytes, 4);
+
+			crcPending = false;
+			crcBroken = !file || getBig32(crcBytes) != (chunkCrc ^ 0xFFFFFFFFu);
+		}
+
+		return !crcBroken;
+	};
+
+	// The image data can be split over any number of IDAT chunks, one straight after another
+	Inflater::Input readImageData = [&](unsigned char* buffer, size_t size) -> size_t
+	{
+		while (chunkLeft == 0)
+		{
+			if (!checkChunkCrc())
+			{
+				return 0;
+			}
+
+			// Then the next chunk's length and type
+			unsigned char chunkHeader[8];
+			file.read((char*)chunkHeader, 8);
+
+			if (!file || memcmp(chunkHeader + 4, "IDAT", 4) != 0)
+			{
+				return 0;
+			}
+
+			chunkLeft = getBig32(chunkHeader);
+			chunkCrc = HeightMapExporter::updateCrc(0xFFFFFFFFu, chunkHeader + 4, 4);
+			crcPending = true;
+		}
+
+		size_t count = size < chunkLeft ? size : chunkLeft;
+		file.read((char*)buffer, count);
+		count = (size_t)file.gcount();
+		chunkLeft -= (unsigned int)count;
+		chunkCrc = HeightMapExporter::updateCrc(chunkCrc, buffer, count);
+
+		return count;
+	};
+
+	Inflater inflater(readImageData);
+
+	const int pixelBytes = channels * bitDepth / 8;
+	const size_t rowBytes = (size_t)width * pixelBytes;
+	const float scale = (high - low) / (bitDepth == 16 ? 65535.0f : 255.0f);
+
+	// Each row starts with its filter type, and the filters need the row above
+	std::vector<unsigned char> filtered(rowBytes + 1);
+	std::vector<unsigned char> row(rowBytes);
+	std::vector<unsigned char> previous(rowBytes, 0);
+
+	bool read = resample(heightmap, width, height, [&](float* out) -> bool
+	{
+		if (inflater.read(filtered.data(), filtered.size()) != filtered.size() || filtered[0] > 4)
+		{
+			error = filename + (crcBroken ? " has a broken IDAT chunk" : "'s image data is broken or cut short");
+			return false;
+		}
+
+		unfilterRow(filtered[0], &filtered[1], previous.data(), row.data(), rowBytes, pixelBytes);
+
+		for (int x = 0; x < width; ++x)
+		{
+			const unsigned char* pixel = &row[(size_t)x * pixelBytes];
+			unsigned int sample = bitDepth == 16 ? ((unsigned int)pixel[0] << 8) | pixel[1] : pixel[0];
+
+			out[x] = low + sample * scale;
+		}
+
+		row.swap(previous);
+		return true;
+	});
+
+	if (!read)
+	{
+		return false;
+	}
+
+	// Every row's been read, but the stream's Adler-32 (and the last chunk's CRC) are only checked at its very end
+	unsigned char rest[256];
+
+	while (!inflater.isFinished() && !inflater.hasFailed() && inflater.read(rest, sizeof(rest)) > 0)
+	{
+	}
+
+	// Anything left in the last IDAT after the stream is only read for its CRC
+	while (chunkLeft > 0 && readImageData(rest, sizeof(rest)) > 0)
+	{
+	}
+
+	if (!inflater.isFinished() || inflater.hasFailed() || !checkChunkCrc())
+	{
+		error = filename + (crcBroken ? " has a broken IDAT chunk" : "'s image data is broken or doesn't end where it should");
+		return false;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapImporter::importRaw(HeightMap& heightmap, const std::string& filename, bool floatSamples)
+{
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+	if (!file)
+	{
+		error = "Can't open " + filename;
+		return false;
+	}
+
+	const int sampleBytes = floatSamples ? 4 : 2;
+	const unsigned long long fileSize = (unsigned long long)file.tellg();
+
+	if (fileSize > (unsigned long long)MAX_IMPORT_SIZE * MAX_IMPORT_SIZE * sampleBytes)
+	{
+		error = filename + " is bigger than " + std::to_string(MAX_IMPORT_SIZE) + "x" + std::to_string(MAX_IMPORT_SIZE);
+		return false;
+	}
+
+	// There's no header, so it has to be square to know how wide it is
+	const int res = (int)(sqrt((double)(fileSize / sampleBytes)) + 0.5);
+
+	if (res < 2 || (unsigned long long)res * res * sampleBytes != fileSize)
+	{
+		error = filename + " isn't a square grid of " + (floatSamples ? "32 bit floats" : "16 bit heights");
+		return false;
+	}
+
+	file.seekg(0);
+
+	std::vector<unsigned char> bytes((size_t)res * sampleBytes);
+	const float scale = (heightHigh - heightLow) / 65535.0f;
+
+	return resample(heightmap, res, res, [&](float* out) -> bool
+	{
+		if (!file.read((char*)bytes.data(), bytes.size()))
+		{
+			error = filename + " is cut short";
+			return false;
+		}
+
+		for (int x = 0; x < res; ++x)
+		{
+			// Little endian, whatever the machine is
+			unsigned int sample = 0;
+
+			for (int b = 0; b < sampleBytes; ++b)
+			{
+				sample |= (unsigned int)bytes[x * sampleBytes + b] << (b * 8);
+			}
+
+			if (floatSamples)
+			{
+				memcpy(&out[x], &sample, 4);
+			}
+			else
+			{
+				out[x] = heightLow + sample * scale;
+			}
+		}
+
+		return true;
+	});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapImporter::importTiled(HeightMap& heightmap, const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+	if (!file)
+	{
+		error = "Can't open " + filename;
+		return false;
+	}
+
+	const unsigned long long fileSize = (unsigned long long)file.tellg();
+	file.seekg(0);
+
+	auto get32 = [](const unsigned char* data)
+	{
+		return (unsigned int)data[0] | ((unsigned int)data[1] << 8) | ((unsigned int)data[2] << 16) | ((unsigned int)data[3] << 24);
+	};
+
+	auto get64 = [&](const unsigned char* data)
+	{
+		return (unsigned long long)get32(data) | ((unsigned long long)get32(data + 4) << 32);
+	};
+
+	unsigned char header[TILED_HEADER_SIZE];
+	file.read((char*)header, TILED_HEADER_SIZE);
+
+	if (!file || memcmp(header, "HMT1", 4) != 0)
+	{
+		error = filename + " isn't a tiled height map";
+		return false;
+	}
+
+	const int res = (int)get32(header + 4);
+	const int tileSize = (int)get32(header + 8);
+	const int tilesPerRow = (int)get32(header + 12);
+	const bool floatSamples = get32(header + 16) == 1;
+
+	float low, high;
+	unsigned int bits = get32(header + 20);
+	memcpy(&low, &bits, 4);
+	bits = get32(header + 24);
+	memcpy(&high, &bits, 4);
+
+	// Negative if they didn't fit in an int, and bounded so none of the sizes below can overflow
+	if (res < 2 || res > MAX_IMPORT_SIZE || tileSize < 1 || tileSize > MAX_IMPORT_SIZE || tilesPerRow != (res + tileSize - 1) / tileSize)
+	{
+		error = filename + " has a broken header, or is bigger than " + std::to_string(MAX_IMPORT_SIZE) + "x" + std::to_string(MAX_IMPORT_SIZE);
+		return false;
+	}
+
+	// Checked against the file before anything's made that big
+	const unsigned long long indexOffset = get64(header + 28);
+	const unsigned long long indexSize = (unsigned long long)tilesPerRow * tilesPerRow * TILED_INDEX_ENTRY_SIZE;
+
+	if (indexOffset > fileSize || indexSize > fileSize - indexOffset)
+	{
+		error = filename + "'s tile index is missing or cut short";
+		return false;
+	}
+
+	std::vector<unsigned char> index((size_t)indexSize);
+	file.seekg(indexOffset);
+	file.read((char*)index.data(), index.size());
+
+	if (!file)
+	{
+		error = filename + "'s tile index is missing or cut short";
+		return false;
+	}
+
+	const int sampleBytes = floatSamples ? 4 : 2;
+	const float scale = (high - low) / 65535.0f;
+
+	// A row of tiles at a time, read in order, then each tile decoded on its own thread
+	const int bandRows = tileSize < res ? tileSize : res;
+	std::vector<float> band((size_t)bandRows * res);
+	std::vector<std::vector<unsigned char>> tiles(tilesPerRow);
+	std::vector<unsigned int> compression(tilesPerRow);
+	std::vector<char> decoded(tilesPerRow);
+	int nextRow = 0;
+
+	return resample(heightmap, res, res, [&](float* out) -> bool
+	{
+		const int tileZ = nextRow / tileSize;
+		const int startZ = tileZ * tileSize;
+		const int height = res - startZ < tileSize ? res - startZ : tileSize;
+
+		if (nextRow == startZ)
+		{
+			for (int tileX = 0; tileX < tilesPerRow; ++tileX)
+			{
+				const unsigned char* entry = &index[(size_t)(tileZ * tilesPerRow + tileX) * TILED_INDEX_ENTRY_SIZE];
+				const int width = res - tileX * tileSize < tileSize ? res - tileX * tileSize : tileSize;
+				const unsigned int size = get32(entry + 8);
+
+				// A tile is only ever compressed if that made it smaller
+				if ((size_t)size > (size_t)width * height * sampleBytes)
+				{
+					error = filename + " has a broken tile index";
+					return false;
+				}
+
+				tiles[tileX].resize(size);
+				compression[tileX] = get32(entry + 12);
+
+				file.seekg(get64(entry));
+				file.read((char*)tiles[tileX].data(), size);
+
+				if (!file)
+				{
+					error = filename + " is cut short";
+					return false;
+				}
+			}
+
+			ParallelFor::run(tilesPerRow, [&](int startTile, int endTile)
+			{
+				for (int tileX = startTile; tileX < endTile; ++tileX)
+				{
+					const int startX = tileX * tileSize;
+					const int width = res - startX < tileSize ? res - startX : tileSize;
+
+					decoded[tileX] = decodeTile(tiles[tileX], compression[tileX], floatSamples, width, height, low, scale, &band[startX], res);
+				}
+			}, 1);
+
+			for (int tileX = 0; tileX < tilesPerRow; ++tileX)
+			{
+				if (!decoded[tileX])
+				{
+					error = filename + " has a broken tile";
+					return false;
+				}
+			}
+		}
+
+		memcpy(out, &band[(size_t)(nextRow - startZ) * res], res * sizeof(float));
+		++nextRow;
+
+		return true;
+	});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapImporter::setFilter(Filter newFilter)
+{
+	filter = newFilter;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapImporter::setHeightRange(float low, float high)
+{
+	heightLow = low;
+	heightHigh = high;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapImporter::setRowsPerBand(int rows)
+{
+	rowsPerBand = rows > 1 ? rows : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int HeightMapImporter::getSourceWidth() const
+{
+	return sourceWidth;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int HeightMapImporter::getSourceHeight() const
+{
+	return sourceHeight;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const std::string& HeightMapImporter::getError() const
+{
+	return error;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapImporter::resample(HeightMap& heightmap, int width, int height, const RowReader& readRow)
+{
+	sourceWidth = width;
+	sourceHeight = height;
+	error.clear();
+
+	const int res = heightmap.getResolution();
+
+	if (res < 2)
+	{
+		error = "The height map is too small to read into";
+		return false;
+	}
+
+	const int tapCount = filter == BICUBIC ? 4 : 2;
+
+	std::vector<int> xTaps, zTaps;
+	std::vector<float> xWeights, zWeights;
+	findTaps(res, width, xTaps, xWeights);
+	findTaps(res, height, zTaps, zWeights);
+
+	// A band of source rows, plus room for the rows above and below it a map row can need
+	const int windowRows = rowsPerBand + tapCount;
+	std::vector<float> window((size_t)windowRows * width);
+	int windowFirst = 0;
+	int windowCount = 0;
+
+	for (int z = 0; z < res;)
+	{
+		// Slide the window down to the first row this map row needs
+		const int firstNeeded = zTaps[z * tapCount];
+
+		if (firstNeeded >= windowFirst + windowCount)
+		{
+			// Past everything in the window, so the rows in between (when shrinking) are read and thrown away
+			for (int row = windowFirst + windowCount; row < firstNeeded; ++row)
+			{
+				if (!readRow(window.data()))
+				{
+					return false;
+				}
+			}
+
+			windowFirst = firstNeeded;
+			windowCount = 0;
+		}
+		else if (firstNeeded > windowFirst)
+		{
+			const int dropped = firstNeeded - windowFirst;
+			memmove(window.data(), &window[(size_t)dropped * width], (size_t)(windowCount - dropped) * width * sizeof(float));
+
+			windowFirst = firstNeeded;
+			windowCount -= dropped;
+		}
+
+		while (windowCount < windowRows && windowFirst + windowCount < height)
+		{
+			if (!readRow(&window[(size_t)windowCount * width]))
+			{
+				return false;
+			}
+
+			++windowCount;
+		}
+
+		// Every map row with all its taps in the window
+		const int firstRow = z;
+		int endRow = z;
+
+		while (endRow < res && zTaps[endRow * tapCount + tapCount - 1] < windowFirst + windowCount)
+		{
+			++endRow;
+		}
+
+		ParallelFor::run(endRow - firstRow, [&](int start, int end)
+		{
+			std::vector<float> blended(width);
+
+			for (int i = start; i < end; ++i)
+			{
+				const int mapZ = firstRow + i;
+				const float* rows[4];
+				__m128 weights[4];
+
+				for (int tap = 0; tap < tapCount; ++tap)
+				{
+					rows[tap] = &window[(size_t)(zTaps[mapZ * tapCount + tap] - windowFirst) * width];
+					weights[tap] = _mm_set1_ps(zWeights[mapZ * tapCount + tap]);
+				}
+
+				// Vertical pass, the source rows blended into one, 4 at a time
+				int x = 0;
+
+				for (; x + 4 <= width; x += 4)
+				{
+					__m128 sum = _mm_mul_ps(_mm_loadu_ps(rows[0] + x), weights[0]);
+
+					for (int tap = 1; tap < tapCount; ++tap)
+					{
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[tap] + x), weights[tap]));
+					}
+
+					_mm_storeu_ps(&blended[x], sum);
+				}
+
+				for (; x < width; ++x)
+				{
+					float sum = 0.0f;
+
+					for (int tap = 0; tap < tapCount; ++tap)
+					{
+						sum += rows[tap][x] * zWeights[mapZ * tapCount + tap];
+					}
+
+					blended[x] = sum;
+				}
+
+				// Horizontal pass, straight into the map
+				for (int mapX = 0; mapX < res; ++mapX)
+				{
+					const int* tap = &xTaps[mapX * tapCount];
+					const float* weight = &xWeights[mapX * tapCount];
+					float sum = 0.0f;
+
+					for (int t = 0; t < tapCount; ++t)
+					{
+						sum += blended[tap[t]] * weight[t];
+					}
+
+					heightmap.at(mapX, mapZ) = sum;
+				}
+			}
+		}, 4);
+
+		z = endRow;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapImporter::findTaps(int targetCount, int sourceCount, std::vector<int>& taps, std::vector<float>& weights)
+{
+	const int tapCount = filter == BICUBIC ? 4 : 2;
+	taps.resize(targetCount * tapCount);
+	weights.resize(targetCount * tapCount);
+
+	for (int target = 0; target < targetCount; ++target)
+	{
+		// Corner to corner, so the first and last samples line up exactly
+		double position = (double)target * (sourceCount - 1) / (targetCount - 1);
+		int whole = (int)position;
+		whole = whole < sourceCount - 2 ? whole : sourceCount - 2;
+		float f = (float)(position - whole);
+
+		int* tap = &taps[target * tapCount];
+		float* weight = &weights[target * tapCount];
+
+		if (filter == BICUBIC)
+		{
+			// Off the edges just repeats the edge sample
+			for (int t = 0; t < 4; ++t)
+			{
+				int source = whole - 1 + t;
+				tap[t] = source < 0 ? 0 : (source > sourceCount - 1 ? sourceCount - 1 : source);
+			}
+
+			weight[0] = ((-0.5f * f + 1.0f) * f - 0.5f) * f;
+			weight[1] = (1.5f * f - 2.5f) * f * f + 1.0f;
+			weight[2] = ((-1.5f * f + 2.0f) * f + 0.5f) * f;
+			weight[3] = (0.5f * f - 0.5f) * f * f;
+		}
+		else
+		{
+			tap[0] = whole;
+			tap[1] = whole + 1;
+			weight[0] = 1.0f - f;
+			weight[1] = f;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapImporter::unfilterRow(int filterType, const unsigned char* filtered, const unsigned char* previous, unsigned char* row, size_t rowBytes, int pixelBytes)
+{
+	// Left, above and above left are the same byte of the neighbouring pixels, 0 off the edge
+	switch (filterType)
+	{
+		case 0:
+		{
+			memcpy(row, filtered, rowBytes);
+			break;
+		}
+		case 1:
+		{
+			for (size_t i = 0; i < rowBytes; ++i)
+			{
+				row[i] = (unsigned char)(filtered[i] + (i >= (size_t)pixelBytes ? row[i - pixelBytes] : 0));
+			}
+
+			break;
+		}
+		case 2:
+		{
+			for (size_t i = 0; i < rowBytes; ++i)
+			{
+				row[i] = (unsigned char)(filtered[i] + previous[i]);
+			}
+
+			break;
+		}
+		case 3:
+		{
+			for (size_t i = 0; i < rowBytes; ++i)
+			{
+				int left = i >= (size_t)pixelBytes ? row[i - pixelBytes] : 0;
+				row[i] = (unsigned char)(filtered[i] + ((left + previous[i]) >> 1));
+			}
+
+			break;
+		}
+		case 4:
+		{
+			// Paeth, whichever neighbour is closest to left + above - above left
+			for (size_t i = 0; i < rowBytes; ++i)
+			{
+				int left = i >= (size_t)pixelBytes ? row[i - pixelBytes] : 0;
+				int above = previous[i];
+				int aboveLeft = i >= (size_t)pixelBytes ? previous[i - pixelBytes] : 0;
+
+				int estimate = left + above - aboveLeft;
+				int toLeft = abs(estimate - left);
+				int toAbove = abs(estimate - above);
+				int toAboveLeft = abs(estimate - aboveLeft);
+
+				int predicted = (toLeft <= toAbove && toLeft <= toAboveLeft) ? left : (toAbove <= toAboveLeft ? above : aboveLeft);
+				row[i] = (unsigned char)(filtered[i] + predicted);
+			}
+
+			break;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapImporter::decodeTile(const std::vector<unsigned char>& data, unsigned int compression, bool floatSamples, int width, int height, float low, float scale, float* out, int outStride)
+{
+	const int sampleBytes = floatSamples ? 4 : 2;
+	size_t position = 0;
+	unsigned int rowStart = 0;
+
+	for (int z = 0; z < height; ++z)
+	{
+		// Delta samples carry on from the first sample of the row above
+		unsigned int previous = rowStart;
+
+		for (int x = 0; x < width; ++x)
+		{
+			unsigned int sample = 0;
+
+			if (compression == HeightMapExporter::TILE_RAW)
+			{
+				if (position + sampleBytes > data.size())
+				{
+					return false;
+				}
+
+				for (int b = 0; b < sampleBytes; ++b)
+				{
+					sample |= (unsigned int)data[position++] << (b * 8);
+				}
+			}
+			else if (compression == HeightMapExporter::TILE_DELTA)
+			{
+				unsigned long long zigzag = 0;
+				int shift = 0;
+				unsigned char byte;
+
+				do
+				{
+					if (position == data.size() || shift > 35)
+					{
+						return false;
+					}
+
+					byte = data[position++];
+					zigzag |= (unsigned long long)(byte & 0x7F) << shift;
+					shift += 7;
+				}
+				while (byte & 0x80);
+
+				long long delta = (zigzag & 1) ? -(long long)((zigzag + 1) >> 1) : (long long)(zigzag >> 1);
+				sample = (unsigned int)((long long)previous + delta);
+			}
+			else
+			{
+				return false;
+			}
+
+			if (x == 0)
+			{
+				rowStart = sample;
+			}
+
+			previous = sample;
+
+			if (floatSamples)
+			{
+				memcpy(&out[(size_t)z * outStride + x], &sample, 4);
+			}
+			else
+			{
+				out[(size_t)z * outStride + x] = low + (sample & 0xFFFF) * scale;
+			}
+		}
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
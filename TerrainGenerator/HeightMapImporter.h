@@ -0,0 +1,83 @@
+/*
+ * This is the Height Map Importer class it handles:
+ *		- Reading a height map in from a PNG (8 or 16 bit), raw little endian 16 bit (.r16) or 32 bit float (.r32) heights,
+ *		  or a tiled container written by HeightMapExporter (.hmt)
+ *		- Resampling it to the resolution of the height map it's read into, bilinear or bicubic (Catmull-Rom)
+ *
+ * Nothing is read in whole, the file is decoded a row at a time into a window only a band of rows tall, and each band
+ * is resampled on all threads and written straight into the height map (whatever its layout), then the window slides
+ * on down the file. The filter is separable, a vertical pass blends the source rows 4 floats at a time with SSE, then
+ * a horizontal pass picks the taps out of that, both using taps and weights worked out once up front.
+ *
+ * The corners of the file land on the corners of the map. Bicubic is smoother when scaling up, but can overshoot a
+ * little either side of a cliff, bilinear never goes outside the heights around it.
+ *
+ * A PNG's grey (or red) channel is used, any alpha is ignored. 16 bit files are mapped from 0 -> 65535 (255 for an 8
+ * bit PNG) onto the height range, unless the file has its own, i.e. a PNG with a HeightRange tEXt chunk or a .hmt.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "HeightMap.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HeightMapImporter
+{
+public:
+	enum Filter
+	{
+		BILINEAR = 0,
+		BICUBIC
+	};
+
+	HeightMapImporter();
+	~HeightMapImporter();
+
+	// Picks the reader from the extension (.png, .r16, .r32 or .hmt), false if it can't be read, see getError()
+	// The map keeps its resolution and layout, anything already in it is overwritten, even if the file turns out to be broken
+	bool importHeightMap(HeightMap& heightmap, const std::string& filename);
+	bool importPNG(HeightMap& heightmap, const std::string& filename);
+	bool importRaw(HeightMap& heightmap, const std::string& filename, bool floatSamples);
+	bool importTiled(HeightMap& heightmap, const std::string& filename);
+
+	void setFilter(Filter newFilter);
+	// The heights the lowest and highest samples become, for files that don't carry their own range
+	void setHeightRange(float low, float high);
+	void setRowsPerBand(int rows);
+
+	// The size of the last file read
+	int getSourceWidth() const;
+	int getSourceHeight() const;
+	const std::string& getError() const;
+
+private:
+	// Reads the next row of the file into row, false if the file ends early or is broken
+	typedef std::function<bool(float* row)> RowReader;
+
+	bool resample(HeightMap& heightmap, int width, int height, const RowReader& readRow);
+	void findTaps(int targetCount, int sourceCount, std::vector<int>& taps, std::vector<float>& weights);
+
+	static void unfilterRow(int filterType, const unsigned char* filtered, const unsigned char* previous, unsigned char* row, size_t rowBytes, int pixelBytes);
+	static bool decodeTile(const std::vector<unsigned char>& data, unsigned int compression, bool floatSamples, int width, int height, float low, float scale, float* out, int outStride);
+
+	Filter filter;
+	float heightLow;
+	float heightHigh;
+	int rowsPerBand;
+	int sourceWidth;
+	int sourceHeight;
+	std::string error;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,459 @@
+/*
+ * This is the Height Map Pyramid class it handles:
+ *		- Keeping the lowest and highest height of every grid cell, then of every 2x2 block of those, and so on up to one
+ *		  block covering the whole map (a min/max mip pyramid)
+ *		- Casting rays against the terrain, i.e. for picking with the mouse
+ *		- Finding the lowest and highest ground over an area, i.e. for keeping the camera or an object above the ground
+ *		- Redoing only the blocks over the part of the map that changed
+ *
+ * A ray starts at the top block and only goes down into the blocks its path actually passes through at their height,
+ * nearest first, so most of the map is skipped a few levels down and the first cell it hits is the nearest. A cell is
+ * hit against the same two triangles the terrain is drawn with, split from its top left to its bottom right corner.
+ *
+ * Everything is in grid space, x and z in grid points and y in height, see Terrain for the terrain's local space. The
+ * heights come from a HeightMapSampler, which has to stay around (and not be resized) for as long as the pyramid does.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "HeightMapPyramid.h"
+#include "ParallelFor.h"
+#include <cfloat>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// How far outside a cell's triangle a hit can be and still count, so a ray can't slip between two cells
+const float CELL_EDGE_TOLERANCE = 1e-4f;
+
+// Far more than a ray can ever have waiting, each level adds at most 3 to the stack
+const int MAX_RAY_STACK = 128;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+HeightMapPyramid::HeightMapPyramid()
+{
+	// Default values
+	sampler = nullptr;
+	resolution = 0;
+}
+
+HeightMapPyramid::~HeightMapPyramid()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void HeightMapPyramid::build(const HeightMapSampler& heights)
+{
+	sampler = &heights;
+	resolution = heights.getResolution();
+	levels.clear();
+
+	if (resolution < 2)
+	{
+		return;
+	}
+
+	// Halving (rounding up) until a single block is left
+	int width = resolution - 1;
+
+	while (true)
+	{
+		levels.push_back(Level());
+		levels.back().width = width;
+		levels.back().low.resize((size_t)width * width);
+		levels.back().high.resize((size_t)width * width);
+
+		if (width == 1)
+		{
+			break;
+		}
+
+		width = (width + 1) / 2;
+	}
+
+	const int cells = resolution - 1;
+	buildCells(0, 0, cells - 1, cells - 1);
+
+	for (int l = 1; l < (int)levels.size(); ++l)
+	{
+		buildLevel(l, 0, 0, levels[l].width - 1, levels[l].width - 1);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapPyramid::update(const HeightMapSampler& heights, int minX, int minZ, int maxX, int maxZ)
+{
+	if (sampler != &heights || heights.getResolution() != resolution || levels.empty())
+	{
+		build(heights);
+		return;
+	}
+
+	// Every cell with one of the changed points as a corner
+	const int lastCell = resolution - 2;
+	minX = minX - 1 > 0 ? minX - 1 : 0;
+	minZ = minZ - 1 > 0 ? minZ - 1 : 0;
+	maxX = maxX < lastCell ? maxX : lastCell;
+	maxZ = maxZ < lastCell ? maxZ : lastCell;
+
+	if (minX > maxX || minZ > maxZ)
+	{
+		return;
+	}
+
+	buildCells(minX, minZ, maxX, maxZ);
+
+	for (int l = 1; l < (int)levels.size(); ++l)
+	{
+		minX /= 2;
+		minZ /= 2;
+		maxX /= 2;
+		maxZ /= 2;
+
+		buildLevel(l, minX, minZ, maxX, maxZ);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapPyramid::rayCast(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT, float& hitT) const
+{
+	if (levels.empty())
+	{
+		return false;
+	}
+
+	struct Block
+	{
+		int level;
+		int x;
+		int z;
+		float tEnter;
+	};
+
+	Block stack[MAX_RAY_STACK];
+	int stackSize = 0;
+
+	Block top = { (int)levels.size() - 1, 0, 0, 0.0f };
+
+	if (!intersectBlock(top.level, 0, 0, origin, direction, maxT, top.tEnter))
+	{
+		return false;
+	}
+
+	stack[stackSize++] = top;
+
+	while (stackSize > 0)
+	{
+		Block block = stack[--stackSize];
+
+		// The cells don't overlap from above, so the first one the ray hits, nearest first, is the nearest hit
+		if (block.level == 0)
+		{
+			if (intersectCell(block.x, block.z, origin, direction, maxT, hitT))
+			{
+				return true;
+			}
+
+			continue;
+		}
+
+		// The children the ray passes through, sorted furthest first so the nearest comes off the stack next
+		Block children[4];
+		int childCount = 0;
+		const int level = block.level - 1;
+
+		for (int c = 0; c < 4; ++c)
+		{
+			Block child = { level, block.x * 2 + (c & 1), block.z * 2 + (c >> 1), 0.0f };
+
+			if (child.x >= levels[level].width || child.z >= levels[level].width)
+			{
+				continue;
+			}
+
+			if (!intersectBlock(level, child.x, child.z, origin, direction, maxT, child.tEnter))
+			{
+				continue;
+			}
+
+			int insert = childCount++;
+
+			while (insert > 0 && children[insert - 1].tEnter < child.tEnter)
+			{
+				children[insert] = children[insert - 1];
+				--insert;
+			}
+
+			children[insert] = child;
+		}
+
+		for (int c = 0; c < childCount; ++c)
+		{
+			stack[stackSize++] = children[c];
+		}
+	}
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapPyramid::getHeightRange(float x0, float z0, float x1, float z1, float& low, float& high) const
+{
+	low = FLT_MAX;
+	high = -FLT_MAX;
+
+	if (levels.empty())
+	{
+		low = high = 0.0f;
+		return;
+	}
+
+	// Cells by their top left corner, an area right on a cell's edge only counts the cell it's in
+	const int lastCell = resolution - 2;
+	int minX = (int)floorf(x0 < x1 ? x0 : x1);
+	int minZ = (int)floorf(z0 < z1 ? z0 : z1);
+	int maxX = (int)ceilf(x0 < x1 ? x1 : x0) - 1;
+	int maxZ = (int)ceilf(z0 < z1 ? z1 : z0) - 1;
+
+	minX = minX < 0 ? 0 : (minX > lastCell ? lastCell : minX);
+	minZ = minZ < 0 ? 0 : (minZ > lastCell ? lastCell : minZ);
+	maxX = maxX < minX ? minX : (maxX > lastCell ? lastCell : maxX);
+	maxZ = maxZ < minZ ? minZ : (maxZ > lastCell ? lastCell : maxZ);
+
+	findHeightRange((int)levels.size() - 1, 0, 0, minX, minZ, maxX, maxZ, low, high);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int HeightMapPyramid::getLevelCount() const
+{
+	return (int)levels.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapPyramid::buildCells(int minX, int minZ, int maxX, int maxZ)
+{
+	Level& cells = levels[0];
+
+	ParallelFor::run(maxZ - minZ + 1, [&](int start, int end)
+	{
+		for (int z = minZ + start; z < minZ + end; ++z)
+		{
+			for (int x = minX; x <= maxX; ++x)
+			{
+				float nw = sampler->getGridHeight(x, z);
+				float ne = sampler->getGridHeight(x + 1, z);
+				float sw = sampler->getGridHeight(x, z + 1);
+				float se = sampler->getGridHeight(x + 1, z + 1);
+
+				float northLow = nw < ne ? nw : ne;
+				float northHigh = nw < ne ? ne : nw;
+				float southLow = sw < se ? sw : se;
+				float southHigh = sw < se ? se : sw;
+
+				size_t cell = (size_t)z * cells.width + x;
+				cells.low[cell] = northLow < southLow ? northLow : southLow;
+				cells.high[cell] = northHigh > southHigh ? northHigh : southHigh;
+			}
+		}
+	});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapPyramid::buildLevel(int level, int minX, int minZ, int maxX, int maxZ)
+{
+	Level& blocks = levels[level];
+	const Level& below = levels[level - 1];
+
+	ParallelFor::run(maxZ - minZ + 1, [&](int start, int end)
+	{
+		for (int z = minZ + start; z < minZ + end; ++z)
+		{
+			for (int x = minX; x <= maxX; ++x)
+			{
+				float low = FLT_MAX;
+				float high = -FLT_MAX;
+
+				// Blocks on the right and bottom edges can have fewer than 4 below them
+				for (int childZ = z * 2; childZ <= z * 2 + 1 && childZ < below.width; ++childZ)
+				{
+					for (int childX = x * 2; childX <= x * 2 + 1 && childX < below.width; ++childX)
+					{
+						size_t child = (size_t)childZ * below.width + childX;
+						low = below.low[child] < low ? below.low[child] : low;
+						high = below.high[child] > high ? below.high[child] : high;
+					}
+				}
+
+				size_t block = (size_t)z * blocks.width + x;
+				blocks.low[block] = low;
+				blocks.high[block] = high;
+			}
+		}
+	});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapPyramid::intersectBlock(int level, int x, int z, const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT, float& tEnter) const
+{
+	const Level& blocks = levels[level];
+	const size_t block = (size_t)z * blocks.width + x;
+	const int lastPoint = resolution - 1;
+
+	// The grid points the block covers, and the heights between
+	float boxMin[3] = { (float)(x << level), blocks.low[block], (float)(z << level) };
+	float boxMax[3] = { (float)((x + 1) << level), blocks.high[block], (float)((z + 1) << level) };
+	boxMax[0] = boxMax[0] < lastPoint ? boxMax[0] : (float)lastPoint;
+	boxMax[2] = boxMax[2] < lastPoint ? boxMax[2] : (float)lastPoint;
+
+	const float start[3] = { origin.x, origin.y, origin.z };
+	const float step[3] = { direction.x, direction.y, direction.z };
+	float tMin = 0.0f;
+	float tMax = maxT;
+
+	// Slabs, the ray has to be between each pair of planes at the same time
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (fabsf(step[axis]) < 1e-12f)
+		{
+			if (start[axis] < boxMin[axis] || start[axis] > boxMax[axis])
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		float inverse = 1.0f / step[axis];
+		float t0 = (boxMin[axis] - start[axis]) * inverse;
+		float t1 = (boxMax[axis] - start[axis]) * inverse;
+
+		tMin = fmaxf(tMin, fminf(t0, t1));
+		tMax = fminf(tMax, fmaxf(t0, t1));
+
+		if (tMin > tMax)
+		{
+			return false;
+		}
+	}
+
+	tEnter = tMin;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapPyramid::intersectCell(int x, int z, const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT, float& hitT) const
+{
+	/*
+	*	a *-------* b
+	*	  | \     |		Split the same way as the index buffer, a -> d
+	*	  |   \   |		a, b, d above the diagonal, a, d, c below it
+	*	  |     \ |
+	*	c *-------* d
+	*/
+
+	float a = sampler->getGridHeight(x, z);
+	float b = sampler->getGridHeight(x + 1, z);
+	float c = sampler->getGridHeight(x, z + 1);
+	float d = sampler->getGridHeight(x + 1, z + 1);
+
+	// The origin relative to the cell's top left corner
+	float startU = origin.x - x;
+	float startV = origin.z - z;
+
+	// Each triangle as a plane, height = base + slopeU * u + slopeV * v
+	const float slopesU[2] = { b - a, d - c };
+	const float slopesV[2] = { d - b, c - a };
+	bool hit = false;
+
+	for (int triangle = 0; triangle < 2; ++triangle)
+	{
+		float denominator = direction.y - slopesU[triangle] * direction.x - slopesV[triangle] * direction.z;
+
+		// Running along the triangle, never through it
+		if (fabsf(denominator) < 1e-12f)
+		{
+			continue;
+		}
+
+		float t = (a + slopesU[triangle] * startU + slopesV[triangle] * startV - origin.y) / denominator;
+
+		if (t < 0.0f || t > maxT || (hit && t >= hitT))
+		{
+			continue;
+		}
+
+		float u = startU + t * direction.x;
+		float v = startV + t * direction.z;
+
+		bool inCell = u >= -CELL_EDGE_TOLERANCE && u <= 1.0f + CELL_EDGE_TOLERANCE && v >= -CELL_EDGE_TOLERANCE && v <= 1.0f + CELL_EDGE_TOLERANCE;
+		bool onSide = triangle == 0 ? v <= u + CELL_EDGE_TOLERANCE : u <= v + CELL_EDGE_TOLERANCE;
+
+		if (inCell && onSide)
+		{
+			hitT = t;
+			hit = true;
+		}
+	}
+
+	return hit;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapPyramid::findHeightRange(int level, int x, int z, int minX, int minZ, int maxX, int maxZ, float& low, float& high) const
+{
+	// The cells under this block
+	const int firstX = x << level;
+	const int firstZ = z << level;
+	const int lastX = ((x + 1) << level) - 1;
+	const int lastZ = ((z + 1) << level) - 1;
+
+	if (lastX < minX || firstX > maxX || lastZ < minZ || firstZ > maxZ)
+	{
+		return;
+	}
+
+	// Completely inside, so the block's own range is the answer for all of it
+	if (level == 0 || (firstX >= minX && lastX <= maxX && firstZ >= minZ && lastZ <= maxZ))
+	{
+		const Level& blocks = levels[level];
+		const size_t block = (size_t)z * blocks.width + x;
+
+		low = fminf(low, blocks.low[block]);
+		high = fmaxf(high, blocks.high[block]);
+		return;
+	}
+
+	const int width = levels[level - 1].width;
+
+	for (int c = 0; c < 4; ++c)
+	{
+		int childX = x * 2 + (c & 1);
+		int childZ = z * 2 + (c >> 1);
+
+		if (childX < width && childZ < width)
+		{
+			findHeightRange(level - 1, childX, childZ, minX, minZ, maxX, maxZ, low, high);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
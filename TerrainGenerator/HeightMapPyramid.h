@@ -0,0 +1,72 @@
+/*
+ * This is the Height Map Pyramid class it handles:
+ *		- Keeping the lowest and highest height of every grid cell, then of every 2x2 block of those, and so on up to one
+ *		  block covering the whole map (a min/max mip pyramid)
+ *		- Casting rays against the terrain, i.e. for picking with the mouse
+ *		- Finding the lowest and highest ground over an area, i.e. for keeping the camera or an object above the ground
+ *		- Redoing only the blocks over the part of the map that changed
+ *
+ * A ray starts at the top block and only goes down into the blocks its path actually passes through at their height,
+ * nearest first, so most of the map is skipped a few levels down and the first cell it hits is the nearest. A cell is
+ * hit against the same two triangles the terrain is drawn with, split from its top left to its bottom right corner.
+ *
+ * Everything is in grid space, x and z in grid points and y in height, see Terrain for the terrain's local space. The
+ * heights come from a HeightMapSampler, which has to stay around (and not be resized) for as long as the pyramid does.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include "HeightMapSampler.h"
+
+using namespace DirectX;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HeightMapPyramid
+{
+public:
+	HeightMapPyramid();
+	~HeightMapPyramid();
+
+	void build(const HeightMapSampler& heights);
+	// Only the blocks over grid points minX -> maxX, minZ -> maxZ are redone, everything if the resolution has changed
+	void update(const HeightMapSampler& heights, int minX, int minZ, int maxX, int maxZ);
+
+	// The direction doesn't need to be normalised, hitT is how many lots of it from the origin the hit is
+	// Only hits between 0 and maxT count, false if there aren't any
+	bool rayCast(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT, float& hitT) const;
+	// The lowest and highest ground over x0 -> x1, z0 -> z1, any cell the area touches is counted whole
+	void getHeightRange(float x0, float z0, float x1, float z1, float& low, float& high) const;
+
+	int getLevelCount() const;
+
+private:
+	struct Level
+	{
+		int width;
+		std::vector<float> low;
+		std::vector<float> high;
+	};
+
+	// Level 0 from the heights, then each level above from the one below
+	void buildCells(int minX, int minZ, int maxX, int maxZ);
+	void buildLevel(int level, int minX, int minZ, int maxX, int maxZ);
+
+	bool intersectBlock(int level, int x, int z, const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT, float& tEnter) const;
+	bool intersectCell(int x, int z, const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT, float& hitT) const;
+	void findHeightRange(int level, int x, int z, int minX, int minZ, int maxX, int maxZ, float& low, float& high) const;
+
+	const HeightMapSampler* sampler;
+	int resolution;
+	std::vector<Level> levels;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,263 @@
+/*
+ * This is the Height Map Sampler class it handles:
+ *		- Keeping a read only copy of the heights, row by row, with one extra column and row copied from the edge
+ *		- Bilinear heights and gradients for whole arrays of positions, 4 at a time with SSE
+ *		- The same for a single position, for anything that only wants one, i.e. following the ground with the camera
+ *		- Keeping track of which part of the map changed in the last update, so anything built from it (i.e. the
+ *		  min/max pyramid) only has to redo that part
+ *
+ * The heights and gradients are worked out exactly like HydraulicErosion::calculateHeightAndGradient, but with no
+ * branches per sample. Positions are clamped onto the map (anything off it, or NaN, reads the nearest edge), and the
+ * extra column and row mean the cell at the far edge can always read its right and bottom neighbours. The 4 corners of
+ * each cell are gathered as 2 pairs of floats per lane, NW/NE and SW/SE are next to each other in memory.
+ *
+ * The copy is only as new as the last update(), edits to the height map don't show until it's called again.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "HeightMapSampler.h"
+#include "ParallelFor.h"
+#include <cstring>
+#include <emmintrin.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+HeightMapSampler::HeightMapSampler()
+{
+	// Default values
+	resolution = 0;
+	stride = 0;
+	maxCoord = 0.0f;
+	changedMinX = 0;
+	changedMinZ = 0;
+	changedMaxX = -1;
+	changedMaxZ = -1;
+}
+
+HeightMapSampler::~HeightMapSampler()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void HeightMapSampler::update(const HeightMap& heightmap)
+{
+	// A new size means everything has changed
+	const bool resized = heightmap.getResolution() != resolution;
+
+	resolution = heightmap.getResolution();
+	stride = resolution + 1;
+	maxCoord = (float)(resolution - 1);
+	heights.resize((size_t)stride * stride);
+
+	changedMinX = resized ? 0 : resolution;
+	changedMinZ = resized ? 0 : resolution;
+	changedMaxX = resized ? resolution - 1 : -1;
+	changedMaxZ = resized ? resolution - 1 : -1;
+
+	if (resolution == 0)
+	{
+		return;
+	}
+
+	const bool rowMajor = heightmap.getLayout() == HeightMap::ROW_MAJOR;
+
+	// The first and last changed point of each row, then put together afterwards
+	std::vector<int> firstChanged(resolution), lastChanged(resolution);
+
+	ParallelFor::run(resolution, [&](int startZ, int endZ)
+	{
+		for (int z = startZ; z < endZ; ++z)
+		{
+			float* row = &heights[(size_t)z * stride];
+			const float* source = rowMajor ? &heightmap.data()[heightmap.index(0, z)] : nullptr;
+			int first = resolution;
+			int last = -1;
+
+			for (int x = 0; x < resolution; ++x)
+			{
+				float height = source ? source[x] : heightmap.at(x, z);
+
+				if (height != row[x])
+				{
+					first = x < first ? x : first;
+					last = x;
+					row[x] = height;
+				}
+			}
+
+			firstChanged[z] = first;
+			lastChanged[z] = last;
+
+			// The extra column
+			row[resolution] = row[resolution - 1];
+
+			// And the extra row
+			if (z == resolution - 1)
+			{
+				memcpy(row + stride, row, stride * sizeof(float));
+			}
+		}
+	});
+
+	if (resized)
+	{
+		return;
+	}
+
+	for (int z = 0; z < resolution; ++z)
+	{
+		if (lastChanged[z] >= 0)
+		{
+			changedMinX = firstChanged[z] < changedMinX ? firstChanged[z] : changedMinX;
+			changedMaxX = lastChanged[z] > changedMaxX ? lastChanged[z] : changedMaxX;
+			changedMinZ = z < changedMinZ ? z : changedMinZ;
+			changedMaxZ = z;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HeightMapSampler::getChangedArea(int& minX, int& minZ, int& maxX, int& maxZ) const
+{
+	minX = changedMinX;
+	minZ = changedMinZ;
+	maxX = changedMaxX;
+	maxZ = changedMaxZ;
+
+	return changedMaxX >= 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapSampler::sample(const float* x, const float* z, int count, float* outHeights, float* gradientX, float* gradientZ) const
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 maxPosition = _mm_set1_ps(maxCoord);
+	const float* grid = heights.data();
+
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		// max() first, it gives 0 for NaN
+		__m128 posX = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(x + i), zero), maxPosition);
+		__m128 posZ = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(z + i), zero), maxPosition);
+
+		// Never negative by now, so truncating is the same as flooring
+		__m128i cellX = _mm_cvttps_epi32(posX);
+		__m128i cellZ = _mm_cvttps_epi32(posZ);
+		__m128 offsetX = _mm_sub_ps(posX, _mm_cvtepi32_ps(cellX));
+		__m128 offsetZ = _mm_sub_ps(posZ, _mm_cvtepi32_ps(cellZ));
+
+		alignas(16) int cellsX[4];
+		alignas(16) int cellsZ[4];
+		_mm_store_si128((__m128i*)cellsX, cellX);
+		_mm_store_si128((__m128i*)cellsZ, cellZ);
+
+		const float* nw[4];
+
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			nw[lane] = grid + (size_t)cellsZ[lane] * stride + cellsX[lane];
+		}
+
+		// Each lane's NW/NE and SW/SE pairs, then shuffled so each corner has a register of its own
+		__m128 top01 = _mm_loadh_pi(_mm_loadl_pi(zero, (const __m64*)nw[0]), (const __m64*)nw[1]);
+		__m128 top23 = _mm_loadh_pi(_mm_loadl_pi(zero, (const __m64*)nw[2]), (const __m64*)nw[3]);
+		__m128 bottom01 = _mm_loadh_pi(_mm_loadl_pi(zero, (const __m64*)(nw[0] + stride)), (const __m64*)(nw[1] + stride));
+		__m128 bottom23 = _mm_loadh_pi(_mm_loadl_pi(zero, (const __m64*)(nw[2] + stride)), (const __m64*)(nw[3] + stride));
+
+		__m128 heightNW = _mm_shuffle_ps(top01, top23, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 heightNE = _mm_shuffle_ps(top01, top23, _MM_SHUFFLE(3, 1, 3, 1));
+		__m128 heightSW = _mm_shuffle_ps(bottom01, bottom23, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 heightSE = _mm_shuffle_ps(bottom01, bottom23, _MM_SHUFFLE(3, 1, 3, 1));
+
+		__m128 inverseX = _mm_sub_ps(one, offsetX);
+		__m128 inverseZ = _mm_sub_ps(one, offsetZ);
+
+		// Along the top and bottom edges, then between them
+		__m128 top = _mm_add_ps(_mm_mul_ps(heightNW, inverseX), _mm_mul_ps(heightNE, offsetX));
+		__m128 bottom = _mm_add_ps(_mm_mul_ps(heightSW, inverseX), _mm_mul_ps(heightSE, offsetX));
+		_mm_storeu_ps(outHeights + i, _mm_add_ps(_mm_mul_ps(top, inverseZ), _mm_mul_ps(bottom, offsetZ)));
+
+		if (gradientX)
+		{
+			__m128 slopeX = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(heightNE, heightNW), inverseZ), _mm_mul_ps(_mm_sub_ps(heightSE, heightSW), offsetZ));
+			__m128 slopeZ = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(heightSW, heightNW), inverseX), _mm_mul_ps(_mm_sub_ps(heightSE, heightNE), offsetX));
+
+			_mm_storeu_ps(gradientX + i, slopeX);
+			_mm_storeu_ps(gradientZ + i, slopeZ);
+		}
+	}
+
+	// Whatever doesn't fill a full 4
+	for (; i < count; ++i)
+	{
+		HeightAndGradient result = sample(x[i], z[i]);
+		outHeights[i] = result.height;
+
+		if (gradientX)
+		{
+			gradientX[i] = result.gradientX;
+			gradientZ[i] = result.gradientZ;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightAndGradient HeightMapSampler::sample(float x, float z) const
+{
+	// Written so NaN ends up at 0, like the SSE version
+	x = x > 0.0f ? (x < maxCoord ? x : maxCoord) : 0.0f;
+	z = z > 0.0f ? (z < maxCoord ? z : maxCoord) : 0.0f;
+
+	int cellX = (int)x;
+	int cellZ = (int)z;
+	float offsetX = x - cellX;
+	float offsetZ = z - cellZ;
+
+	const float* nw = &heights[(size_t)cellZ * stride + cellX];
+	float heightNW = nw[0];
+	float heightNE = nw[1];
+	float heightSW = nw[stride];
+	float heightSE = nw[stride + 1];
+
+	float top = heightNW * (1 - offsetX) + heightNE * offsetX;
+	float bottom = heightSW * (1 - offsetX) + heightSE * offsetX;
+
+	HeightAndGradient result;
+	result.height = top * (1 - offsetZ) + bottom * offsetZ;
+	result.gradientX = (heightNE - heightNW) * (1 - offsetZ) + (heightSE - heightSW) * offsetZ;
+	result.gradientZ = (heightSW - heightNW) * (1 - offsetX) + (heightSE - heightNE) * offsetX;
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float HeightMapSampler::getHeight(float x, float z) const
+{
+	return sample(x, z).height;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int HeightMapSampler::getResolution() const
+{
+	return resolution;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,67 @@
+/*
+ * This is the Height Map Sampler class it handles:
+ *		- Keeping a read only copy of the heights, row by row, with one extra column and row copied from the edge
+ *		- Bilinear heights and gradients for whole arrays of positions, 4 at a time with SSE
+ *		- The same for a single position, for anything that only wants one, i.e. following the ground with the camera
+ *		- Keeping track of which part of the map changed in the last update, so anything built from it (i.e. the
+ *		  min/max pyramid) only has to redo that part
+ *
+ * The heights and gradients are worked out exactly like HydraulicErosion::calculateHeightAndGradient, but with no
+ * branches per sample. Positions are clamped onto the map (anything off it, or NaN, reads the nearest edge), and the
+ * extra column and row mean the cell at the far edge can always read its right and bottom neighbours. The 4 corners of
+ * each cell are gathered as 2 pairs of floats per lane, NW/NE and SW/SE are next to each other in memory.
+ *
+ * The copy is only as new as the last update(), edits to the height map don't show until it's called again.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <vector>
+#include "HeightMap.h"
+#include "HydraulicErosion.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HeightMapSampler
+{
+public:
+	HeightMapSampler();
+	~HeightMapSampler();
+
+	// Copies the heights in, whatever the map's layout, and finds which grid points have changed since the last copy
+	void update(const HeightMap& heightmap);
+	// The grid points that changed in the last update(), all of them if the resolution did, false if nothing changed
+	bool getChangedArea(int& minX, int& minZ, int& maxX, int& maxZ) const;
+
+	// Positions are in grid units, 0 -> resolution - 1, gradientX and gradientZ can be nullptr if only the heights are wanted
+	void sample(const float* x, const float* z, int count, float* heights, float* gradientX, float* gradientZ) const;
+	HeightAndGradient sample(float x, float z) const;
+	float getHeight(float x, float z) const;
+
+	// The height at a grid point, x and z MUST be within 0 -> resolution - 1
+	inline float getGridHeight(int x, int z) const
+	{
+		return heights[(size_t)z * stride + x];
+	}
+
+	int getResolution() const;
+
+private:
+	int resolution;
+	int stride;
+	float maxCoord;
+	std::vector<float> heights;
+
+	int changedMinX;
+	int changedMinZ;
+	int changedMaxX;
+	int changedMaxZ;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,196 @@
+/*
+ * This is the Height Map Snapshot class it handles:
+ *		- Keeping a read only copy of a height map, split up into square pages
+ *		- Sharing every page that hasn't changed with the snapshot before it, rather than copying it again
+ *		- Writing the heights back into a height map, skipping the pages it already has
+ *
+ * A snapshot is never changed once it's built, and the pages are only ever read, so snapshots can be handed to
+ * other threads (i.e. TerrainBatch's workers) while the terrain carries on being edited.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "HeightMapSnapshot.h"
+#include "ParallelFor.h"
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+HeightMapSnapshot::HeightMapSnapshot(const HeightMap& heightmap, const HeightMapSnapshot* previous)
+{
+	resolution = heightmap.getResolution();
+	pagesPerRow = (resolution + PAGE_SIZE - 1) / PAGE_SIZE;
+	pages.resize(pagesPerRow * pagesPerRow);
+
+	// Pages can only be shared with a map the same size
+	if (previous && previous->resolution != resolution)
+	{
+		previous = nullptr;
+	}
+
+	const bool rowMajor = heightmap.getLayout() == HeightMap::ROW_MAJOR;
+
+	ParallelFor::run((int)pages.size(), [&](int startPage, int endPage)
+	{
+		Page heights;
+
+		for (int page = startPage; page < endPage; ++page)
+		{
+			int startX, startZ, width, height;
+			getPageBounds(page, startX, startZ, width, height);
+
+			heights.resize(width * height);
+
+			for (int z = 0; z < height; ++z)
+			{
+				if (rowMajor)
+				{
+					memcpy(&heights[z * width], &heightmap.data()[heightmap.index(startX, startZ + z)], width * sizeof(float));
+				}
+				else
+				{
+					for (int x = 0; x < width; ++x)
+					{
+						heights[z * width + x] = heightmap.at(startX + x, startZ + z);
+					}
+				}
+			}
+
+			// Unchanged, so there's no need for another copy
+			if (previous && memcmp(previous->pages[page]->data(), heights.data(), heights.size() * sizeof(float)) == 0)
+			{
+				pages[page] = previous->pages[page];
+			}
+			else
+			{
+				pages[page] = std::make_shared<const Page>(heights);
+			}
+		}
+	}, 1);
+}
+
+HeightMapSnapshot::~HeightMapSnapshot()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void HeightMapSnapshot::copyTo(HeightMap& heightmap, const HeightMapSnapshot* current) const
+{
+	if (heightmap.getResolution() != resolution)
+	{
+		heightmap.resize(resolution, heightmap.getLayout());
+		current = nullptr;
+	}
+
+	if (current && current->resolution != resolution)
+	{
+		current = nullptr;
+	}
+
+	const bool rowMajor = heightmap.getLayout() == HeightMap::ROW_MAJOR;
+
+	ParallelFor::run((int)pages.size(), [&](int startPage, int endPage)
+	{
+		for (int page = startPage; page < endPage; ++page)
+		{
+			// The map already has these heights
+			if (current && current->pages[page] == pages[page])
+			{
+				continue;
+			}
+
+			int startX, startZ, width, height;
+			getPageBounds(page, startX, startZ, width, height);
+
+			const Page& heights = *pages[page];
+
+			for (int z = 0; z < height; ++z)
+			{
+				if (rowMajor)
+				{
+					memcpy(&heightmap.data()[heightmap.index(startX, startZ + z)], &heights[z * width], width * sizeof(float));
+				}
+				else
+				{
+					for (int x = 0; x < width; ++x)
+					{
+						heightmap.at(startX + x, startZ + z) = heights[z * width + x];
+					}
+				}
+			}
+		}
+	}, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float HeightMapSnapshot::at(int x, int z) const
+{
+	int page = (z / PAGE_SIZE) * pagesPerRow + (x / PAGE_SIZE);
+
+	int startX, startZ, width, height;
+	getPageBounds(page, startX, startZ, width, height);
+
+	return (*pages[page])[(z - startZ) * width + (x - startX)];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int HeightMapSnapshot::getResolution() const
+{
+	return resolution;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int HeightMapSnapshot::getPageCount() const
+{
+	return (int)pages.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const HeightMapSnapshot::Page* HeightMapSnapshot::getPage(int page) const
+{
+	return pages[page].get();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int HeightMapSnapshot::countSharedPages(const HeightMapSnapshot& other) const
+{
+	if (other.resolution != resolution)
+	{
+		return 0;
+	}
+
+	int shared = 0;
+
+	for (int page = 0; page < (int)pages.size(); ++page)
+	{
+		shared += pages[page] == other.pages[page] ? 1 : 0;
+	}
+
+	return shared;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HeightMapSnapshot::getPageBounds(int page, int& startX, int& startZ, int& width, int& height) const
+{
+	startX = (page % pagesPerRow) * PAGE_SIZE;
+	startZ = (page / pagesPerRow) * PAGE_SIZE;
+	width = resolution - startX < PAGE_SIZE ? resolution - startX : PAGE_SIZE;
+	height = resolution - startZ < PAGE_SIZE ? resolution - startZ : PAGE_SIZE;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
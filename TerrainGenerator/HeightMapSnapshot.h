@@ -0,0 +1,56 @@
+/*
+ * This is the Height Map Snapshot class it handles:
+ *		- Keeping a read only copy of a height map, split up into square pages
+ *		- Sharing every page that hasn't changed with the snapshot before it, rather than copying it again
+ *		- Writing the heights back into a height map, skipping the pages it already has
+ *
+ * A snapshot is never changed once it's built, and the pages are only ever read, so snapshots can be handed to
+ * other threads (i.e. TerrainBatch's workers) while the terrain carries on being edited.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <memory>
+#include <vector>
+#include "HeightMap.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HeightMapSnapshot
+{
+public:
+	// The heights of one page, row by row, pages on the right and bottom edges can be smaller than PAGE_SIZE
+	typedef std::vector<float> Page;
+
+	static const int PAGE_SIZE = 64;
+
+	// Any page with the same heights as the same page of previous is shared with it, previous can be nullptr
+	HeightMapSnapshot(const HeightMap& heightmap, const HeightMapSnapshot* previous = nullptr);
+	~HeightMapSnapshot();
+
+	// Writes the snapshot into the height map, which is resized if it has to be
+	// If the map already holds the heights of current, only the pages that differ from it are written
+	void copyTo(HeightMap& heightmap, const HeightMapSnapshot* current = nullptr) const;
+	float at(int x, int z) const;
+
+	int getResolution() const;
+	int getPageCount() const;
+	const Page* getPage(int page) const;
+	// How many pages are shared with other, all of them if the heights are the same
+	int countSharedPages(const HeightMapSnapshot& other) const;
+
+private:
+	void getPageBounds(int page, int& startX, int& startZ, int& width, int& height) const;
+
+	int resolution;
+	int pagesPerRow;
+	std::vector<std::shared_ptr<const Page>> pages;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,430 @@
+/*
+ * This is the Hydraulic Erosion class it handles:
+ *		- Running droplet (particle) based hydraulic erosion, one droplet at a time, each one picking up sediment
+ *		  as it runs downhill and dropping it again when it slows, goes uphill, or is carrying too much
+ *		- Optionally recording each droplet's flow, erosion and deposition, see ErosionMaps
+ *
+ * The droplets take their random numbers from a generator they're given, and their settings from
+ * a copy, so a run can be split up (see ErosionSession) and still give exactly the same terrain.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "HydraulicErosion.h"
+#include <cfloat>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const float TWO_PI = 6.28318530718f;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+HydraulicErosion::HydraulicErosion(int& res, HeightMap& heightmp, ErosionBrushCache& brushes) :
+	resolution(res), heightMap(heightmp), brushCache(brushes)
+{
+	// Default values
+	params.erosionRadius = 3;
+	params.inertia = 0.5f;
+	params.sedimentCapacity = 1.1f;
+	params.minSedimentCapacity = 0.01f;
+	params.erodeSpeed = 0.5f;
+	params.depositSpeed = 0.012f;
+	params.evaporateSpeed = 0.012f;
+	params.gravity = 4.0f;
+	params.maxDropletLifetime = 30;
+}
+
+HydraulicErosion::~HydraulicErosion()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void HydraulicErosion::simulateDroplet(ErosionRandom& random, const DropletParams& dropletParams, float* flowCounts, float* erodedTotals, float* depositedTotals)
+{
+	// Ref:
+	// https://www.firespark.de/resources/downloads/implementation%20of%20a%20methode%20for%20hydraulic%20erosion.pdf
+	// https://github.com/SebLague/Hydraulic-Erosion
+	// http://ranmantaru.com/blog/2011/10/08/water-erosion-on-heightmap-terrain/
+
+	// Ref:
+	// Laugue, S (2019), Hydraulic-Erosion Version(Unknown) [Source code]. https://github.com/SebLague/Hydraulic-Erosion
+
+	/*
+	* The following was built using the above links, it mostly follows the
+	* first pdf paper, which is also the source for the second link.
+	* The third link is similar in nature again in using the droplet method
+	* This code has been adapted, modified, and updated by me, and in places,
+	* to best suit the needs of the application and the aesthetics. 
+	* 
+	 */
+
+	// Looked up every droplet, so a slider can change the radius between droplets without leaving a stale brush
+	const ErosionBrush& brush = brushCache.getBrush(resolution, dropletParams.erosionRadius);
+	const int brushSize = (int)brush.weights.size();
+	const bool rowMajor = heightMap.getLayout() == HeightMap::ROW_MAJOR;
+
+	// Spawn New Particle at random location on the map
+	int initialRandXPos = random.next() % resolution;
+	int initialRandZPos = random.next() % resolution;
+	float posX = initialRandXPos;
+	float posZ = initialRandZPos;
+	float dirX = 0;
+	float dirZ = 0;
+	//float speed = 1.0f;
+	float waterVolume = 1.0f;
+	float sedimentCarried = 0;
+
+	for (int lifetime = 0; lifetime < dropletParams.maxDropletLifetime; lifetime++)
+	{
+		int nodeX = (int)posX;
+		int nodeZ = (int)posZ;
+		int dropletIndex = nodeZ * resolution + nodeX;		// Row-major, the brush's row-major offsets are added to this
+
+		if (flowCounts)
+		{
+			flowCounts[heightMap.index(nodeX, nodeZ)] += 1.0f;
+		}
+
+		// Calculate droplet's offset inside the cell (0,0) = at NW node, (1,1) = at SE node
+		float cellOffsetX = posX - nodeX;
+		float cellOffsetZ = posZ - nodeZ;
+
+		// Calculate droplet's height and direction of flow with bilinear interpolation of surrounding heights
+		HeightAndGradient heightAndGradient = calculateHeightAndGradient(posX, posZ);
+
+		// Update the droplet's direction
+		dirX = ((dirX * dropletParams.inertia) - (heightAndGradient.gradientX * (1 - dropletParams.inertia)));
+		dirZ = ((dirZ * dropletParams.inertia) - (heightAndGradient.gradientZ * (1 - dropletParams.inertia)));
+
+		float sum = dirX * dirX + dirZ * dirZ;
+		float len = sqrt(sum);
+
+		// If the new direction value is below tiny threshold value, i.e. almost flat surface
+		if (len <= FLT_EPSILON)
+		{
+			// Pick random direction
+			const float MIN_RAND = 0;
+			const float MAX_RAND = TWO_PI;
+			const float range = MAX_RAND - MIN_RAND;
+			float randomAngle = range * random.nextFloat() + MIN_RAND;
+			dirX = cosf(randomAngle);
+			dirZ = sinf(randomAngle);
+		}
+
+		// Normalize direction
+		dirX /= len;
+		dirZ /= len;
+
+		// Update the droplets position
+		posX += dirX;
+		posZ += dirZ;
+
+		// Stop simulating droplet has flowed over edge of map
+		if (posX < 0 || posX >= resolution - 1 || posZ < 0 || posZ >= resolution - 1)
+		{
+			break;
+		}
+
+		// Find the droplet's new height and calculate the deltaHeight
+		float newHeight = calculateHeightAndGradient(posX, posZ).height;
+		float deltaHeight = newHeight - heightAndGradient.height;
+
+		// Calculated new sediment capacity, This is not done as it does not produce the correct aesthetics if included
+		//sedimentCapacity = fmax(-deltaHeight, minSedimentCapacity) * speed * waterVolume * sedimentCapacity;		// Hans Beyer
+		//sedimentCapacity = fmax(-deltaHeight * speed * waterVolume * sedimentCapacity, minSedimentCapacity);		// Lague
+
+		// If the change in height is positive, i.e. we moved 'uphill' then we deposit some sediment
+		// in the pit the particle just ran through.
+		// OR if the particle is carrying more sediment than its capacity, we must deposit some
+		// DEPOSITION
+		if (deltaHeight > 0 || sedimentCarried > dropletParams.sedimentCapacity)
+		{
+			float amountToDeposit = 0;
+
+			// If moving uphill (deltaHeight > 0) try fill up to the current height,
+			// otherwise deposit a fraction of the excess sediment currently carried
+			if (deltaHeight > 0)
+			{
+				amountToDeposit = fmin(deltaHeight, sedimentCarried);
+			}
+			else
+			{
+				amountToDeposit = (sedimentCarried - dropletParams.sedimentCapacity) * dropletParams.depositSpeed;
+			}
+
+			sedimentCarried -= amountToDeposit;
+
+			// Add the sediment to the four nodes of the current cell using bilinear interpolation
+			// Deposition is not distributed over a radius (like erosion) so that it can fill small pits
+
+			// Current vertex
+			depositAt(heightMap.index(nodeX, nodeZ), amountToDeposit * (1 - cellOffsetX) * (1 - cellOffsetZ), depositedTotals);
+
+			// Boundary checks on the other 3 surrounding the above vertex location
+			if (nodeX < (resolution - 1))
+			{
+				depositAt(heightMap.index(nodeX + 1, nodeZ), amountToDeposit * cellOffsetX * (1 - cellOffsetZ), depositedTotals);
+			}
+
+			if (nodeZ < (resolution - 1))
+			{
+				depositAt(heightMap.index(nodeX, nodeZ + 1), amountToDeposit * (1 - cellOffsetX) * cellOffsetZ, depositedTotals);
+			}
+
+			if (nodeX < (resolution - 1) && nodeZ < (resolution - 1))
+			{
+				depositAt(heightMap.index(nodeX + 1, nodeZ + 1), amountToDeposit * cellOffsetX * cellOffsetZ, depositedTotals);
+			}				
+		}
+		else		// We moved downhill	-	EROSION
+		{
+			// Erode a fraction of the droplet's current carry capacity.
+			float amountToErode = 0;
+
+			// As long as we've not gone over capacity, calculate a new amount of erosion
+			if (sedimentCarried < dropletParams.sedimentCapacity)
+			{
+				// Clamp the erosion to the change in height so that it doesn't dig a hole in the terrain behind the droplet
+				// The final value of this should NEVER be more than the height diff between old position and new position, i.e deltaHeight
+				float resultantSediment = (dropletParams.sedimentCapacity - sedimentCarried) * dropletParams.erodeSpeed;
+				amountToErode = fmin(resultantSediment, -deltaHeight);
+			}
+
+			// Near the edges some of the brush is off the map, so the rest of it shares out all of the erosion
+			bool nearEdge = nodeX < brush.radius || nodeX >= resolution - brush.radius || nodeZ < brush.radius || nodeZ >= resolution - brush.radius;
+			float weightScale = 1.0f;
+
+			if (nearEdge)
+			{
+				float weightSum = 0.0f;
+
+				for (int brushPointIndex = 0; brushPointIndex < brushSize; brushPointIndex++)
+				{
+					if (isOnMap(nodeX + brush.offsetX[brushPointIndex], nodeZ + brush.offsetZ[brushPointIndex]))
+					{
+						weightSum += brush.weights[brushPointIndex];
+					}
+				}
+
+				weightScale = 1.0f / weightSum;
+			}
+
+			// Use erosion brush to erode from all nodes inside the droplet's erosion radius
+			for (int brushPointIndex = 0; brushPointIndex < brushSize; brushPointIndex++)
+			{
+				int coordX = nodeX + brush.offsetX[brushPointIndex];
+				int coordZ = nodeZ + brush.offsetZ[brushPointIndex];
+
+				if (nearEdge && !isOnMap(coordX, coordZ))
+				{
+					continue;
+				}
+
+				int nodeIndex = rowMajor ? dropletIndex + brush.rowMajorOffset[brushPointIndex] : heightMap.index(coordX, coordZ);
+
+				float weightedErodeAmount = amountToErode * brush.weights[brushPointIndex] * weightScale;
+
+				float deltaSediment = 0;
+
+				// ## THIS ##
+				// Comment this out if you do not want the "sea level" texture to be flattened out
+				if (heightMap[nodeIndex] < weightedErodeAmount)
+				{
+					deltaSediment = heightMap[nodeIndex];
+				}
+				else
+				{
+					deltaSediment = weightedErodeAmount;
+				}
+
+				//float deltaSediment = (heightMap[nodeIndex] < weightedErodeAmount) ? heightMap[nodeIndex] : weightedErodeAmount;
+
+				// ## OR THIS ## // ## BUT NOT BOTH ##
+				// Uncomment this wish to have the aesthetics of seeing "through" the "sea level water" to the rocky sea bed
+				//float deltaSediment = weightedErodeAmount;
+
+				heightMap[nodeIndex] -= deltaSediment;
+				sedimentCarried += deltaSediment;
+
+				if (erodedTotals)
+				{
+					erodedTotals[nodeIndex] += deltaSediment;
+				}
+			}
+		}
+
+		// Update droplet's speed and water content
+		// This can be +/- to represent when the particle may be flowing up/downhill
+		// with either a pos/neg vel
+		//speed = speed * speed + deltaHeight * gravity;
+
+		// This is what the paper has - Hans Beyer
+		//speed = sqrt(speed * speed + deltaHeight * gravity);
+		
+		waterVolume *= (1 - dropletParams.evaporateSpeed);
+
+		// If the water has all but evaporated, stop iterating on this particle
+		if (waterVolume <= 0.0001)
+		{
+			break;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HydraulicErosion::depositAt(int storageIndex, float amount, float* depositedTotals)
+{
+	heightMap[storageIndex] += amount;
+
+	if (depositedTotals)
+	{
+		depositedTotals[storageIndex] += amount;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeightAndGradient HydraulicErosion::calculateHeightAndGradient(float posX, float posZ)
+{
+	int coordX = (int)posX;
+	int coordZ = (int)posZ;
+
+	// Calculate Particles offset inside the cell (0,0) = at NW node, (1,1) = at SE node
+	float xOffset = posX - coordX;
+	float zOffset = posZ - coordZ;
+
+	// Bilinear Interpolation
+	// https://x-engineer.org/bilinear-interpolation/
+	// https://blogs.sas.com/content/iml/2020/05/18/what-is-bilinear-interpolation.html
+
+	/*
+	*			--->
+	* (0,0)	NW	 |		NE (1,0)
+	*		*----*p1----*
+	*		|	 |		|
+	*	 --------*p3--------
+	*		|	 |		|
+	*		|	 |		|
+	* (0,1)	*----*p2-----* (1,1)
+	*		SW	 |		SE 
+	*			--->
+	*/
+
+	// Calculate heights of the four nodes of the droplet's cell
+	float heightNW = heightMap.at(coordX, coordZ);
+	float heightNE = 0;
+	float heightSW = 0;
+	float heightSE = 0;
+
+	if (coordX < (resolution - 1))
+	{
+		heightNE = heightMap.at(coordX + 1, coordZ);
+	}
+
+	if (coordZ < (resolution - 1))
+	{
+		heightSW = heightMap.at(coordX, coordZ + 1);
+	}
+
+	if (coordX < (resolution - 1) && coordZ < (resolution - 1))
+	{
+		heightSE = heightMap.at(coordX + 1, coordZ + 1);
+	}
+
+	// Calculate droplet's direction of flow with bilinear interpolation of height difference along the edges
+	float gradientX = (heightNE - heightNW) * (1 - zOffset) + (heightSE - heightSW) * zOffset;
+	float gradientZ = (heightSW - heightNW) * (1 - xOffset) + (heightSE - heightNE) * xOffset;
+
+	// Calculate height with bilinear interpolation of the heights of the nodes of the cell
+	float height = heightNW * (1 - xOffset) * (1 - zOffset) + heightNE * xOffset * (1 - zOffset) + heightSW * (1 - xOffset) * zOffset + heightSE * xOffset * zOffset;
+
+	HeightAndGradient heightAndGrad;
+	heightAndGrad.height = height;
+	heightAndGrad.gradientX = gradientX;
+	heightAndGrad.gradientZ = gradientZ;
+
+	return heightAndGrad;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool HydraulicErosion::isOnMap(int x, int z)
+{
+	return x >= 0 && x < resolution && z >= 0 && z < resolution;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const HydraulicErosion::DropletParams& HydraulicErosion::getParams()
+{
+	return params;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HydraulicErosion::setErosionRad(int newRad)
+{
+	params.erosionRadius = newRad;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HydraulicErosion::setInertia(float newInertia)
+{
+	params.inertia = newInertia;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HydraulicErosion::setSedimentCap(float newCapacity)
+{
+	params.sedimentCapacity = newCapacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HydraulicErosion::setErosionSpeed(float newErosionSpeed)
+{
+	params.erodeSpeed = newErosionSpeed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HydraulicErosion::setDepositSpeed(float newDepositSpeed)
+{
+	params.depositSpeed = newDepositSpeed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HydraulicErosion::setEvapSpeed(float newEvapSpeed)
+{
+	params.evaporateSpeed = newEvapSpeed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HydraulicErosion::setGravity(float newGravity)
+{
+	params.gravity = newGravity;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HydraulicErosion::setMaxParticleLifetime(int newLifetime)
+{
+	params.maxDropletLifetime = newLifetime;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,84 @@
+/*
+ * This is the Hydraulic Erosion class it handles:
+ *		- Running droplet (particle) based hydraulic erosion, one droplet at a time, each one picking up sediment
+ *		  as it runs downhill and dropping it again when it slows, goes uphill, or is carrying too much
+ *		- Optionally recording each droplet's flow, erosion and deposition, see ErosionMaps
+ *
+ * The droplets take their random numbers from a generator they're given, and their settings from
+ * a copy, so a run can be split up (see ErosionSession) and still give exactly the same terrain.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <vector>
+#include "HeightMap.h"
+#include "ErosionBrushCache.h"
+#include "ErosionRandom.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Used in the Hydraulic Erosion algorithm
+struct HeightAndGradient
+{
+	float height;
+	float gradientX;
+	float gradientZ;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HydraulicErosion
+{
+public:
+	// Everything that changes what a droplet does, a run takes a copy so moving a slider mid-run can't change its result
+	struct DropletParams
+	{
+		int erosionRadius;
+		float inertia;					// At zero, water will instantly change direction to flow directly downhill. At 1, water will never change direction.
+		float sedimentCapacity;			// Multiplier for how much sediment a droplet can carry
+		float minSedimentCapacity;		// Used to prevent carry capacity getting too close to zero on flatter terrain
+		float erodeSpeed;
+		float depositSpeed;
+		float evaporateSpeed;
+		float gravity;
+		int maxDropletLifetime;			// This ensures we do not get 'immortal' particles roaming around
+	};
+
+	// The brushes can be shared, i.e. by every level of a pyramid, they're looked up by resolution
+	HydraulicErosion(int& res, HeightMap& heightmp, ErosionBrushCache& brushes);
+	~HydraulicErosion();
+
+	// Run one droplet from where it lands until it evaporates or runs off the map
+	// flowCounts/erodedTotals/depositedTotals are indexed the same as the height map, nullptr if not recording
+	void simulateDroplet(ErosionRandom& random, const DropletParams& dropletParams, float* flowCounts, float* erodedTotals, float* depositedTotals);
+	HeightAndGradient calculateHeightAndGradient(float posX, float posZ);
+
+	const DropletParams& getParams();
+	void setErosionRad(int newRad);
+	void setInertia(float newInertia);
+	void setSedimentCap(float newCapacity);
+	void setErosionSpeed(float newErosionSpeed);
+	void setDepositSpeed(float newDepositSpeed);
+	void setEvapSpeed(float newEvapSpeed);
+	void setGravity(float newGravity);
+	void setMaxParticleLifetime(int newLifetime);
+
+private:
+	bool isOnMap(int x, int z);
+	// Adds to a height, and to the deposited totals if they're being recorded
+	void depositAt(int storageIndex, float amount, float* depositedTotals);
+
+	int& resolution;
+	HeightMap& heightMap;
+	ErosionBrushCache& brushCache;
+
+	DropletParams params;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1,6 +1,8 @@
 /*
  * This is the Improved Prelin Noise class it handles:
  *		- Executing the Improved Perlin Noise algorithm
+ *		- Executing it in 2D with the analytic derivatives, for normals without a second pass
+ *		- Executing it in 2D so it repeats after a given number of cells, for terrain tiles that wrap
  *
  *
  * Original @author Abertay University.
@@ -15,18 +17,16 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool ImprovedPerlin::start = true;
-int ImprovedPerlin::p[512];
+double ImprovedPerlin::noise(double x, double y, double z)
+{
+    return noise(x, y, z, DEFAULT_PERMUTATION);
+}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-double ImprovedPerlin::noise(double x, double y, double z)
+double ImprovedPerlin::noise(double x, double y, double z, const PermutationTable& table)
 {
-    if (start)
-    {
-        genPerm();
-        start = false;
-    }
+    const int* p = table.p;
 
     int X = (int)floor(x) & 255,                             // FIND UNIT CUBE THAT CONTAINS POINT.
         Y = (int)floor(y) & 255,
@@ -59,6 +59,104 @@ double ImprovedPerlin::noise(double x, double y, double z)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+double ImprovedPerlin::noise2D(double x, double z, double& dx, double& dz, double* hessian)
+{
+    return noise2D(x, z, dx, dz, DEFAULT_PERMUTATION, hessian);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double ImprovedPerlin::noise2D(double x, double z, double& dx, double& dz, const PermutationTable& table, double* hessian)
+{
+    // With y = 0 the fade in y is 0, so noise() only ever uses the 4 corners of the y = 0 face
+    int X = (int)floor(x) & 255,
+        Z = (int)floor(z) & 255;
+
+    // The permutation is repeated, so X + 1 and Z + 1 never need wrapped
+    return noise2DCorners(x, z, X, X + 1, Z, Z + 1, table.p, dx, dz, hessian);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double ImprovedPerlin::noise2DPeriodic(double x, double z, int period, double& dx, double& dz, const PermutationTable& table, double* hessian)
+{
+    // Only 256 different corners to hash, so that's the longest period there can be
+    period = period < 1 ? 1 : (period > 256 ? 256 : period);
+
+    int X = (int)floor(x) % period,
+        Z = (int)floor(z) % period;
+
+    X = X < 0 ? X + period : X;
+    Z = Z < 0 ? Z + period : Z;
+
+    // The corners on the far side of the period wrap back round to the start, so the noise repeats every period
+    return noise2DCorners(x, z, X, (X + 1) % period, Z, (Z + 1) % period, table.p, dx, dz, hessian);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double ImprovedPerlin::noise2DCorners(double x, double z, int X0, int X1, int Z0, int Z1, const int* p, double& dx, double& dz, double* hessian)
+{
+    x -= floor(x);
+    z -= floor(z);
+
+    double u = fade(x),
+        w = fade(z);
+
+    int A = p[X0],
+        B = p[X1],
+        H00 = p[A + Z0],
+        H10 = p[B + Z0],
+        H01 = p[A + Z1],
+        H11 = p[B + Z1];
+
+    double g00 = grad(H00, x, 0, z),
+        g10 = grad(H10, x - 1, 0, z),
+        g01 = grad(H01, x, 0, z - 1),
+        g11 = grad(H11, x - 1, 0, z - 1);
+
+    // Each corner's gradient function is linear, so its derivatives are just the gradient's x and z
+    double g00x = grad(H00, 1, 0, 0), g00z = grad(H00, 0, 0, 1),
+        g10x = grad(H10, 1, 0, 0), g10z = grad(H10, 0, 0, 1),
+        g01x = grad(H01, 1, 0, 0), g01z = grad(H01, 0, 0, 1),
+        g11x = grad(H11, 1, 0, 0), g11z = grad(H11, 0, 0, 1);
+
+    double a = lerp(u, g00, g10),
+        b = lerp(u, g01, g11);
+
+    double du = fadeDerivative(x),
+        dw = fadeDerivative(z);
+
+    // Product rule through both lerps
+    double dax = du * (g10 - g00) + lerp(u, g00x, g10x),
+        dbx = du * (g11 - g01) + lerp(u, g01x, g11x),
+        daz = lerp(u, g00z, g10z),
+        dbz = lerp(u, g01z, g11z);
+
+    dx = lerp(w, dax, dbx);
+    dz = dw * (b - a) + lerp(w, daz, dbz);
+
+    if (hessian)
+    {
+        double ddu = fadeSecondDerivative(x),
+            ddw = fadeSecondDerivative(z);
+
+        // The gradient functions are linear, so only the fades have second derivatives
+        double daxx = ddu * (g10 - g00) + 2.0 * du * (g10x - g00x),
+            dbxx = ddu * (g11 - g01) + 2.0 * du * (g11x - g01x),
+            daxz = du * (g10z - g00z),
+            dbxz = du * (g11z - g01z);
+
+        hessian[0] = lerp(w, daxx, dbxx);
+        hessian[1] = dw * (dbx - dax) + lerp(w, daxz, dbxz);
+        hessian[2] = ddw * (b - a) + 2.0 * dw * (dbz - daz);
+    }
+
+    return lerp(w, a, b);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 const double ImprovedPerlin::fade(double t)
 {
     // 6t^5 - 15t^4 + 10t^3
@@ -67,6 +165,22 @@ const double ImprovedPerlin::fade(double t)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+const double ImprovedPerlin::fadeDerivative(double t)
+{
+    // 30t^4 - 60t^3 + 30t^2
+    return 30.0 * t * t * (t * (t - 2.0) + 1.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const double ImprovedPerlin::fadeSecondDerivative(double t)
+{
+    // 120t^3 - 180t^2 + 60t
+    return 60.0 * t * (t * (2.0 * t - 3.0) + 1.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 const double ImprovedPerlin::lerp(double t, double a, double b)
 {
     return a + t * (b - a);
@@ -83,14 +197,4 @@ const double ImprovedPerlin::grad(int hash, double x, double y, double z)
     return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-const void ImprovedPerlin::genPerm()
-{
-    for (int i = 0; i < 256; i++)
-    {
-        p[256 + i] = p[i] = permutation[i];
-    }
-}
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -0,0 +1,631 @@
+/*
+ * This is the Inflater class it handles:
+ *		- Decompressing a zlib (or bare deflate) stream, stored, fixed and dynamic Huffman blocks
+ *		- Pulling the compressed bytes in as it needs them, i.e. straight out of a PNG's IDAT chunks
+ *		- Handing the output back a piece at a time, so the whole thing never has to be in memory
+ *
+ * Only the last 32K of output is kept, that's as far back as deflate can ever copy from. The Huffman codes are decoded
+ * with a 9 bit lookup table, the few codes longer than that fall back to walking the code lengths one bit at a time.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "Inflater.h"
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Deflate never looks further back than this
+const size_t WINDOW_SIZE = 32768;
+const size_t WINDOW_MASK = WINDOW_SIZE - 1;
+const size_t INPUT_BUFFER_SIZE = 65536;
+
+// Lengths 3 -> 258 and distances 1 -> 32768, as a base plus however many extra bits follow the symbol
+const unsigned short LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const unsigned char LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const unsigned short DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const unsigned char DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// The order a dynamic block lists the code length code lengths in
+const unsigned char CODE_LENGTH_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+Inflater::Inflater(const Input& in, bool zlibHeader) : input(in)
+{
+	// Default values
+	inBuffer.resize(INPUT_BUFFER_SIZE);
+	inPosition = 0;
+	inSize = 0;
+	bitBuffer = 0;
+	bitCount = 0;
+
+	window.resize(WINDOW_SIZE);
+	windowPosition = 0;
+	totalOut = 0;
+	adlerLow = 1;
+	adlerHigh = 0;
+
+	expectZlibHeader = zlibHeader;
+	zlibStream = zlibHeader;
+	adlerChecked = false;
+	lastBlock = false;
+	blockType = NO_BLOCK;
+	storedLeft = 0;
+	copyLength = 0;
+	copyDistance = 0;
+	finished = false;
+	failed = false;
+}
+
+Inflater::~Inflater()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+size_t Inflater::read(unsigned char* out, size_t size)
+{
+	if (expectZlibHeader)
+	{
+		expectZlibHeader = false;
+		failed = !readZlibHeader();
+	}
+
+	size_t written = 0;
+
+	while (written < size && !finished && !failed)
+	{
+		// Part way through copying a match from earlier output
+		if (copyLength > 0)
+		{
+			size_t count = (size_t)copyLength < size - written ? (size_t)copyLength : size - written;
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				unsigned char byte = window[(windowPosition - copyDistance) & WINDOW_MASK];
+				window[windowPosition++ & WINDOW_MASK] = byte;
+				out[written++] = byte;
+			}
+
+			copyLength -= (int)count;
+			totalOut += count;
+			continue;
+		}
+
+		if (blockType == NO_BLOCK)
+		{
+			if (lastBlock)
+			{
+				finished = true;
+				break;
+			}
+
+			failed = !startBlock();
+			continue;
+		}
+
+		if (blockType == STORED_BLOCK)
+		{
+			if (storedLeft == 0)
+			{
+				blockType = NO_BLOCK;
+				continue;
+			}
+
+			size_t count;
+
+			// Anything already pulled into the bit buffer comes first, it's always whole bytes by now
+			if (bitCount >= 8)
+			{
+				out[written] = (unsigned char)(bitBuffer & 0xFF);
+				bitBuffer >>= 8;
+				bitCount -= 8;
+				count = 1;
+			}
+			else
+			{
+				if (inPosition == inSize && !refillInput())
+				{
+					failed = true;
+					break;
+				}
+
+				count = inSize - inPosition;
+				count = count < storedLeft ? count : storedLeft;
+				count = count < size - written ? count : size - written;
+				memcpy(&out[written], &inBuffer[inPosition], count);
+				inPosition += count;
+			}
+
+			keep(&out[written], count);
+			written += count;
+			storedLeft -= count;
+			totalOut += count;
+			continue;
+		}
+
+		int symbol = decodeSymbol(literals);
+
+		if (symbol < 0)
+		{
+			failed = true;
+		}
+		else if (symbol < 256)
+		{
+			window[windowPosition++ & WINDOW_MASK] = (unsigned char)symbol;
+			out[written++] = (unsigned char)symbol;
+			++totalOut;
+		}
+		else if (symbol == 256)
+		{
+			blockType = NO_BLOCK;
+		}
+		else
+		{
+			symbol -= 257;
+
+			if (symbol >= 29 || !needBits(LENGTH_EXTRA[symbol]))
+			{
+				failed = true;
+				break;
+			}
+
+			copyLength = LENGTH_BASE[symbol] + getBits(LENGTH_EXTRA[symbol]);
+
+			symbol = decodeSymbol(distances);
+
+			if (symbol < 0 || symbol >= 30 || !needBits(DISTANCE_EXTRA[symbol]))
+			{
+				failed = true;
+				break;
+			}
+
+			copyDistance = DISTANCE_BASE[symbol] + getBits(DISTANCE_EXTRA[symbol]);
+
+			// Can't copy from before the start
+			if ((size_t)copyDistance > totalOut)
+			{
+				failed = true;
+			}
+		}
+	}
+
+	if (zlibStream)
+	{
+		updateAdler(out, written);
+
+		// The Adler-32 of everything inflated follows the last block, big endian
+		if (finished && !failed && !adlerChecked)
+		{
+			adlerChecked = true;
+			getBits(bitCount & 7);
+
+			unsigned int expected = 0;
+
+			for (int b = 0; b < 4 && !failed; ++b)
+			{
+				failed = !needBits(8);
+				expected = (expected << 8) | getBits(8);
+			}
+
+			failed = failed || expected != ((adlerHigh << 16) | adlerLow);
+		}
+	}
+
+	return written;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Inflater::isFinished() const
+{
+	return finished;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Inflater::hasFailed() const
+{
+	return failed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Inflater::readZlibHeader()
+{
+	if (!needBits(16))
+	{
+		return false;
+	}
+
+	unsigned int method = getBits(8);
+	unsigned int flags = getBits(8);
+
+	// Deflate with a window no bigger than 32K, the check bits right, and no preset dictionary
+	return (method & 0x0F) == 8 && (method >> 4) <= 7 && ((method << 8) | flags) % 31 == 0 && !(flags & 0x20);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Inflater::startBlock()
+{
+	if (!needBits(3))
+	{
+		return false;
+	}
+
+	lastBlock = getBits(1) == 1;
+	unsigned int type = getBits(2);
+
+	if (type == 0)
+	{
+		// Stored, the length starts on the next byte
+		getBits(bitCount & 7);
+
+		if (!needBits(32))
+		{
+			return false;
+		}
+
+		unsigned int length = getBits(16);
+		unsigned int check = getBits(16);
+
+		if ((length ^ 0xFFFF) != check)
+		{
+			return false;
+		}
+
+		storedLeft = length;
+		blockType = STORED_BLOCK;
+		return true;
+	}
+
+	if (type == 1)
+	{
+		// The fixed codes from the deflate spec
+		unsigned char lengths[288 + 30];
+		memset(lengths, 8, 144);
+		memset(lengths + 144, 9, 112);
+		memset(lengths + 256, 7, 24);
+		memset(lengths + 280, 8, 8);
+		memset(lengths + 288, 5, 30);
+
+		if (!buildHuffman(literals, lengths, 288) || !buildHuffman(distances, lengths + 288, 30))
+		{
+			return false;
+		}
+
+		blockType = HUFFMAN_BLOCK;
+		return true;
+	}
+
+	if (type == 2 && readDynamicTables())
+	{
+		blockType = HUFFMAN_BLOCK;
+		return true;
+	}
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Inflater::readDynamicTables()
+{
+	if (!needBits(14))
+	{
+		return false;
+	}
+
+	int literalCount = getBits(5) + 257;
+	int distanceCount = getBits(5) + 1;
+	int codeLengthCount = getBits(4) + 4;
+
+	if (literalCount > 286 || distanceCount > 30)
+	{
+		return false;
+	}
+
+	unsigned char codeLengthLengths[19] = {};
+
+	for (int i = 0; i < codeLengthCount; ++i)
+	{
+		if (!needBits(3))
+		{
+			return false;
+		}
+
+		codeLengthLengths[CODE_LENGTH_ORDER[i]] = (unsigned char)getBits(3);
+	}
+
+	Huffman codeLengths;
+
+	if (!buildHuffman(codeLengths, codeLengthLengths, 19))
+	{
+		return false;
+	}
+
+	// The literal and distance code lengths run on from one to the other, repeats can cross between them
+	unsigned char lengths[286 + 30];
+	int count = 0;
+
+	while (count < literalCount + distanceCount)
+	{
+		int symbol = decodeSymbol(codeLengths);
+
+		if (symbol < 0)
+		{
+			return false;
+		}
+
+		if (symbol < 16)
+		{
+			lengths[count++] = (unsigned char)symbol;
+			continue;
+		}
+
+		unsigned char repeated = 0;
+		int repeats;
+
+		if (symbol == 16)
+		{
+			if (count == 0 || !needBits(2))
+			{
+				return false;
+			}
+
+			repeated = lengths[count - 1];
+			repeats = 3 + getBits(2);
+		}
+		else if (symbol == 17)
+		{
+			if (!needBits(3))
+			{
+				return false;
+			}
+
+			repeats = 3 + getBits(3);
+		}
+		else
+		{
+			if (!needBits(7))
+			{
+				return false;
+			}
+
+			repeats = 11 + getBits(7);
+		}
+
+		if (count + repeats > literalCount + distanceCount)
+		{
+			return false;
+		}
+
+		memset(lengths + count, repeated, repeats);
+		count += repeats;
+	}
+
+	// There has to be a way to end the block
+	if (lengths[256] == 0)
+	{
+		return false;
+	}
+
+	return buildHuffman(literals, lengths, literalCount) && buildHuffman(distances, lengths + literalCount, distanceCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Inflater::buildHuffman(Huffman& huffman, const unsigned char* lengths, int count)
+{
+	memset(huffman.counts, 0, sizeof(huffman.counts));
+	memset(huffman.fast, 0, sizeof(huffman.fast));
+
+	for (int symbol = 0; symbol < count; ++symbol)
+	{
+		++huffman.counts[lengths[symbol]];
+	}
+
+	huffman.counts[0] = 0;
+
+	// More codes of a length than there's room for can't be decoded, too few is allowed (i.e. a single distance code)
+	int left = 1;
+	unsigned short offsets[MAX_BITS + 2];
+	offsets[1] = 0;
+
+	for (int length = 1; length <= MAX_BITS; ++length)
+	{
+		left = (left << 1) - huffman.counts[length];
+
+		if (left < 0)
+		{
+			return false;
+		}
+
+		offsets[length + 1] = offsets[length] + huffman.counts[length];
+	}
+
+	// Canonical codes, each length's codes follow on from the last length's, in symbol order
+	int code = 0;
+	int nextCode[MAX_BITS + 1];
+
+	for (int length = 1; length <= MAX_BITS; ++length)
+	{
+		nextCode[length] = code;
+		code = (code + huffman.counts[length]) << 1;
+	}
+
+	for (int symbol = 0; symbol < count; ++symbol)
+	{
+		int length = lengths[symbol];
+
+		if (length == 0)
+		{
+			continue;
+		}
+
+		huffman.symbols[offsets[length]++] = (unsigned short)symbol;
+
+		if (length > FAST_BITS)
+		{
+			continue;
+		}
+
+		// Codes are sent first bit first, so the table is indexed by them backwards
+		int reversed = 0;
+
+		for (int bit = 0, value = nextCode[length]; bit < length; ++bit, value >>= 1)
+		{
+			reversed = (reversed << 1) | (value & 1);
+		}
+
+		for (int entry = reversed; entry < (1 << FAST_BITS); entry += 1 << length)
+		{
+			huffman.fast[entry] = (unsigned short)((symbol << 4) | length);
+		}
+
+		++nextCode[length];
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int Inflater::decodeSymbol(const Huffman& huffman)
+{
+	fillBits();
+
+	unsigned short entry = huffman.fast[bitBuffer & ((1 << FAST_BITS) - 1)];
+
+	if (entry != 0 && (entry & 15) <= bitCount)
+	{
+		getBits(entry & 15);
+		return entry >> 4;
+	}
+
+	// A longer code, a bit at a time, counting through the codes of each length
+	int code = 0;
+	int first = 0;
+	int index = 0;
+
+	for (int length = 1; length <= MAX_BITS && length <= bitCount; ++length)
+	{
+		code |= (int)((bitBuffer >> (length - 1)) & 1);
+		int count = huffman.counts[length];
+
+		if (code - first < count)
+		{
+			getBits(length);
+			return huffman.symbols[index + code - first];
+		}
+
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+
+	return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Inflater::keep(const unsigned char* data, size_t size)
+{
+	// Only the last 32K can matter
+	if (size > WINDOW_SIZE)
+	{
+		windowPosition += size - WINDOW_SIZE;
+		data += size - WINDOW_SIZE;
+		size = WINDOW_SIZE;
+	}
+
+	size_t start = windowPosition & WINDOW_MASK;
+	size_t first = WINDOW_SIZE - start < size ? WINDOW_SIZE - start : size;
+
+	memcpy(&window[start], data, first);
+	memcpy(&window[0], data + first, size - first);
+	windowPosition += size;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Inflater::updateAdler(const unsigned char* data, size_t size)
+{
+	while (size > 0)
+	{
+		// The most that can be summed before the high half could overflow
+		size_t count = size < 5552 ? size : 5552;
+		size -= count;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			adlerLow += data[i];
+			adlerHigh += adlerLow;
+		}
+
+		data += count;
+		adlerLow %= 65521;
+		adlerHigh %= 65521;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Inflater::refillInput()
+{
+	inPosition = 0;
+	inSize = input(inBuffer.data(), inBuffer.size());
+
+	return inSize > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Inflater::fillBits()
+{
+	while (bitCount <= 56)
+	{
+		if (inPosition == inSize && !refillInput())
+		{
+			return;
+		}
+
+		bitBuffer |= (unsigned long long)inBuffer[inPosition++] << bitCount;
+		bitCount += 8;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Inflater::needBits(int count)
+{
+	if (bitCount < count)
+	{
+		fillBits();
+	}
+
+	return bitCount >= count;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int Inflater::getBits(int count)
+{
+	unsigned int value = (unsigned int)(bitBuffer & ((1ull << count) - 1));
+	bitBuffer >>= count;
+	bitCount -= count;
+
+	return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,102 @@
+/*
+ * This is the Inflater class it handles:
+ *		- Decompressing a zlib (or bare deflate) stream, stored, fixed and dynamic Huffman blocks
+ *		- Pulling the compressed bytes in as it needs them, i.e. straight out of a PNG's IDAT chunks
+ *		- Handing the output back a piece at a time, so the whole thing never has to be in memory
+ *
+ * Only the last 32K of output is kept, that's as far back as deflate can ever copy from. The Huffman codes are decoded
+ * with a 9 bit lookup table, the few codes longer than that fall back to walking the code lengths one bit at a time.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <functional>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class Inflater
+{
+public:
+	// Writes up to size compressed bytes into buffer, returns how many, 0 once there are no more
+	typedef std::function<size_t(unsigned char* buffer, size_t size)> Input;
+
+	Inflater(const Input& in, bool zlibHeader = true);
+	~Inflater();
+
+	// Inflates up to size bytes into out, returns how many, fewer only at the end of the stream or if it's broken
+	size_t read(unsigned char* out, size_t size);
+
+	bool isFinished() const;
+	bool hasFailed() const;
+
+private:
+	static const int FAST_BITS = 9;
+	static const int MAX_BITS = 15;
+
+	struct Huffman
+	{
+		// Symbol << 4 | code length, 0 if the code is longer than FAST_BITS
+		unsigned short fast[1 << FAST_BITS];
+		// How many codes there are of each length, and the symbols in code order
+		unsigned short counts[MAX_BITS + 1];
+		unsigned short symbols[288];
+	};
+
+	bool readZlibHeader();
+	bool startBlock();
+	bool buildHuffman(Huffman& huffman, const unsigned char* lengths, int count);
+	bool readDynamicTables();
+	int decodeSymbol(const Huffman& huffman);
+	// Stored bytes go into the window in one go
+	void keep(const unsigned char* data, size_t size);
+	void updateAdler(const unsigned char* data, size_t size);
+
+	// Bits come out of the stream lowest first
+	bool refillInput();
+	void fillBits();
+	bool needBits(int count);
+	unsigned int getBits(int count);
+
+	Input input;
+	std::vector<unsigned char> inBuffer;
+	size_t inPosition;
+	size_t inSize;
+	unsigned long long bitBuffer;
+	int bitCount;
+
+	std::vector<unsigned char> window;
+	size_t windowPosition;
+	size_t totalOut;
+	unsigned int adlerLow;
+	unsigned int adlerHigh;
+
+	enum BlockType
+	{
+		NO_BLOCK = 0,
+		STORED_BLOCK,
+		HUFFMAN_BLOCK
+	};
+
+	bool expectZlibHeader;
+	bool zlibStream;
+	bool adlerChecked;
+	bool lastBlock;
+	BlockType blockType;
+	size_t storedLeft;
+	int copyLength;
+	int copyDistance;
+	bool finished;
+	bool failed;
+
+	Huffman literals;
+	Huffman distances;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
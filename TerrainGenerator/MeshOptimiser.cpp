@@ -0,0 +1,321 @@
+/*
+ * This is the Mesh Optimiser class it handles:
+ *		- Reordering triangle lists for the post-transform vertex cache (Forsyth's linear speed algorithm)
+ *		- Simulating a FIFO vertex cache to measure the ACMR and ATVR of a triangle list
+ *
+ * The measurements don't need a GPU, so the vertex shader work saved can be checked on any machine.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "MeshOptimiser.h"
+#include <unordered_map>
+#include <vector>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The size of the LRU cache modelled while optimising, this doesn't need to match the hardware exactly
+const int OPTIMISER_CACHE_SIZE = 32;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void MeshOptimiser::optimiseVertexCache(unsigned long* indices, int indexCount)
+{
+	// Ref:
+	// Forsyth, T. (2006) Linear-Speed Vertex Cache Optimisation
+	// https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+
+	/*
+	* Greedily emit the triangle with the highest score, where a triangle's score is the sum of its vertices' scores.
+	* A vertex scores highly if it's near the front of the (modelled) cache, and if it has few triangles left to use it,
+	* so lone triangles get finished off rather than left behind to cost a transform later.
+	* Only the vertices in the cache change score after a triangle is emitted, so the next best triangle
+	* is always one that uses a vertex in the cache, or there is none and the next unused triangle is picked.
+	*/
+
+	int triangleCount = indexCount / 3;
+
+	if (triangleCount < 2)
+	{
+		return;
+	}
+
+	// The indices can point anywhere in a large vertex buffer, so map them to a compact local range first
+	std::unordered_map<unsigned long, int> localIDs;
+	std::vector<int> localIndices(indexCount);
+	std::vector<unsigned long> globalIDs;
+
+	for (int i = 0; i < indexCount; ++i)
+	{
+		auto found = localIDs.find(indices[i]);
+
+		if (found == localIDs.end())
+		{
+			found = localIDs.emplace(indices[i], (int)globalIDs.size()).first;
+			globalIDs.push_back(indices[i]);
+		}
+
+		localIndices[i] = found->second;
+	}
+
+	int vertexCount = (int)globalIDs.size();
+
+	// Per vertex list of the triangles using it, the first 'remaining' entries are the ones not yet emitted
+	std::vector<int> remaining(vertexCount, 0);
+	std::vector<int> triangleOffset(vertexCount + 1, 0);
+
+	for (int i = 0; i < indexCount; ++i)
+	{
+		++remaining[localIndices[i]];
+	}
+
+	for (int v = 0; v < vertexCount; ++v)
+	{
+		triangleOffset[v + 1] = triangleOffset[v] + remaining[v];
+	}
+
+	std::vector<int> vertexTriangles(indexCount);
+	std::vector<int> fill(triangleOffset.begin(), triangleOffset.end() - 1);
+
+	for (int i = 0; i < indexCount; ++i)
+	{
+		vertexTriangles[fill[localIndices[i]]++] = i / 3;
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	std::vector<float> triangleScores(triangleCount, 0.0f);
+	std::vector<bool> emitted(triangleCount, false);
+
+	for (int v = 0; v < vertexCount; ++v)
+	{
+		vertexScores[v] = vertexScore(-1, remaining[v]);
+	}
+
+	int bestTriangle = 0;
+
+	for (int t = 0; t < triangleCount; ++t)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			triangleScores[t] += vertexScores[localIndices[t * 3 + k]];
+		}
+
+		if (triangleScores[t] > triangleScores[bestTriangle])
+		{
+			bestTriangle = t;
+		}
+	}
+
+	// The cache can briefly hold 3 extra vertices while a triangle is being added
+	int cache[OPTIMISER_CACHE_SIZE + 3];
+	int cacheCount = 0;
+	int newCache[OPTIMISER_CACHE_SIZE + 3];
+	int nextUnemitted = 0;
+
+	std::vector<unsigned long> optimised;
+	optimised.reserve(indexCount);
+
+	for (int emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+	{
+		// Nothing in the cache has any triangles left, so move on to the next triangle in the original order
+		if (bestTriangle < 0)
+		{
+			while (emitted[nextUnemitted])
+			{
+				++nextUnemitted;
+			}
+
+			bestTriangle = nextUnemitted;
+		}
+
+		emitted[bestTriangle] = true;
+
+		int newCacheCount = 0;
+
+		for (int k = 0; k < 3; ++k)
+		{
+			int v = localIndices[bestTriangle * 3 + k];
+			optimised.push_back(globalIDs[v]);
+
+			// Remove the triangle from the vertex's remaining list
+			int* triangles = &vertexTriangles[triangleOffset[v]];
+
+			for (int r = 0; r < remaining[v]; ++r)
+			{
+				if (triangles[r] == bestTriangle)
+				{
+					triangles[r] = triangles[remaining[v] - 1];
+					break;
+				}
+			}
+
+			--remaining[v];
+
+			// The triangle's vertices move to the front of the cache
+			newCache[newCacheCount++] = v;
+		}
+
+		// Then the rest of the old cache, in order, without the vertices just added
+		for (int c = 0; c < cacheCount; ++c)
+		{
+			int v = cache[c];
+
+			if (v != newCache[0] && v != newCache[1] && v != newCache[2])
+			{
+				newCache[newCacheCount++] = v;
+			}
+		}
+
+		// Re-score everything in the cache, the vertices that have fallen out go back to having no cache bonus
+		for (int c = 0; c < newCacheCount; ++c)
+		{
+			int v = newCache[c];
+			cachePosition[v] = (c < OPTIMISER_CACHE_SIZE) ? c : -1;
+
+			float newScore = vertexScore(cachePosition[v], remaining[v]);
+			float scoreChange = newScore - vertexScores[v];
+			vertexScores[v] = newScore;
+
+			for (int r = 0; r < remaining[v]; ++r)
+			{
+				triangleScores[vertexTriangles[triangleOffset[v] + r]] += scoreChange;
+			}
+		}
+
+		cacheCount = (newCacheCount < OPTIMISER_CACHE_SIZE) ? newCacheCount : OPTIMISER_CACHE_SIZE;
+
+		for (int c = 0; c < cacheCount; ++c)
+		{
+			cache[c] = newCache[c];
+		}
+
+		// The next triangle is the best one using a vertex in the cache
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+
+		for (int c = 0; c < cacheCount; ++c)
+		{
+			int v = cache[c];
+
+			for (int r = 0; r < remaining[v]; ++r)
+			{
+				int t = vertexTriangles[triangleOffset[v] + r];
+
+				if (triangleScores[t] > bestScore)
+				{
+					bestScore = triangleScores[t];
+					bestTriangle = t;
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < indexCount; ++i)
+	{
+		indices[i] = optimised[i];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float MeshOptimiser::vertexScore(int cachePosition, int remainingTriangles)
+{
+	// The tuned values from the paper
+	const float cacheDecayPower = 1.5f;
+	const float lastTriangleScore = 0.75f;
+	const float valenceBoostScale = 2.0f;
+	const float valenceBoostPower = 0.5f;
+
+	// Not used by anything else, so it doesn't matter where this is emitted
+	if (remainingTriangles == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+		{
+			// Used by the triangle just emitted, deliberately less than the next few so the strip doesn't just go back on itself
+			score = lastTriangleScore;
+		}
+		else
+		{
+			float scaler = 1.0f / (OPTIMISER_CACHE_SIZE - 3);
+			score = powf(1.0f - (cachePosition - 3) * scaler, cacheDecayPower);
+		}
+	}
+
+	score += valenceBoostScale * powf((float)remainingTriangles, -valenceBoostPower);
+
+	return score;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VertexCacheStats MeshOptimiser::analyseVertexCache(const unsigned long* indices, int indexCount, int cacheSize)
+{
+	/*
+	* Simulate a FIFO post-transform cache, like the ones on most GPUs.
+	* Each vertex keeps the 'time' it was last transformed, it's still in the cache if fewer than cacheSize
+	* vertices have been transformed since then, so no cache array needs to be shuffled.
+	*/
+
+	VertexCacheStats stats;
+	stats.triangles = indexCount / 3;
+	stats.uniqueVertices = 0;
+	stats.transformedVertices = 0;
+	stats.acmr = 0.0f;
+	stats.atvr = 0.0f;
+
+	std::unordered_map<unsigned long, int> transformedAt;
+
+	for (int i = 0; i < stats.triangles * 3; ++i)
+	{
+		auto found = transformedAt.find(indices[i]);
+
+		if (found == transformedAt.end())
+		{
+			++stats.uniqueVertices;
+			transformedAt.emplace(indices[i], stats.transformedVertices);
+			++stats.transformedVertices;
+		}
+		else if (stats.transformedVertices - found->second >= cacheSize)
+		{
+			found->second = stats.transformedVertices;
+			++stats.transformedVertices;
+		}
+	}
+
+	if (stats.triangles > 0)
+	{
+		stats.acmr = (float)stats.transformedVertices / (float)stats.triangles;
+		stats.atvr = (float)stats.transformedVertices / (float)stats.uniqueVertices;
+	}
+
+	return stats;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void MeshOptimiser::accumulateStats(VertexCacheStats& total, const VertexCacheStats& stats)
+{
+	total.triangles += stats.triangles;
+	total.uniqueVertices += stats.uniqueVertices;
+	total.transformedVertices += stats.transformedVertices;
+
+	total.acmr = (total.triangles > 0) ? (float)total.transformedVertices / (float)total.triangles : 0.0f;
+	total.atvr = (total.uniqueVertices > 0) ? (float)total.transformedVertices / (float)total.uniqueVertices : 0.0f;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
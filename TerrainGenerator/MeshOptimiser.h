@@ -0,0 +1,49 @@
+/*
+ * This is the Mesh Optimiser class it handles:
+ *		- Reordering triangle lists for the post-transform vertex cache (Forsyth's linear speed algorithm)
+ *		- Simulating a FIFO vertex cache to measure the ACMR and ATVR of a triangle list
+ *
+ * The measurements don't need a GPU, so the vertex shader work saved can be checked on any machine.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct VertexCacheStats
+{
+	int triangles;
+	int uniqueVertices;
+	int transformedVertices;	// Cache misses
+	float acmr;					// Average cache miss ratio, vertices transformed per triangle (0.5 is ideal for a grid)
+	float atvr;					// Average transform to vertex ratio, vertices transformed per unique vertex (1.0 is ideal)
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class MeshOptimiser
+{
+public:
+	// Reorder the triangles in place, the triangles themselves and their winding are untouched
+	static void optimiseVertexCache(unsigned long* indices, int indexCount);
+
+	static VertexCacheStats analyseVertexCache(const unsigned long* indices, int indexCount, int cacheSize = 16);
+	// Add the counts of 'stats' into 'total' and update the ratios
+	static void accumulateStats(VertexCacheStats& total, const VertexCacheStats& stats);
+
+private:
+	// Private constructors/destructors, i.e. you cannot create and instance of this class
+	MeshOptimiser() {};
+	~MeshOptimiser() {};
+
+	static float vertexScore(int cachePosition, int remainingTriangles);
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,186 @@
+/*
+ * This is the Noise Tables class it handles:
+ *		- Building the permutation table used by the Improved Perlin and Simplex noise
+ *		- Building the permutation and gradient tables used by the Old (Classic) Perlin noise
+ *		- Doing either at compile time (constexpr) for the default tables, or at runtime for any other seed
+ *
+ * The tables are plain values that are only ever read once built, so the noise functions that use them
+ * need no lazy initialisation and can be called from as many threads as needed.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Ken Perlin's reference permutation, seed 0 uses this so the Improved Perlin noise matches the reference implementation
+constexpr int permutation[256] = { 151,160,137,91,90,15,
+131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
+190,6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,
+88,237,149,56,87,174,20,125,136,171,168,68,175,74,165,71,134,139,48,27,166,
+77,146,158,231,83,111,229,122,60,211,133,230,220,105,92,41,55,46,245,40,244,
+102,143,54,65,25,63,161,1,216,80,73,209,76,132,187,208,89,18,169,200,196,
+135,130,116,188,159,86,164,100,109,198,173,186,3,64,52,217,226,250,124,123,
+5,202,38,147,118,126,255,82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,
+223,183,170,213,119,248,152,2,44,154,163,70,221,153,101,155,167,43,172,9,
+129,22,39,253,19,98,108,110,79,113,224,232,178,185,112,104,218,246,97,228,
+251,34,242,193,238,210,144,12,191,179,162,241,81,51,145,235,249,14,239,107,
+49,192,214,31,181,199,106,157,184,84,204,176,115,121,50,45,127,4,150,254,
+138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180
+};
+
+// The Old Perlin tables hold 256 entries, repeated, plus 2 so a cell's + 1 neighbour never needs wrapped
+const int CLASSIC_TABLE_SIZE = 256 + 256 + 2;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// For Improved Perlin and Simplex noise, the 256 entry permutation repeated so p[i + 1] never needs wrapped
+struct PermutationTable
+{
+	int p[512];
+};
+
+// For Old Perlin noise
+struct ClassicNoiseTables
+{
+	int perm[CLASSIC_TABLE_SIZE];
+	float grad1D[CLASSIC_TABLE_SIZE];
+	float grad2D[CLASSIC_TABLE_SIZE][2];
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class NoiseTables
+{
+public:
+	// Seed 0 gives Ken Perlin's permutation, any other seed a shuffle of 0 -> 255
+	static constexpr PermutationTable makePermutation(unsigned int seed)
+	{
+		PermutationTable table{};
+		int shuffled[256]{};
+
+		for (int i = 0; i < 256; ++i)
+		{
+			shuffled[i] = (seed == 0) ? permutation[i] : i;
+		}
+
+		if (seed != 0)
+		{
+			unsigned int state = seed;
+
+			// Fisher-Yates shuffle
+			for (int i = 255; i > 0; --i)
+			{
+				int j = (int)(nextRandom(state) % (unsigned int)(i + 1));
+				int swap = shuffled[i];
+				shuffled[i] = shuffled[j];
+				shuffled[j] = swap;
+			}
+		}
+
+		for (int i = 0; i < 256; ++i)
+		{
+			table.p[i] = shuffled[i];
+			table.p[256 + i] = shuffled[i];
+		}
+
+		return table;
+	}
+
+	// The same steps as the original rand() based init(), with a seeded generator in place of rand()
+	static constexpr ClassicNoiseTables makeClassicTables(unsigned int seed)
+	{
+		ClassicNoiseTables tables{};
+		unsigned int state = seed;
+		int i = 0;
+
+		for (i = 0; i < 256; ++i)
+		{
+			tables.perm[i] = i;
+			tables.grad1D[i] = (float)((int)(nextRandom(state) % 512u) - 256) / 256.0f;
+
+			float gradX = (float)((int)(nextRandom(state) % 512u) - 256) / 256.0f;
+			float gradZ = (float)((int)(nextRandom(state) % 512u) - 256) / 256.0f;
+			float length = squareRoot(gradX * gradX + gradZ * gradZ);
+
+			// Can't normalise a zero length gradient, so just point it along x
+			tables.grad2D[i][0] = (length > 0.0f) ? gradX / length : 1.0f;
+			tables.grad2D[i][1] = (length > 0.0f) ? gradZ / length : 0.0f;
+		}
+
+		while (--i)
+		{
+			int j = (int)(nextRandom(state) % 256u);
+			int swap = tables.perm[i];
+			tables.perm[i] = tables.perm[j];
+			tables.perm[j] = swap;
+		}
+
+		for (i = 0; i < 256 + 2; ++i)
+		{
+			tables.perm[256 + i] = tables.perm[i];
+			tables.grad1D[256 + i] = tables.grad1D[i];
+			tables.grad2D[256 + i][0] = tables.grad2D[i][0];
+			tables.grad2D[256 + i][1] = tables.grad2D[i][1];
+		}
+
+		return tables;
+	}
+
+private:
+	// A small LCG with the output scrambled, plenty for shuffling 256 numbers
+	static constexpr unsigned int nextRandom(unsigned int& state)
+	{
+		state = state * 1664525u + 1013904223u;
+
+		unsigned int result = state;
+		result ^= result >> 16;
+		result *= 0x7feb352du;
+		result ^= result >> 15;
+
+		return result;
+	}
+
+	// sqrtf() isn't constexpr, so Newton's method, which has settled well within 16 steps for the lengths used here (0 -> 2)
+	static constexpr float squareRoot(float value)
+	{
+		if (value <= 0.0f)
+		{
+			return 0.0f;
+		}
+
+		float root = 1.0f;
+
+		for (int i = 0; i < 16; ++i)
+		{
+			float next = 0.5f * (root + value / root);
+
+			if (next == root)
+			{
+				break;
+			}
+
+			root = next;
+		}
+
+		return root;
+	}
+
+	// Private constructors/destructors, i.e. you cannot create and instance of this class
+	NoiseTables() {};
+	~NoiseTables() {};
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The tables every noise function uses unless it's given others, built by the compiler
+constexpr PermutationTable DEFAULT_PERMUTATION = NoiseTables::makePermutation(0);
+constexpr ClassicNoiseTables DEFAULT_CLASSIC_TABLES = NoiseTables::makeClassicTables(0);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
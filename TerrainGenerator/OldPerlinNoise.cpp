@@ -1,6 +1,7 @@
 /*
  * This is the Original(Classic) Prelin Noise class it handles:
  *		- Executing the Original Perlin Noise algorithm
+ *		- Executing it so it repeats after a given number of cells, for terrain tiles that wrap
  *
  *
  * Original @author Abertay University.
@@ -15,15 +16,24 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool OldPerlinNoise::start = true;
-int	OldPerlinNoise::perm[B + B + 2];
-float OldPerlinNoise::grad1D[B + B + 2];
-float OldPerlinNoise::grad2D[B + B + 2][2];
+double OldPerlinNoise::noise1D(double arg)
+{
+	return noise1D(arg, DEFAULT_CLASSIC_TABLES);
+}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-double OldPerlinNoise::noise1D(double arg)
+double OldPerlinNoise::noise2D(float vec[2])
 {
+	return noise2D(vec, DEFAULT_CLASSIC_TABLES);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double OldPerlinNoise::noise1D(double arg, const ClassicNoiseTables& tables)
+{
+	const int* perm = tables.perm;
+	const float* grad1D = tables.grad1D;
 
 	//The integer left and right boundaries of the arg
 	int bx0 = 0, bx1 = 0;
@@ -36,11 +46,6 @@ double OldPerlinNoise::noise1D(double arg)
 
 	float u = 0.f, v = 0.f, vec[1]{ arg };
 
-	if (start) {
-		start = false;
-		init();
-	}
-
 	//Initialise all our variables
 	setup(vec, 0, bx0, bx1, rx0, rx1);
 
@@ -58,8 +63,17 @@ double OldPerlinNoise::noise1D(double arg)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-double OldPerlinNoise::noise2D(float vec[2])
+double OldPerlinNoise::noise2D(float vec[2], const ClassicNoiseTables& tables)
+{
+	return noise2DPeriodic(vec, B, tables);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double OldPerlinNoise::noise2DPeriodic(float vec[2], int period, const ClassicNoiseTables& tables)
 {
+	const int* perm = tables.perm;
+
 	//The integer left & right x values and the bottom & top y values. These define what "cell" we are in
 	int bx0 = 0, bx1 = 0, by0 = 0, by1 = 0;
 
@@ -73,19 +87,16 @@ double OldPerlinNoise::noise2D(float vec[2])
 	float sx = 0.f, sy = 0.f;
 
 	//Some variables used to store values during calculations
-	float* q, a = 0.f, b = 0.f, u = 0.f, v = 0.f;
+	const float* q;
+	float a = 0.f, b = 0.f, u = 0.f, v = 0.f;
 	int i, j;
 
-	//If we've not done this already, build the permutation and gradient lookup tables
-	if (start)
-	{
-		start = 0;
-		init();
-	}
-
 	//Initialise all our variables on the X & Y
-	setup(vec, 0, bx0, bx1, rx0, rx1);
-	setup(vec, 1, by0, by1, ry0, ry1);
+	//Only B different corners to hash, so that's the longest period there can be
+	period = period < 1 ? 1 : (period > B ? B : period);
+
+	setup(vec, 0, bx0, bx1, rx0, rx1, period);
+	setup(vec, 1, by0, by1, ry0, ry1, period);
 
 	//Get a pseudo-random number for the x boundaries
 	i = perm[bx0];
@@ -103,16 +114,16 @@ double OldPerlinNoise::noise2D(float vec[2])
 
 	//q is set to the pseudo-random gradient
 	//Solve for the bottom two points
-	q = grad2D[b00];
+	q = tables.grad2D[b00];
 	u = dotProduct(rx0, ry0, q[0], q[1]);	//U is the weighting of the gradient based on the distance of the point from this corner (0,0)
-	q = grad2D[b10];
+	q = tables.grad2D[b10];
 	v = dotProduct(rx1, ry0, q[0], q[1]);	//V is the weighting of the gradient based on the distance of the point from this corner (1,0)
 	a = lerp(sx, u, v);						//a is the the value of U and V blended together using the horizontal easing curve
 
 	//Solve for the top two points
-	q = grad2D[b01];
+	q = tables.grad2D[b01];
 	u = dotProduct(rx0, ry1, q[0], q[1]);	//U is the weighting of the gradient based on the distance of the point from this corner (0,1)
-	q = grad2D[b11];
+	q = tables.grad2D[b11];
 	v = dotProduct(rx1, ry1, q[0], q[1]);	//V is the weighting of the gradient based on the distance of the point from this corner (1,1)
 	b = lerp(sx, u, v);						//b is the the value of U and V blended together using the horizontal easing curve
 
@@ -122,57 +133,17 @@ double OldPerlinNoise::noise2D(float vec[2])
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-//This function just sets up a table of numbers which we use for generating a pseudo-random number later
-//and then generates arrays of pseudo-random gradients that we can access using the pseudo-random numbers
-//You don't need to worry too much about this
-void OldPerlinNoise::init(void)
-{
-	int i, j, k;
-
-	for (i = 0; i < B; i++)
-	{
-		perm[i] = i;
-
-		grad1D[i] = (float)((rand() % (B + B)) - B) / B;
-
-		for (j = 0; j < 2; j++)
-		{
-			grad2D[i][j] = (float)((rand() % (B + B)) - B) / B;
-		}
-			
-		normalize2D(grad2D[i]);
-	}
-
-	while (--i)
-	{
-		k = perm[i];
-		perm[i] = perm[j = rand() % B];
-		perm[j] = k;
-	}
-
-	for (i = 0; i < B + 2; i++)
-	{
-		perm[B + i] = perm[i];
-		grad1D[B + i] = grad1D[i];
-
-		for (j = 0; j < 2; j++)
-		{
-			grad2D[B + i][j] = grad2D[i][j];
-		}	
-	}
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
 //Setup the function variables
 //b0 and b1 are the integer values before and after our point
 //r0 and r1 are the fractional distances from the integer boundaries
 //This is an old school way of doing it, which I've kept in to be as close to the original implementation as possible
-void OldPerlinNoise::setup(float* vec, int i, int& b0, int& b1, float& r0, float& r1)
+//The boundaries wrap every period cells, for the full B that's the same as the original & BM
+void OldPerlinNoise::setup(float* vec, int i, int& b0, int& b1, float& r0, float& r1, int period)
 {
 	float t = vec[i] + N;
-	b0 = ((int)t) & BM;
-	b1 = (b0 + 1) & BM;
+	b0 = ((int)t) % period;
+	b0 = b0 < 0 ? b0 + period : b0;
+	b1 = (b0 + 1) % period;
 	r0 = t - (int)t;
 	r1 = r0 - 1.;
 }
@@ -1,6 +1,7 @@
 /*
  * This is the Original(Classic) Prelin Noise class it handles:
  *		- Executing the Original Perlin Noise algorithm
+ *		- Executing it so it repeats after a given number of cells, for terrain tiles that wrap
  *
  *
  * Original @author Abertay University.
@@ -13,6 +14,7 @@
 // INCLUDES
 #pragma once
 #include <cstdlib>
+#include "NoiseTables.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -28,18 +30,14 @@ public:
 	static double noise1D(double arg);
 	static double noise2D(float vec[2]);
 
-private:
-	///Initialisation///
-	//Does the class need to be initialised
-	static bool		start;
-
-	//Set up the permuation and gradient tables
-	static int	perm[B + B + 2];
-	static float grad1D[B + B + 2];
-	static float grad2D[B + B + 2][2];
+	//The same again, using the given permutation and gradient tables rather than the defaults, see NoiseTables.h
+	static double noise1D(double arg, const ClassicNoiseTables& tables);
+	static double noise2D(float vec[2], const ClassicNoiseTables& tables);
+	//The same as noise2D(), but the noise repeats every period (1 -> B) cells in both x and y
+	static double noise2DPeriodic(float vec[2], int period, const ClassicNoiseTables& tables);
 
-	static void	init(void);
-	static void	setup(float* vec, int i, int& b0, int& b1, float& r0, float& r1);
+private:
+	static void	setup(float* vec, int i, int& b0, int& b1, float& r0, float& r1, int period = B);
 
 	///Helper math functions///
 	static const void normalize2D(float v[2]);
@@ -0,0 +1,234 @@
+/*
+ * This is the Parallel For class it handles:
+ *		- Splitting a range of work (i.e. the rows of the height map) into contiguous blocks
+ *		- Running the blocks on a pool of worker threads and waiting for them all to finish
+ *
+ * The blocks never overlap, so a job that only writes to its own rows needs no locking.
+ *
+ * The worker threads are started once and reused, only one run() at a time gets them and any other runs inline.
+ * A thread that's already one of a pool (i.e. a TerrainBatch worker) can limit itself to one thread, so anything it
+ * runs is done inline without ever waiting on the shared workers.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "ParallelFor.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Each thread has its own, so a limit set by one worker doesn't hold back any other thread
+thread_local int threadLimit = 0;
+// Set on the pool's own threads, anything they run is done inline
+thread_local bool isPoolWorker = false;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The worker threads, one per core besides the caller's, started the first time run() needs them and kept until exit
+// Only one run() uses them at a time, any other caller runs its blocks itself rather than waiting for them
+struct ParallelForPool
+{
+	ParallelForPool();
+	~ParallelForPool();
+
+	void work();
+	void runBlocks(const std::function<void(int start, int end)>* blockJob, int blockCount, int blockTotal);
+
+	std::vector<std::thread> workers;
+	std::mutex runMutex;				// Held by whichever run() is using the pool
+
+	// The current job, only changed while no workers are active
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	const std::function<void(int start, int end)>* job;
+	int count;
+	int blocks;
+	int generation;						// Bumped for every job, so a worker knows it hasn't seen it yet
+	int activeWorkers;
+	bool stop;
+	std::atomic<int> nextBlock;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ParallelForPool::ParallelForPool()
+{
+	job = nullptr;
+	count = 0;
+	blocks = 0;
+	generation = 0;
+	activeWorkers = 0;
+	stop = false;
+	nextBlock = 0;
+
+	int workerCount = ParallelFor::getThreadCount() - 1;
+	workers.reserve(workerCount);
+
+	for (int i = 0; i < workerCount; ++i)
+	{
+		workers.emplace_back(&ParallelForPool::work, this);
+	}
+}
+
+ParallelForPool::~ParallelForPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+
+	wake.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ParallelForPool::work()
+{
+	isPoolWorker = true;
+
+	int seenGeneration = 0;
+
+	while (true)
+	{
+		const std::function<void(int start, int end)>* blockJob;
+		int blockCount, blockTotal;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stop || generation != seenGeneration; });
+
+			if (stop)
+			{
+				return;
+			}
+
+			// Copied while the lock is held, the caller won't replace the job until this worker is inactive again
+			seenGeneration = generation;
+			blockJob = job;
+			blockCount = count;
+			blockTotal = blocks;
+			++activeWorkers;
+		}
+
+		runBlocks(blockJob, blockCount, blockTotal);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--activeWorkers;
+		}
+
+		done.notify_one();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Take blocks until there are none left, a worker that wakes after the last block has been taken does nothing
+void ParallelForPool::runBlocks(const std::function<void(int start, int end)>* blockJob, int blockCount, int blockTotal)
+{
+	for (int b = nextBlock++; b < blockTotal; b = nextBlock++)
+	{
+		int start = (int)((long long)blockCount * b / blockTotal);
+		int end = (int)((long long)blockCount * (b + 1) / blockTotal);
+
+		(*blockJob)(start, end);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void ParallelFor::run(int count, const std::function<void(int start, int end)>& job, int minBlockSize)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	int blocks = threadLimit > 0 ? threadLimit : getThreadCount();
+
+	if (minBlockSize > 0 && count / minBlockSize < blocks)
+	{
+		blocks = count / minBlockSize;
+	}
+
+	if (blocks <= 1 || isPoolWorker)
+	{
+		job(0, count);
+		return;
+	}
+
+	static ParallelForPool pool;
+
+	// The pool is already busy, i.e. this is a job calling run() or another thread got there first
+	std::unique_lock<std::mutex> runLock(pool.runMutex, std::try_to_lock);
+
+	if (!runLock.owns_lock())
+	{
+		job(0, count);
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(pool.mutex);
+
+		// A worker that woke too late for the last job may still be finding there's nothing left in it
+		pool.done.wait(lock, [&] { return pool.activeWorkers == 0; });
+
+		pool.job = &job;
+		pool.count = count;
+		pool.blocks = blocks;
+		pool.nextBlock = 0;
+		++pool.generation;
+	}
+
+	pool.wake.notify_all();
+
+	// The calling thread takes blocks too rather than sitting idle
+	pool.runBlocks(&job, count, blocks);
+
+	// Every block has been taken, so once no workers are active every block is done
+	std::unique_lock<std::mutex> lock(pool.mutex);
+	pool.done.wait(lock, [&] { return pool.activeWorkers == 0; });
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int ParallelFor::getThreadCount()
+{
+	// Can be 0 if it isn't known
+	unsigned int threads = std::thread::hardware_concurrency();
+
+	return threads > 0 ? (int)threads : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ParallelFor::setThreadLimit(int threads)
+{
+	threadLimit = threads > 0 ? threads : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int ParallelFor::getThreadLimit()
+{
+	return threadLimit;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
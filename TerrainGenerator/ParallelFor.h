@@ -0,0 +1,43 @@
+/*
+ * This is the Parallel For class it handles:
+ *		- Splitting a range of work (i.e. the rows of the height map) into contiguous blocks
+ *		- Running the blocks on a pool of worker threads and waiting for them all to finish
+ *
+ * The blocks never overlap, so a job that only writes to its own rows needs no locking.
+ *
+ * The worker threads are started once and reused, only one run() at a time gets them and any other runs inline.
+ * A thread that's already one of a pool (i.e. a TerrainBatch worker) can limit itself to one thread, so anything it
+ * runs is done inline without ever waiting on the shared workers.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <functional>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ParallelFor
+{
+public:
+	// Calls job(start, end) for blocks covering 0 -> count - 1, returns once every block is done
+	// Small ranges are just run on the calling thread
+	static void run(int count, const std::function<void(int start, int end)>& job, int minBlockSize = 16);
+	static int getThreadCount();
+
+	// The most blocks run() splits into when it's called from this thread, 0 (the default) for one per core
+	static void setThreadLimit(int threads);
+	static int getThreadLimit();
+
+private:
+	// Private constructors/destructors, i.e. you cannot create and instance of this class
+	ParallelFor() {};
+	~ParallelFor() {};
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
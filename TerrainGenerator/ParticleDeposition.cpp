@@ -16,7 +16,7 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // CONSTRUCTOR / DESTRUCTOR
-ParticleDeposition::ParticleDeposition(int& res, float* heightmp) : resolution(res), heightmap(heightmp)
+ParticleDeposition::ParticleDeposition(int& res, HeightMap& heightmp) : resolution(res), heightmap(heightmp)
 {
 	getNewStartPos = true;
 	xPos = 0;
@@ -38,18 +38,11 @@ void ParticleDeposition::runParticleDepo()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void ParticleDeposition::updateHeightMap(float* newHeightMap)
-{
-	heightmap = newHeightMap;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
 void ParticleDeposition::startParticleDepo()
 {
 	//int randHeight = rand() % 2 + 1;
 	float randHeight = (float)rand() / RAND_MAX;
-	int oldHeight = heightmap[(zPos * resolution) + xPos];
+	int oldHeight = heightmap.at(xPos, zPos);
 
 	// We enter this is the random walk hit the edge of the map
 	if (getNewStartPos)
@@ -59,7 +52,7 @@ void ParticleDeposition::startParticleDepo()
 		zPos = rand() % resolution;
 	}
 
-	//heightmap[(zPos * resolution) + xPos] = heightmap[(zPos * resolution) + xPos] + randHeight;
+	//heightmap.at(xPos, zPos) = heightmap.at(xPos, zPos) + randHeight;
 
 	// Randomise whether we add or remove height
 	/*if (rand() % 2 == 0)
@@ -67,8 +60,6 @@ void ParticleDeposition::startParticleDepo()
 		randHeight = -randHeight;
 	}*/
 	
-	int heightMapIndex = (zPos * resolution) + xPos;
-
 	// Update the surrounding 8 points AND the drop point itself
 	// Boundary checks carried out
 
@@ -89,39 +80,39 @@ void ParticleDeposition::startParticleDepo()
 	 * 
 	*/
 
-	heightmap[heightMapIndex] = heightmap[heightMapIndex] + randHeight;
+	heightmap.at(xPos, zPos) = heightmap.at(xPos, zPos) + randHeight;
 
 	if (xPos - 1 >= 0)
 	{
-		heightmap[heightMapIndex - 1] = heightmap[heightMapIndex - 1] + randHeight;
+		heightmap.at(xPos - 1, zPos) = heightmap.at(xPos - 1, zPos) + randHeight;
 	}
 	if (xPos + 1 < (resolution - 1))
 	{
-		heightmap[heightMapIndex + 1] = heightmap[heightMapIndex + 1] + randHeight;
+		heightmap.at(xPos + 1, zPos) = heightmap.at(xPos + 1, zPos) + randHeight;
 	}
 	if (zPos + 1 < (resolution - 1))
 	{
-		heightmap[heightMapIndex + resolution] = heightmap[heightMapIndex + resolution] + randHeight;
+		heightmap.at(xPos, zPos + 1) = heightmap.at(xPos, zPos + 1) + randHeight;
 	}
 	if (zPos - 1 >= 0)
 	{
-		heightmap[heightMapIndex - resolution] = heightmap[heightMapIndex - resolution] + randHeight;
+		heightmap.at(xPos, zPos - 1) = heightmap.at(xPos, zPos - 1) + randHeight;
 	}
 	if (zPos + 1 < (resolution - 1) && xPos + 1 < (resolution - 1))
 	{
-		heightmap[heightMapIndex + resolution + 1] = heightmap[heightMapIndex + resolution + 1] + randHeight;
+		heightmap.at(xPos + 1, zPos + 1) = heightmap.at(xPos + 1, zPos + 1) + randHeight;
 	}
 	if (zPos + 1 < (resolution - 1) && xPos - 1 >= 0)
 	{
-		heightmap[heightMapIndex + resolution - 1] = heightmap[heightMapIndex + resolution - 1] + randHeight;
+		heightmap.at(xPos - 1, zPos + 1) = heightmap.at(xPos - 1, zPos + 1) + randHeight;
 	}
 	if (zPos - 1 >= 0 && xPos + 1 < (resolution - 1))
 	{
-		heightmap[heightMapIndex - resolution + 1] = heightmap[heightMapIndex - resolution + 1] + randHeight;
+		heightmap.at(xPos + 1, zPos - 1) = heightmap.at(xPos + 1, zPos - 1) + randHeight;
 	}
 	if (zPos - 1 >= 0 && xPos - 1 >= 0)
 	{
-		heightmap[heightMapIndex - resolution - 1] = heightmap[heightMapIndex - resolution - 1] + randHeight;
+		heightmap.at(xPos - 1, zPos - 1) = heightmap.at(xPos - 1, zPos - 1) + randHeight;
 	}
 
 	// Move some random direction, boundary checks carried out
@@ -145,7 +136,7 @@ void ParticleDeposition::startParticleDepo()
 				// Move left 1 vertex
 				--xPos;
 				// Get the height of this new vertex
-				int newHeight = heightmap[(zPos * resolution) + xPos];
+				int newHeight = heightmap.at(xPos, zPos);
 
 				// Keep moving left until we get to a vertex of >= to current vertex height
 				// Once we do this will be the vertex we add height to next iteration, then repeat algo
@@ -153,7 +144,7 @@ void ParticleDeposition::startParticleDepo()
 				{
 					--xPos;
 					oldHeight = newHeight;
-					newHeight = heightmap[(zPos * resolution) + xPos];
+					newHeight = heightmap.at(xPos, zPos);
 				}
 
 				break;
@@ -170,13 +161,13 @@ void ParticleDeposition::startParticleDepo()
 			if (xPos < (resolution - 1))
 			{
 				++xPos;
-				int newHeight = heightmap[(zPos * resolution) + xPos];
+				int newHeight = heightmap.at(xPos, zPos);
 
 				while ((newHeight < oldHeight) && xPos < (resolution - 1))
 				{
 					++xPos;
 					oldHeight = newHeight;
-					newHeight = heightmap[(zPos * resolution) + xPos];
+					newHeight = heightmap.at(xPos, zPos);
 				}
 
 				break;
@@ -193,13 +184,13 @@ void ParticleDeposition::startParticleDepo()
 			if (zPos >= 1)
 			{
 				--zPos;
-				int newHeight = heightmap[(zPos * resolution) + xPos];
+				int newHeight = heightmap.at(xPos, zPos);
 
 				while ((newHeight < oldHeight) && zPos >= 1)
 				{
 					--zPos;
 					oldHeight = newHeight;
-					newHeight = heightmap[(zPos * resolution) + xPos];
+					newHeight = heightmap.at(xPos, zPos);
 				}
 
 				break;
@@ -216,13 +207,13 @@ void ParticleDeposition::startParticleDepo()
 			if (zPos < (resolution - 1))
 			{
 				++zPos;
-				int newHeight = heightmap[(zPos * resolution) + xPos];
+				int newHeight = heightmap.at(xPos, zPos);
 
 				while ((newHeight < oldHeight) && zPos < (resolution - 1))
 				{
 					++zPos;
 					oldHeight = newHeight;
-					newHeight = heightmap[(zPos * resolution) + xPos];
+					newHeight = heightmap.at(xPos, zPos);
 				}
 
 				break;
@@ -11,16 +11,16 @@
 
 // INCLUDES
 #pragma once
+#include "HeightMap.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 class ParticleDeposition
 {
 public:
-	ParticleDeposition(int& res, float* heightmp);
+	ParticleDeposition(int& res, HeightMap& heightmp);
 	~ParticleDeposition();
 	void runParticleDepo();
-	void updateHeightMap(float* newHeightMap);
 
 private:
 	void startParticleDepo();
@@ -28,7 +28,7 @@ private:
 	bool getNewStartPos;
 
 	int& resolution;
-	float* heightmap;
+	HeightMap& heightmap;
 	int xPos;
 	int zPos;
 };
@@ -3,9 +3,16 @@
  *		- Calling specific versions of Perlin Noise:
  *			* Old (Classic) Perlin Noise algorithm
  *			* Improved PErlin Noise algorithm
+ *			* Simplex Noise algorithm
  *		- Modifying the type of noise return to create varieties of noise:
  *			* Ridged noise
  *			* Terraced noise
+ *		- Derivative-dampened ("eroded") fBm, all octaves in one pass
+ *		- Domain warped noise, 1 or 2 levels of warp and the noise itself in one pass
+ *		- Sampling from a tile's origin in a larger world, optionally wrapping every period grid points,
+ *		  so tiles built separately (on other threads, or other machines) join up seamlessly
+ *		- Adding the analytic gradient of the noise to a gradient map, so the normals don't need
+ *		  finite differences afterwards
  *
  * Original @author D. Green.
  *
@@ -18,20 +25,32 @@
 #include "PerlinNoise.h"
 #include "OldPerlinNoise.h"
 #include "ImprovedPerlin.h"
+#include "SimplexNoise.h"
+#include <cstring>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // CONSTRUCTOR / DESTRUCTOR
-PerlinNoise::PerlinNoise(int& res, float* heightmp, const int& terrainSize) : resolution(res), heightmap(heightmp), terrainSz(terrainSize)
+PerlinNoise::PerlinNoise(int& res, HeightMap& heightmp, const int& terrainSize) : resolution(res), heightmap(heightmp), terrainSz(terrainSize)
 {
 	// Default values
 	ridgedPerlin = false;
+	terracedPerlin = false;
 	oldPerlin = false;
 	improvedPerlin = false;
+	simplexNoise = false;
 
 	perlinFreq = 0.0f;
 	perlinScale = 0.0f;
 	amplitude = 0.0f;
+
+	noiseSeed = 0;
+	permutationTable = DEFAULT_PERMUTATION;
+	classicTables = DEFAULT_CLASSIC_TABLES;
+
+	tileOriginX = 0;
+	tileOriginZ = 0;
+	period = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -44,20 +63,13 @@ PerlinNoise::~PerlinNoise()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void PerlinNoise::updateHeightMap(float* newHeightMap)
-{
-	heightmap = newHeightMap;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
 double PerlinNoise::genOldPerlinNoise(float xPos, float zPos)
 {
 	// Same values in, same terrain out
 	float vec[2] = { xPos * perlinScale * perlinFreq, zPos * perlinScale * perlinFreq };
 	//float vec[2] = { xPos * perlinScale + perlinFreq, zPos * perlinScale + perlinFreq };
 	//float vec[2] = { z, x };		// Test to ensure that without the rand scale value, perlin noise returned zero, and it does!
-	double perlinNoise = OldPerlinNoise::noise2D(vec);
+	double perlinNoise = OldPerlinNoise::noise2D(vec, classicTables);
 
 	return perlinNoise;
 }
@@ -68,76 +80,389 @@ double PerlinNoise::genImprovedPerlinNoise(float xPos, float yPos, float zPos)
 {
 	double vec[3] = { xPos * perlinScale * perlinFreq, yPos, zPos * perlinScale * perlinFreq };
 	//double vec[3] = { xPos * perlinScale + perlinFreq, yPos, zPos * perlinScale + perlinFreq };
-	double improvedPerlin = ImprovedPerlin::noise(vec[0], vec[1], vec[2]);
+	double improvedPerlin = ImprovedPerlin::noise(vec[0], vec[1], vec[2], permutationTable);
 
 	return improvedPerlin;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void PerlinNoise::fracBrownianMotion()
+double PerlinNoise::genImprovedPerlinNoise(float xPos, float zPos, double& dNoiseX, double& dNoiseZ)
+{
+	return ImprovedPerlin::noise2D(xPos * perlinScale * perlinFreq, zPos * perlinScale * perlinFreq, dNoiseX, dNoiseZ, permutationTable);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PerlinNoise::genSimplexNoiseRow(int zPos)
+{
+	rowNoise.resize(resolution);
+	rowNoiseDx.resize(resolution);
+	rowNoiseDz.resize(resolution);
+
+	const float step = (float)(perlinScale * perlinFreq);
+	const float z[4] = { zPos * step, zPos * step, zPos * step, zPos * step };
+
+	int x = 0;
+
+	for (; x + 4 <= resolution; x += 4)
+	{
+		const float xs[4] = { (tileOriginX + x) * step, (tileOriginX + x + 1) * step, (tileOriginX + x + 2) * step, (tileOriginX + x + 3) * step };
+		SimplexNoise::noise4(xs, z, permutationTable, &rowNoise[x], &rowNoiseDx[x], &rowNoiseDz[x]);
+	}
+
+	// Whatever is left over if the resolution isn't a multiple of 4
+	for (; x < resolution; ++x)
+	{
+		rowNoise[x] = SimplexNoise::noise((tileOriginX + x) * step, z[0], permutationTable, &rowNoiseDx[x], &rowNoiseDz[x]);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool PerlinNoise::fracBrownianMotion(float* gradientX, float* gradientZ)
 {
-	buildPerlinNoise();
+	bool gradientsAdded = buildPerlinNoise(gradientX, gradientZ);
 	amplitude *= 0.5;
 	perlinFreq *= 2;
+
+	return gradientsAdded;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void PerlinNoise::buildPerlinNoise()
+bool PerlinNoise::buildPerlinNoise(float* gradientX, float* gradientZ)
 {
 	float height = 0.0f;
 	double noise = 0.0f;
-	float result = 0.0f;
 
-	// Scale everything so that the look is consistent across terrain resolutions
-	const float scale = terrainSz / (float)resolution;
+	// The Old Perlin algorithm has no derivatives, and the terraces are steps so they have no useful gradient
+	bool addGradients = gradientX && gradientZ && !oldPerlin && !terracedPerlin;
+	double dNoiseX = 0.0;
+	double dNoiseZ = 0.0;
+
+	// When periodic, the step is nudged so a whole number of noise cells fit in the period
+	const int octavePeriod = getOctavePeriod();
+
+	// The noise derivatives are per unit of noise space, the gradient map is per grid point
+	const double step = octavePeriod ? (double)octavePeriod / period : perlinScale * perlinFreq;
 
 	for (int z = 0; z < (resolution); z++)
 	{
+		const int worldZ = toWorldGrid(z, tileOriginZ);
+
+		if (simplexNoise && !octavePeriod)
+		{
+			genSimplexNoiseRow(worldZ);
+		}
+
 		for (int x = 0; x < (resolution); x++)
 		{
+			const int worldX = toWorldGrid(x, tileOriginX);
+
 			// What noise are we using?
-			if (oldPerlin)
+			if (octavePeriod)
 			{
-				noise = genOldPerlinNoise(x, z);
+				noise = genPeriodicNoise(worldX * step, worldZ * step, octavePeriod, dNoiseX, dNoiseZ);
+			}
+			else if (oldPerlin)
+			{
+				noise = genOldPerlinNoise(worldX, worldZ);
 			}
 			else if (improvedPerlin)
 			{
-				noise = genImprovedPerlinNoise(x, 0, z);
+				noise = genImprovedPerlinNoise(worldX, worldZ, dNoiseX, dNoiseZ);
+			}
+			else if (simplexNoise)
+			{
+				noise = rowNoise[x];
+				dNoiseX = rowNoiseDx[x];
+				dNoiseZ = rowNoiseDz[x];
 			}
 
-			// Is it going to be ridged or terraced or normal?
-			if (ridgedPerlin)
+			// How much the height changes per unit of noise, for the chain rule below
+			double dHeight = 0.0;
+			height = applyNoiseStyle(noise, dHeight);
+
+			// Set the height
+			heightmap.at(x, z) += height;
+
+			if (addGradients)
 			{
-				result = amplitude * abs(noise);
-				// The smaller the exponent the more defined and sharper the ridge
-				// The larger the exponent the softer and more rounded the ridge
-				// Sensible range for values are 0.75 - 2.0
-				height = pow(result, 1.5f);
-				// Invert the height so we get ridges, otherwise the "ridges" will be more like valleys, which could also be useful
-				height = -height;
+				gradientX[z * resolution + x] += (float)(dHeight * dNoiseX * step);
+				gradientZ[z * resolution + x] += (float)(dHeight * dNoiseZ * step);
 			}
-			else if (terracedPerlin)
+		}
+	}
+
+	return addGradients;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float PerlinNoise::applyNoiseStyle(double noise, double& dHeight)
+{
+	float height = 0.0f;
+	float result = 0.0f;
+
+	dHeight = amplitude;
+
+	// Is it going to be ridged or terraced or normal?
+	if (ridgedPerlin)
+	{
+		result = amplitude * abs(noise);
+		// The smaller the exponent the more defined and sharper the ridge
+		// The larger the exponent the softer and more rounded the ridge
+		// Sensible range for values are 0.75 - 2.0
+		height = pow(result, 1.5f);
+		// Invert the height so we get ridges, otherwise the "ridges" will be more like valleys, which could also be useful
+		height = -height;
+
+		// d/dn of -(amplitude * |n|)^1.5
+		dHeight = -1.5 * sqrt(result) * amplitude * (noise < 0.0 ? -1.0 : 1.0);
+	}
+	else if (terracedPerlin)
+	{
+		int exponent = 1;
+
+		result = amplitude * noise;
+		// This must be used with whole integers as the exponent, NOT fractional numbers
+		// Also anything > 2, is just simply too much, as we lose the terracing aesthetic
+		// so really 2 is the only worthwhile value, as 1 would just return the same result
+		// Even values provide positive only heightmap alterations
+		// Odd values provide both positive and negative heightmap alterations
+		result = pow(result, exponent);
+		height = round(result * exponent) / exponent;
+	}
+	else
+	{
+		height = amplitude * noise;
+	}
+
+	return height;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool PerlinNoise::buildDomainWarpedNoise(int warpLevels, float warpStrength, float* gradientX, float* gradientZ)
+{
+	// Ref:
+	// Quilez, I. (2002) Domain Warping
+	// https://iquilezles.org/articles/warp/
+
+	/*
+	* Rather than h(p) = noise(p) this is h(p) = noise(p + strength * warp(p)), where warp() is 2 noise values, one to push x
+	* and one to push z. With 2 levels the warp is itself warped, h(p) = noise(p + strength * warp(p + strength * warp(p))).
+	* The warps and the height are all worked out for a cell before moving to the next, so it's still one pass over the map,
+	* and both parts of each warp come from the one simplex noise2() call, so they share the cell's permutation lookups.
+	*/
+
+	bool addGradients = gradientX && gradientZ && !oldPerlin && !terracedPerlin;
+	const double step = perlinScale * perlinFreq;
+
+	// Moves the second level's warp away from the first, so they aren't the same noise
+	const float levelOffsetX = 5.2f;
+	const float levelOffsetZ = 1.3f;
+
+	for (int z = 0; z < resolution; z++)
+	{
+		for (int x = 0; x < resolution; x++)
+		{
+			double posX = (tileOriginX + x) * step;
+			double posZ = (tileOriginZ + z) * step;
+
+			// Where the warped position has moved to, and how it changes across the grid (d warped / d grid)
+			double warpedX = posX;
+			double warpedZ = posZ;
+			double warpedChange[2][2] = { { step, 0.0 }, { 0.0, step } };
+
+			for (int level = 0; level < warpLevels; level++)
+			{
+				float warp[2], warpDx[2], warpDz[2];
+				SimplexNoise::noise2((float)warpedX + level * levelOffsetX, (float)warpedZ + level * levelOffsetZ, permutationTable, warp, warpDx, warpDz);
+
+				// Chain rule, this level's warp was sampled at the previous level's warped position
+				double next[2][2];
+
+				for (int c = 0; c < 2; c++)
+				{
+					double warpChangeX = warpDx[0] * warpedChange[0][c] + warpDz[0] * warpedChange[1][c];
+					double warpChangeZ = warpDx[1] * warpedChange[0][c] + warpDz[1] * warpedChange[1][c];
+
+					next[0][c] = (c == 0 ? step : 0.0) + warpStrength * warpChangeX;
+					next[1][c] = (c == 1 ? step : 0.0) + warpStrength * warpChangeZ;
+				}
+
+				memcpy(warpedChange, next, sizeof(next));
+
+				// Every level warps the original position, not the last warped one
+				warpedX = posX + warpStrength * warp[0];
+				warpedZ = posZ + warpStrength * warp[1];
+			}
+
+			double noise = 0.0;
+			double dNoiseX = 0.0;
+			double dNoiseZ = 0.0;
+
+			if (oldPerlin)
 			{
-				int exponent = 1;
-
-				result = amplitude * noise;
-				// This must be used with whole integers as the exponent, NOT fractional numbers
-				// Also anything > 2, is just simply too much, as we lose the terracing aesthetic
-				// so really 2 is the only worthwhile value, as 1 would just return the same result
-				// Even values provide positive only heightmap alterations
-				// Odd values provide both positive and negative heightmap alterations
-				result = pow(result, exponent);
-				height = round(result * exponent) / exponent;
+				float vec[2] = { (float)warpedX, (float)warpedZ };
+				noise = OldPerlinNoise::noise2D(vec, classicTables);
 			}
 			else
 			{
-				height = amplitude * noise;
+				noise = genNoiseWithDerivatives(warpedX, warpedZ, dNoiseX, dNoiseZ, nullptr);
+			}
+
+			double dHeight = 0.0;
+			heightmap.at(x, z) += applyNoiseStyle(noise, dHeight);
+
+			if (addGradients)
+			{
+				gradientX[z * resolution + x] += (float)(dHeight * (warpedChange[0][0] * dNoiseX + warpedChange[1][0] * dNoiseZ));
+				gradientZ[z * resolution + x] += (float)(dHeight * (warpedChange[0][1] * dNoiseX + warpedChange[1][1] * dNoiseZ));
+			}
+		}
+	}
+
+	return addGradients;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double PerlinNoise::genNoiseWithDerivatives(double xPos, double zPos, double& dNoiseX, double& dNoiseZ, double hessian[3])
+{
+	if (simplexNoise)
+	{
+		float dx = 0.0f;
+		float dz = 0.0f;
+		float secondDerivs[3];
+		double noise = SimplexNoise::noise((float)xPos, (float)zPos, permutationTable, &dx, &dz, hessian ? secondDerivs : nullptr);
+
+		dNoiseX = dx;
+		dNoiseZ = dz;
+
+		for (int k = 0; k < 3 && hessian; k++)
+		{
+			hessian[k] = secondDerivs[k];
+		}
+
+		return noise;
+	}
+
+	// The Old Perlin algorithm has no derivatives, so it uses Improved Perlin here
+	return ImprovedPerlin::noise2D(xPos, zPos, dNoiseX, dNoiseZ, permutationTable, hessian);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double PerlinNoise::genPeriodicNoise(double xPos, double zPos, int octavePeriod, double& dNoiseX, double& dNoiseZ)
+{
+	if (oldPerlin)
+	{
+		float vec[2] = { (float)xPos, (float)zPos };
+
+		return OldPerlinNoise::noise2DPeriodic(vec, octavePeriod, classicTables);
+	}
+
+	// Simplex noise's triangles don't line up with a square period, so it uses Improved Perlin here
+	return ImprovedPerlin::noise2DPeriodic(xPos, zPos, octavePeriod, dNoiseX, dNoiseZ, permutationTable);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PerlinNoise::buildErodedfBm(int octaves, float* gradientX, float* gradientZ)
+{
+	// Ref:
+	// Quilez, I. (2008) Value Noise Derivatives
+	// https://iquilezles.org/articles/morenoise/
+
+	/*
+	* Every octave is summed in the one pass over the map, rather than one pass per octave like fracBrownianMotion().
+	* Each octave is scaled down by 1 / (1 + |d|^2), where d is the sum of the derivatives of the octaves so far,
+	* so detail builds up on the flat areas but is smoothed away on the steep slopes, which looks a lot like erosion.
+	* Each octave is also rotated, so the grid of the noise doesn't line up from octave to octave.
+	*
+	* The dampening changes with the slope, so the exact gradient of the height needs the noise's second derivatives too.
+	*/
+
+	// 2 * the rotation matrix, from the article
+	const double rotate[2][2] = { { 1.6, -1.2 }, { 1.2, 1.6 } };
+	const double step = perlinScale * perlinFreq;
+
+	for (int z = 0; z < resolution; z++)
+	{
+		for (int x = 0; x < resolution; x++)
+		{
+			// Position in this octave's noise space, and the matrix that took it there from grid space
+			double posX = (tileOriginX + x) * step;
+			double posZ = (tileOriginZ + z) * step;
+			double toOctave[2][2] = { { step, 0.0 }, { 0.0, step } };
+
+			double sum = 0.0;
+			double octaveAmplitude = 1.0;
+			double derivSumX = 0.0;
+			double derivSumZ = 0.0;
+			// How derivSum changes across the grid, the sum of each octave's hessian * toOctave
+			double derivSumChange[2][2] = { { 0.0, 0.0 }, { 0.0, 0.0 } };
+			double gradX = 0.0;
+			double gradZ = 0.0;
+
+			for (int o = 0; o < octaves; o++)
+			{
+				double dNoiseX = 0.0;
+				double dNoiseZ = 0.0;
+				double hessian[3];
+				double noise = genNoiseWithDerivatives(posX, posZ, dNoiseX, dNoiseZ, hessian);
+
+				derivSumX += dNoiseX;
+				derivSumZ += dNoiseZ;
+
+				for (int c = 0; c < 2; c++)
+				{
+					derivSumChange[0][c] += hessian[0] * toOctave[0][c] + hessian[1] * toOctave[1][c];
+					derivSumChange[1][c] += hessian[1] * toOctave[0][c] + hessian[2] * toOctave[1][c];
+				}
+
+				double dampen = 1.0 / (1.0 + derivSumX * derivSumX + derivSumZ * derivSumZ);
+				sum += octaveAmplitude * noise * dampen;
+
+				// Product rule, the noise's slope taken back to grid space through the transpose of toOctave,
+				// plus the change in the dampening, which is -2 * dampen^2 * (d derivSum)^T * derivSum
+				double slopeX = toOctave[0][0] * dNoiseX + toOctave[1][0] * dNoiseZ;
+				double slopeZ = toOctave[0][1] * dNoiseX + toOctave[1][1] * dNoiseZ;
+				double dampenX = -2.0 * dampen * dampen * (derivSumChange[0][0] * derivSumX + derivSumChange[1][0] * derivSumZ);
+				double dampenZ = -2.0 * dampen * dampen * (derivSumChange[0][1] * derivSumX + derivSumChange[1][1] * derivSumZ);
+
+				gradX += octaveAmplitude * (slopeX * dampen + noise * dampenX);
+				gradZ += octaveAmplitude * (slopeZ * dampen + noise * dampenZ);
+
+				double nextX = rotate[0][0] * posX + rotate[0][1] * posZ;
+				double nextZ = rotate[1][0] * posX + rotate[1][1] * posZ;
+				posX = nextX;
+				posZ = nextZ;
+
+				double next[2][2];
+
+				for (int r = 0; r < 2; r++)
+				{
+					for (int c = 0; c < 2; c++)
+					{
+						next[r][c] = rotate[r][0] * toOctave[0][c] + rotate[r][1] * toOctave[1][c];
+					}
+				}
+
+				memcpy(toOctave, next, sizeof(next));
+				octaveAmplitude *= 0.5;
+			}
+
+			heightmap.at(x, z) += (float)(amplitude * sum);
+
+			if (gradientX && gradientZ)
+			{
+				gradientX[z * resolution + x] += (float)(amplitude * gradX);
+				gradientZ[z * resolution + x] += (float)(amplitude * gradZ);
 			}
-			
-			// Set the height
-			heightmap[(z * resolution) + x] += height;
 		}
 	}
 }
@@ -185,16 +510,106 @@ void PerlinNoise::setPerlinAlgorithm(char type)
 	{
 		oldPerlin = true;
 		improvedPerlin = false;
+		simplexNoise = false;
 	}
 	else if (type == 'I')
 	{
 		improvedPerlin = true;
 		oldPerlin = false;
+		simplexNoise = false;
+	}
+	else if (type == 'S')
+	{
+		simplexNoise = true;
+		oldPerlin = false;
+		improvedPerlin = false;
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+char PerlinNoise::getPerlinAlgorithm()
+{
+	if (simplexNoise)
+	{
+		return 'S';
+	}
+
+	return improvedPerlin ? 'I' : 'O';
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PerlinNoise::setSeed(unsigned int seed)
+{
+	if (seed == noiseSeed)
+	{
+		return;
+	}
+
+	noiseSeed = seed;
+
+	// The defaults are already built at compile time, anything else is built here, once per seed change
+	permutationTable = (seed == 0) ? DEFAULT_PERMUTATION : NoiseTables::makePermutation(seed);
+	classicTables = (seed == 0) ? DEFAULT_CLASSIC_TABLES : NoiseTables::makeClassicTables(seed);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int PerlinNoise::getSeed()
+{
+	return noiseSeed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PerlinNoise::setTileOrigin(int originX, int originZ)
+{
+	tileOriginX = originX;
+	tileOriginZ = originZ;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PerlinNoise::setPeriod(int gridPoints)
+{
+	period = gridPoints < 0 ? 0 : gridPoints;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int PerlinNoise::getOctavePeriod()
+{
+	if (period == 0)
+	{
+		return 0;
+	}
+
+	// The nearest whole number of cells to what the frequency asks for, at least 1 and at most the 256 the noise can hash
+	int cells = (int)round(period * perlinScale * perlinFreq);
+
+	return cells < 1 ? 1 : (cells > 256 ? 256 : cells);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int PerlinNoise::toWorldGrid(int gridPos, int origin)
+{
+	int worldPos = origin + gridPos;
+
+	if (period == 0)
+	{
+		return worldPos;
+	}
+
+	// Wrapping the grid point rather than the noise position means every tile works out the exact same position for it
+	worldPos %= period;
+
+	return worldPos < 0 ? worldPos + period : worldPos;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 float PerlinNoise::getFreq()
 {
 	return perlinFreq;
@@ -3,9 +3,16 @@
  *		- Calling specific versions of Perlin Noise:
  *			* Old (Classic) Perlin Noise algorithm
  *			* Improved PErlin Noise algorithm
+ *			* Simplex Noise algorithm
  *		- Modifying the type of noise return to create varieties of noise:
  *			* Ridged noise
  *			* Terraced noise
+ *		- Derivative-dampened ("eroded") fBm, all octaves in one pass
+ *		- Domain warped noise, 1 or 2 levels of warp and the noise itself in one pass
+ *		- Sampling from a tile's origin in a larger world, optionally wrapping every period grid points,
+ *		  so tiles built separately (on other threads, or other machines) join up seamlessly
+ *		- Adding the analytic gradient of the noise to a gradient map, so the normals don't need
+ *		  finite differences afterwards
  *
  * Original @author D. Green.
  *
@@ -17,45 +24,85 @@
 // INCLUDES
 #pragma once
 #include <string>
+#include <vector>
+#include "HeightMap.h"
+#include "NoiseTables.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 class PerlinNoise
 {
 public:
-	PerlinNoise(int& res, float* heightmp, const int& terrainSize);
+	PerlinNoise(int& res, HeightMap& heightmp, const int& terrainSize);
 	~PerlinNoise();
 
-	void updateHeightMap(float* newHeightMap);
-
-	void buildPerlinNoise();
-	void fracBrownianMotion();
+	// If gradientX/Z are given (row-major, height change per grid point) the noise's gradient is added to them,
+	// returns false if it couldn't be, i.e. for Old Perlin or terraced noise, and then the gradients are no longer valid
+	bool buildPerlinNoise(float* gradientX = nullptr, float* gradientZ = nullptr);
+	bool fracBrownianMotion(float* gradientX = nullptr, float* gradientZ = nullptr);
+	void buildErodedfBm(int octaves, float* gradientX = nullptr, float* gradientZ = nullptr);
+	bool buildDomainWarpedNoise(int warpLevels, float warpStrength, float* gradientX = nullptr, float* gradientZ = nullptr);
 	void setFrequency(double freq);
 	void setScale(double scl);
 	void setAmplitude(float amp);
 	void setRidged(bool isRidged);
 	void setTerraced(bool isTerraced);
 	void setPerlinAlgorithm(char type);
+	// Seed 0 is the original noise, any other seed shuffles the permutation (and Old Perlin's gradients) for a different terrain
+	void setSeed(unsigned int seed);
+	unsigned int getSeed();
+	// Where this height map's (0, 0) is in the world, in grid points, so neighbouring tiles sample the noise they share the same
+	void setTileOrigin(int originX, int originZ);
+	// Periodic noise repeats every period grid points in x and z, 0 turns it off
+	// Only used by buildPerlinNoise()/fracBrownianMotion(), the eroded fBm's rotated octaves and the warps can't repeat on a square
+	void setPeriod(int gridPoints);
+	// The period of the current octave in noise cells, this doubles each octave of fBm as the frequency does, 0 if not periodic
+	int getOctavePeriod();
+	char getPerlinAlgorithm();
 	float getFreq();
 	float getAmplitude();
 
 private:
 	double genOldPerlinNoise(float xPos, float zPos);
 	double genImprovedPerlinNoise(float xPos, float yPos, float zPos);
+	double genImprovedPerlinNoise(float xPos, float zPos, double& dNoiseX, double& dNoiseZ);
+	// hessian can be nullptr if the second derivatives aren't needed
+	double genNoiseWithDerivatives(double xPos, double zPos, double& dNoiseX, double& dNoiseZ, double hessian[3]);
+	// Applies the ridged/terraced style and the amplitude, dHeight is set to d height / d noise
+	float applyNoiseStyle(double noise, double& dHeight);
+	void genSimplexNoiseRow(int zPos);
+	double genPeriodicNoise(double xPos, double zPos, int octavePeriod, double& dNoiseX, double& dNoiseZ);
+	// A grid point's position in the world, wrapped into the period if there is one
+	int toWorldGrid(int gridPos, int origin);
 	
 	bool ridgedPerlin;
 	bool terracedPerlin;
 	bool oldPerlin;
 	bool improvedPerlin;
+	bool simplexNoise;
 
 	int& resolution;
 	const int& terrainSz;
 
-	float* heightmap;
+	HeightMap& heightmap;
 	float amplitude;
 
 	double perlinFreq;
 	double perlinScale;
+
+	// Only ever read by the noise functions, so building a terrain doesn't need to touch any shared state
+	unsigned int noiseSeed;
+	PermutationTable permutationTable;
+	ClassicNoiseTables classicTables;
+
+	int tileOriginX;
+	int tileOriginZ;
+	int period;
+
+	// Simplex noise is generated a row at a time, 4 points at once
+	std::vector<float> rowNoise;
+	std::vector<float> rowNoiseDx;
+	std::vector<float> rowNoiseDz;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
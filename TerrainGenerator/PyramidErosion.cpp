@@ -0,0 +1,172 @@
+/*
+ * This is the Pyramid Erosion class it handles:
+ *		- Running droplet (hydraulic) erosion coarse to fine, on smaller copies of the height map first
+ *		- Downsampling the height map to each level of the pyramid, halving the resolution each level
+ *		- Upsampling each level's change in height back onto the full height map
+ *
+ * At high resolutions a droplet has to travel much further (in grid points) to carve a large valley,
+ * so single level erosion needs far more droplets and a longer lifetime. On a coarse level every droplet
+ * step covers several grid points, so the large scale drainage is cut with far fewer droplets, leaving
+ * only the fine detail for the full resolution pass, see Terrain::pyramidErodeTerrain().
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "PyramidErosion.h"
+#include "ParallelFor.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Any smaller and there's nothing left for the droplets to run down
+const int MIN_LEVEL_RESOLUTION = 16;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+PyramidErosion::PyramidErosion(int& res, HeightMap& heightmp, ErosionBrushCache& brushes) :
+	resolution(res), heightmap(heightmp), coarseResolution(0), coarseErosion(coarseResolution, coarseMap, brushes)
+{
+
+}
+
+PyramidErosion::~PyramidErosion()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void PyramidErosion::erodeCoarseLevels(int levels, int dropletsPerLevel, unsigned int seed, const HydraulicErosion::DropletParams& params)
+{
+	ErosionRandom random(seed);
+
+	for (int level = levels; level >= 1; --level)
+	{
+		int levelResolution = getLevelResolution(level);
+
+		// Not enough resolution for this many levels, skip to the first one that's big enough
+		if (levelResolution < MIN_LEVEL_RESOLUTION)
+		{
+			continue;
+		}
+
+		// The level's points line up with every factor'th point of the full map
+		int factor = 1 << level;
+
+		if (levelResolution != coarseResolution)
+		{
+			coarseResolution = levelResolution;
+			coarseMap.resize(coarseResolution, HeightMap::ROW_MAJOR);
+		}
+
+		downsample(factor);
+		coarseOriginal.assign(coarseMap.data(), coarseMap.data() + coarseResolution * coarseResolution);
+
+		for (int i = 0; i < dropletsPerLevel; ++i)
+		{
+			coarseErosion.simulateDroplet(random, params, nullptr, nullptr, nullptr);
+		}
+
+		// Only the change goes back up, so the full map keeps all the detail the coarse map couldn't hold
+		upsampleDelta(factor);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int PyramidErosion::getLevelResolution(int level)
+{
+	// The first and last points of every level line up with the full map's
+	return (resolution - 1) / (1 << level) + 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PyramidErosion::downsample(int factor)
+{
+	const int half = factor / 2;
+	float* coarse = coarseMap.data();
+
+	ParallelFor::run(coarseResolution, [&](int startZ, int endZ)
+	{
+		for (int cz = startZ; cz < endZ; ++cz)
+		{
+			int z0 = cz * factor - half;
+			int z1 = cz * factor + half;
+			z0 = z0 < 0 ? 0 : z0;
+			z1 = z1 > resolution - 1 ? resolution - 1 : z1;
+
+			for (int cx = 0; cx < coarseResolution; ++cx)
+			{
+				int x0 = cx * factor - half;
+				int x1 = cx * factor + half;
+				x0 = x0 < 0 ? 0 : x0;
+				x1 = x1 > resolution - 1 ? resolution - 1 : x1;
+
+				float sum = 0.0f;
+
+				for (int z = z0; z <= z1; ++z)
+				{
+					for (int x = x0; x <= x1; ++x)
+					{
+						sum += heightmap.at(x, z);
+					}
+				}
+
+				coarse[cz * coarseResolution + cx] = sum / (float)((x1 - x0 + 1) * (z1 - z0 + 1));
+			}
+		}
+	}, 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void PyramidErosion::upsampleDelta(int factor)
+{
+	const float* coarse = coarseMap.data();
+	const float* original = coarseOriginal.data();
+	const float step = 1.0f / (float)factor;
+	const int last = coarseResolution - 1;
+
+	ParallelFor::run(resolution, [&](int startZ, int endZ)
+	{
+		for (int z = startZ; z < endZ; ++z)
+		{
+			// Points past the last coarse point, when (resolution - 1) doesn't divide by the factor, use the last one
+			float coarseZ = z * step;
+			int cz = (int)coarseZ;
+			cz = cz >= last ? last - 1 : cz;
+			float tz = coarseZ - cz;
+			tz = tz > 1.0f ? 1.0f : tz;
+
+			for (int x = 0; x < resolution; ++x)
+			{
+				float coarseX = x * step;
+				int cx = (int)coarseX;
+				cx = cx >= last ? last - 1 : cx;
+				float tx = coarseX - cx;
+				tx = tx > 1.0f ? 1.0f : tx;
+
+				int i = cz * coarseResolution + cx;
+
+				float delta00 = coarse[i] - original[i];
+				float delta10 = coarse[i + 1] - original[i + 1];
+				float delta01 = coarse[i + coarseResolution] - original[i + coarseResolution];
+				float delta11 = coarse[i + coarseResolution + 1] - original[i + coarseResolution + 1];
+
+				float top = delta00 + (delta10 - delta00) * tx;
+				float bottom = delta01 + (delta11 - delta01) * tx;
+
+				heightmap.at(x, z) += top + (bottom - top) * tz;
+			}
+		}
+	}, 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,55 @@
+/*
+ * This is the Pyramid Erosion class it handles:
+ *		- Running droplet (hydraulic) erosion coarse to fine, on smaller copies of the height map first
+ *		- Downsampling the height map to each level of the pyramid, halving the resolution each level
+ *		- Upsampling each level's change in height back onto the full height map
+ *
+ * At high resolutions a droplet has to travel much further (in grid points) to carve a large valley,
+ * so single level erosion needs far more droplets and a longer lifetime. On a coarse level every droplet
+ * step covers several grid points, so the large scale drainage is cut with far fewer droplets, leaving
+ * only the fine detail for the full resolution pass, see Terrain::pyramidErodeTerrain().
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <vector>
+#include "HeightMap.h"
+#include "HydraulicErosion.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class PyramidErosion
+{
+public:
+	PyramidErosion(int& res, HeightMap& heightmp, ErosionBrushCache& brushes);
+	~PyramidErosion();
+
+	// Erodes levels coarse copies of the height map, coarsest first, each one half the resolution of the next
+	// dropletsPerLevel droplets are run on every level, the full resolution pass is left to the caller
+	void erodeCoarseLevels(int levels, int dropletsPerLevel, unsigned int seed, const HydraulicErosion::DropletParams& params);
+	// The resolution of a level, level 0 is the full height map
+	int getLevelResolution(int level);
+
+private:
+	// Box filters the height map down to the coarse map, each coarse point is the average of the block around it
+	void downsample(int factor);
+	// Adds the bilinearly interpolated change in the coarse heights onto the height map
+	void upsampleDelta(int factor);
+
+	int& resolution;
+	HeightMap& heightmap;
+
+	// The current level, coarseErosion is bound to these so they MUST be declared before it
+	int coarseResolution;
+	HeightMap coarseMap;
+	std::vector<float> coarseOriginal;
+	HydraulicErosion coarseErosion;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
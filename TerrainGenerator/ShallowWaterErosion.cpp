@@ -0,0 +1,423 @@
+/*
+ * This is the Shallow Water Erosion class it handles:
+ *		- Running a grid based (pipe model) hydraulic erosion, as an alternative to the droplets in Terrain::erodeTerrain()
+ *		- Raining on the terrain, letting the water flow between neighbouring points through virtual pipes,
+ *		  and evaporating it again
+ *		- Dissolving and depositing sediment depending on how fast the water is flowing, and carrying
+ *		  the sediment along with the water
+ *
+ * Every step of a time step is a stencil over the whole grid, where a point only writes to itself,
+ * so the rows are split between threads, and the flux and erosion steps do 4 points at once with SSE.
+ * TerrainTests' benchmarkShallowWaterScaling times it on 1 thread up to one per core.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "ShallowWaterErosion.h"
+#include "ParallelFor.h"
+#include <emmintrin.h>
+#include <cmath>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const float GRAVITY = 9.81f;
+
+// Below this the water is too shallow to have a meaningful velocity
+const float MIN_WATER_DEPTH = 0.001f;
+
+// Without a minimum tilt the water couldn't carry anything across flat ground
+const float MIN_TILT = 0.05f;
+
+// Water shallower than this carries less, so a thin film of rain can't strip the slopes
+const float FULL_CAPACITY_DEPTH = 0.5f;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+ShallowWaterErosion::ShallowWaterErosion(int& res, HeightMap& heightmp) : resolution(res), heightmap(heightmp)
+{
+	// Default values
+	rainRate = 0.2f;
+	evaporationRate = 0.5f;
+	sedimentCapacity = 0.2f;
+	dissolveRate = 0.3f;
+	depositRate = 0.3f;
+	timeStep = 0.02f;
+
+	cellSize = 1.0f;
+	fluxScale = 0.0f;
+}
+
+ShallowWaterErosion::~ShallowWaterErosion()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void ShallowWaterErosion::erodeTerrain(int iterations, float gridScale)
+{
+	// Ref:
+	// Mei, X., Decaudin, P. and Hu, B. (2007) Fast Hydraulic Erosion Simulation and Visualization on GPU
+	// https://hal.inria.fr/inria-00402079/document
+
+	if (iterations <= 0)
+	{
+		return;
+	}
+
+	const int pointCount = resolution * resolution;
+
+	// Each pipe is as long as the grid spacing, with a cross section of a whole cell, so the flux gained
+	// per unit of height difference is timeStep * gravity * area / length
+	cellSize = gridScale;
+	fluxScale = timeStep * GRAVITY * cellSize;
+
+	terrain.resize(pointCount);
+	heightmap.copyToRowMajor(terrain.data());
+
+	// The first step's rain, every following step's rain is added at the end of the step before it
+	water.assign(pointCount, rainRate * timeStep);
+	newWater.assign(pointCount, 0.0f);
+	fluxLeft.assign(pointCount, 0.0f);
+	fluxRight.assign(pointCount, 0.0f);
+	fluxUp.assign(pointCount, 0.0f);
+	fluxDown.assign(pointCount, 0.0f);
+	velocityX.assign(pointCount, 0.0f);
+	velocityZ.assign(pointCount, 0.0f);
+	capacity.assign(pointCount, 0.0f);
+	sediment.assign(pointCount, 0.0f);
+	newSediment.assign(pointCount, 0.0f);
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		// Each step reads what the step before wrote, so each has to finish on every row before the next starts
+		ParallelFor::run(resolution, [this](int startZ, int endZ)
+		{
+			updateFlux(startZ, endZ);
+		});
+
+		ParallelFor::run(resolution, [this](int startZ, int endZ)
+		{
+			updateWater(startZ, endZ);
+		});
+
+		water.swap(newWater);
+
+		ParallelFor::run(resolution, [this](int startZ, int endZ)
+		{
+			erodeDeposit(startZ, endZ);
+		});
+
+		ParallelFor::run(resolution, [this](int startZ, int endZ)
+		{
+			transportSediment(startZ, endZ);
+		});
+
+		sediment.swap(newSediment);
+	}
+
+	// Whatever the water is still carrying settles where it is
+	for (int i = 0; i < pointCount; ++i)
+	{
+		terrain[i] += sediment[i];
+	}
+
+	heightmap.copyFromRowMajor(terrain.data());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::updateFlux(int startZ, int endZ)
+{
+	const float cellArea = cellSize * cellSize;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(fluxScale);
+	const __m128 waterToFlux = _mm_set1_ps(cellArea / timeStep);
+
+	for (int z = startZ; z < endZ; ++z)
+	{
+		// The edge rows and columns have missing neighbours, so they go through the scalar version
+		if (z == 0 || z == resolution - 1)
+		{
+			for (int x = 0; x < resolution; ++x)
+			{
+				updateFluxCell(x, z);
+			}
+
+			continue;
+		}
+
+		updateFluxCell(0, z);
+
+		int x = 1;
+
+		for (; x + 4 <= resolution - 1; x += 4)
+		{
+			const int i = z * resolution + x;
+			const float* b = &terrain[i];
+			const float* d = &water[i];
+
+			__m128 height = _mm_add_ps(_mm_loadu_ps(b), _mm_loadu_ps(d));
+			__m128 left = _mm_add_ps(_mm_loadu_ps(b - 1), _mm_loadu_ps(d - 1));
+			__m128 right = _mm_add_ps(_mm_loadu_ps(b + 1), _mm_loadu_ps(d + 1));
+			__m128 up = _mm_add_ps(_mm_loadu_ps(b - resolution), _mm_loadu_ps(d - resolution));
+			__m128 down = _mm_add_ps(_mm_loadu_ps(b + resolution), _mm_loadu_ps(d + resolution));
+
+			__m128 fl = _mm_max_ps(zero, _mm_add_ps(_mm_loadu_ps(&fluxLeft[i]), _mm_mul_ps(scale, _mm_sub_ps(height, left))));
+			__m128 fr = _mm_max_ps(zero, _mm_add_ps(_mm_loadu_ps(&fluxRight[i]), _mm_mul_ps(scale, _mm_sub_ps(height, right))));
+			__m128 fu = _mm_max_ps(zero, _mm_add_ps(_mm_loadu_ps(&fluxUp[i]), _mm_mul_ps(scale, _mm_sub_ps(height, up))));
+			__m128 fd = _mm_max_ps(zero, _mm_add_ps(_mm_loadu_ps(&fluxDown[i]), _mm_mul_ps(scale, _mm_sub_ps(height, down))));
+
+			// Scale the flux down if it would take more water than there is, the max() keeps 0 / 0 out
+			__m128 total = _mm_add_ps(_mm_add_ps(fl, fr), _mm_add_ps(fu, fd));
+			__m128 available = _mm_mul_ps(_mm_loadu_ps(d), waterToFlux);
+			__m128 k = _mm_min_ps(one, _mm_div_ps(available, _mm_max_ps(total, _mm_set1_ps(1e-20f))));
+
+			_mm_storeu_ps(&fluxLeft[i], _mm_mul_ps(fl, k));
+			_mm_storeu_ps(&fluxRight[i], _mm_mul_ps(fr, k));
+			_mm_storeu_ps(&fluxUp[i], _mm_mul_ps(fu, k));
+			_mm_storeu_ps(&fluxDown[i], _mm_mul_ps(fd, k));
+		}
+
+		// Whatever is left over, and the last column
+		for (; x < resolution; ++x)
+		{
+			updateFluxCell(x, z);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::updateFluxCell(int x, int z)
+{
+	const int i = z * resolution + x;
+	const float height = terrain[i] + water[i];
+
+	// No water leaves the map, so there are no pipes off the edges
+	float fl = 0.0f, fr = 0.0f, fu = 0.0f, fd = 0.0f;
+
+	if (x > 0)
+	{
+		fl = std::max(0.0f, fluxLeft[i] + fluxScale * (height - (terrain[i - 1] + water[i - 1])));
+	}
+
+	if (x < resolution - 1)
+	{
+		fr = std::max(0.0f, fluxRight[i] + fluxScale * (height - (terrain[i + 1] + water[i + 1])));
+	}
+
+	if (z > 0)
+	{
+		fu = std::max(0.0f, fluxUp[i] + fluxScale * (height - (terrain[i - resolution] + water[i - resolution])));
+	}
+
+	if (z < resolution - 1)
+	{
+		fd = std::max(0.0f, fluxDown[i] + fluxScale * (height - (terrain[i + resolution] + water[i + resolution])));
+	}
+
+	float total = (fl + fr) + (fu + fd);
+	float k = std::min(1.0f, water[i] * (cellSize * cellSize / timeStep) / std::max(total, 1e-20f));
+
+	fluxLeft[i] = fl * k;
+	fluxRight[i] = fr * k;
+	fluxUp[i] = fu * k;
+	fluxDown[i] = fd * k;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::updateWater(int startZ, int endZ)
+{
+	const float cellArea = cellSize * cellSize;
+
+	for (int z = startZ; z < endZ; ++z)
+	{
+		for (int x = 0; x < resolution; ++x)
+		{
+			const int i = z * resolution + x;
+
+			// What the neighbours send this way, nothing comes in from off the map
+			float fromLeft = x > 0 ? fluxRight[i - 1] : 0.0f;
+			float fromRight = x < resolution - 1 ? fluxLeft[i + 1] : 0.0f;
+			float fromUp = z > 0 ? fluxDown[i - resolution] : 0.0f;
+			float fromDown = z < resolution - 1 ? fluxUp[i + resolution] : 0.0f;
+
+			float inflow = (fromLeft + fromRight) + (fromUp + fromDown);
+			float outflow = (fluxLeft[i] + fluxRight[i]) + (fluxUp[i] + fluxDown[i]);
+
+			float depth = std::max(0.0f, water[i] + timeStep * (inflow - outflow) / cellArea);
+			float averageDepth = 0.5f * (water[i] + depth);
+			newWater[i] = depth;
+
+			// The water passing through in x and z, averaged over both sides of the point
+			float passX = 0.5f * (fromLeft - fluxLeft[i] + fluxRight[i] - fromRight);
+			float passZ = 0.5f * (fromUp - fluxUp[i] + fluxDown[i] - fromDown);
+
+			float velX = 0.0f;
+			float velZ = 0.0f;
+
+			if (averageDepth > MIN_WATER_DEPTH)
+			{
+				velX = passX / (averageDepth * cellSize);
+				velZ = passZ / (averageDepth * cellSize);
+			}
+
+			velocityX[i] = velX;
+			velocityZ[i] = velZ;
+
+			// The terrain's slope from its neighbours, one sided at the edges
+			int left = x > 0 ? i - 1 : i;
+			int right = x < resolution - 1 ? i + 1 : i;
+			int up = z > 0 ? i - resolution : i;
+			int down = z < resolution - 1 ? i + resolution : i;
+
+			float slopeX = (terrain[right] - terrain[left]) / ((right - left) * cellSize);
+			float slopeZ = (terrain[down] - terrain[up]) / (((down - up) / resolution) * cellSize);
+			float slopeSq = slopeX * slopeX + slopeZ * slopeZ;
+
+			// sin of the tilt angle, from tan^2
+			float tilt = std::max(MIN_TILT, sqrtf(slopeSq / (1.0f + slopeSq)));
+
+			capacity[i] = sedimentCapacity * tilt * sqrtf(velX * velX + velZ * velZ) * std::min(1.0f, averageDepth / FULL_CAPACITY_DEPTH);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::erodeDeposit(int startZ, int endZ)
+{
+	// Every point is on its own here, so the rows can be treated as one long run
+	const int start = startZ * resolution;
+	const int end = endZ * resolution;
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 dissolve = _mm_set1_ps(dissolveRate);
+	const __m128 deposit = _mm_set1_ps(depositRate);
+
+	int i = start;
+
+	for (; i + 4 <= end; i += 4)
+	{
+		// Positive when there's spare capacity, so it dissolves, negative when there's too much sediment, so it deposits
+		__m128 spare = _mm_sub_ps(_mm_loadu_ps(&capacity[i]), _mm_loadu_ps(&sediment[i]));
+		__m128 dissolving = _mm_cmpgt_ps(spare, zero);
+		__m128 rate = _mm_or_ps(_mm_and_ps(dissolving, dissolve), _mm_andnot_ps(dissolving, deposit));
+		__m128 amount = _mm_mul_ps(rate, spare);
+
+		_mm_storeu_ps(&terrain[i], _mm_sub_ps(_mm_loadu_ps(&terrain[i]), amount));
+		_mm_storeu_ps(&sediment[i], _mm_add_ps(_mm_loadu_ps(&sediment[i]), amount));
+	}
+
+	for (; i < end; ++i)
+	{
+		float spare = capacity[i] - sediment[i];
+		float amount = (spare > 0.0f ? dissolveRate : depositRate) * spare;
+
+		terrain[i] -= amount;
+		sediment[i] += amount;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::transportSediment(int startZ, int endZ)
+{
+	// The sediment moves the same way as the water did this step, through the pipes, so none is lost or made.
+	// newWater still holds the depths from the start of the step, what each point's flux was scaled against
+	const float toFraction = timeStep / (cellSize * cellSize);
+	const float keep = std::max(0.0f, 1.0f - evaporationRate * timeStep);
+	const float rain = rainRate * timeStep;
+
+	for (int z = startZ; z < endZ; ++z)
+	{
+		for (int x = 0; x < resolution; ++x)
+		{
+			const int i = z * resolution + x;
+
+			// The fraction of a point's water that left it down each pipe, and so the fraction of its sediment
+			float stays = 1.0f - ((fluxLeft[i] + fluxRight[i]) + (fluxUp[i] + fluxDown[i])) * fractionOf(i, toFraction);
+			float carried = sediment[i] * std::max(0.0f, stays);
+
+			if (x > 0)
+			{
+				carried += sediment[i - 1] * fluxRight[i - 1] * fractionOf(i - 1, toFraction);
+			}
+
+			if (x < resolution - 1)
+			{
+				carried += sediment[i + 1] * fluxLeft[i + 1] * fractionOf(i + 1, toFraction);
+			}
+
+			if (z > 0)
+			{
+				carried += sediment[i - resolution] * fluxDown[i - resolution] * fractionOf(i - resolution, toFraction);
+			}
+
+			if (z < resolution - 1)
+			{
+				carried += sediment[i + resolution] * fluxUp[i + resolution] * fractionOf(i + resolution, toFraction);
+			}
+
+			newSediment[i] = carried;
+
+			// Evaporate, then rain for the next time step
+			water[i] = water[i] * keep + rain;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::setRainRate(float rate)
+{
+	rainRate = rate;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::setEvaporationRate(float rate)
+{
+	evaporationRate = rate;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::setSedimentCapacity(float newCapacity)
+{
+	sedimentCapacity = newCapacity;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::setDissolveRate(float rate)
+{
+	dissolveRate = rate;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::setDepositRate(float rate)
+{
+	depositRate = rate;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ShallowWaterErosion::setTimeStep(float step)
+{
+	timeStep = step;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
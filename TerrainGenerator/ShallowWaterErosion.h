@@ -0,0 +1,90 @@
+/*
+ * This is the Shallow Water Erosion class it handles:
+ *		- Running a grid based (pipe model) hydraulic erosion, as an alternative to the droplets in Terrain::erodeTerrain()
+ *		- Raining on the terrain, letting the water flow between neighbouring points through virtual pipes,
+ *		  and evaporating it again
+ *		- Dissolving and depositing sediment depending on how fast the water is flowing, and carrying
+ *		  the sediment along with the water
+ *
+ * Every step of a time step is a stencil over the whole grid, where a point only writes to itself,
+ * so the rows are split between threads, and the flux and erosion steps do 4 points at once with SSE.
+ * TerrainTests' benchmarkShallowWaterScaling times it on 1 thread up to one per core.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <vector>
+#include "HeightMap.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ShallowWaterErosion
+{
+public:
+	ShallowWaterErosion(int& res, HeightMap& heightmp);
+	~ShallowWaterErosion();
+
+	// Starts dry, runs the time steps, and then drops whatever sediment is still being carried
+	// gridScale is the world space distance between neighbouring grid points
+	void erodeTerrain(int iterations, float gridScale);
+
+	void setRainRate(float rate);				// Water height added per second
+	void setEvaporationRate(float rate);		// Fraction of the water lost per second
+	void setSedimentCapacity(float newCapacity);	// How much sediment the water can carry per unit of speed and slope
+	void setDissolveRate(float rate);			// Fraction of the spare capacity picked up per step
+	void setDepositRate(float rate);			// Fraction of the excess sediment dropped per step
+	void setTimeStep(float step);
+
+private:
+	// The water each point sends to its 4 neighbours, scaled so no more can leave than the point holds
+	void updateFlux(int startZ, int endZ);
+	void updateFluxCell(int x, int z);
+	// The new water height from the flux in and out, the water's velocity, and how much sediment it can carry
+	void updateWater(int startZ, int endZ);
+	// Dissolves or deposits sediment towards the capacity, only touches the point itself
+	void erodeDeposit(int startZ, int endZ);
+	// Moves the sediment along the pipes in proportion to the water, then evaporates and rains
+	void transportSediment(int startZ, int endZ);
+
+	// 1 / the water a point started the step with, as a fraction of flux (0 if it was dry, as then it had no flux)
+	inline float fractionOf(int i, float toFraction)
+	{
+		return newWater[i] > 0.0f ? toFraction / newWater[i] : 0.0f;
+	}
+
+	int& resolution;
+	HeightMap& heightmap;
+
+	float rainRate;
+	float evaporationRate;
+	float sedimentCapacity;
+	float dissolveRate;
+	float depositRate;
+	float timeStep;
+
+	// Worked out from the above and the grid scale at the start of erodeTerrain()
+	float cellSize;
+	float fluxScale;
+
+	// Every field is row-major, whatever layout the height map is using, so neighbouring points are next to each other for SSE
+	std::vector<float> terrain;
+	std::vector<float> water;
+	std::vector<float> newWater;
+	std::vector<float> fluxLeft;
+	std::vector<float> fluxRight;
+	std::vector<float> fluxUp;			// Towards z - 1
+	std::vector<float> fluxDown;		// Towards z + 1
+	std::vector<float> velocityX;
+	std::vector<float> velocityZ;
+	std::vector<float> capacity;
+	std::vector<float> sediment;
+	std::vector<float> newSediment;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
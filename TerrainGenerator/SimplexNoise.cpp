@@ -0,0 +1,300 @@
+/*
+ * This is the Simplex Noise class it handles:
+ *		- Executing the 2D Simplex Noise algorithm
+ *		- Executing it for 4 points at once with SSE, for filling whole rows of the height map
+ *		- Returning the analytic derivatives alongside the noise, for normals without a second pass
+ *		- Returning 2 unrelated noise values from the one cell lookup, i.e. for warping both x and z
+ *
+ * Simplex noise splits the plane into triangles rather than squares, so each sample only
+ * blends the gradients of 3 corners, where Improved Perlin (used in 2D with y = 0) needs 8.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "SimplexNoise.h"
+#include <emmintrin.h>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Skew the input space onto the simplex grid, and unskew back again
+const float F2 = 0.366025403f;		// (sqrt(3) - 1) / 2
+const float G2 = 0.211324865f;		// (3 - sqrt(3)) / 6
+
+// Brings the sum of the 3 corners to roughly -1 -> 1
+const float SIMPLEX_SCALE = 40.0f;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+float SimplexNoise::noise(float x, float z, float* dx, float* dz, float* hessian)
+{
+	return noise(x, z, DEFAULT_PERMUTATION, dx, dz, hessian);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SimplexNoise::noise4(const float x[4], const float z[4], float result[4], float dx[4], float dz[4])
+{
+	noise4(x, z, DEFAULT_PERMUTATION, result, dx, dz);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SimplexNoise::noise2(float x, float z, float result[2], float dx[2], float dz[2])
+{
+	noise2(x, z, DEFAULT_PERMUTATION, result, dx, dz);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float SimplexNoise::noise(float x, float z, const PermutationTable& table, float* dx, float* dz, float* hessian)
+{
+	// Ref:
+	// Gustavson, S. (2005) Simplex noise demystified
+	// https://weber.itn.liu.se/~stegu/simplexnoise/simplexnoise.pdf
+
+	float cornerX[3], cornerZ[3], falloff[3];
+	int hashes[3];
+	findCorners(x, z, table.p, cornerX, cornerZ, falloff, hashes);
+
+	float result = 0.0f;
+	float derivX = 0.0f;
+	float derivZ = 0.0f;
+	float secondDerivs[3] = { 0.0f, 0.0f, 0.0f };
+
+	for (int c = 0; c < 3; ++c)
+	{
+		// Each corner only reaches a radius of sqrt(0.5), so no interpolation is needed, just sum them
+		float falloffSq = falloff[c] * falloff[c];
+		result += falloffSq * falloffSq * grad(hashes[c], cornerX[c], cornerZ[c]);
+
+		if (dx && dz)
+		{
+			addCornerDerivatives(hashes[c], cornerX[c], cornerZ[c], falloff[c], falloffSq, derivX, derivZ, hessian ? secondDerivs : nullptr);
+		}
+	}
+
+	if (dx && dz)
+	{
+		*dx = SIMPLEX_SCALE * derivX;
+		*dz = SIMPLEX_SCALE * derivZ;
+
+		if (hessian)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				hessian[k] = SIMPLEX_SCALE * secondDerivs[k];
+			}
+		}
+	}
+
+	return SIMPLEX_SCALE * result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SimplexNoise::noise2(float x, float z, const PermutationTable& table, float result[2], float dx[2], float dz[2])
+{
+	/*
+	* Two noise values for the price of one cell lookup.
+	* Both share the corners and the permutation lookups, the second just takes its gradients
+	* from the next 3 bits of each corner's hash, so the two are unrelated to look at.
+	*/
+
+	float cornerX[3], cornerZ[3], falloff[3];
+	int hashes[3];
+	findCorners(x, z, table.p, cornerX, cornerZ, falloff, hashes);
+
+	for (int n = 0; n < 2; ++n)
+	{
+		float sum = 0.0f;
+		float derivX = 0.0f;
+		float derivZ = 0.0f;
+
+		for (int c = 0; c < 3; ++c)
+		{
+			int hash = hashes[c] >> (n * 3);
+			float falloffSq = falloff[c] * falloff[c];
+			sum += falloffSq * falloffSq * grad(hash, cornerX[c], cornerZ[c]);
+
+			if (dx && dz)
+			{
+				addCornerDerivatives(hash, cornerX[c], cornerZ[c], falloff[c], falloffSq, derivX, derivZ, nullptr);
+			}
+		}
+
+		result[n] = SIMPLEX_SCALE * sum;
+
+		if (dx && dz)
+		{
+			dx[n] = SIMPLEX_SCALE * derivX;
+			dz[n] = SIMPLEX_SCALE * derivZ;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SimplexNoise::findCorners(float x, float z, const int* p, float cornerX[3], float cornerZ[3], float falloff[3], int hashes[3])
+{
+	// Which simplex cell are we in
+	float s = (x + z) * F2;
+	float i = floorf(x + s);
+	float j = floorf(z + s);
+	float t = (i + j) * G2;
+
+	// Distance from the cell origin, back in normal space
+	float x0 = x - (i - t);
+	float z0 = z - (j - t);
+
+	// The cell is two triangles, the lower one if x0 > z0, so the middle corner is either (1, 0) or (0, 1)
+	float i1 = x0 > z0 ? 1.0f : 0.0f;
+	float j1 = 1.0f - i1;
+
+	cornerX[0] = x0;
+	cornerZ[0] = z0;
+	cornerX[1] = x0 - i1 + G2;
+	cornerZ[1] = z0 - j1 + G2;
+	cornerX[2] = x0 - 1.0f + 2.0f * G2;
+	cornerZ[2] = z0 - 1.0f + 2.0f * G2;
+
+	int ii = (int)i & 255;
+	int jj = (int)j & 255;
+	hashes[0] = p[ii + p[jj]];
+	hashes[1] = p[ii + (int)i1 + p[jj + (int)j1]];
+	hashes[2] = p[ii + 1 + p[jj + 1]];
+
+	// Anything past the corner's radius clamps to 0
+	for (int c = 0; c < 3; ++c)
+	{
+		float f = 0.5f - cornerX[c] * cornerX[c] - cornerZ[c] * cornerZ[c];
+		falloff[c] = f < 0.0f ? 0.0f : f;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SimplexNoise::noise4(const float x[4], const float z[4], const PermutationTable& table, float result[4], float dx[4], float dz[4])
+{
+	/*
+	* The same steps as noise(), with a point in each SSE lane.
+	* SSE2 has no gather, so only the permutation lookups are done a lane at a time,
+	* everything else (skewing, corner offsets, gradients and falloff) is done 4 wide.
+	*/
+
+	const int* p = table.p;
+
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 g2 = _mm_set1_ps(G2);
+
+	__m128 vx = _mm_loadu_ps(x);
+	__m128 vz = _mm_loadu_ps(z);
+
+	__m128 s = _mm_mul_ps(_mm_add_ps(vx, vz), _mm_set1_ps(F2));
+	__m128 xs = _mm_add_ps(vx, s);
+	__m128 zs = _mm_add_ps(vz, s);
+
+	// Floor, truncate then take 1 off anything that was rounded up (negatives)
+	__m128 i = _mm_cvtepi32_ps(_mm_cvttps_epi32(xs));
+	__m128 j = _mm_cvtepi32_ps(_mm_cvttps_epi32(zs));
+	i = _mm_sub_ps(i, _mm_and_ps(_mm_cmpgt_ps(i, xs), one));
+	j = _mm_sub_ps(j, _mm_and_ps(_mm_cmpgt_ps(j, zs), one));
+
+	__m128 t = _mm_mul_ps(_mm_add_ps(i, j), g2);
+	__m128 x0 = _mm_sub_ps(vx, _mm_sub_ps(i, t));
+	__m128 z0 = _mm_sub_ps(vz, _mm_sub_ps(j, t));
+
+	__m128 lower = _mm_cmpgt_ps(x0, z0);
+	__m128 i1 = _mm_and_ps(lower, one);
+	__m128 j1 = _mm_andnot_ps(lower, one);
+
+	__m128 x1 = _mm_add_ps(_mm_sub_ps(x0, i1), g2);
+	__m128 z1 = _mm_add_ps(_mm_sub_ps(z0, j1), g2);
+	__m128 x2 = _mm_add_ps(_mm_sub_ps(x0, one), _mm_set1_ps(2.0f * G2));
+	__m128 z2 = _mm_add_ps(_mm_sub_ps(z0, one), _mm_set1_ps(2.0f * G2));
+
+	// Hash the corners a lane at a time
+	alignas(16) int cellX[4];
+	alignas(16) int cellZ[4];
+	alignas(16) int hashes[3][4];
+
+	const __m128i mask = _mm_set1_epi32(255);
+	_mm_store_si128((__m128i*)cellX, _mm_and_si128(_mm_cvttps_epi32(i), mask));
+	_mm_store_si128((__m128i*)cellZ, _mm_and_si128(_mm_cvttps_epi32(j), mask));
+	int lowerBits = _mm_movemask_ps(lower);
+
+	for (int lane = 0; lane < 4; ++lane)
+	{
+		int ii = cellX[lane];
+		int jj = cellZ[lane];
+		int mid = (lowerBits >> lane) & 1;
+
+		hashes[0][lane] = p[ii + p[jj]];
+		hashes[1][lane] = p[ii + mid + p[jj + 1 - mid]];
+		hashes[2][lane] = p[ii + 1 + p[jj + 1]];
+	}
+
+	const __m128 cornerX[3] = { x0, x1, x2 };
+	const __m128 cornerZ[3] = { z0, z1, z2 };
+	const __m128i seven = _mm_set1_epi32(7);
+	const __m128i four = _mm_set1_epi32(4);
+	const __m128i bit0 = _mm_set1_epi32(1);
+	const __m128i bit1 = _mm_set1_epi32(2);
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+
+	__m128 sum = zero;
+	__m128 sumDx = zero;
+	__m128 sumDz = zero;
+
+	for (int c = 0; c < 3; ++c)
+	{
+		__m128i h = _mm_and_si128(_mm_load_si128((const __m128i*)hashes[c]), seven);
+
+		// Same as grad(), u = h < 4 ? x : z, v = h < 4 ? z : x, then the sign flips from bits 0 and 1
+		__m128 low = _mm_castsi128_ps(_mm_cmplt_epi32(h, four));
+		__m128 u = _mm_or_ps(_mm_and_ps(low, cornerX[c]), _mm_andnot_ps(low, cornerZ[c]));
+		__m128 v = _mm_or_ps(_mm_and_ps(low, cornerZ[c]), _mm_andnot_ps(low, cornerX[c]));
+
+		__m128 flipU = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, bit0), bit0));
+		__m128 flipV = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, bit1), bit1));
+		u = _mm_xor_ps(u, _mm_and_ps(flipU, signBit));
+		v = _mm_xor_ps(_mm_mul_ps(_mm_set1_ps(2.0f), v), _mm_and_ps(flipV, signBit));
+		__m128 gradient = _mm_add_ps(u, v);
+
+		// Falloff, anything past the corner's radius clamps to 0
+		__m128 falloff = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.5f), _mm_mul_ps(cornerX[c], cornerX[c])), _mm_mul_ps(cornerZ[c], cornerZ[c]));
+		falloff = _mm_max_ps(falloff, zero);
+		__m128 falloffSq = _mm_mul_ps(falloff, falloff);
+		__m128 falloff4 = _mm_mul_ps(falloffSq, falloffSq);
+
+		sum = _mm_add_ps(sum, _mm_mul_ps(falloff4, gradient));
+
+		// Same as addCornerDerivatives(), the gradient vector is (+/-1, +/-2) or (+/-2, +/-1)
+		__m128 gu = _mm_or_ps(one, _mm_and_ps(flipU, signBit));
+		__m128 gv = _mm_or_ps(_mm_set1_ps(2.0f), _mm_and_ps(flipV, signBit));
+		__m128 gx = _mm_or_ps(_mm_and_ps(low, gu), _mm_andnot_ps(low, gv));
+		__m128 gz = _mm_or_ps(_mm_and_ps(low, gv), _mm_andnot_ps(low, gu));
+
+		__m128 slope = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(8.0f), _mm_mul_ps(falloffSq, falloff)), gradient);
+		sumDx = _mm_add_ps(sumDx, _mm_sub_ps(_mm_mul_ps(falloff4, gx), _mm_mul_ps(slope, cornerX[c])));
+		sumDz = _mm_add_ps(sumDz, _mm_sub_ps(_mm_mul_ps(falloff4, gz), _mm_mul_ps(slope, cornerZ[c])));
+	}
+
+	const __m128 scale = _mm_set1_ps(SIMPLEX_SCALE);
+	_mm_storeu_ps(result, _mm_mul_ps(scale, sum));
+
+	if (dx && dz)
+	{
+		_mm_storeu_ps(dx, _mm_mul_ps(scale, sumDx));
+		_mm_storeu_ps(dz, _mm_mul_ps(scale, sumDz));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -0,0 +1,83 @@
+/*
+ * This is the Simplex Noise class it handles:
+ *		- Executing the 2D Simplex Noise algorithm
+ *		- Executing it for 4 points at once with SSE, for filling whole rows of the height map
+ *		- Returning the analytic derivatives alongside the noise, for normals without a second pass
+ *		- Returning 2 unrelated noise values from the one cell lookup, i.e. for warping both x and z
+ *
+ * Simplex noise splits the plane into triangles rather than squares, so each sample only
+ * blends the gradients of 3 corners, where Improved Perlin (used in 2D with y = 0) needs 8.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include "NoiseTables.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class SimplexNoise
+{
+public:
+	// Returns roughly -1 -> 1, and if dx/dz are given the partial derivatives in x and z
+	// If hessian is given too it's filled with the second derivatives { dxx, dxz, dzz }
+	static float noise(float x, float z, float* dx = nullptr, float* dz = nullptr, float* hessian = nullptr);
+	// The same as noise(), for the 4 points (x[i], z[i])
+	static void noise4(const float x[4], const float z[4], float result[4], float dx[4] = nullptr, float dz[4] = nullptr);
+	// 2 noise values at (x, z) sharing the corners and permutation lookups, and their derivatives if dx/dz are given
+	static void noise2(float x, float z, float result[2], float dx[2] = nullptr, float dz[2] = nullptr);
+
+	// The same again, using the given permutation rather than Ken Perlin's, see NoiseTables.h
+	static float noise(float x, float z, const PermutationTable& table, float* dx = nullptr, float* dz = nullptr, float* hessian = nullptr);
+	static void noise4(const float x[4], const float z[4], const PermutationTable& table, float result[4], float dx[4] = nullptr, float dz[4] = nullptr);
+	static void noise2(float x, float z, const PermutationTable& table, float result[2], float dx[2] = nullptr, float dz[2] = nullptr);
+
+private:
+	// The simplex cell's 3 corners, as offsets from (x, z), with their falloffs and hashes
+	static void findCorners(float x, float z, const int* p, float cornerX[3], float cornerZ[3], float falloff[3], int hashes[3]);
+
+	static inline float grad(int hash, float x, float z)
+	{
+		// 8 gradient directions, (+/-1, +/-2) and (+/-2, +/-1)
+		int h = hash & 7;
+		float u = h < 4 ? x : z;
+		float v = h < 4 ? z : x;
+
+		return ((h & 1) ? -u : u) + ((h & 2) ? -2.0f * v : 2.0f * v);
+	}
+
+	// Adds the derivatives of one corner's contribution, t^4 * grad(), where t = 0.5 - x^2 - z^2
+	static inline void addCornerDerivatives(int hash, float x, float z, float t, float t2, float& dx, float& dz, float* hessian)
+	{
+		int h = hash & 7;
+		float gu = (h & 1) ? -1.0f : 1.0f;
+		float gv = (h & 2) ? -2.0f : 2.0f;
+		float gx = h < 4 ? gu : gv;
+		float gz = h < 4 ? gv : gu;
+		float g = gx * x + gz * z;
+
+		// d(t^4 * g) = t^4 * dg + 4t^3 * dt * g, and dt = -2x (or -2z)
+		float t3 = t2 * t;
+		dx += t2 * t2 * gx - 8.0f * t3 * x * g;
+		dz += t2 * t2 * gz - 8.0f * t3 * z * g;
+
+		if (hessian)
+		{
+			// Differentiating again, d2t = -2 on the diagonal and 0 off it
+			hessian[0] += -8.0f * t3 * (2.0f * x * gx + g) + 48.0f * t2 * x * x * g;
+			hessian[1] += -8.0f * t3 * (z * gx + x * gz) + 48.0f * t2 * x * z * g;
+			hessian[2] += -8.0f * t3 * (2.0f * z * gz + g) + 48.0f * t2 * z * z * g;
+		}
+	}
+
+	// Private constructors/destructors, i.e. you cannot create and instance of this class
+	SimplexNoise() {};
+	~SimplexNoise() {};
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
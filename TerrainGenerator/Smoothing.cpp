@@ -13,7 +13,7 @@
 #include "Smoothing.h"
 
 // CONSTRUCTOR / DESTRUCTOR
-Smoothing::Smoothing(int& res, float* heightmp, const int& terrainSize) : resolution(res), heightmap(heightmp), terrainSz(terrainSize)
+Smoothing::Smoothing(int& res, HeightMap& heightmp, const int& terrainSize) : resolution(res), heightmap(heightmp), terrainSz(terrainSize)
 {
 
 }
@@ -33,7 +33,8 @@ void Smoothing::smoothTerrain()
 	// while we are still operating on it to calculate the avgerages for each index pos
 	// Once all avg values have been calculated and this temp has been populated
 	// Copy the data from this structure back into the original, overwriting the original data
-	float* tempHeightMap = new float[resolution * resolution];
+	// The temp map uses the same layout as the height map, so it can be copied straight back
+	float* tempHeightMap = new float[heightmap.getStorageSize()];
 
 	// Scale everything so that the look is consistent across terrain resolutions
 	//const float scale = terrainSz / (float)resolution;
@@ -48,33 +49,33 @@ void Smoothing::smoothTerrain()
 			// Check left, ensure no LEFT checks are carried out until our 'x' index pos is >= 1 or we will go OOB
 			if (x >= 1)
 			{
-				windowTotal += heightmap[(z * resolution) + (x - 1)];
+				windowTotal += heightmap.at(x - 1, z);
 				++sectionsTotalled;
 			}
 
 			// Check up, ensure no UP checks are carried out until our 'y' index pos is >= 1 or we will go OOB
 			if (z >= 1)
 			{
-				windowTotal += heightmap[((z - 1) * resolution) + x];
+				windowTotal += heightmap.at(x, z - 1);
 				++sectionsTotalled;
 			}
 
 			// Check right, ensure no RIGHT checks are carried out if our 'x' index pos is == resolution or we will go OOB
 			if (x < (resolution - 1))
 			{
-				windowTotal += heightmap[(z * resolution) + (x + 1)];
+				windowTotal += heightmap.at(x + 1, z);
 				++sectionsTotalled;
 			}
 
 			// Check down, ensure no DOWN checks are carried out if our 'y' index pos is == resolution or we will go OOB
 			if (z < (resolution - 1))
 			{
-				windowTotal += heightmap[((z + 1) * resolution) + x];
+				windowTotal += heightmap.at(x, z + 1);
 				++sectionsTotalled;
 			}
 
 			// Set new smooth data.
-			tempHeightMap[(z * resolution) + x] = (heightmap[(z * resolution) + x] + (windowTotal / sectionsTotalled)) * 0.5f;
+			tempHeightMap[heightmap.index(x, z)] = (heightmap.at(x, z) + (windowTotal / sectionsTotalled)) * 0.5f;
 		}
 	}
 
@@ -84,7 +85,7 @@ void Smoothing::smoothTerrain()
 	{
 		for (int x = 0; x < resolution; ++x)
 		{
-			heightmap[(z * resolution) + x] = tempHeightMap[(z * resolution) + x];
+			heightmap.at(x, z) = tempHeightMap[heightmap.index(x, z)];
 		}
 	}
 
@@ -11,13 +11,14 @@
 
 // INCLUDES
 #pragma once
+#include "HeightMap.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 class Smoothing
 {
 public:
-	Smoothing(int& res, float* heightmp, const int& terrainSize);
+	Smoothing(int& res, HeightMap& heightmp, const int& terrainSize);
 	~Smoothing();
 
 	void smoothTerrain();
@@ -26,7 +27,7 @@ private:
 	int& resolution;
 	const int& terrainSz;
 
-	float* heightmap;
+	HeightMap& heightmap;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
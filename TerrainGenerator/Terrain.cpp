@@ -4,7 +4,19 @@
  *		- Regenerating the terrain mesh after modifications
  *		- Setting up the terrain mesh buffers
  *		- Passing information from the App class to respective terrain features classes
- *		- Running the Hydraulic Erosion algorithm
+ *		- Passing Hydraulic Erosion requests to the hydraulic erosion class, either all at once or a slice at a time
+ *		- Running Hydraulic Erosion coarse to fine, through the pyramid erosion class
+ *		- Passing Thermal Erosion requests to the thermal erosion class
+ *		- Passing grid based (shallow water) Hydraulic Erosion requests to the shallow water erosion class
+ *		- Optionally recording the Hydraulic Erosion's flow, erosion and deposition into maps, for export and texturing
+ *		- Keeping a history of height map snapshots, for undo, redo and comparing versions
+ *		- Exporting the height map, as a 16 bit PNG, raw heights or compressed tiles
+ *		- Importing a height map from a file, resampled to the terrain's resolution
+ *		- Keeping a padded copy of the heights for batched bilinear height and gradient queries
+ *		- Casting rays against the terrain and finding the ground height, for picking, the camera and placing objects
+ *		- Scattering trees over the terrain, by slope, height and the recorded erosion flow
+ *		- Choosing which terrain chunks to draw, and at what LOD
+ *		- Culling the terrain chunks that are outside the camera frustum
  *
  * Original @author Abertay University.
  * Updated by @author D. Green.
@@ -17,6 +29,7 @@
 #include "Terrain.h"
 #include "Particle.h"
 #include <algorithm>
+#include <cfloat>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -29,9 +42,6 @@ Terrain::Terrain(ID3D11Device* device, ID3D11DeviceContext* deviceContext, int r
 
 Terrain::~Terrain()
 {
-	delete[] heightMap;
-	heightMap = 0;
-
 	if (faulting)
 	{
 		delete faulting;
@@ -55,6 +65,54 @@ Terrain::~Terrain()
 		delete smoothing;
 		smoothing = nullptr;
 	}
+
+	if (worleyNoise)
+	{
+		delete worleyNoise;
+		worleyNoise = nullptr;
+	}
+
+	if (thermalErosion)
+	{
+		delete thermalErosion;
+		thermalErosion = nullptr;
+	}
+
+	if (shallowWaterErosion)
+	{
+		delete shallowWaterErosion;
+		shallowWaterErosion = nullptr;
+	}
+
+	if (erosionSession)
+	{
+		delete erosionSession;
+		erosionSession = nullptr;
+	}
+
+	if (hydraulicErosion)
+	{
+		delete hydraulicErosion;
+		hydraulicErosion = nullptr;
+	}
+
+	if (pyramidErosion)
+	{
+		delete pyramidErosion;
+		pyramidErosion = nullptr;
+	}
+
+	if (erosionMapView)
+	{
+		erosionMapView->Release();
+		erosionMapView = NULL;
+	}
+
+	if (erosionMapTexture)
+	{
+		erosionMapTexture->Release();
+		erosionMapTexture = NULL;
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -84,6 +142,12 @@ void Terrain::initTerrainObjects()
 	particleDepo = new ParticleDeposition(resolution, heightMap);
 	perlinNoise = new PerlinNoise(resolution, heightMap, terrainSize);
 	smoothing = new Smoothing(resolution, heightMap, terrainSize);
+	worleyNoise = new WorleyNoise(resolution, heightMap);
+	thermalErosion = new ThermalErosion(resolution, heightMap);
+	shallowWaterErosion = new ShallowWaterErosion(resolution, heightMap);
+	hydraulicErosion = new HydraulicErosion(resolution, heightMap, erosionBrushes);
+	erosionSession = new ErosionSession(*hydraulicErosion);
+	pyramidErosion = new PyramidErosion(resolution, heightMap, erosionBrushes);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -92,13 +156,45 @@ void Terrain::resize(int& newResolution)
 {
 	newTerrain = true;
 
+	// A run can't carry on at a different size, its maps are added to the old ones before they're resized below
+	// On the first resize from initTerrain() the erosion objects don't exist yet
+	if (erosionSession)
+	{
+		erosionSession->cancel();
+	}
+
 	resolution = newResolution;
 
-	// Clean up old heightMap before reassinging or we'll have a mem leak
-	delete[] heightMap;
-	heightMap = 0;
-	
-	heightMap = new float[resolution * resolution];
+	// Keep whichever layout is in use
+	heightMap.resize(resolution, heightMap.getLayout());
+	rowMajorHeights.resize(resolution * resolution);
+
+	// The new map is flat, so its gradient is 0 everywhere
+	noiseGradientX.assign(resolution * resolution, 0.0f);
+	noiseGradientZ.assign(resolution * resolution, 0.0f);
+	analyticGradients = true;
+
+	// Brushes are kept per resolution, the old resolution's are no use now
+	erosionBrushes.clear();
+
+	// Snapshots can't be put back into a different size map
+	history.clear();
+
+	// Nothing has been eroded at the new size yet, and the texture is the wrong size
+	erosionMaps.resize(resolution, heightMap.getLayout());
+	erosionMapsChanged = true;
+
+	if (erosionMapView != NULL)
+	{
+		erosionMapView->Release();
+		erosionMapView = NULL;
+	}
+
+	if (erosionMapTexture != NULL)
+	{
+		erosionMapTexture->Release();
+		erosionMapTexture = NULL;
+	}
 
 	if (vertexBuffer != NULL)
 	{
@@ -106,15 +202,14 @@ void Terrain::resize(int& newResolution)
 	}
 
 	vertexBuffer = NULL;
-}
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// The index buffer depends on the resolution too
+	if (indexBuffer != NULL)
+	{
+		indexBuffer->Release();
+	}
 
-void Terrain::updateHeightMap()
-{
-	faulting->updateHeightMap(heightMap);
-	particleDepo->updateHeightMap(heightMap);
-	perlinNoise->updateHeightMap(heightMap);
+	indexBuffer = NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -122,12 +217,8 @@ void Terrain::updateHeightMap()
 // Generate all the vertices and indice in our terrain
 void Terrain::generateTerrain(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
 {
-	VertexType* vertices;
-	unsigned long* indices;
-	int index, i, j;
-	float positionX, height, positionZ, u, v, increment;
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData, indexData;
+	TerrainVertexType* vertices;
+	int i, j;
 
 	if (newTerrain)
 	{
@@ -135,166 +226,163 @@ void Terrain::generateTerrain(ID3D11Device* device, ID3D11DeviceContext* deviceC
 		newTerrain = false;
 	}
 
+	heightsChanged = true;
+
 	// Calculate the number of vertices in the terrain mesh.
 	// We share vertices in this mesh, so the vertex count is simply the terrain 'resolution'
-	// and the index count is the number of resulting triangles * 3 OR the number of quads * 6
 	vertexCount = resolution * resolution;
+	vertices = new TerrainVertexType[vertexCount];
 
-	indexCount = ((resolution - 1) * (resolution - 1)) * 6;
-	vertices = new VertexType[vertexCount];
-	indices = new unsigned long[indexCount];
-
-	index = 0;
-
-	// UV coords.
-	u = 0;
-	v = 0;
-	increment = uvScale / resolution;
-
+	// The x/z positions and UVs are NOT stored in the vertices, the vertex shader rebuilds them from the vertex ID
+	// using these values, see getGridScale() and getUVIncrement()
 	//Scale everything so that the look is consistent across terrain resolutions
-	const float scale = terrainSize / (float)resolution;
+	const float scale = getGridScale();
 
-	//Set up vertices
-	for (j = 0; j < (resolution); j++)
-	{
-		for (i = 0; i < (resolution); i++)
-		{
-			positionX = (float)i * scale;
-			positionZ = (float)(j)*scale;
+	// The index list only depends on the resolution, so it's only rebuilt when the vertex buffer has been released by resize()
+	// It holds every chunk at every LOD, getDrawRanges() picks out what to draw each frame
+	std::vector<unsigned long> indices;
 
-			height = heightMap[index];
-			vertices[index].position = XMFLOAT3(positionX, height, positionZ);
-			vertices[index].texture = XMFLOAT2(u, v);
+	// The vertex buffer is always in row-major order, whatever layout the height map is using
+	heightMap.copyToRowMajor(rowMajorHeights.data());
+	updateHeightQueries();
 
-			u += increment;
-			index++;
-		}
-
-		u = 0;
-		v += increment;
+	if (vertexBuffer == NULL)
+	{
+		quadtree.build(rowMajorHeights.data(), resolution, scale);
+		quadtree.buildIndices(indices);
+		indexCount = (int)indices.size();
 	}
+	else
+	{
+		quadtree.updateHeights(rowMajorHeights.data());
+	}
+
+	updateChunkBounds();
 
-	//Set up index list
-	index = 0;
+	// Normals are kept as seperate x, y, z arrays so they can be packed 4 at a time
+	std::vector<float> normalX(vertexCount), normalY(vertexCount), normalZ(vertexCount);
 
-	for (j = 0; j < (resolution - 1); j++)
+	if (analyticGradients)
 	{
-		for (i = 0; i < (resolution - 1); i++)
+		// The terrain is only noise, so the normals come straight from the noise's exact gradient
+		// The normal of y = h(x, z) is (-dh/dx, 1, -dh/dz), and the gradients are per grid point so divide by the grid scale
+		for (i = 0; i < vertexCount; i++)
 		{
+			float nx = -noiseGradientX[i] / scale;
+			float nz = -noiseGradientZ[i] / scale;
+			float mag = sqrtf(nx * nx + 1.0f + nz * nz);
 
-			//Build index array
-			indices[index] = (j * resolution) + i;
-			indices[index + 1] = ((j + 1) * resolution) + (i + 1);
-			indices[index + 2] = ((j + 1) * resolution) + i;
-
-			indices[index + 3] = (j * resolution) + i;
-			indices[index + 4] = (j * resolution) + (i + 1);
-			indices[index + 5] = ((j + 1) * resolution) + (i + 1);
-			index += 6;
+			normalX[i] = nx / mag;
+			normalY[i] = 1.0f / mag;
+			normalZ[i] = nz / mag;
 		}
 	}
-
-	//Set up normals
-	for (j = 0; j < (resolution - 1); j++)
+	else
 	{
-		for (i = 0; i < (resolution - 1); i++)
+		std::vector<float> faceNormalX(vertexCount), faceNormalY(vertexCount), faceNormalZ(vertexCount);
+
+		//Set up normals
+		for (j = 0; j < (resolution - 1); j++)
 		{
-			//Calculate the plane normals
-			XMFLOAT3 a, b, c;	//Three corner vertices
-			a = vertices[j * resolution + i].position;
-			b = vertices[j * resolution + i + 1].position;
-			c = vertices[(j + 1) * resolution + i].position;
-
-			//Two edges
-			XMFLOAT3 ab(c.x - a.x, c.y - a.y, c.z - a.z);
-			XMFLOAT3 ac(b.x - a.x, b.y - a.y, b.z - a.z);
-
-			//Calculate the cross product
-			XMFLOAT3 cross;
-			cross.x = ab.y * ac.z - ab.z * ac.y;
-			cross.y = ab.z * ac.x - ab.x * ac.z;
-			cross.z = ab.x * ac.y - ab.y * ac.x;
-			float mag = (cross.x * cross.x) + (cross.y * cross.y) + (cross.z * cross.z);
-			mag = sqrtf(mag);
-			cross.x /= mag;
-			cross.y /= mag;
-			cross.z /= mag;
-			vertices[j * resolution + i].normal = cross;
+			for (i = 0; i < (resolution - 1); i++)
+			{
+				//Calculate the plane normals from the three corner vertices
+				//a = (i, j), b = (i + 1, j), c = (i, j + 1)
+				float heightA = heightMap.at(i, j);
+				float heightB = heightMap.at(i + 1, j);
+				float heightC = heightMap.at(i, j + 1);
+
+				//Two edges
+				XMFLOAT3 ab(0.0f, heightC - heightA, scale);
+				XMFLOAT3 ac(scale, heightB - heightA, 0.0f);
+
+				//Calculate the cross product
+				XMFLOAT3 cross;
+				cross.x = ab.y * ac.z - ab.z * ac.y;
+				cross.y = ab.z * ac.x - ab.x * ac.z;
+				cross.z = ab.x * ac.y - ab.y * ac.x;
+				float mag = (cross.x * cross.x) + (cross.y * cross.y) + (cross.z * cross.z);
+				mag = sqrtf(mag);
+				faceNormalX[j * resolution + i] = cross.x / mag;
+				faceNormalY[j * resolution + i] = cross.y / mag;
+				faceNormalZ[j * resolution + i] = cross.z / mag;
+			}
 		}
-	}
 
-	//Smooth the normals by averaging the normals from the surrounding planes
-	XMFLOAT3 smoothedNormal(0, 1, 0);
+		//Smooth the normals by averaging the normals from the surrounding planes
+		XMFLOAT3 smoothedNormal(0, 1, 0);
 
-	for (j = 0; j < resolution; j++)
-	{
-		for (i = 0; i < resolution; i++)
+		for (j = 0; j < resolution; j++)
 		{
-			smoothedNormal.x = 0;
-			smoothedNormal.y = 0;
-			smoothedNormal.z = 0;
-			float count = 0;
-
-			//Left planes
-			if ((i - 1) >= 0)
+			for (i = 0; i < resolution; i++)
 			{
-				//Top planes
-				if ((j) < (resolution - 1))
-				{
-					smoothedNormal.x += vertices[j * resolution + (i - 1)].normal.x;
-					smoothedNormal.y += vertices[j * resolution + (i - 1)].normal.y;
-					smoothedNormal.z += vertices[j * resolution + (i - 1)].normal.z;
-					count++;
-				}
-				//Bottom planes
-				if ((j - 1) >= 0)
-				{
-					smoothedNormal.x += vertices[(j - 1) * resolution + (i - 1)].normal.x;
-					smoothedNormal.y += vertices[(j - 1) * resolution + (i - 1)].normal.y;
-					smoothedNormal.z += vertices[(j - 1) * resolution + (i - 1)].normal.z;
-					count++;
-				}
-			}
+				smoothedNormal.x = 0;
+				smoothedNormal.y = 0;
+				smoothedNormal.z = 0;
+				float count = 0;
 
-			//right planes
-			if ((i) < (resolution - 1))
-			{
-				//Top planes
-				if ((j) < (resolution - 1))
+				//Left planes
+				if ((i - 1) >= 0)
 				{
-					smoothedNormal.x += vertices[j * resolution + i].normal.x;
-					smoothedNormal.y += vertices[j * resolution + i].normal.y;
-					smoothedNormal.z += vertices[j * resolution + i].normal.z;
-					count++;
+					//Top planes
+					if ((j) < (resolution - 1))
+					{
+						smoothedNormal.x += faceNormalX[j * resolution + (i - 1)];
+						smoothedNormal.y += faceNormalY[j * resolution + (i - 1)];
+						smoothedNormal.z += faceNormalZ[j * resolution + (i - 1)];
+						count++;
+					}
+					//Bottom planes
+					if ((j - 1) >= 0)
+					{
+						smoothedNormal.x += faceNormalX[(j - 1) * resolution + (i - 1)];
+						smoothedNormal.y += faceNormalY[(j - 1) * resolution + (i - 1)];
+						smoothedNormal.z += faceNormalZ[(j - 1) * resolution + (i - 1)];
+						count++;
+					}
 				}
 
-				//Bottom planes
-				if ((j - 1) >= 0)
+				//right planes
+				if ((i) < (resolution - 1))
 				{
-					smoothedNormal.x += vertices[(j - 1) * resolution + i].normal.x;
-					smoothedNormal.y += vertices[(j - 1) * resolution + i].normal.y;
-					smoothedNormal.z += vertices[(j - 1) * resolution + i].normal.z;
-					count++;
-				}
-			}
+					//Top planes
+					if ((j) < (resolution - 1))
+					{
+						smoothedNormal.x += faceNormalX[j * resolution + i];
+						smoothedNormal.y += faceNormalY[j * resolution + i];
+						smoothedNormal.z += faceNormalZ[j * resolution + i];
+						count++;
+					}
 
-			smoothedNormal.x /= count;
-			smoothedNormal.y /= count;
-			smoothedNormal.z /= count;
+					//Bottom planes
+					if ((j - 1) >= 0)
+					{
+						smoothedNormal.x += faceNormalX[(j - 1) * resolution + i];
+						smoothedNormal.y += faceNormalY[(j - 1) * resolution + i];
+						smoothedNormal.z += faceNormalZ[(j - 1) * resolution + i];
+						count++;
+					}
+				}
 
-			float mag = sqrt((smoothedNormal.x * smoothedNormal.x) + (smoothedNormal.y * smoothedNormal.y) + (smoothedNormal.z * smoothedNormal.z));
-			smoothedNormal.x /= mag;
-			smoothedNormal.y /= mag;
-			smoothedNormal.z /= mag;
+				smoothedNormal.x /= count;
+				smoothedNormal.y /= count;
+				smoothedNormal.z /= count;
 
-			vertices[j * resolution + i].normal = smoothedNormal;
+				float mag = sqrt((smoothedNormal.x * smoothedNormal.x) + (smoothedNormal.y * smoothedNormal.y) + (smoothedNormal.z * smoothedNormal.z));
+				normalX[j * resolution + i] = smoothedNormal.x / mag;
+				normalY[j * resolution + i] = smoothedNormal.y / mag;
+				normalZ[j * resolution + i] = smoothedNormal.z / mag;
+			}
 		}
 	}
 
+	// Pack the heights and normals into the compact vertex stream
+	TerrainVertexPacker::packVertices(rowMajorHeights.data(), normalX.data(), normalY.data(), normalZ.data(), vertexCount, vertices);
+
 	// Create our dyanmic Vertex and Index buffers with the vertex and index data
 	if (vertexBuffer == NULL)
 	{
-		createBuffers(device, vertices, indices);
+		createBuffers(device, vertices, indices.data());
 	}
 	else
 	{
@@ -305,7 +393,7 @@ void Terrain::generateTerrain(ID3D11Device* device, ID3D11DeviceContext* deviceC
 		//  Disable GPU access to the vertex buffer data.
 		deviceContext->Map(vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 		//  Update the vertex buffer here.
-		memcpy(mappedResource.pData, vertices, sizeof(VertexType) * vertexCount);
+		memcpy(mappedResource.pData, vertices, sizeof(TerrainVertexType) * vertexCount);
 		//  Reenable GPU access to the vertex buffer data.
 		deviceContext->Unmap(vertexBuffer, 0);
 	}
@@ -313,8 +401,29 @@ void Terrain::generateTerrain(ID3D11Device* device, ID3D11DeviceContext* deviceC
 	// Release the arrays now that the buffers have been created and loaded.
 	delete[] vertices;
 	vertices = 0;
-	delete[] indices;
-	indices = 0;
+
+	if (erosionMapsChanged)
+	{
+		updateErosionMapTexture(device, deviceContext);
+		erosionMapsChanged = false;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The terrain uses its own compact vertex format, so the stride differs from BaseMesh::VertexType
+void Terrain::sendData(ID3D11DeviceContext* deviceContext, D3D_PRIMITIVE_TOPOLOGY top)
+{
+	unsigned int stride;
+	unsigned int offset;
+
+	// Set vertex buffer stride and offset.
+	stride = sizeof(TerrainVertexType);
+	offset = 0;
+
+	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+	deviceContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	deviceContext->IASetPrimitiveTopology(top);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -328,26 +437,49 @@ void Terrain::buildTerrain()
 	// Scale everything so that the look is consistent across terrain resolutions
 	const float scale = terrainSize / (float)resolution;
 
-	for (int j = 0; j < (resolution); j++)
+	heightMap.fill(height);
+
+	// Flat, so the gradient is 0 everywhere
+	std::fill(noiseGradientX.begin(), noiseGradientX.end(), 0.0f);
+	std::fill(noiseGradientZ.begin(), noiseGradientZ.end(), 0.0f);
+	analyticGradients = true;
+
+	// A new terrain has no erosion history
+	erosionMaps.clear();
+	erosionMapsChanged = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The chunk AABBs in the terrain's local space, these follow the heights so need refreshed whenever the terrain is regenerated
+void Terrain::updateChunkBounds()
+{
+	const float scale = getGridScale();
+
+	chunkBounds.clear();
+	chunkBounds.reserve(quadtree.getChunkCount());
+
+	for (int i = 0; i < quadtree.getChunkCount(); ++i)
 	{
-		for (int i = 0; i < (resolution); i++)
-		{
-			heightMap[(j * resolution) + i] = height;
-		}
+		const TerrainChunk& chunk = quadtree.getChunk(i);
+
+		XMFLOAT3 min(chunk.x0 * scale, chunk.minHeight, chunk.z0 * scale);
+		XMFLOAT3 max(chunk.x1 * scale, chunk.maxHeight, chunk.z1 * scale);
+		chunkBounds.add(min, max);
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Create the vertex and index buffers that will be passed along to the graphics card for rendering
-void Terrain::createBuffers(ID3D11Device* device, VertexType* vertices, unsigned long* indices)
+void Terrain::createBuffers(ID3D11Device* device, TerrainVertexType* vertices, unsigned long* indices)
 {
 	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
 	D3D11_SUBRESOURCE_DATA vertexData, indexData;
 
 	// Set up the description of the dyanmic vertex buffer.
 	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType) * vertexCount;
+	vertexBufferDesc.ByteWidth = sizeof(TerrainVertexType) * vertexCount;
 	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	vertexBufferDesc.MiscFlags = 0;
@@ -377,410 +509,425 @@ void Terrain::createBuffers(ID3D11Device* device, VertexType* vertices, unsigned
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void Terrain::updateErosionMapTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+{
+	std::vector<unsigned int> texels;
+	erosionMaps.buildSplatTexels(texels);
+
+	// The texture only depends on the resolution, so it's only recreated when resize() has released it
+	if (erosionMapTexture == NULL)
+	{
+		D3D11_TEXTURE2D_DESC textureDesc;
+		textureDesc.Width = resolution;
+		textureDesc.Height = resolution;
+		textureDesc.MipLevels = 1;
+		textureDesc.ArraySize = 1;
+		textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		textureDesc.SampleDesc.Count = 1;
+		textureDesc.SampleDesc.Quality = 0;
+		textureDesc.Usage = D3D11_USAGE_DEFAULT;
+		textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		textureDesc.CPUAccessFlags = 0;
+		textureDesc.MiscFlags = 0;
+
+		D3D11_SUBRESOURCE_DATA textureData;
+		textureData.pSysMem = texels.data();
+		textureData.SysMemPitch = resolution * sizeof(unsigned int);
+		textureData.SysMemSlicePitch = 0;
+
+		device->CreateTexture2D(&textureDesc, &textureData, &erosionMapTexture);
+		device->CreateShaderResourceView(erosionMapTexture, NULL, &erosionMapView);
+		return;
+	}
+
+	deviceContext->UpdateSubresource(erosionMapTexture, 0, NULL, texels.data(), resolution * sizeof(unsigned int), 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 // ###################### GENERATE TERRAIN EFFECTS ######################
 
 void Terrain::erodeTerrain(int cycles)
 {
-	// Ref:
-	// https://www.firespark.de/resources/downloads/implementation%20of%20a%20methode%20for%20hydraulic%20erosion.pdf
-	// https://github.com/SebLague/Hydraulic-Erosion
-	// http://ranmantaru.com/blog/2011/10/08/water-erosion-on-heightmap-terrain/
+	// The droplets carve into the terrain, so it's no longer just noise
+	analyticGradients = false;
+
+	// All in one go, rand() picks the seed so each run is different, unless srand() has been given a fixed seed
+	erosionSession->start(cycles, (unsigned int)rand(), recordErosionMaps ? &erosionMaps : nullptr);
+	erosionSession->runDroplets(cycles);
 
-	// Ref:
-	// Laugue, S (2019), Hydraulic-Erosion Version(Unknown) [Source code]. https://github.com/SebLague/Hydraulic-Erosion
+	erosionMapsChanged = erosionMapsChanged || recordErosionMaps;
+}
 
-	/*
-	* The following was built using the above links, it mostly follows the
-	* first pdf paper, which is also the source for the second link.
-	* The third link is similar in nature again in using the droplet method
-	* This code has been adapted, modified, and updated by me, and in places,
-	* to best suit the needs of the application and the aesthetics. 
-	* 
-	 */
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	int currentErosionRadius = 0;
+void Terrain::startErosion(int cycles, unsigned int seed)
+{
+	analyticGradients = false;
+
+	erosionSession->start(cycles, seed, recordErosionMaps ? &erosionMaps : nullptr);
+}
 
-	if (erosionBrushIndicesVec.size() == 0 || currentErosionRadius != erosionRadius)
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int Terrain::advanceErosion(float milliseconds)
+{
+	if (erosionSession->getState() != ErosionSession::RUNNING)
 	{
-		initializeBrushIndices(resolution, erosionRadius);
-		currentErosionRadius = erosionRadius;
+		return 0;
 	}
 
-	// Create water droplet at some random point on the map
-	for (int iteration = 0; iteration < cycles; iteration++)
+	int dropletsRun = erosionSession->runFor(milliseconds);
+
+	// The session only adds its maps to the totals once it's done
+	if (!erosionSession->isActive())
 	{
-		// Spawn New Particle at random location on the map
-		int initialRandXPos = rand() % resolution;
-		int initialRandZPos = rand() % resolution;
-		float posX = initialRandXPos;
-		float posZ = initialRandZPos;
-		float dirX = 0;
-		float dirZ = 0;
-		//float speed = 1.0f;
-		float waterVolume = 1.0f;
-		float sedimentCarried = 0;
+		erosionMapsChanged = true;
+	}
 
-		for (int lifetime = 0; lifetime < maxDropletLifetime; lifetime++)
-		{
-			int nodeX = (int)posX;
-			int nodeZ = (int)posZ;
-			int dropletIndex = nodeZ * resolution + nodeX;
+	return dropletsRun;
+}
 
-			// Calculate droplet's offset inside the cell (0,0) = at NW node, (1,1) = at SE node
-			float cellOffsetX = posX - nodeX;
-			float cellOffsetZ = posZ - nodeZ;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-			// Calculate droplet's height and direction of flow with bilinear interpolation of surrounding heights
-			HeightAndGradient heightAndGradient = calculateHeightAndGradient(heightMap, resolution, posX, posZ);
+void Terrain::pauseErosion()
+{
+	erosionSession->pause();
+}
 
-			// Update the droplet's direction
-			dirX = ((dirX * inertia) - (heightAndGradient.gradientX * (1 - inertia)));
-			dirZ = ((dirZ * inertia) - (heightAndGradient.gradientZ * (1 - inertia)));
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-			float sum = dirX * dirX + dirZ * dirZ;
-			float len = sqrt(sum);
+void Terrain::resumeErosion()
+{
+	erosionSession->resume();
+}
 
-			// If the new direction value is below tiny threshold value, i.e. almost flat surface
-			if (len <= FLT_EPSILON)
-			{
-				// Pick random direction
-				const float MIN_RAND = 0;
-				const float MAX_RAND = XM_2PI;
-				const float range = MAX_RAND - MIN_RAND;
-				float random = range * ((((float)rand()) / (float)RAND_MAX)) + MIN_RAND;
-				dirX = cosf(random);
-				dirZ = sinf(random);
-			}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-			// Normalize direction
-			dirX /= len;
-			dirZ /= len;
+void Terrain::cancelErosion()
+{
+	if (erosionSession->isActive())
+	{
+		erosionSession->cancel();
+		erosionMapsChanged = true;
+	}
+}
 
-			// Update the droplets position
-			posX += dirX;
-			posZ += dirZ;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-			// Stop simulating droplet has flowed over edge of map
-			if (posX < 0 || posX >= resolution - 1 || posZ < 0 || posZ >= resolution - 1)
-			{
-				break;
-			}
+ErosionSession* Terrain::getErosionSession()
+{
+	return erosionSession;
+}
 
-			// Find the droplet's new height and calculate the deltaHeight
-			float newHeight = calculateHeightAndGradient(heightMap, resolution, posX, posZ).height;
-			float deltaHeight = newHeight - heightAndGradient.height;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-			// Calculated new sediment capacity, This is not done as it does not produce the correct aesthetics if included
-			//sedimentCapacity = fmax(-deltaHeight, minSedimentCapacity) * speed * waterVolume * sedimentCapacity;		// Hans Beyer
-			//sedimentCapacity = fmax(-deltaHeight * speed * waterVolume * sedimentCapacity, minSedimentCapacity);		// Lague
+void Terrain::pyramidErodeTerrain(int levels, int dropletsPerLevel, int fineDroplets)
+{
+	analyticGradients = false;
 
-			// If the change in height is positive, i.e. we moved 'uphill' then we deposit some sediment
-			// in the pit the particle just ran through.
-			// OR if the particle is carrying more sediment than its capacity, we must deposit some
-			// DEPOSITION
-			if (deltaHeight > 0 || sedimentCarried > sedimentCapacity)
-			{
-				float amountToDeposit = 0;
+	// The large scale drainage first, then the fine detail the coarse levels can't hold
+	pyramidErosion->erodeCoarseLevels(levels, dropletsPerLevel, (unsigned int)rand(), hydraulicErosion->getParams());
+	erodeTerrain(fineDroplets);
+}
 
-				// If moving uphill (deltaHeight > 0) try fill up to the current height,
-				// otherwise deposit a fraction of the excess sediment currently carried
-				if (deltaHeight > 0)
-				{
-					amountToDeposit = fmin(deltaHeight, sedimentCarried);
-				}
-				else
-				{
-					amountToDeposit = (sedimentCarried - sedimentCapacity) * depositSpeed;
-				}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-				sedimentCarried -= amountToDeposit;
+void Terrain::recordHistory()
+{
+	// The first snapshot is always taken, so there's something to undo back to
+	if (heightsChanged || history.getSnapshotCount() == 0)
+	{
+		history.record(heightMap);
+		heightsChanged = false;
+	}
+}
 
-				// Add the sediment to the four nodes of the current cell using bilinear interpolation
-				// Deposition is not distributed over a radius (like erosion) so that it can fill small pits
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-				// Current vertex
-				heightMap[dropletIndex] += amountToDeposit * (1 - cellOffsetX) * (1 - cellOffsetZ);
+bool Terrain::undo()
+{
+	// A half finished erosion run can't carry on from different heights
+	cancelErosion();
 
-				// Boundary checks on the other 3 surrounding the above vertex location
-				if (nodeX < (resolution - 1))
-				{
-					heightMap[dropletIndex + 1] += amountToDeposit * cellOffsetX * (1 - cellOffsetZ);
-				}
+	// Any edit not recorded yet is its own step, so it's what gets undone
+	recordHistory();
 
-				if (nodeZ < (resolution - 1))
-				{
-					heightMap[dropletIndex + resolution] += amountToDeposit * (1 - cellOffsetX) * cellOffsetZ;
-				}
+	if (!history.undo(heightMap))
+	{
+		return false;
+	}
 
-				if (nodeX < (resolution - 1) && nodeZ < (resolution - 1))
-				{
-					heightMap[dropletIndex + resolution + 1] += amountToDeposit * cellOffsetX * cellOffsetZ;
-				}				
-			}
-			else		// We moved downhill	-	EROSION
-			{
-				// Erode a fraction of the droplet's current carry capacity.
-				float amountToErode = 0;
+	analyticGradients = false;
+	return true;
+}
 
-				// As long as we've not gone over capacity, calculate a new amount of erosion
-				if (sedimentCarried < sedimentCapacity)
-				{
-					// Clamp the erosion to the change in height so that it doesn't dig a hole in the terrain behind the droplet
-					// The final value of this should NEVER be more than the height diff between old position and new position, i.e deltaHeight
-					float resultantSediment = (sedimentCapacity - sedimentCarried) * erodeSpeed;
-					amountToErode = fmin(resultantSediment, -deltaHeight);
-				}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-				// Use erosion brush to erode from all nodes inside the droplet's erosion radius
-				for (int brushPointIndex = 0; brushPointIndex < erosionBrushIndicesVec[dropletIndex].size(); brushPointIndex++)
-				{
-					int nodeIndex = erosionBrushIndicesVec[dropletIndex][brushPointIndex];
+bool Terrain::redo()
+{
+	cancelErosion();
+	recordHistory();
 
-					if (nodeIndex > (resolution * resolution))
-					{
-						continue;
-					}
+	if (!history.redo(heightMap))
+	{
+		return false;
+	}
 
-					float weightedErodeAmount = amountToErode * erosionBrushWeightsVec[dropletIndex][brushPointIndex];
+	analyticGradients = false;
+	return true;
+}
 
-					float deltaSediment = 0;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-					// ## THIS ##
-					// Comment this out if you do not want the "sea level" texture to be flattened out
-					if (heightMap[nodeIndex] < weightedErodeAmount)
-					{
-						deltaSediment = heightMap[nodeIndex];
-					}
-					else
-					{
-						deltaSediment = weightedErodeAmount;
-					}
+const HeightMapHistory& Terrain::getHistory()
+{
+	return history;
+}
 
-					//float deltaSediment = (heightMap[nodeIndex] < weightedErodeAmount) ? heightMap[nodeIndex] : weightedErodeAmount;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-					// ## OR THIS ## // ## BUT NOT BOTH ##
-					// Uncomment this wish to have the aesthetics of seeing "through" the "sea level water" to the rocky sea bed
-					//float deltaSediment = weightedErodeAmount;
+std::shared_ptr<const HeightMapSnapshot> Terrain::getSnapshot()
+{
+	recordHistory();
 
-					heightMap[nodeIndex] -= deltaSediment;
-					sedimentCarried += deltaSediment;
-				}
-			}
+	return history.getCurrent();
+}
 
-			// Update droplet's speed and water content
-			// This can be +/- to represent when the particle may be flowing up/downhill
-			// with either a pos/neg vel
-			//speed = speed * speed + deltaHeight * gravity;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-			// This is what the paper has - Hans Beyer
-			//speed = sqrt(speed * speed + deltaHeight * gravity);
-			
-			waterVolume *= (1 - evaporateSpeed);
+bool Terrain::restoreSnapshot(const std::shared_ptr<const HeightMapSnapshot>& snapshot)
+{
+	cancelErosion();
+	recordHistory();
 
-			// If the water has all but evaporated, stop iterating on this particle
-			if (waterVolume <= 0.0001)
-			{
-				break;
-			}
-		}
+	if (!history.restore(heightMap, snapshot))
+	{
+		return false;
 	}
+
+	analyticGradients = false;
+	return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-HeightAndGradient Terrain::calculateHeightAndGradient(float heightMap[], int mapSize, float posX, float posZ)
+void Terrain::generateFault()
 {
-	int coordX = (int)posX;
-	int coordZ = (int)posZ;
+	faulting->createFault();
+	analyticGradients = false;
+}
 
-	// Calculate Particles offset inside the cell (0,0) = at NW node, (1,1) = at SE node
-	float xOffset = posX - coordX;
-	float zOffset = posZ - coordZ;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	// Bilinear Interpolation
-	// https://x-engineer.org/bilinear-interpolation/
-	// https://blogs.sas.com/content/iml/2020/05/18/what-is-bilinear-interpolation.html
+void Terrain::startParticleDepo()
+{
+	particleDepo->runParticleDepo();
+	analyticGradients = false;
+}
 
-	/*
-	*			--->
-	* (0,0)	NW	 |		NE (1,0)
-	*		*----*p1----*
-	*		|	 |		|
-	*	 --------*p3--------
-	*		|	 |		|
-	*		|	 |		|
-	* (0,1)	*----*p2-----* (1,1)
-	*		SW	 |		SE 
-	*			--->
-	*/
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	// Calculate heights of the four nodes of the droplet's cell
-	int nodeIndexNW = coordZ * mapSize + coordX;
+void Terrain::genPerlinNoise()
+{
+	if (analyticGradients)
+	{
+		analyticGradients = perlinNoise->buildPerlinNoise(noiseGradientX.data(), noiseGradientZ.data());
+	}
+	else
+	{
+		perlinNoise->buildPerlinNoise();
+	}
+}
 
-	float heightNW = heightMap[nodeIndexNW];
-	float heightNE = 0;
-	float heightSW = 0;
-	float heightSE = 0;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	if (coordX < (resolution - 1))
+void Terrain::generatefBm()
+{
+	if (analyticGradients)
+	{
+		analyticGradients = perlinNoise->fracBrownianMotion(noiseGradientX.data(), noiseGradientZ.data());
+	}
+	else
 	{
-		heightNE = heightMap[nodeIndexNW + 1];
+		perlinNoise->fracBrownianMotion();
 	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	if (coordZ < (resolution - 1))
+void Terrain::generateErodedfBm(int octaves)
+{
+	if (analyticGradients)
+	{
+		perlinNoise->buildErodedfBm(octaves, noiseGradientX.data(), noiseGradientZ.data());
+	}
+	else
 	{
-		heightSW = heightMap[nodeIndexNW + mapSize];
+		perlinNoise->buildErodedfBm(octaves);
 	}
+}
 
-	if (coordX < (resolution - 1) && coordZ < (resolution - 1))
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::genDomainWarpedNoise(int warpLevels, float warpStrength)
+{
+	if (analyticGradients)
 	{
-		heightSE = heightMap[nodeIndexNW + mapSize + 1];
+		analyticGradients = perlinNoise->buildDomainWarpedNoise(warpLevels, warpStrength, noiseGradientX.data(), noiseGradientZ.data());
 	}
+	else
+	{
+		perlinNoise->buildDomainWarpedNoise(warpLevels, warpStrength);
+	}
+}
 
-	// Calculate droplet's direction of flow with bilinear interpolation of height difference along the edges
-	float gradientX = (heightNE - heightNW) * (1 - zOffset) + (heightSE - heightSW) * zOffset;
-	float gradientZ = (heightSW - heightNW) * (1 - xOffset) + (heightSE - heightNE) * xOffset;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::genWorleyNoise()
+{
+	worleyNoise->buildWorleyNoise();
+
+	// The cell edges are creases, so there's no useful gradient to keep
+	analyticGradients = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	// Calculate height with bilinear interpolation of the heights of the nodes of the cell
-	float height = heightNW * (1 - xOffset) * (1 - zOffset) + heightNE * xOffset * (1 - zOffset) + heightSW * (1 - xOffset) * zOffset + heightSE * xOffset * zOffset;
+void Terrain::smoothTerrain()
+{
+	smoothing->smoothTerrain();
+	analyticGradients = false;
+}
 
-	HeightAndGradient heightAndGrad;
-	heightAndGrad.height = height;
-	heightAndGrad.gradientX = gradientX;
-	heightAndGrad.gradientZ = gradientZ;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	return heightAndGrad;
+void Terrain::thermalErodeTerrain(int iterations)
+{
+	thermalErosion->erodeTerrain(iterations, getGridScale());
+	analyticGradients = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void Terrain::initializeBrushIndices(int mapSize, int radius)
+void Terrain::shallowWaterErodeTerrain(int iterations)
 {
-	int size = mapSize * mapSize;
+	shallowWaterErosion->erodeTerrain(iterations, getGridScale());
+	analyticGradients = false;
+}
 
-	// Set up our containers
-	erosionBrushIndicesVec.resize(size);
-	erosionBrushWeightsVec.resize(size);
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	std::vector<int> xOffsets;
-	std::vector<int> zOffsets;
-	std::vector<float> weights;
+int Terrain::getTerrainRes()
+{
+	return resolution;
+}
 
-	float weightSum = 0;
-	int addIndex = 0;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	for (int i = 0; i < (mapSize * mapSize); i++)
+// World space distance between two neighbouring vertices, used by the vertex shader to rebuild x/z
+float Terrain::getGridScale()
+{
+	return terrainSize / (float)resolution;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// UV distance between two neighbouring vertices, used by the vertex shader to rebuild the UVs
+float Terrain::getUVIncrement()
+{
+	return uvScale / (float)resolution;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The camera position must be relative to the terrain, i.e. with the terrain's world translation removed
+// With LOD turned off every chunk is drawn at full resolution
+// The frustum must be in the terrain's local space too, i.e. extracted from world * view * projection, nullptr to draw everything
+void Terrain::getDrawRanges(const XMFLOAT3& localCameraPos, float viewportHeight, float fovY, float maxPixelError, bool useLOD, const Frustum* frustum, std::vector<TerrainIndexRange>& ranges)
+{
+	if (useLOD)
+	{
+		quadtree.selectLOD(localCameraPos, viewportHeight, fovY, maxPixelError, drawList);
+	}
+	else
 	{
-		// Get our x location
-		int centreX = i % mapSize;
-		// Get our z location
-		int centreZ = i / mapSize;
+		drawList.resize(quadtree.getChunkCount());
 
-		// This is an optimisation and controls only recalculating the edge cases,
-		// for everything else within the main body of the map we just repopulate
-		// with the known 25 values, meaning this conditional fails and we skip to for loop below
-		if (centreZ <= radius || centreZ >= mapSize - radius || centreX <= radius + 1 || centreX >= mapSize - radius)
+		for (int i = 0; i < (int)drawList.size(); ++i)
 		{
-			weightSum = 0;
-			addIndex = 0;
+			drawList[i].chunk = i;
+			drawList[i].lod = 0;
+		}
+	}
 
-			// Start from negative radius, i.e. to the top of our current location
-			// Moving through our current location, and outwards again to the bottom
-			// of our current location
-			for (int z = -radius; z <= radius; z++)
-			{
-				// Start from negative radius, i.e. to the left of our current location
-				// Moving through our current location, and outwards again to the right
-				// of our current location
-				for (int x = -radius; x <= radius; x++)
-				{
-					// Get the straight line distance from our location to some point within the radius
-					float straightLineDist = x * x + z * z;
+	if (frustum)
+	{
+		frustum->cullBoxes(chunkBounds, visibleChunks);
 
-					if (straightLineDist < radius * radius)
-					{
-						int coordX = centreX + x;
-						int coordZ = centreZ + z;
-
-						// Boundary checks
-						if (coordX >= 0 && coordX < mapSize && coordZ >= 0 && coordZ < mapSize)
-						{
-							float weight = 1 - (sqrt(straightLineDist) / radius);
-
-							// Sum the weight so we can normalise later
-							weightSum += weight;
-							weights.push_back(weight);
-							xOffsets.push_back(x);
-							zOffsets.push_back(z);
-
-							// Track how many positions will have weights assigned
-							addIndex++;
-						}
-					}
-				}
-			}
-		}
+		// Keep only the draw items of visible chunks, in the same order
+		// A culled chunk is completely outside the frustum, so any mismatch along its edges can't be seen
+		std::vector<bool> isVisible(chunkBounds.size(), false);
 
-		int numEntries = addIndex;
+		for (int i = 0; i < (int)visibleChunks.size(); ++i)
+		{
+			isVisible[visibleChunks[i]] = true;
+		}
 
-		std::vector<int> tempBrushIndicesVec;
-		std::vector<float> tempWeightsVec;
+		int visibleCount = 0;
 
-		// Loop over the number of indices that were tracked
-		for (int j = 0; j < numEntries; j++)
+		for (int i = 0; i < (int)drawList.size(); ++i)
 		{
-			// Add the particular vertex index from the map to the vector
-			tempBrushIndicesVec.push_back((zOffsets[j] + centreZ) * mapSize + xOffsets[j] + centreX);
-			// Add the weight that was associated with that vertex position to the weights vector
-			tempWeightsVec.push_back(weights[j] / weightSum);
+			if (isVisible[drawList[i].chunk])
+			{
+				drawList[visibleCount] = drawList[i];
+				++visibleCount;
+			}
 		}
 
-		// Copy from temp to actual
-		erosionBrushIndicesVec[i] = tempBrushIndicesVec;
-		erosionBrushWeightsVec[i] = tempWeightsVec;
+		drawList.resize(visibleCount);
 	}
-}
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-void Terrain::generateFault()
-{
-	faulting->createFault();
+	quadtree.getDrawRanges(drawList, ranges);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void Terrain::startParticleDepo()
+const std::vector<TerrainDrawItem>& Terrain::getDrawList()
 {
-	particleDepo->runParticleDepo();
+	return drawList;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void Terrain::genPerlinNoise()
+const TerrainQuadtree& Terrain::getQuadtree()
 {
-	perlinNoise->buildPerlinNoise();
+	return quadtree;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void Terrain::generatefBm()
+int Terrain::getVisibleChunkCount()
 {
-	perlinNoise->fracBrownianMotion();
+	return (int)drawList.size();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void Terrain::smoothTerrain()
+void Terrain::setHeightMapLayout(HeightMap::Layout layout)
 {
-	smoothing->smoothTerrain();
+	// A run records with storage indices, so it has to stop before they move
+	cancelErosion();
+
+	heightMap.setLayout(layout);
+	erosionMaps.setLayout(layout);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int Terrain::getTerrainRes()
+HeightMap::Layout Terrain::getHeightMapLayout()
 {
-	return resolution;
+	return heightMap.getLayout();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -815,6 +962,23 @@ void Terrain::setPerlinAlgoType(char type)
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void Terrain::setPerlinSeed(unsigned int seed)
+{
+	perlinNoise->setSeed(seed);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::setPerlinTile(int tileX, int tileZ, int tilesPerPeriod)
+{
+	const int tileSize = resolution - 1;
+
+	perlinNoise->setTileOrigin(tileX * tileSize, tileZ * tileSize);
+	perlinNoise->setPeriod(tilesPerPeriod > 0 ? tilesPerPeriod * tileSize : 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 float Terrain::getPerlinFreq()
 {
 	return perlinNoise->getFreq();
@@ -829,58 +993,226 @@ float Terrain::getPerlinAmplitude()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void Terrain::setWorleyParams(float freq, float amplitude, float jitter, WorleyNoise::Metric metric, WorleyNoise::Feature feature, unsigned int seed)
+{
+	worleyNoise->setFrequency(freq);
+	worleyNoise->setAmplitude(amplitude);
+	worleyNoise->setJitter(jitter);
+	worleyNoise->setMetric(metric);
+	worleyNoise->setFeature(feature);
+	worleyNoise->setSeed(seed);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Terrain::hasAnalyticNormals()
+{
+	return analyticGradients;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void Terrain::setErosionRad(int newRad)
 {
-	erosionRadius = newRad;
+	hydraulicErosion->setErosionRad(newRad);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Terrain::setInertia(float newInertia)
 {
-	inertia = newInertia;
+	hydraulicErosion->setInertia(newInertia);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Terrain::setSedimentCap(float newCapacity)
 {
-	sedimentCapacity = newCapacity;
+	hydraulicErosion->setSedimentCap(newCapacity);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Terrain::setErosionSpeed(float newErosionSpeed)
 {
-	erodeSpeed = newErosionSpeed;
+	hydraulicErosion->setErosionSpeed(newErosionSpeed);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Terrain::setDepositSpeed(float newDepositSpeed)
 {
-	depositSpeed = newDepositSpeed;
+	hydraulicErosion->setDepositSpeed(newDepositSpeed);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Terrain::setEvapSpeed(float newEvapSpeed)
 {
-	evaporateSpeed = newEvapSpeed;
+	hydraulicErosion->setEvapSpeed(newEvapSpeed);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Terrain::setGravity(float newGravity)
 {
-	gravity = newGravity;
+	hydraulicErosion->setGravity(newGravity);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void Terrain::setMaxParticleLifetime(int newLifetime)
 {
-	maxDropletLifetime = newLifetime;
+	hydraulicErosion->setMaxParticleLifetime(newLifetime);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::setTalusAngle(float newAngle)
+{
+	thermalErosion->setTalusAngle(newAngle);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::setThermalErosionRate(float newRate)
+{
+	thermalErosion->setErosionRate(newRate);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::setRecordErosionMaps(bool record)
+{
+	recordErosionMaps = record;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::clearErosionMaps()
+{
+	erosionMaps.clear();
+	erosionMapsChanged = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Terrain::exportErosionMaps(const std::string& prefix)
+{
+	return erosionMaps.exportMaps(prefix);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Terrain::exportHeightMap(const std::string& filename, HeightMapExporter::Format format)
+{
+	HeightMapExporter exporter;
+
+	return exporter.exportHeightMap(heightMap, filename, format);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const HeightMapSampler& Terrain::getHeightSampler()
+{
+	return heightSampler;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::updateHeightQueries()
+{
+	heightSampler.update(heightMap);
+
+	int minX, minZ, maxX, maxZ;
+
+	if (heightSampler.getChangedArea(minX, minZ, maxX, maxZ))
+	{
+		heightPyramid.update(heightSampler, minX, minZ, maxX, maxZ);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Terrain::rayCastTerrain(const XMFLOAT3& origin, const XMFLOAT3& direction, XMFLOAT3& hitPoint)
+{
+	// Into grid space, only x and z are scaled so the ray's t is the same in both
+	const float scale = getGridScale();
+	XMFLOAT3 gridOrigin(origin.x / scale, origin.y, origin.z / scale);
+	XMFLOAT3 gridDirection(direction.x / scale, direction.y, direction.z / scale);
+	float hitT;
+
+	if (!heightPyramid.rayCast(gridOrigin, gridDirection, FLT_MAX, hitT))
+	{
+		return false;
+	}
+
+	hitPoint = XMFLOAT3(origin.x + direction.x * hitT, origin.y + direction.y * hitT, origin.z + direction.z * hitT);
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float Terrain::getGroundHeight(float x, float z)
+{
+	const float scale = getGridScale();
+
+	return heightSampler.getHeight(x / scale, z / scale);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::getGroundHeightRange(float minX, float minZ, float maxX, float maxZ, float& low, float& high)
+{
+	const float scale = getGridScale();
+
+	heightPyramid.getHeightRange(minX / scale, minZ / scale, maxX / scale, maxZ / scale, low, high);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::scatterVegetation(VegetationScatter& scatter, std::vector<VegetationInstance>& instances)
+{
+	scatter.scatter(heightSampler, &erosionMaps.getFlow(), getGridScale(), instances);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool Terrain::importHeightMap(HeightMapImporter& importer, const std::string& filename)
+{
+	cancelErosion();
+
+	// The heights as they are now, to undo back to, or to put back if the file is broken part way through
+	recordHistory();
+
+	if (!importer.importHeightMap(heightMap, filename))
+	{
+		history.getCurrent()->copyTo(heightMap);
+		return false;
+	}
+
+	heightsChanged = true;
+	analyticGradients = false;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ID3D11ShaderResourceView* Terrain::getErosionMapTexture()
+{
+	return erosionMapView;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void Terrain::setShallowWaterParams(float rainRate, float evaporationRate, float capacity, float dissolveRate, float depositRate)
+{
+	shallowWaterErosion->setRainRate(rainRate);
+	shallowWaterErosion->setEvaporationRate(evaporationRate);
+	shallowWaterErosion->setSedimentCapacity(capacity);
+	shallowWaterErosion->setDissolveRate(dissolveRate);
+	shallowWaterErosion->setDepositRate(depositRate);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -4,7 +4,19 @@
  *		- Regenerating the terrain mesh after modifications
  *		- Setting up the terrain mesh buffers
  *		- Passing information from the App class to respective terrain features classes
- *		- Running the Hydraulic Erosion algorithm
+ *		- Passing Hydraulic Erosion requests to the hydraulic erosion class, either all at once or a slice at a time
+ *		- Running Hydraulic Erosion coarse to fine, through the pyramid erosion class
+ *		- Passing Thermal Erosion requests to the thermal erosion class
+ *		- Passing grid based (shallow water) Hydraulic Erosion requests to the shallow water erosion class
+ *		- Optionally recording the Hydraulic Erosion's flow, erosion and deposition into maps, for export and texturing
+ *		- Keeping a history of height map snapshots, for undo, redo and comparing versions
+ *		- Exporting the height map, as a 16 bit PNG, raw heights or compressed tiles
+ *		- Importing a height map from a file, resampled to the terrain's resolution
+ *		- Keeping a padded copy of the heights for batched bilinear height and gradient queries
+ *		- Casting rays against the terrain and finding the ground height, for picking, the camera and placing objects
+ *		- Scattering trees over the terrain, by slope, height and the recorded erosion flow
+ *		- Choosing which terrain chunks to draw, and at what LOD
+ *		- Culling the terrain chunks that are outside the camera frustum
  *
  * Original @author Abertay University.
  * Updated by @author D. Green.
@@ -20,22 +32,29 @@
 #include "Faulting.h"
 #include "ParticleDeposition.h"
 #include "PerlinNoise.h"
+#include "WorleyNoise.h"
 #include "Smoothing.h"
+#include "ThermalErosion.h"
+#include "ShallowWaterErosion.h"
+#include "HydraulicErosion.h"
+#include "ErosionSession.h"
+#include "PyramidErosion.h"
+#include "ErosionMaps.h"
+#include "HeightMap.h"
+#include "HeightMapHistory.h"
+#include "HeightMapExporter.h"
+#include "HeightMapImporter.h"
+#include "HeightMapSampler.h"
+#include "HeightMapPyramid.h"
+#include "VegetationScatter.h"
+#include "TerrainVertex.h"
+#include "TerrainQuadtree.h"
+#include "FrustumCulling.h"
 #include <array>
 #include <vector>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Used in the Hydraulic Erosion algorithm
-struct HeightAndGradient
-{
-	float height;
-	float gradientX;
-	float gradientZ;
-};
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
 class Terrain : public PlaneMesh
 {
 public:
@@ -43,28 +62,97 @@ public:
 	~Terrain();
 
 	void generateTerrain(ID3D11Device* device, ID3D11DeviceContext* deviceContext);
+	void sendData(ID3D11DeviceContext* deviceContext, D3D_PRIMITIVE_TOPOLOGY top = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST) override;
 	void resetTerrain();
 	void resize(int& newResolution);
-	void updateHeightMap();
 
 	// Generate terrain effects
 	void generateFault();
 	void startParticleDepo();
 	void genPerlinNoise();
 	void generatefBm();
+	void generateErodedfBm(int octaves);
+	void genDomainWarpedNoise(int warpLevels, float warpStrength);
+	void genWorleyNoise();
 	void smoothTerrain();
 	void erodeTerrain(int cycles);                 //Perform n erosion cycles
-	HeightAndGradient calculateHeightAndGradient(float heightMap[], int mapSize, float posX, float posZ);
-	void initializeBrushIndices(int mapSize, int radius);
+	void thermalErodeTerrain(int iterations);
+	void shallowWaterErodeTerrain(int iterations);
+
+	// Hydraulic Erosion a slice at a time, i.e. a few milliseconds a frame, see ErosionSession
+	// The same seed always gives the same terrain, however the run is sliced up
+	void startErosion(int cycles, unsigned int seed);
+	int advanceErosion(float milliseconds);
+	void pauseErosion();
+	void resumeErosion();
+	void cancelErosion();
+	ErosionSession* getErosionSession();
+	// Erodes levels coarse copies first, dropletsPerLevel droplets each, then fineDroplets at full resolution
+	// Only the full resolution droplets are recorded in the erosion maps
+	void pyramidErodeTerrain(int levels, int dropletsPerLevel, int fineDroplets);
+
+	// Erosion maps, recorded by erodeTerrain() while turned on, and summed over every run until cleared
+	void setRecordErosionMaps(bool record);
+	void clearErosionMaps();
+	bool exportErosionMaps(const std::string& prefix);
+	// r = flow, g = eroded, b = deposited, each 0 -> 1, one texel per grid point, updated by generateTerrain()
+	ID3D11ShaderResourceView* getErosionMapTexture();
+
+	// Streams the heights out a band at a time, the 16 bit formats go from the lowest point to the highest
+	bool exportHeightMap(const std::string& filename, HeightMapExporter::Format format);
+	// Replaces the heights with the file's, left as they were if it can't be read, see the importer's getError()
+	bool importHeightMap(HeightMapImporter& importer, const std::string& filename);
+
+	// The heights as of the last generateTerrain(), positions in grid units, for anything placed on or following the ground
+	const HeightMapSampler& getHeightSampler();
+
+	// Picking and ground queries, as of the last generateTerrain(), all in the terrain's local space (before it's moved into the world)
+	// The direction doesn't need to be normalised, false if the ray misses
+	bool rayCastTerrain(const XMFLOAT3& origin, const XMFLOAT3& direction, XMFLOAT3& hitPoint);
+	float getGroundHeight(float x, float z);
+	// The lowest and highest ground anywhere in the area, i.e. to keep something above every point under it
+	void getGroundHeightRange(float minX, float minZ, float maxX, float maxZ, float& low, float& high);
+
+	// Trees over the terrain as of the last generateTerrain(), in its local space, thinned by the recorded flow if there is any
+	void scatterVegetation(VegetationScatter& scatter, std::vector<VegetationInstance>& instances);
+
+	// Undo and redo, each step is whatever changed between two recordHistory() calls
+	// Call it once an edit is finished, i.e. not every frame of a faulting loop, so an undo takes back the whole edit
+	void recordHistory();
+	bool undo();
+	bool redo();
+	const HeightMapHistory& getHistory();
+	// The terrain as it is now, read only, so it can be kept to compare against or handed to another thread
+	std::shared_ptr<const HeightMapSnapshot> getSnapshot();
+	// Puts a snapshot's heights back, as an edit that can be undone, false if it's a different resolution
+	bool restoreSnapshot(const std::shared_ptr<const HeightMapSnapshot>& snapshot);
+
+	// Chunked LOD
+	void getDrawRanges(const XMFLOAT3& localCameraPos, float viewportHeight, float fovY, float maxPixelError, bool useLOD, const Frustum* frustum, std::vector<TerrainIndexRange>& ranges);
+	const std::vector<TerrainDrawItem>& getDrawList();
+	const TerrainQuadtree& getQuadtree();
+	int getVisibleChunkCount();
+
+	// Height map layout
+	void setHeightMapLayout(HeightMap::Layout layout);
+	HeightMap::Layout getHeightMapLayout();
 
 	// Getters and Setters
 	int getTerrainRes();
+	float getGridScale();
+	float getUVIncrement();
 	void setPNFreqScaleAmp(float freq, float scale, float amplitude);
 	void setPerlinRidged(bool isRidged);
 	void setPerlinTerraced(bool isTerraced);
 	void setPerlinAlgoType(char type);
+	void setPerlinSeed(unsigned int seed);
+	// Tiles share their border row/column, so tile (1, 0) starts where tile (0, 0)'s last column is
+	// With tilesPerPeriod > 0 the Perlin noise and fBm wrap after that many tiles, 0 for no wrapping
+	void setPerlinTile(int tileX, int tileZ, int tilesPerPeriod);
 	float getPerlinFreq();
 	float getPerlinAmplitude();
+	void setWorleyParams(float freq, float amplitude, float jitter, WorleyNoise::Metric metric, WorleyNoise::Feature feature, unsigned int seed);
+	bool hasAnalyticNormals();
 
 	void setErosionRad(int newRad);
 	void setInertia(float newInertia);
@@ -74,17 +162,30 @@ public:
 	void setEvapSpeed(float newEvapSpeed);
 	void setGravity(float newGravity);
 	void setMaxParticleLifetime(int newLifetime);
+	void setTalusAngle(float newAngle);
+	void setThermalErosionRate(float newRate);
+	void setShallowWaterParams(float rainRate, float evaporationRate, float capacity, float dissolveRate, float depositRate);
 
 private:
 	void initTerrain(int& newResolution, ID3D11Device* device, ID3D11DeviceContext* deviceContext);
 	void initTerrainObjects();	
 	
 	void buildTerrain();
-	void createBuffers(ID3D11Device* device, VertexType* vertices, unsigned long* indices);
+	void updateChunkBounds();
+	void createBuffers(ID3D11Device* device, TerrainVertexType* vertices, unsigned long* indices);
+	void updateErosionMapTexture(ID3D11Device* device, ID3D11DeviceContext* deviceContext);
+	void updateHeightQueries();
 	
 	const float uvScale = 25.0f;			// Tile the UV map 50 times across the plane
 	const float terrainSize = 250.0f;		// What is the width and height of our terrain
-	float* heightMap;
+	HeightMap heightMap;
+	std::vector<float> rowMajorHeights;		// Copy of the heights in vertex order, for the vertex buffer and the LOD quadtree
+
+	// While the terrain has only been built from noise these hold its exact slope (height change per grid point, row-major),
+	// so generateTerrain() can use them for the normals rather than finite differences
+	std::vector<float> noiseGradientX;
+	std::vector<float> noiseGradientZ;
+	bool analyticGradients = false;
 
 	bool newTerrain = false;
 	bool isFaulting = false;
@@ -93,23 +194,36 @@ private:
 	Faulting* faulting;
 	ParticleDeposition* particleDepo;
 	PerlinNoise* perlinNoise;
+	WorleyNoise* worleyNoise;
 	Smoothing* smoothing;
-
-	// For Hydr Eros
-	int erosionRadius = 3;
-	float inertia = 0.5f;					// At zero, water will instantly change direction to flow directly downhill. At 1, water will never change direction. 
-	float sedimentCapacity = 1.1f;			// Multiplier for how much sediment a droplet can carry
-	float minSedimentCapacity = 0.01f;		// Used to prevent carry capacity getting too close to zero on flatter terrain
-	float erodeSpeed = 0.5f;
-	float depositSpeed = 0.012f;
-	float evaporateSpeed = 0.012f;
-	float gravity = 4.0f;
-	int maxDropletLifetime = 30;			// This ensures we do not get 'immortal' particles roaming around
-	//float initialWaterVolume = 1.0f;		// This part of the particle
-	//float initialSpeed = 1.0f;
-
-	std::vector<std::vector<int>> erosionBrushIndicesVec;
-	std::vector<std::vector<float>> erosionBrushWeightsVec;
+	ThermalErosion* thermalErosion;
+	ShallowWaterErosion* shallowWaterErosion;
+	HydraulicErosion* hydraulicErosion = nullptr;		// Checked by resize(), which runs before initTerrainObjects()
+	ErosionSession* erosionSession = nullptr;
+	PyramidErosion* pyramidErosion;
+	ErosionBrushCache erosionBrushes;		// Shared by the hydraulic and pyramid erosion
+
+	// Chunked LOD
+	TerrainQuadtree quadtree;
+	std::vector<TerrainDrawItem> drawList;
+	BoundingBoxList chunkBounds;
+	std::vector<int> visibleChunks;
+
+	// Each run records into its own maps, which are added to the totals once it's done
+	ErosionMaps erosionMaps;
+	bool recordErosionMaps = false;
+	bool erosionMapsChanged = false;
+
+	// Set by generateTerrain(), so recordHistory() only compares the heights when they could have changed
+	HeightMapHistory history;
+	bool heightsChanged = false;
+
+	// Brought up to date by generateTerrain(), the pyramid only redoes the part the sampler saw change
+	HeightMapSampler heightSampler;
+	HeightMapPyramid heightPyramid;
+
+	ID3D11Texture2D* erosionMapTexture = NULL;
+	ID3D11ShaderResourceView* erosionMapView = NULL;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
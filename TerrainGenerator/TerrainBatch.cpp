@@ -0,0 +1,740 @@
+/*
+ * This is the Terrain Batch class it handles:
+ *		- Loading a manifest of terrain jobs, each one a resolution and a list of stages (fault, smooth, noise, erosion...)
+ *		- Running the jobs on a pool of worker threads, with no window or GPU needed
+ *		- Turning away any job whose height map and scratch buffers would be over its memory limit
+ *		- Running a run of stages that several jobs start with only once, then forking the result for each of them
+ *		- Exporting every finished job's height map
+ *
+ * A job can start from a snapshot of the terrain rather than a flat map, the snapshot is only ever read so the
+ * terrain can carry on being edited while the batch runs.
+ *
+ * The jobs are put into a tree, where each node is one stage and its parent is the stage before it, so jobs that
+ * start the same way share the same nodes. A node's height map is shared by its children and any job that ends there,
+ * and it's only copied when a child is about to change it while someone else still needs it (copy-on-write), the last
+ * child to run just takes it over, unless a job ends at its parent or another child is still copying it. Each stage
+ * runs on its worker's thread alone, the workers are already one per core.
+ *
+ * Manifest, one stage per line, # for comments:
+ *		job <name> <resolution> [memory limit in MB]
+ *		<stage> [count] [setting=value ...]
+ *
+ * Stages: fault, smooth, particles, perlin, fbm, erodedfbm, worley, hydraulic, thermal, shallowwater, see applyStage()
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TerrainBatch.h"
+#include "ParallelFor.h"
+#include "Faulting.h"
+#include "ParticleDeposition.h"
+#include "PerlinNoise.h"
+#include "WorleyNoise.h"
+#include "Smoothing.h"
+#include "ThermalErosion.h"
+#include "ShallowWaterErosion.h"
+#include "HydraulicErosion.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The same size as the Terrain's, so the grid scale, and so the thermal and shallow water erosion, match the app
+const int BATCH_TERRAIN_SIZE = 250;
+
+const int MIN_BATCH_RESOLUTION = 2;
+const int MAX_BATCH_RESOLUTION = 8192;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+TerrainBatch::TerrainBatch()
+{
+
+}
+
+TerrainBatch::~TerrainBatch()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+bool TerrainBatch::loadManifest(const std::string& filename)
+{
+	clear();
+
+	std::ifstream file(filename);
+
+	if (!file)
+	{
+		error = "Can't open " + filename;
+		return false;
+	}
+
+	std::string line;
+	int lineNumber = 0;
+
+	while (std::getline(file, line))
+	{
+		++lineNumber;
+
+		// Everything after a # is a comment
+		size_t comment = line.find('#');
+
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+
+		std::istringstream stream(line);
+		std::vector<std::string> words;
+		std::string word;
+
+		while (stream >> word)
+		{
+			words.push_back(word);
+		}
+
+		if (words.empty())
+		{
+			continue;
+		}
+
+		if (words[0] == "job")
+		{
+			BatchJob job;
+			job.resolution = words.size() > 2 ? atoi(words[2].c_str()) : 0;
+			job.memoryLimitMB = words.size() > 3 ? atoi(words[3].c_str()) : 0;
+
+			if (words.size() < 3 || words.size() > 4 || job.resolution < MIN_BATCH_RESOLUTION || job.resolution > MAX_BATCH_RESOLUTION || job.memoryLimitMB < 0)
+			{
+				error = "Line " + std::to_string(lineNumber) + ": expected job <name> <resolution> [memory limit in MB]";
+				jobs.clear();
+				return false;
+			}
+
+			job.name = words[1];
+			addJob(job);
+			continue;
+		}
+
+		BatchStage stage;
+
+		if (jobs.empty())
+		{
+			error = "Line " + std::to_string(lineNumber) + ": " + words[0] + " is before the first job";
+			jobs.clear();
+			return false;
+		}
+
+		if (!parseStage(words, stage))
+		{
+			error = "Line " + std::to_string(lineNumber) + ": " + error;
+			jobs.clear();
+			return false;
+		}
+
+		jobs.back().stages.push_back(stage);
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TerrainBatch::parseStage(const std::vector<std::string>& words, BatchStage& stage)
+{
+	// Every stage's name, and the settings it understands
+	static const struct
+	{
+		const char* name;
+		BatchStage::Type type;
+		const char* settings;
+	}
+	stageTypes[] =
+	{
+		{ "fault", BatchStage::FAULT, " seed " },
+		{ "smooth", BatchStage::SMOOTH, " " },
+		{ "particles", BatchStage::PARTICLE_DEPOSITION, " seed " },
+		{ "perlin", BatchStage::PERLIN_NOISE, " freq scale amplitude algorithm ridged terraced seed " },
+		{ "fbm", BatchStage::FBM, " freq scale amplitude algorithm ridged terraced seed " },
+		{ "erodedfbm", BatchStage::ERODED_FBM, " freq scale amplitude algorithm ridged terraced seed " },
+		{ "worley", BatchStage::WORLEY_NOISE, " freq amplitude jitter metric feature seed " },
+		{ "hydraulic", BatchStage::HYDRAULIC_EROSION, " seed radius inertia capacity mincapacity erodespeed depositspeed evaporatespeed gravity lifetime " },
+		{ "thermal", BatchStage::THERMAL_EROSION, " talus rate " },
+		{ "shallowwater", BatchStage::SHALLOW_WATER_EROSION, " rain evaporation capacity dissolve deposit " }
+	};
+
+	const char* settings = nullptr;
+
+	for (const auto& stageType : stageTypes)
+	{
+		if (words[0] == stageType.name)
+		{
+			stage.type = stageType.type;
+			settings = stageType.settings;
+			break;
+		}
+	}
+
+	if (!settings)
+	{
+		error = "unknown stage " + words[0];
+		return false;
+	}
+
+	// The count is optional, i.e. a single Perlin noise pass doesn't need one
+	stage.count = 1;
+	size_t first = 1;
+
+	if (words.size() > 1 && words[1].find('=') == std::string::npos)
+	{
+		char* end = nullptr;
+		long count = strtol(words[1].c_str(), &end, 10);
+
+		if (*end != '\0' || count < 0)
+		{
+			error = "bad count " + words[1];
+			return false;
+		}
+
+		stage.count = (int)count;
+		first = 2;
+	}
+
+	for (size_t i = first; i < words.size(); ++i)
+	{
+		size_t equals = words[i].find('=');
+		std::string name = words[i].substr(0, equals);
+
+		if (equals == std::string::npos || equals == 0 || equals == words[i].size() - 1 || std::string(settings).find(" " + name + " ") == std::string::npos)
+		{
+			error = "bad setting " + words[i] + " for " + words[0];
+			return false;
+		}
+
+		stage.settings[name] = words[i].substr(equals + 1);
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainBatch::addJob(const BatchJob& job)
+{
+	jobs.push_back(job);
+	jobs.back().status = BatchJob::WAITING;
+	jobs.back().estimatedBytes = 0;
+	jobs.back().heights = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainBatch::setStartSnapshot(const std::shared_ptr<const HeightMapSnapshot>& snapshot)
+{
+	for (BatchJob& job : jobs)
+	{
+		job.startFrom = snapshot;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainBatch::clear()
+{
+	jobs.clear();
+	nodes.clear();
+	error.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainBatch::run(int threads, BatchResults& results)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	results = BatchResults{ 0, 0, 0, 0, 0, 0.0f };
+	buildTree(results);
+
+	std::mutex lock;
+	std::condition_variable wake;
+	std::deque<int> ready;
+	int nodesLeft = (int)nodes.size();
+
+	// The roots, a flat map for each resolution and a copy of each snapshot
+	for (int i = 0; i < (int)nodes.size(); ++i)
+	{
+		if (nodes[i].parent < 0)
+		{
+			ready.push_back(i);
+		}
+	}
+
+	auto worker = [&]()
+	{
+		// The workers are already one per core, so the stages' own ParallelFors run inline rather than each starting more
+		ParallelFor::setThreadLimit(1);
+
+		std::unique_lock<std::mutex> guard(lock);
+
+		while (true)
+		{
+			wake.wait(guard, [&]() { return !ready.empty() || nodesLeft == 0; });
+
+			if (ready.empty())
+			{
+				return;
+			}
+
+			int nodeIndex = ready.front();
+			ready.pop_front();
+
+			Node& node = nodes[nodeIndex];
+			// This worker's alone, whether that means taking over the parent's or copying it is decided under the lock
+			std::shared_ptr<HeightMap> heights;
+			// The parent's, still shared, so only read from
+			std::shared_ptr<const HeightMap> source;
+
+			if (node.parent >= 0)
+			{
+				Node& parent = nodes[node.parent];
+
+				// The last child takes the height map over, unless a job ends with it or another child is still copying it
+				if (--parent.childrenLeft == 0 && parent.jobs.empty() && parent.copiesRunning == 0)
+				{
+					heights = std::move(parent.heights);
+				}
+				else
+				{
+					source = parent.heights;
+					++parent.copiesRunning;
+				}
+
+				if (parent.childrenLeft == 0)
+				{
+					parent.heights = nullptr;
+				}
+			}
+
+			guard.unlock();
+
+			if (source)
+			{
+				heights = std::make_shared<HeightMap>(*source);
+				source = nullptr;
+
+				// As soon as it's done, so the last child is less likely to have to copy as well
+				guard.lock();
+				--nodes[node.parent].copiesRunning;
+				++results.heightMapCopies;
+				guard.unlock();
+			}
+			else if (!heights)
+			{
+				heights = std::make_shared<HeightMap>();
+				heights->resize(node.resolution, HeightMap::ROW_MAJOR);
+
+				if (node.startFrom)
+				{
+					node.startFrom->copyTo(*heights);
+				}
+			}
+
+			if (node.stage)
+			{
+				applyStage(*node.stage, *heights);
+			}
+
+			guard.lock();
+
+			for (int jobIndex : node.jobs)
+			{
+				jobs[jobIndex].heights = heights;
+				jobs[jobIndex].status = BatchJob::FINISHED;
+			}
+
+			node.childrenLeft = (int)node.children.size();
+
+			if (!node.children.empty())
+			{
+				node.heights = heights;
+			}
+
+			// Children go to the front, so a branch is finished (and its height maps let go) before the next is started
+			for (auto child = node.children.rbegin(); child != node.children.rend(); ++child)
+			{
+				ready.push_front(*child);
+			}
+
+			--nodesLeft;
+			wake.notify_all();
+		}
+	};
+
+	if (threads <= 0)
+	{
+		threads = ParallelFor::getThreadCount();
+	}
+
+	// The calling thread only waits, the stages seed rand() on their own thread and mustn't change the caller's sequence
+	std::vector<std::thread> workers;
+	workers.reserve(threads);
+
+	for (int i = 0; i < threads; ++i)
+	{
+		workers.emplace_back(worker);
+	}
+
+	for (auto& thread : workers)
+	{
+		thread.join();
+	}
+
+	nodes.clear();
+
+	for (const BatchJob& job : jobs)
+	{
+		results.jobsFinished += job.status == BatchJob::FINISHED ? 1 : 0;
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	results.totalMs = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainBatch::buildTree(BatchResults& results)
+{
+	nodes.clear();
+
+	// The root node of each resolution and starting snapshot
+	std::map<std::pair<int, const HeightMapSnapshot*>, int> roots;
+
+	for (int jobIndex = 0; jobIndex < (int)jobs.size(); ++jobIndex)
+	{
+		BatchJob& job = jobs[jobIndex];
+		job.status = BatchJob::WAITING;
+		job.heights = nullptr;
+
+		if (job.startFrom)
+		{
+			job.resolution = job.startFrom->getResolution();
+		}
+
+		job.estimatedBytes = estimateJobBytes(job);
+
+		if (job.memoryLimitMB > 0 && job.estimatedBytes > (size_t)job.memoryLimitMB * 1024 * 1024)
+		{
+			job.status = BatchJob::OVER_MEMORY_LIMIT;
+			++results.jobsOverLimit;
+			continue;
+		}
+
+		auto root = std::make_pair(job.resolution, job.startFrom.get());
+
+		if (roots.find(root) == roots.end())
+		{
+			roots[root] = (int)nodes.size();
+			nodes.push_back(Node{ -1, job.resolution, job.startFrom.get(), nullptr, {}, {}, 0, 0, nullptr });
+		}
+
+		int current = roots[root];
+
+		// Follow the stages this job has in common with the jobs before it, then branch off for the rest
+		for (const BatchStage& stage : job.stages)
+		{
+			int next = -1;
+
+			for (int child : nodes[current].children)
+			{
+				if (*nodes[child].stage == stage)
+				{
+					next = child;
+					break;
+				}
+			}
+
+			if (next < 0)
+			{
+				next = (int)nodes.size();
+				nodes.push_back(Node{ current, job.resolution, nullptr, &stage, {}, {}, 0, 0, nullptr });
+				nodes[current].children.push_back(next);
+				++results.stagesRun;
+			}
+
+			current = next;
+		}
+
+		nodes[current].jobs.push_back(jobIndex);
+		results.stagesInJobs += (int)job.stages.size();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t TerrainBatch::estimateJobBytes(const BatchJob& job)
+{
+	// Extra floats per grid point each stage allocates while it runs, on top of the height map itself
+	int mostScratch = 0;
+
+	for (const BatchStage& stage : job.stages)
+	{
+		int scratch = 0;
+
+		switch (stage.type)
+		{
+			case BatchStage::SMOOTH:
+			{
+				// The averaged heights
+				scratch = 1;
+				break;
+			}
+			case BatchStage::THERMAL_EROSION:
+			{
+				// Two height buffers and the outflow
+				scratch = 3;
+				break;
+			}
+			case BatchStage::SHALLOW_WATER_EROSION:
+			{
+				// Terrain, water (twice), four fluxes, velocity x and z, capacity and sediment (twice)
+				scratch = 12;
+				break;
+			}
+			default:
+			{
+				break;
+			}
+		}
+
+		mostScratch = scratch > mostScratch ? scratch : mostScratch;
+	}
+
+	size_t points = (size_t)job.resolution * (size_t)job.resolution;
+
+	return points * sizeof(float) * (size_t)(1 + mostScratch);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float TerrainBatch::getSetting(const BatchStage& stage, const char* name, float defaultValue)
+{
+	auto found = stage.settings.find(name);
+
+	return found != stage.settings.end() ? (float)atof(found->second.c_str()) : defaultValue;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string TerrainBatch::getSettingText(const BatchStage& stage, const char* name, const char* defaultValue)
+{
+	auto found = stage.settings.find(name);
+
+	return found != stage.settings.end() ? found->second : std::string(defaultValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+unsigned int TerrainBatch::getSeed(const BatchStage& stage)
+{
+	auto found = stage.settings.find("seed");
+
+	return found != stage.settings.end() ? (unsigned int)strtoul(found->second.c_str(), nullptr, 10) : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainBatch::applyStage(const BatchStage& stage, HeightMap& heightmap)
+{
+	int resolution = heightmap.getResolution();
+	const int terrainSize = BATCH_TERRAIN_SIZE;
+	const float gridScale = (float)BATCH_TERRAIN_SIZE / (float)resolution;
+
+	switch (stage.type)
+	{
+		case BatchStage::FAULT:
+		{
+			// Faulting picks its lines with rand(), whose state is per thread in the MSVC runtime, so the seed keeps
+			// the job the same whichever worker runs it
+			srand(getSeed(stage));
+
+			Faulting faulting(resolution, heightmap);
+
+			for (int i = 0; i < stage.count; ++i)
+			{
+				faulting.createFault();
+			}
+
+			break;
+		}
+		case BatchStage::SMOOTH:
+		{
+			Smoothing smoothing(resolution, heightmap, terrainSize);
+
+			for (int i = 0; i < stage.count; ++i)
+			{
+				smoothing.smoothTerrain();
+			}
+
+			break;
+		}
+		case BatchStage::PARTICLE_DEPOSITION:
+		{
+			srand(getSeed(stage));
+
+			ParticleDeposition particleDepo(resolution, heightmap);
+
+			for (int i = 0; i < stage.count; ++i)
+			{
+				particleDepo.runParticleDepo();
+			}
+
+			break;
+		}
+		case BatchStage::PERLIN_NOISE:
+		case BatchStage::FBM:
+		case BatchStage::ERODED_FBM:
+		{
+			PerlinNoise perlinNoise(resolution, heightmap, terrainSize);
+
+			// The same defaults as the app's sliders
+			perlinNoise.setFrequency(getSetting(stage, "freq", 0.2f));
+			perlinNoise.setScale(getSetting(stage, "scale", 0.2f));
+			perlinNoise.setAmplitude(getSetting(stage, "amplitude", 5.0f));
+			perlinNoise.setRidged(getSetting(stage, "ridged", 0.0f) != 0.0f);
+			perlinNoise.setTerraced(getSetting(stage, "terraced", 0.0f) != 0.0f);
+			perlinNoise.setSeed(getSeed(stage));
+
+			std::string algorithm = getSettingText(stage, "algorithm", "improved");
+			perlinNoise.setPerlinAlgorithm(algorithm == "old" ? 'O' : (algorithm == "simplex" ? 'S' : 'I'));
+
+			if (stage.type == BatchStage::PERLIN_NOISE)
+			{
+				perlinNoise.buildPerlinNoise();
+			}
+			else if (stage.type == BatchStage::FBM)
+			{
+				perlinNoise.fracBrownianMotion();
+			}
+			else
+			{
+				perlinNoise.buildErodedfBm(stage.count);
+			}
+
+			break;
+		}
+		case BatchStage::WORLEY_NOISE:
+		{
+			WorleyNoise worleyNoise(resolution, heightmap);
+
+			worleyNoise.setFrequency(getSetting(stage, "freq", 0.05f));
+			worleyNoise.setAmplitude(getSetting(stage, "amplitude", 5.0f));
+			worleyNoise.setJitter(getSetting(stage, "jitter", 1.0f));
+			worleyNoise.setSeed(getSeed(stage));
+
+			std::string metric = getSettingText(stage, "metric", "euclidean");
+			worleyNoise.setMetric(metric == "manhattan" ? WorleyNoise::MANHATTAN : (metric == "chebyshev" ? WorleyNoise::CHEBYSHEV : WorleyNoise::EUCLIDEAN));
+
+			std::string feature = getSettingText(stage, "feature", "f1");
+			worleyNoise.setFeature(feature == "f2" ? WorleyNoise::F2 : (feature == "f2-f1" ? WorleyNoise::F2_MINUS_F1 : WorleyNoise::F1));
+
+			worleyNoise.buildWorleyNoise();
+			break;
+		}
+		case BatchStage::HYDRAULIC_EROSION:
+		{
+			// Brushes aren't shared between threads, and they're cheap enough to build per stage
+			ErosionBrushCache brushes;
+			HydraulicErosion hydraulicErosion(resolution, heightmap, brushes);
+
+			HydraulicErosion::DropletParams params = hydraulicErosion.getParams();
+			params.erosionRadius = (int)getSetting(stage, "radius", (float)params.erosionRadius);
+			params.inertia = getSetting(stage, "inertia", params.inertia);
+			params.sedimentCapacity = getSetting(stage, "capacity", params.sedimentCapacity);
+			params.minSedimentCapacity = getSetting(stage, "mincapacity", params.minSedimentCapacity);
+			params.erodeSpeed = getSetting(stage, "erodespeed", params.erodeSpeed);
+			params.depositSpeed = getSetting(stage, "depositspeed", params.depositSpeed);
+			params.evaporateSpeed = getSetting(stage, "evaporatespeed", params.evaporateSpeed);
+			params.gravity = getSetting(stage, "gravity", params.gravity);
+			params.maxDropletLifetime = (int)getSetting(stage, "lifetime", (float)params.maxDropletLifetime);
+
+			ErosionRandom random(getSeed(stage));
+
+			for (int i = 0; i < stage.count; ++i)
+			{
+				hydraulicErosion.simulateDroplet(random, params, nullptr, nullptr, nullptr);
+			}
+
+			break;
+		}
+		case BatchStage::THERMAL_EROSION:
+		{
+			ThermalErosion thermalErosion(resolution, heightmap);
+
+			thermalErosion.setTalusAngle(getSetting(stage, "talus", 35.0f));
+			thermalErosion.setErosionRate(getSetting(stage, "rate", 0.25f));
+			thermalErosion.erodeTerrain(stage.count, gridScale);
+			break;
+		}
+		case BatchStage::SHALLOW_WATER_EROSION:
+		{
+			ShallowWaterErosion shallowWaterErosion(resolution, heightmap);
+
+			shallowWaterErosion.setRainRate(getSetting(stage, "rain", 0.2f));
+			shallowWaterErosion.setEvaporationRate(getSetting(stage, "evaporation", 0.5f));
+			shallowWaterErosion.setSedimentCapacity(getSetting(stage, "capacity", 0.2f));
+			shallowWaterErosion.setDissolveRate(getSetting(stage, "dissolve", 0.3f));
+			shallowWaterErosion.setDepositRate(getSetting(stage, "deposit", 0.3f));
+			shallowWaterErosion.erodeTerrain(stage.count, gridScale);
+			break;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TerrainBatch::exportResults(const std::string& prefix, HeightMapExporter::Format format) const
+{
+	HeightMapExporter exporter;
+	bool exported = true;
+
+	for (const BatchJob& job : jobs)
+	{
+		if (job.status == BatchJob::FINISHED)
+		{
+			exported = exporter.exportHeightMap(*job.heights, prefix + job.name + HeightMapExporter::getExtension(format), format) && exported;
+		}
+	}
+
+	return exported;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const std::vector<BatchJob>& TerrainBatch::getJobs() const
+{
+	return jobs;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const std::string& TerrainBatch::getError() const
+{
+	return error;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
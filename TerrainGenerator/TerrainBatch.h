@@ -0,0 +1,155 @@
+/*
+ * This is the Terrain Batch class it handles:
+ *		- Loading a manifest of terrain jobs, each one a resolution and a list of stages (fault, smooth, noise, erosion...)
+ *		- Running the jobs on a pool of worker threads, with no window or GPU needed
+ *		- Turning away any job whose height map and scratch buffers would be over its memory limit
+ *		- Running a run of stages that several jobs start with only once, then forking the result for each of them
+ *		- Exporting every finished job's height map
+ *
+ * A job can start from a snapshot of the terrain rather than a flat map, the snapshot is only ever read so the
+ * terrain can carry on being edited while the batch runs.
+ *
+ * The jobs are put into a tree, where each node is one stage and its parent is the stage before it, so jobs that
+ * start the same way share the same nodes. A node's height map is shared by its children and any job that ends there,
+ * and it's only copied when a child is about to change it while someone else still needs it (copy-on-write), the last
+ * child to run just takes it over, unless a job ends at its parent or another child is still copying it. Each stage
+ * runs on its worker's thread alone, the workers are already one per core.
+ *
+ * Manifest, one stage per line, # for comments:
+ *		job <name> <resolution> [memory limit in MB]
+ *		<stage> [count] [setting=value ...]
+ *
+ * Stages: fault, smooth, particles, perlin, fbm, erodedfbm, worley, hydraulic, thermal, shallowwater, see applyStage()
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "HeightMap.h"
+#include "HeightMapSnapshot.h"
+#include "HeightMapExporter.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct BatchStage
+{
+	enum Type
+	{
+		FAULT = 0,
+		SMOOTH,
+		PARTICLE_DEPOSITION,
+		PERLIN_NOISE,
+		FBM,
+		ERODED_FBM,
+		WORLEY_NOISE,
+		HYDRAULIC_EROSION,
+		THERMAL_EROSION,
+		SHALLOW_WATER_EROSION
+	};
+
+	Type type;
+	int count;										// Faults, passes, particles, octaves, droplets or iterations
+	std::map<std::string, std::string> settings;	// Sorted, so two stages with the same settings always compare equal
+
+	bool operator==(const BatchStage& other) const
+	{
+		return type == other.type && count == other.count && settings == other.settings;
+	}
+};
+
+struct BatchJob
+{
+	enum Status
+	{
+		WAITING = 0,
+		FINISHED,
+		OVER_MEMORY_LIMIT
+	};
+
+	std::string name;
+	int resolution;
+	int memoryLimitMB;								// 0 for no limit
+	std::vector<BatchStage> stages;
+	std::shared_ptr<const HeightMapSnapshot> startFrom;	// nullptr for a flat map, otherwise its resolution is used
+
+	Status status;
+	size_t estimatedBytes;
+	std::shared_ptr<const HeightMap> heights;		// Can be shared with other jobs, it's never changed once the job is finished
+};
+
+// Totals from the last run()
+struct BatchResults
+{
+	int jobsFinished;
+	int jobsOverLimit;
+	int stagesInJobs;			// Every stage of every job that ran
+	int stagesRun;				// How many that actually took, the rest were shared
+	int heightMapCopies;		// Forks that had to copy, rather than take over their parent's height map
+	float totalMs;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TerrainBatch
+{
+public:
+	TerrainBatch();
+	~TerrainBatch();
+
+	// Replaces any jobs already added, false if the file can't be read or has a mistake in it, see getError()
+	bool loadManifest(const std::string& filename);
+	void addJob(const BatchJob& job);
+	// Every job added so far starts from the snapshot, i.e. to try out a batch of erosion settings on the current terrain
+	void setStartSnapshot(const std::shared_ptr<const HeightMapSnapshot>& snapshot);
+	void clear();
+
+	// Runs every job, threads 0 for one per core, returns once they're all done
+	void run(int threads, BatchResults& results);
+	// Writes <prefix><job name> for every finished job, each 16 bit one from its own lowest to highest point
+	bool exportResults(const std::string& prefix, HeightMapExporter::Format format = HeightMapExporter::PNG_16) const;
+
+	const std::vector<BatchJob>& getJobs() const;
+	const std::string& getError() const;
+
+	// What a job needs at its peak, the height map and the scratch buffers of its hungriest stage
+	static size_t estimateJobBytes(const BatchJob& job);
+	// Runs one stage on a height map, on whatever thread calls it
+	static void applyStage(const BatchStage& stage, HeightMap& heightmap);
+
+private:
+	struct Node
+	{
+		int parent;						// -1 for the height map the jobs start from, flat or a snapshot
+		int resolution;
+		const HeightMapSnapshot* startFrom;
+		const BatchStage* stage;
+		std::vector<int> children;
+		std::vector<int> jobs;			// Jobs that end at this node
+		int childrenLeft;				// Children still to take the height map, it's let go once this is 0
+		int copiesRunning;				// Children copying the height map right now, it can't be taken over until they're done
+		std::shared_ptr<HeightMap> heights;
+	};
+
+	bool parseStage(const std::vector<std::string>& words, BatchStage& stage);
+	void buildTree(BatchResults& results);
+
+	// A stage's settings, or the default if the manifest didn't give one
+	static float getSetting(const BatchStage& stage, const char* name, float defaultValue);
+	static std::string getSettingText(const BatchStage& stage, const char* name, const char* defaultValue);
+	static unsigned int getSeed(const BatchStage& stage);
+
+	std::vector<BatchJob> jobs;
+	std::vector<Node> nodes;
+	std::string error;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
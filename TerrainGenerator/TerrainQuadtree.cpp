@@ -0,0 +1,854 @@
+/*
+ * This is the Terrain Quadtree class it handles:
+ *		- Splitting the terrain into square chunks of quads
+ *		- Building a min/max height quadtree over the chunks
+ *		- Calculating the geometric error of each chunk at each level of detail
+ *		- Selecting a level of detail per chunk from the camera distance and screen space error
+ *		- Keeping neighbouring chunks within one LOD of each other
+ *		- Building the chunk index lists for every LOD, including the stitched edges between LODs
+ *		- Reordering each chunk index list for the vertex cache, and keeping the before/after cache stats
+ *
+ * Nothing in here touches D3D, so the selection can be run and checked without a device.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TerrainQuadtree.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+TerrainQuadtree::TerrainQuadtree()
+{
+	heightMap = nullptr;
+	resolution = 0;
+	gridScale = 1.0f;
+	chunkSize = 64;
+	chunksX = 0;
+	chunksZ = 0;
+	maxLOD = 0;
+	originalCacheStats = VertexCacheStats{ 0, 0, 0, 0.0f, 0.0f };
+	optimisedCacheStats = VertexCacheStats{ 0, 0, 0, 0.0f, 0.0f };
+}
+
+TerrainQuadtree::~TerrainQuadtree()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void TerrainQuadtree::build(const float* heightMp, int res, float scale, int size)
+{
+	heightMap = heightMp;
+	resolution = res;
+	gridScale = scale;
+	chunkSize = size;
+
+	// The number of quads along each side, the last chunk takes any remainder
+	// so every chunk is at least chunkSize quads wide (unless the whole terrain is smaller)
+	int quads = resolution - 1;
+	chunksX = std::max(1, quads / chunkSize);
+	chunksZ = chunksX;
+
+	chunks.resize(chunksX * chunksZ);
+
+	for (int cz = 0; cz < chunksZ; ++cz)
+	{
+		for (int cx = 0; cx < chunksX; ++cx)
+		{
+			TerrainChunk& chunk = chunks[cz * chunksX + cx];
+			chunk.x0 = cx * chunkSize;
+			chunk.z0 = cz * chunkSize;
+			chunk.x1 = (cx == chunksX - 1) ? quads : (cx + 1) * chunkSize;
+			chunk.z1 = (cz == chunksZ - 1) ? quads : (cz + 1) * chunkSize;
+		}
+	}
+
+	// Each LOD doubles the step between vertices, stop while every chunk still has an interior row of vertices
+	int minChunkWidth = (chunksX == 1) ? quads : chunkSize;
+	maxLOD = 0;
+
+	while (maxLOD < MAX_TERRAIN_LODS - 1 && (1 << (maxLOD + 1)) * 2 <= minChunkWidth)
+	{
+		++maxLOD;
+	}
+
+	nodes.clear();
+	buildNode(0, 0, chunksX, chunksZ);
+
+	updateHeights(heightMap);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TerrainQuadtree::buildNode(int chunkX0, int chunkZ0, int chunkX1, int chunkZ1)
+{
+	int nodeIndex = (int)nodes.size();
+
+	TerrainQuadtreeNode node;
+	node.minX = chunks[chunkZ0 * chunksX + chunkX0].x0 * gridScale;
+	node.minZ = chunks[chunkZ0 * chunksX + chunkX0].z0 * gridScale;
+	node.maxX = chunks[(chunkZ1 - 1) * chunksX + (chunkX1 - 1)].x1 * gridScale;
+	node.maxZ = chunks[(chunkZ1 - 1) * chunksX + (chunkX1 - 1)].z1 * gridScale;
+	node.minHeight = 0.0f;
+	node.maxHeight = 0.0f;
+	node.chunk = -1;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		node.children[i] = -1;
+	}
+
+	for (int lod = 0; lod < MAX_TERRAIN_LODS; ++lod)
+	{
+		node.lodError[lod] = 0.0f;
+	}
+
+	nodes.push_back(node);
+
+	// Leaf node, exactly one chunk
+	if (chunkX1 - chunkX0 == 1 && chunkZ1 - chunkZ0 == 1)
+	{
+		nodes[nodeIndex].chunk = chunkZ0 * chunksX + chunkX0;
+		return nodeIndex;
+	}
+
+	// Split into (up to) four quadrants
+	int midX = (chunkX1 - chunkX0 > 1) ? (chunkX0 + chunkX1) / 2 : chunkX1;
+	int midZ = (chunkZ1 - chunkZ0 > 1) ? (chunkZ0 + chunkZ1) / 2 : chunkZ1;
+
+	int xRanges[2][2] = { { chunkX0, midX }, { midX, chunkX1 } };
+	int zRanges[2][2] = { { chunkZ0, midZ }, { midZ, chunkZ1 } };
+	int childCount = 0;
+
+	for (int qz = 0; qz < 2; ++qz)
+	{
+		for (int qx = 0; qx < 2; ++qx)
+		{
+			if (xRanges[qx][0] < xRanges[qx][1] && zRanges[qz][0] < zRanges[qz][1])
+			{
+				// The nodes vector may grow while building the child, so don't hold a reference across this call
+				int child = buildNode(xRanges[qx][0], zRanges[qz][0], xRanges[qx][1], zRanges[qz][1]);
+				nodes[nodeIndex].children[childCount] = child;
+				++childCount;
+			}
+		}
+	}
+
+	return nodeIndex;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainQuadtree::updateHeights(const float* heightMp)
+{
+	heightMap = heightMp;
+
+	for (int i = 0; i < (int)chunks.size(); ++i)
+	{
+		calculateChunkHeights(chunks[i]);
+	}
+
+	// Children are always built after their parent, so walking backwards updates the tree bottom up
+	for (int i = (int)nodes.size() - 1; i >= 0; --i)
+	{
+		TerrainQuadtreeNode& node = nodes[i];
+
+		if (node.chunk >= 0)
+		{
+			const TerrainChunk& chunk = chunks[node.chunk];
+			node.minHeight = chunk.minHeight;
+			node.maxHeight = chunk.maxHeight;
+
+			for (int lod = 0; lod < MAX_TERRAIN_LODS; ++lod)
+			{
+				node.lodError[lod] = chunk.lodError[lod];
+			}
+
+			continue;
+		}
+
+		node.minHeight = FLT_MAX;
+		node.maxHeight = -FLT_MAX;
+
+		for (int lod = 0; lod < MAX_TERRAIN_LODS; ++lod)
+		{
+			node.lodError[lod] = 0.0f;
+		}
+
+		for (int c = 0; c < 4 && node.children[c] >= 0; ++c)
+		{
+			const TerrainQuadtreeNode& child = nodes[node.children[c]];
+			node.minHeight = std::min(node.minHeight, child.minHeight);
+			node.maxHeight = std::max(node.maxHeight, child.maxHeight);
+
+			for (int lod = 0; lod < MAX_TERRAIN_LODS; ++lod)
+			{
+				node.lodError[lod] = std::max(node.lodError[lod], child.lodError[lod]);
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainQuadtree::calculateChunkHeights(TerrainChunk& chunk)
+{
+	chunk.minHeight = FLT_MAX;
+	chunk.maxHeight = -FLT_MAX;
+
+	for (int z = chunk.z0; z <= chunk.z1; ++z)
+	{
+		for (int x = chunk.x0; x <= chunk.x1; ++x)
+		{
+			float height = heightMap[z * resolution + x];
+			chunk.minHeight = std::min(chunk.minHeight, height);
+			chunk.maxHeight = std::max(chunk.maxHeight, height);
+		}
+	}
+
+	// The error of a LOD is never allowed to be less than the error of the finer LOD before it,
+	// otherwise the selection could flip back to a finer LOD further away from the camera
+	chunk.lodError[0] = 0.0f;
+
+	for (int lod = 1; lod < MAX_TERRAIN_LODS; ++lod)
+	{
+		if (lod <= maxLOD)
+		{
+			chunk.lodError[lod] = std::max(calculateLODError(chunk, lod), chunk.lodError[lod - 1]);
+		}
+		else
+		{
+			chunk.lodError[lod] = FLT_MAX;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float TerrainQuadtree::calculateLODError(const TerrainChunk& chunk, int lod) const
+{
+	/*
+	* Compare every full resolution vertex against the surface of the coarser LOD at the same point.
+	* The coarse cells are split along the same diagonal as the index buffer, (xa, za) -> (xb, zb)
+	*
+	*	(xa, za) a *-------* b (xb, za)
+	*			   | \     |
+	*			   |   \   |
+	*			   |     \ |
+	*	(xa, zb) c *-------* d (xb, zb)
+	*/
+
+	std::vector<int> xCoords, zCoords;
+	getLODCoords(chunk.x0, chunk.x1, lod, xCoords);
+	getLODCoords(chunk.z0, chunk.z1, lod, zCoords);
+
+	float maxError = 0.0f;
+
+	for (int cellZ = 0; cellZ + 1 < (int)zCoords.size(); ++cellZ)
+	{
+		int za = zCoords[cellZ];
+		int zb = zCoords[cellZ + 1];
+
+		for (int cellX = 0; cellX + 1 < (int)xCoords.size(); ++cellX)
+		{
+			int xa = xCoords[cellX];
+			int xb = xCoords[cellX + 1];
+
+			float heightA = heightMap[za * resolution + xa];
+			float heightB = heightMap[za * resolution + xb];
+			float heightC = heightMap[zb * resolution + xa];
+			float heightD = heightMap[zb * resolution + xb];
+
+			for (int z = za; z <= zb; ++z)
+			{
+				float v = (float)(z - za) / (float)(zb - za);
+
+				for (int x = xa; x <= xb; ++x)
+				{
+					float u = (float)(x - xa) / (float)(xb - xa);
+					float coarseHeight;
+
+					if (u >= v)
+					{
+						coarseHeight = heightA + u * (heightB - heightA) + v * (heightD - heightB);
+					}
+					else
+					{
+						coarseHeight = heightA + v * (heightC - heightA) + u * (heightD - heightC);
+					}
+
+					maxError = std::max(maxError, fabsf(heightMap[z * resolution + x] - coarseHeight));
+				}
+			}
+		}
+	}
+
+	return maxError;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The vertex coords used along one side of a chunk at a LOD, the last step is shortened to land on 'end'
+// Chunks always start on a multiple of the largest step so a coarser LOD's coords are a subset of a finer LOD's
+void TerrainQuadtree::getLODCoords(int start, int end, int lod, std::vector<int>& coords) const
+{
+	int step = 1 << lod;
+
+	coords.clear();
+
+	for (int coord = start; coord < end; coord += step)
+	{
+		coords.push_back(coord);
+	}
+
+	coords.push_back(end);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainQuadtree::selectLOD(const XMFLOAT3& cameraPos, float viewportHeight, float fovY, float maxPixelError, std::vector<TerrainDrawItem>& drawList) const
+{
+	drawList.clear();
+
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	selectNode(0, cameraPos, viewportHeight, fovY, maxPixelError, drawList);
+	restrictNeighbourLODs(drawList);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainQuadtree::selectNode(int nodeIndex, const XMFLOAT3& cameraPos, float viewportHeight, float fovY, float maxPixelError, std::vector<TerrainDrawItem>& drawList) const
+{
+	const TerrainQuadtreeNode& node = nodes[nodeIndex];
+
+	// The closest point of the node and its worst error is conservative for every chunk below it
+	float distance = distanceToBox(cameraPos, node.minX, node.minHeight, node.minZ, node.maxX, node.maxHeight, node.maxZ);
+	int lod = chooseLOD(node.lodError, distance, viewportHeight, fovY, maxPixelError);
+
+	if (node.chunk >= 0)
+	{
+		TerrainDrawItem item;
+		item.chunk = node.chunk;
+		item.lod = lod;
+		drawList.push_back(item);
+		return;
+	}
+
+	// Nothing below this node can go any coarser, so there is no need to visit the children individually
+	if (lod == maxLOD)
+	{
+		addNodeChunks(nodeIndex, lod, drawList);
+		return;
+	}
+
+	for (int c = 0; c < 4 && node.children[c] >= 0; ++c)
+	{
+		selectNode(node.children[c], cameraPos, viewportHeight, fovY, maxPixelError, drawList);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainQuadtree::addNodeChunks(int nodeIndex, int lod, std::vector<TerrainDrawItem>& drawList) const
+{
+	const TerrainQuadtreeNode& node = nodes[nodeIndex];
+
+	if (node.chunk >= 0)
+	{
+		TerrainDrawItem item;
+		item.chunk = node.chunk;
+		item.lod = lod;
+		drawList.push_back(item);
+		return;
+	}
+
+	for (int c = 0; c < 4 && node.children[c] >= 0; ++c)
+	{
+		addNodeChunks(node.children[c], lod, drawList);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Refine any chunk that is more than one LOD coarser than a neighbour, until none are left
+// LODs only ever go down, so this always stops, and no chunk ends up coarser than its error allows
+void TerrainQuadtree::restrictNeighbourLODs(std::vector<TerrainDrawItem>& drawList) const
+{
+	std::vector<int> chunkLODs(chunks.size(), 0);
+
+	for (int i = 0; i < (int)drawList.size(); ++i)
+	{
+		chunkLODs[drawList[i].chunk] = drawList[i].lod;
+	}
+
+	const int neighbourOffsetX[EDGE_COUNT] = { 0, 1, 0, -1 };
+	const int neighbourOffsetZ[EDGE_COUNT] = { -1, 0, 1, 0 };
+
+	bool changed = true;
+
+	while (changed)
+	{
+		changed = false;
+
+		for (int cz = 0; cz < chunksZ; ++cz)
+		{
+			for (int cx = 0; cx < chunksX; ++cx)
+			{
+				int& lod = chunkLODs[cz * chunksX + cx];
+
+				for (int edge = 0; edge < EDGE_COUNT; ++edge)
+				{
+					int nx = cx + neighbourOffsetX[edge];
+					int nz = cz + neighbourOffsetZ[edge];
+
+					if (nx >= 0 && nx < chunksX && nz >= 0 && nz < chunksZ && lod > chunkLODs[nz * chunksX + nx] + 1)
+					{
+						lod = chunkLODs[nz * chunksX + nx] + 1;
+						changed = true;
+					}
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < (int)drawList.size(); ++i)
+	{
+		drawList[i].lod = chunkLODs[drawList[i].chunk];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Pick the coarsest LOD whose projected error is still under the pixel threshold
+int TerrainQuadtree::chooseLOD(const float lodError[MAX_TERRAIN_LODS], float distance, float viewportHeight, float fovY, float maxPixelError) const
+{
+	for (int lod = maxLOD; lod > 0; --lod)
+	{
+		if (screenSpaceError(lodError[lod], distance, viewportHeight, fovY) <= maxPixelError)
+		{
+			return lod;
+		}
+	}
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The size in pixels of a world space error at some distance from a perspective camera
+float TerrainQuadtree::screenSpaceError(float geometricError, float distance, float viewportHeight, float fovY)
+{
+	const float minDistance = 0.0001f;
+
+	float pixelsPerUnit = viewportHeight / (2.0f * tanf(fovY * 0.5f));
+
+	return geometricError * pixelsPerUnit / std::max(distance, minDistance);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float TerrainQuadtree::distanceToBox(const XMFLOAT3& point, float minX, float minY, float minZ, float maxX, float maxY, float maxZ) const
+{
+	float dx = std::max(std::max(minX - point.x, 0.0f), point.x - maxX);
+	float dy = std::max(std::max(minY - point.y, 0.0f), point.y - maxY);
+	float dz = std::max(std::max(minZ - point.z, 0.0f), point.z - maxZ);
+
+	return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainQuadtree::buildIndices(std::vector<unsigned long>& indices, bool optimiseForCache)
+{
+	/*
+	* Each chunk at each LOD is split into an interior grid and a ring of four edge strips.
+	* The edge strips are built once for every LOD the neighbouring chunk could be at (same or coarser),
+	* the edge vertices then always match the coarser of the two chunks, so there are no cracks.
+	*
+	* They are laid out as [interior][N E S W @ same LOD][N E S W @ LOD + 1]...
+	* so a chunk with no coarser neighbours is a single contiguous draw.
+	*
+	* Each range is built in simple row order and then reordered for the vertex cache on its own,
+	* triangles never move between ranges so the layout above still holds.
+	*/
+
+	int lodCount = maxLOD + 1;
+
+	indices.clear();
+	interiorRanges.assign(chunks.size() * lodCount, TerrainIndexRange{ 0, 0 });
+	edgeRanges.assign(chunks.size() * lodCount * EDGE_COUNT * lodCount, TerrainIndexRange{ 0, 0 });
+	originalCacheStats = VertexCacheStats{ 0, 0, 0, 0.0f, 0.0f };
+	optimisedCacheStats = VertexCacheStats{ 0, 0, 0, 0.0f, 0.0f };
+
+	std::vector<int> xCoords, zCoords;
+
+	for (int c = 0; c < (int)chunks.size(); ++c)
+	{
+		const TerrainChunk& chunk = chunks[c];
+
+		for (int lod = 0; lod < lodCount; ++lod)
+		{
+			getLODCoords(chunk.x0, chunk.x1, lod, xCoords);
+			getLODCoords(chunk.z0, chunk.z1, lod, zCoords);
+
+			TerrainIndexRange& interior = interiorRanges[c * lodCount + lod];
+			interior.start = (unsigned int)indices.size();
+
+			// Too small to have an interior ring, only happens on tiny terrains where there is only LOD 0
+			bool hasInterior = xCoords.size() > 2 && zCoords.size() > 2;
+			int first = hasInterior ? 1 : 0;
+			int lastX = hasInterior ? (int)xCoords.size() - 2 : (int)xCoords.size() - 1;
+			int lastZ = hasInterior ? (int)zCoords.size() - 2 : (int)zCoords.size() - 1;
+
+			for (int j = first; j < lastZ; ++j)
+			{
+				for (int i = first; i < lastX; ++i)
+				{
+					addTriangle(indices, xCoords[i], zCoords[j], xCoords[i + 1], zCoords[j + 1], xCoords[i], zCoords[j + 1]);
+					addTriangle(indices, xCoords[i], zCoords[j], xCoords[i + 1], zCoords[j], xCoords[i + 1], zCoords[j + 1]);
+				}
+			}
+
+			finishRange(indices, interior, optimiseForCache, lod == 0);
+
+			if (!hasInterior)
+			{
+				continue;
+			}
+
+			for (int outerLOD = lod; outerLOD < lodCount; ++outerLOD)
+			{
+				for (int edge = 0; edge < EDGE_COUNT; ++edge)
+				{
+					TerrainIndexRange& range = edgeRanges[edgeRangeIndex(c, lod, edge, outerLOD)];
+					range.start = (unsigned int)indices.size();
+					addEdgeStrip(indices, chunk, edge, lod, outerLOD);
+					finishRange(indices, range, optimiseForCache, lod == 0 && outerLOD == 0);
+				}
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Close off a range that has just been added to the end of the index list
+void TerrainQuadtree::finishRange(std::vector<unsigned long>& indices, TerrainIndexRange& range, bool optimiseForCache, bool fullResolution)
+{
+	range.count = (unsigned int)indices.size() - range.start;
+
+	if (range.count == 0)
+	{
+		return;
+	}
+
+	unsigned long* rangeIndices = &indices[range.start];
+
+	if (fullResolution)
+	{
+		MeshOptimiser::accumulateStats(originalCacheStats, MeshOptimiser::analyseVertexCache(rangeIndices, range.count));
+	}
+
+	if (optimiseForCache)
+	{
+		MeshOptimiser::optimiseVertexCache(rangeIndices, range.count);
+	}
+
+	if (fullResolution)
+	{
+		MeshOptimiser::accumulateStats(optimisedCacheStats, MeshOptimiser::analyseVertexCache(rangeIndices, range.count));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainQuadtree::addEdgeStrip(std::vector<unsigned long>& indices, const TerrainChunk& chunk, int edge, int lod, int outerLOD) const
+{
+	/*
+	* Zip the outer row of vertices (on the chunk edge, at outerLOD) to the inner row (the edge of the interior grid, at lod)
+	* Both rows are walked along the edge and the one whose next vertex comes first is advanced.
+	* The first and last triangles reach into the chunk corners, so the four strips meet along the corner diagonals.
+	*
+	*	outer	*-----------*-----------*
+	*			| \       /   \       / |
+	*	inner	|   *---*---*---*---*   |
+	*/
+
+	std::vector<int> xCoords, zCoords, outerCoords;
+	getLODCoords(chunk.x0, chunk.x1, lod, xCoords);
+	getLODCoords(chunk.z0, chunk.z1, lod, zCoords);
+
+	bool alongX = (edge == NORTH || edge == SOUTH);
+
+	if (alongX)
+	{
+		getLODCoords(chunk.x0, chunk.x1, outerLOD, outerCoords);
+	}
+	else
+	{
+		getLODCoords(chunk.z0, chunk.z1, outerLOD, outerCoords);
+	}
+
+	// The inner row runs between the first and last interior vertices
+	const std::vector<int>& innerCoords = alongX ? xCoords : zCoords;
+	int innerFirst = 1;
+	int innerLast = (int)innerCoords.size() - 2;
+
+	// The fixed coord of each row
+	int outerFixed = 0, innerFixed = 0;
+
+	switch (edge)
+	{
+	case NORTH:
+		outerFixed = chunk.z0;
+		innerFixed = zCoords[1];
+		break;
+	case SOUTH:
+		outerFixed = chunk.z1;
+		innerFixed = zCoords[zCoords.size() - 2];
+		break;
+	case WEST:
+		outerFixed = chunk.x0;
+		innerFixed = xCoords[1];
+		break;
+	case EAST:
+		outerFixed = chunk.x1;
+		innerFixed = xCoords[xCoords.size() - 2];
+		break;
+	}
+
+	int outer = 0;
+	int inner = innerFirst;
+	int outerLast = (int)outerCoords.size() - 1;
+
+	while (outer < outerLast || inner < innerLast)
+	{
+		bool advanceOuter;
+
+		if (outer == outerLast)
+		{
+			advanceOuter = false;
+		}
+		else if (inner == innerLast)
+		{
+			advanceOuter = true;
+		}
+		else
+		{
+			advanceOuter = outerCoords[outer + 1] <= innerCoords[inner + 1];
+		}
+
+		int ax, az, bx, bz, cx, cz;
+
+		if (alongX)
+		{
+			ax = outerCoords[outer];	az = outerFixed;
+			bx = innerCoords[inner];	bz = innerFixed;
+
+			if (advanceOuter)
+			{
+				cx = outerCoords[outer + 1];	cz = outerFixed;
+			}
+			else
+			{
+				cx = innerCoords[inner + 1];	cz = innerFixed;
+			}
+		}
+		else
+		{
+			ax = outerFixed;	az = outerCoords[outer];
+			bx = innerFixed;	bz = innerCoords[inner];
+
+			if (advanceOuter)
+			{
+				cx = outerFixed;	cz = outerCoords[outer + 1];
+			}
+			else
+			{
+				cx = innerFixed;	cz = innerCoords[inner + 1];
+			}
+		}
+
+		addTriangle(indices, ax, az, bx, bz, cx, cz);
+
+		if (advanceOuter)
+		{
+			++outer;
+		}
+		else
+		{
+			++inner;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Add a triangle with the same winding as the original terrain triangles, degenerate triangles are dropped
+void TerrainQuadtree::addTriangle(std::vector<unsigned long>& indices, int ax, int az, int bx, int bz, int cx, int cz) const
+{
+	int cross = (bx - ax) * (cz - az) - (bz - az) * (cx - ax);
+
+	if (cross == 0)
+	{
+		return;
+	}
+
+	indices.push_back(az * resolution + ax);
+
+	if (cross > 0)
+	{
+		indices.push_back(bz * resolution + bx);
+		indices.push_back(cz * resolution + cx);
+	}
+	else
+	{
+		indices.push_back(cz * resolution + cx);
+		indices.push_back(bz * resolution + bx);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TerrainQuadtree::edgeRangeIndex(int chunk, int lod, int edge, int outerLOD) const
+{
+	int lodCount = maxLOD + 1;
+
+	return ((chunk * lodCount + lod) * EDGE_COUNT + edge) * lodCount + outerLOD;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainQuadtree::getDrawRanges(const std::vector<TerrainDrawItem>& drawList, std::vector<TerrainIndexRange>& ranges) const
+{
+	int lodCount = maxLOD + 1;
+
+	ranges.clear();
+
+	// The LOD of every chunk being drawn this frame, -1 if it's not being drawn
+	std::vector<int> chunkLODs(chunks.size(), -1);
+
+	for (int i = 0; i < (int)drawList.size(); ++i)
+	{
+		chunkLODs[drawList[i].chunk] = drawList[i].lod;
+	}
+
+	const int neighbourOffsetX[EDGE_COUNT] = { 0, 1, 0, -1 };
+	const int neighbourOffsetZ[EDGE_COUNT] = { -1, 0, 1, 0 };
+
+	for (int i = 0; i < (int)drawList.size(); ++i)
+	{
+		int c = drawList[i].chunk;
+		int lod = drawList[i].lod;
+		int cx = c % chunksX;
+		int cz = c / chunksX;
+
+		TerrainIndexRange chunkRanges[1 + EDGE_COUNT];
+		chunkRanges[0] = interiorRanges[c * lodCount + lod];
+
+		for (int edge = 0; edge < EDGE_COUNT; ++edge)
+		{
+			int outerLOD = lod;
+			int nx = cx + neighbourOffsetX[edge];
+			int nz = cz + neighbourOffsetZ[edge];
+
+			if (nx >= 0 && nx < chunksX && nz >= 0 && nz < chunksZ && chunkLODs[nz * chunksX + nx] > lod)
+			{
+				outerLOD = chunkLODs[nz * chunksX + nx];
+			}
+
+			chunkRanges[1 + edge] = edgeRanges[edgeRangeIndex(c, lod, edge, outerLOD)];
+		}
+
+		// Merge any ranges that follow on from each other
+		for (int r = 0; r < 1 + EDGE_COUNT; ++r)
+		{
+			if (chunkRanges[r].count == 0)
+			{
+				continue;
+			}
+
+			if (!ranges.empty() && ranges.back().start + ranges.back().count == chunkRanges[r].start)
+			{
+				ranges.back().count += chunkRanges[r].count;
+			}
+			else
+			{
+				ranges.push_back(chunkRanges[r]);
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TerrainQuadtree::getChunkCount() const
+{
+	return (int)chunks.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TerrainQuadtree::getChunksX() const
+{
+	return chunksX;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TerrainQuadtree::getChunksZ() const
+{
+	return chunksZ;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TerrainQuadtree::getMaxLOD() const
+{
+	return maxLOD;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const TerrainChunk& TerrainQuadtree::getChunk(int index) const
+{
+	return chunks[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const std::vector<TerrainQuadtreeNode>& TerrainQuadtree::getNodes() const
+{
+	return nodes;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const VertexCacheStats& TerrainQuadtree::getOriginalCacheStats() const
+{
+	return originalCacheStats;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const VertexCacheStats& TerrainQuadtree::getOptimisedCacheStats() const
+{
+	return optimisedCacheStats;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,151 @@
+/*
+ * This is the Terrain Quadtree class it handles:
+ *		- Splitting the terrain into square chunks of quads
+ *		- Building a min/max height quadtree over the chunks
+ *		- Calculating the geometric error of each chunk at each level of detail
+ *		- Selecting a level of detail per chunk from the camera distance and screen space error
+ *		- Keeping neighbouring chunks within one LOD of each other
+ *		- Building the chunk index lists for every LOD, including the stitched edges between LODs
+ *		- Reordering each chunk index list for the vertex cache, and keeping the before/after cache stats
+ *
+ * Nothing in here touches D3D, so the selection can be run and checked without a device.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include "MeshOptimiser.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace DirectX;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+constexpr int MAX_TERRAIN_LODS = 6;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The vertex coords here are inclusive, i.e. a chunk covers the quads between x0 -> x1 and z0 -> z1
+struct TerrainChunk
+{
+	int x0, z0;
+	int x1, z1;
+	float minHeight;
+	float maxHeight;
+	float lodError[MAX_TERRAIN_LODS];		// Max height difference between LOD 0 and each LOD, in world units
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct TerrainQuadtreeNode
+{
+	float minX, minZ;
+	float maxX, maxZ;
+	float minHeight;
+	float maxHeight;
+	float lodError[MAX_TERRAIN_LODS];		// Max of all the chunks below this node
+	int children[4];						// -1 if there is no child
+	int chunk;								// -1 if this is not a leaf
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A single entry in the draw list, which chunk to draw and at what LOD
+struct TerrainDrawItem
+{
+	int chunk;
+	int lod;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct TerrainIndexRange
+{
+	unsigned int start;
+	unsigned int count;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TerrainQuadtree
+{
+public:
+	enum ChunkEdge
+	{
+		NORTH = 0,		// z = z0
+		EAST,			// x = x1
+		SOUTH,			// z = z1
+		WEST,			// x = x0
+		EDGE_COUNT
+	};
+
+	TerrainQuadtree();
+	~TerrainQuadtree();
+
+	// Build the chunk layout and the tree, this only needs redone when the resolution changes
+	void build(const float* heightMap, int resolution, float gridScale, int chunkSize = 64);
+	// Refresh the heights and errors after the height map has been modified
+	void updateHeights(const float* heightMap);
+
+	// Fill the draw list with one entry per chunk, the result only depends on the values passed in
+	// Neighbouring chunks (sharing an edge) never differ by more than one LOD
+	void selectLOD(const XMFLOAT3& cameraPos, float viewportHeight, float fovY, float maxPixelError, std::vector<TerrainDrawItem>& drawList) const;
+	static float screenSpaceError(float geometricError, float distance, float viewportHeight, float fovY);
+
+	// Index lists for all chunks at all LODs, and the ranges used to draw a chunk within them
+	void buildIndices(std::vector<unsigned long>& indices, bool optimiseForCache = true);
+	void getDrawRanges(const std::vector<TerrainDrawItem>& drawList, std::vector<TerrainIndexRange>& ranges) const;
+
+	int getChunkCount() const;
+	int getChunksX() const;
+	int getChunksZ() const;
+	int getMaxLOD() const;
+	const TerrainChunk& getChunk(int index) const;
+	const std::vector<TerrainQuadtreeNode>& getNodes() const;
+	// The vertex cache stats of the full resolution terrain (every chunk at LOD 0), before and after reordering
+	const VertexCacheStats& getOriginalCacheStats() const;
+	const VertexCacheStats& getOptimisedCacheStats() const;
+
+private:
+	int buildNode(int chunkX0, int chunkZ0, int chunkX1, int chunkZ1);
+	void selectNode(int nodeIndex, const XMFLOAT3& cameraPos, float viewportHeight, float fovY, float maxPixelError, std::vector<TerrainDrawItem>& drawList) const;
+	void addNodeChunks(int nodeIndex, int lod, std::vector<TerrainDrawItem>& drawList) const;
+	void restrictNeighbourLODs(std::vector<TerrainDrawItem>& drawList) const;
+	int chooseLOD(const float lodError[MAX_TERRAIN_LODS], float distance, float viewportHeight, float fovY, float maxPixelError) const;
+	float distanceToBox(const XMFLOAT3& point, float minX, float minY, float minZ, float maxX, float maxY, float maxZ) const;
+
+	void calculateChunkHeights(TerrainChunk& chunk);
+	float calculateLODError(const TerrainChunk& chunk, int lod) const;
+	void getLODCoords(int start, int end, int lod, std::vector<int>& coords) const;
+	void addTriangle(std::vector<unsigned long>& indices, int ax, int az, int bx, int bz, int cx, int cz) const;
+	void addEdgeStrip(std::vector<unsigned long>& indices, const TerrainChunk& chunk, int edge, int lod, int outerLOD) const;
+	int edgeRangeIndex(int chunk, int lod, int edge, int outerLOD) const;
+	void finishRange(std::vector<unsigned long>& indices, TerrainIndexRange& range, bool optimiseForCache, bool fullResolution);
+
+	const float* heightMap;
+	int resolution;
+	float gridScale;
+	int chunkSize;
+	int chunksX;
+	int chunksZ;
+	int maxLOD;
+
+	std::vector<TerrainChunk> chunks;
+	std::vector<TerrainQuadtreeNode> nodes;
+
+	// Filled by buildIndices
+	std::vector<TerrainIndexRange> interiorRanges;		// [chunk][lod]
+	std::vector<TerrainIndexRange> edgeRanges;			// [chunk][lod][edge][outerLOD]
+	VertexCacheStats originalCacheStats;
+	VertexCacheStats optimisedCacheStats;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -5,6 +5,9 @@
  *		- Init the texture sampler
  *		- Init a texture bounds buffer used for blending textures
  *		- Init a noise type buffer used to determine which type of noise is being generated
+ *		- Init a grid buffer used by the vertex shader to rebuild positions and UVs from the vertex ID
+ *		- Binding the erosion maps, used as splat masks on top of the height based texturing
+ *		- Drawing the selected terrain chunk index ranges
  *
  *
  * Original @author Abertay University.
@@ -41,6 +44,12 @@ TerrainShader::~TerrainShader()
 		matrixBuffer = 0;
 	}
 	
+	if (gridBuffer)
+	{
+		gridBuffer->Release();
+		gridBuffer = 0;
+	}
+
 	if (noiseStyleBuffer)
 	{
 		noiseStyleBuffer->Release();
@@ -78,13 +87,14 @@ void TerrainShader::initShader(const wchar_t* vsFilename, const wchar_t* psFilen
 {
 	D3D11_BUFFER_DESC matrixBufferDesc;
 	D3D11_BUFFER_DESC lightBufferDesc;
+	D3D11_BUFFER_DESC gridBufferDesc;
 	D3D11_BUFFER_DESC nosieStyleBufferDesc;
 	D3D11_BUFFER_DESC texturingBoundsBufferDesc;
 
 	D3D11_SAMPLER_DESC samplerDesc;
 
 	// Load (+ compile) shader files
-	loadVertexShader(vsFilename);
+	loadTerrainVertexShader(vsFilename);
 	loadPixelShader(psFilename);
 
 	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
@@ -96,6 +106,15 @@ void TerrainShader::initShader(const wchar_t* vsFilename, const wchar_t* psFilen
 	matrixBufferDesc.StructureByteStride = 0;
 	renderer->CreateBuffer(&matrixBufferDesc, NULL, &matrixBuffer);
 
+	// Setup the description of the grid constant buffer that is in the vertex shader.
+	gridBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	gridBufferDesc.ByteWidth = sizeof(GridBufferType);
+	gridBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	gridBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	gridBufferDesc.MiscFlags = 0;
+	gridBufferDesc.StructureByteStride = 0;
+	renderer->CreateBuffer(&gridBufferDesc, NULL, &gridBuffer);
+
 	// Create a texture sampler state description.
 	samplerDesc.Filter = D3D11_FILTER_ANISOTROPIC;
 	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
@@ -138,6 +157,45 @@ void TerrainShader::initShader(const wchar_t* vsFilename, const wchar_t* psFilen
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// The same as BaseShader::loadVertexShader, but with the input layout for the compact TerrainVertexType
+void TerrainShader::loadTerrainVertexShader(const wchar_t* filename)
+{
+	ID3DBlob* vertexShaderBuffer;
+
+	unsigned int numElements;
+
+	vertexShaderBuffer = 0;
+
+	// Reads compiled shader into buffer (bytecode).
+	HRESULT result = D3DReadFileToBlob(filename, &vertexShaderBuffer);
+	if (result != S_OK)
+	{
+		MessageBox(NULL, filename, L"File ERROR", MB_OK);
+		exit(0);
+	}
+
+	// Create the vertex shader from the buffer.
+	renderer->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader);
+
+	// Create the vertex input layout description.
+	// This setup needs to match the TerrainVertexType stucture in TerrainVertex.h and in the shader.
+	// Positions and UVs are not in the layout, they are rebuilt from SV_VertexID.
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[] = {
+		{ "HEIGHT", 0, DXGI_FORMAT_R32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+	};
+
+	// Get a count of the elements in the layout.
+	numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
+
+	// Create the vertex input layout.
+	renderer->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &layout);
+
+	// Release the vertex shader buffer since it is no longer needed.
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+}
+
 void TerrainShader::setShaderParameters(ID3D11DeviceContext* deviceContext,
 	const XMMATRIX &worldMatrix,
 	const XMMATRIX &viewMatrix,
@@ -145,10 +203,15 @@ void TerrainShader::setShaderParameters(ID3D11DeviceContext* deviceContext,
 	ID3D11ShaderResourceView* texture1,
 	ID3D11ShaderResourceView* texture2,
 	ID3D11ShaderResourceView* texture3,
+	ID3D11ShaderResourceView* erosionMaps,
 	Light* light,
 	float style,
+	float erosionMapStrength,
 	XMFLOAT4 normalTexturingBounds,
-	XMFLOAT4 ridgedTexturingBounds)
+	XMFLOAT4 ridgedTexturingBounds,
+	int terrainResolution,
+	float gridScale,
+	float uvIncrement)
 {
 	HRESULT result;
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
@@ -168,6 +231,17 @@ void TerrainShader::setShaderParameters(ID3D11DeviceContext* deviceContext,
 	deviceContext->Unmap(matrixBuffer, 0);
 	deviceContext->VSSetConstantBuffers(0, 1, &matrixBuffer);
 
+	// Send the grid data to the vertex shader so it can rebuild the x/z positions and UVs
+	GridBufferType* gridPtr;
+	deviceContext->Map(gridBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	gridPtr = (GridBufferType*)mappedResource.pData;
+	gridPtr->resolution = (unsigned int)terrainResolution;
+	gridPtr->gridScale = gridScale;
+	gridPtr->uvIncrement = uvIncrement;
+	gridPtr->padding = 0.0f;
+	deviceContext->Unmap(gridBuffer, 0);
+	deviceContext->VSSetConstantBuffers(1, 1, &gridBuffer);
+
 	//Additional
 	// Send light data to pixel shader
 	LightBufferType* lightPtr;
@@ -183,7 +257,9 @@ void TerrainShader::setShaderParameters(ID3D11DeviceContext* deviceContext,
 	deviceContext->Map(noiseStyleBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 	noiseStylePtr = (NoiseBufferType*)mappedResource.pData;
 	noiseStylePtr->noiseStyle = style;
-	noiseStylePtr->noisePadding = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	// Without the maps there's nothing to splat with
+	noiseStylePtr->erosionMapStrength = erosionMaps ? erosionMapStrength : 0.0f;
+	noiseStylePtr->noisePadding = XMFLOAT2(0.0f, 0.0f);
 	deviceContext->Unmap(noiseStyleBuffer, 0);
 	deviceContext->PSSetConstantBuffers(1, 1, &noiseStyleBuffer);
 
@@ -206,7 +282,30 @@ void TerrainShader::setShaderParameters(ID3D11DeviceContext* deviceContext,
 	deviceContext->PSSetShaderResources(0, 1, &texture1);
 	deviceContext->PSSetShaderResources(1, 1, &texture2);
 	deviceContext->PSSetShaderResources(2, 1, &texture3);
+	deviceContext->PSSetShaderResources(3, 1, &erosionMaps);
 	deviceContext->PSSetSamplers(0, 1, &sampleState);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainShader::renderRanges(ID3D11DeviceContext* deviceContext, const std::vector<TerrainIndexRange>& ranges)
+{
+	// Set the vertex input layout.
+	deviceContext->IASetInputLayout(layout);
+
+	// Set the vertex and pixel shaders that will be used to render.
+	deviceContext->VSSetShader(vertexShader, NULL, 0);
+	deviceContext->PSSetShader(pixelShader, NULL, 0);
+	deviceContext->CSSetShader(NULL, NULL, 0);
+	deviceContext->HSSetShader(NULL, NULL, 0);
+	deviceContext->DSSetShader(NULL, NULL, 0);
+	deviceContext->GSSetShader(NULL, NULL, 0);
+
+	// The indices are absolute vertex IDs, the base vertex MUST stay 0 as SV_VertexID does not include it
+	for (int i = 0; i < (int)ranges.size(); ++i)
+	{
+		deviceContext->DrawIndexed(ranges[i].count, ranges[i].start, 0);
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
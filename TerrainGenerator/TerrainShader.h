@@ -5,6 +5,9 @@
  *		- Init the texture sampler
  *		- Init a texture bounds buffer used for blending textures
  *		- Init a noise type buffer used to determine which type of noise is being generated
+ *		- Init a grid buffer used by the vertex shader to rebuild positions and UVs from the vertex ID
+ *		- Binding the erosion maps, used as splat masks on top of the height based texturing
+ *		- Drawing the selected terrain chunk index ranges
  *
  *
  * Original @author Abertay University.
@@ -17,6 +20,8 @@
 // INCLUDES
 #pragma once
 #include "DXF.h"
+#include "TerrainQuadtree.h"
+#include <vector>
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -35,10 +40,19 @@ private:
 		float padding;
 	};
 
+	struct GridBufferType
+	{
+		unsigned int resolution;
+		float gridScale;
+		float uvIncrement;
+		float padding;
+	};
+
 	struct NoiseBufferType
 	{
 		float noiseStyle;
-		XMFLOAT3 noisePadding;
+		float erosionMapStrength;
+		XMFLOAT2 noisePadding;
 	};
 
 	struct TextureBoundsBufferType
@@ -67,17 +81,27 @@ public:
 		ID3D11ShaderResourceView* texture1,
 		ID3D11ShaderResourceView* texture2,
 		ID3D11ShaderResourceView* texture3,
+		ID3D11ShaderResourceView* erosionMaps,
 		Light* light,
 		float noiseStyle,
+		float erosionMapStrength,
 		XMFLOAT4 normalTexturingBounds,
-		XMFLOAT4 ridgedTexturingBounds);
+		XMFLOAT4 ridgedTexturingBounds,
+		int terrainResolution,
+		float gridScale,
+		float uvIncrement);
+
+	// Draw each range of the terrain index buffer, in place of BaseShader::render
+	void renderRanges(ID3D11DeviceContext* deviceContext, const std::vector<TerrainIndexRange>& ranges);
 
 private:
 	void initShader(const wchar_t* cs, const wchar_t* ps);
+	void loadTerrainVertexShader(const wchar_t* filename);
 
 private:
 	ID3D11Buffer * matrixBuffer;
 	ID3D11Buffer* lightBuffer;
+	ID3D11Buffer* gridBuffer;
 	ID3D11Buffer* noiseStyleBuffer;
 	ID3D11Buffer* texturingBoundsBuffer;
 
@@ -0,0 +1,134 @@
+/*
+ * This is the compact terrain vertex format and packing class it handles:
+ *		- Defining the 8 byte terrain vertex (height + octahedral encoded normal)
+ *		- Packing heights and normals into the vertex stream (SSE, 4 vertices at a time)
+ *		- Encoding/Decoding single normals to/from the octahedral representation
+ *
+ * The x/z position and the UVs of a terrain vertex are pure functions of its grid index,
+ * so they are NOT stored, they are rebuilt from SV_VertexID in terrain_vs.hlsl.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TerrainVertex.h"
+#include <emmintrin.h>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void TerrainVertexPacker::packVertices(const float* heights, const float* normalX, const float* normalY, const float* normalZ, int count, TerrainVertexType* outVertices)
+{
+	// Ref:
+	// Cigolle, Z. et al. (2014) A Survey of Efficient Representations for Independent Unit Vectors
+	// http://jcgt.org/published/0003/02/01/
+
+	/*
+	* Octahedral encoding, with y as the "up" axis of the octahedron:
+	*	- Project the normal onto the octahedron |x| + |y| + |z| = 1
+	*	- The upper half (y >= 0) is stored as is using the x and z coords
+	*	- The lower half (y < 0) is folded out over the diagonals
+	*	- Both coords are then stored as 16 bit signed normalised integers
+	*/
+
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 snormScale = _mm_set1_ps(32767.0f);
+
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(normalX + i);
+		__m128 y = _mm_loadu_ps(normalY + i);
+		__m128 z = _mm_loadu_ps(normalZ + i);
+
+		// Project onto the octahedron
+		__m128 absX = _mm_andnot_ps(signMask, x);
+		__m128 absY = _mm_andnot_ps(signMask, y);
+		__m128 absZ = _mm_andnot_ps(signMask, z);
+		__m128 invL1 = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(absX, absY), absZ));
+
+		__m128 px = _mm_mul_ps(x, invL1);
+		__m128 pz = _mm_mul_ps(z, invL1);
+
+		// Fold the lower hemisphere, sign(p) is +/-1 with the same sign bit as p
+		__m128 absPX = _mm_andnot_ps(signMask, px);
+		__m128 absPZ = _mm_andnot_ps(signMask, pz);
+		__m128 signPX = _mm_or_ps(one, _mm_and_ps(signMask, px));
+		__m128 signPZ = _mm_or_ps(one, _mm_and_ps(signMask, pz));
+		__m128 foldX = _mm_mul_ps(_mm_sub_ps(one, absPZ), signPX);
+		__m128 foldZ = _mm_mul_ps(_mm_sub_ps(one, absPX), signPZ);
+
+		__m128 lowerHalf = _mm_cmplt_ps(y, zero);
+		px = _mm_or_ps(_mm_and_ps(lowerHalf, foldX), _mm_andnot_ps(lowerHalf, px));
+		pz = _mm_or_ps(_mm_and_ps(lowerHalf, foldZ), _mm_andnot_ps(lowerHalf, pz));
+
+		// To snorm16, saturating pack takes care of any +/-1 overshoot
+		__m128i ix = _mm_cvtps_epi32(_mm_mul_ps(px, snormScale));
+		__m128i iz = _mm_cvtps_epi32(_mm_mul_ps(pz, snormScale));
+		__m128i oct = _mm_packs_epi32(_mm_unpacklo_epi32(ix, iz), _mm_unpackhi_epi32(ix, iz));
+
+		// Interleave with the heights, each vertex is [height][octX, octZ]
+		__m128i h = _mm_castps_si128(_mm_loadu_ps(heights + i));
+		_mm_storeu_si128((__m128i*)(outVertices + i), _mm_unpacklo_epi32(h, oct));
+		_mm_storeu_si128((__m128i*)(outVertices + i + 2), _mm_unpackhi_epi32(h, oct));
+	}
+
+	// Any remaining vertices
+	for (; i < count; ++i)
+	{
+		outVertices[i].height = heights[i];
+		encodeNormal(normalX[i], normalY[i], normalZ[i], outVertices[i].octNormal);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TerrainVertexPacker::encodeNormal(float x, float y, float z, short outOct[2])
+{
+	float invL1 = 1.0f / (fabsf(x) + fabsf(y) + fabsf(z));
+	float px = x * invL1;
+	float pz = z * invL1;
+
+	if (y < 0.0f)
+	{
+		float foldX = (1.0f - fabsf(pz)) * (px >= 0.0f ? 1.0f : -1.0f);
+		float foldZ = (1.0f - fabsf(px)) * (pz >= 0.0f ? 1.0f : -1.0f);
+		px = foldX;
+		pz = foldZ;
+	}
+
+	outOct[0] = (short)roundf(fminf(fmaxf(px, -1.0f), 1.0f) * 32767.0f);
+	outOct[1] = (short)roundf(fminf(fmaxf(pz, -1.0f), 1.0f) * 32767.0f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+XMFLOAT3 TerrainVertexPacker::decodeNormal(const short oct[2])
+{
+	// Must match decodeOctNormal in terrain_vs.hlsl
+	float px = fmaxf(oct[0] / 32767.0f, -1.0f);
+	float pz = fmaxf(oct[1] / 32767.0f, -1.0f);
+	float y = 1.0f - fabsf(px) - fabsf(pz);
+
+	if (y < 0.0f)
+	{
+		float foldX = (1.0f - fabsf(pz)) * (px >= 0.0f ? 1.0f : -1.0f);
+		float foldZ = (1.0f - fabsf(px)) * (pz >= 0.0f ? 1.0f : -1.0f);
+		px = foldX;
+		pz = foldZ;
+	}
+
+	float mag = sqrtf(px * px + y * y + pz * pz);
+
+	return XMFLOAT3(px / mag, y / mag, pz / mag);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,51 @@
+/*
+ * This is the compact terrain vertex format and packing class it handles:
+ *		- Defining the 8 byte terrain vertex (height + octahedral encoded normal)
+ *		- Packing heights and normals into the vertex stream (SSE, 4 vertices at a time)
+ *		- Encoding/Decoding single normals to/from the octahedral representation
+ *
+ * The x/z position and the UVs of a terrain vertex are pure functions of its grid index,
+ * so they are NOT stored, they are rebuilt from SV_VertexID in terrain_vs.hlsl.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <DirectXMath.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace DirectX;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// This must match the input layout in TerrainShader and the InputType in terrain_vs.hlsl
+struct TerrainVertexType
+{
+	float height;				// DXGI_FORMAT_R32_FLOAT
+	short octNormal[2];			// DXGI_FORMAT_R16G16_SNORM
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TerrainVertexPacker
+{
+public:
+	// Pack 'count' vertices, the normals are passed in as seperate x, y, z arrays (SoA) so they can be loaded 4 at a time
+	static void packVertices(const float* heights, const float* normalX, const float* normalY, const float* normalZ, int count, TerrainVertexType* outVertices);
+
+	static void encodeNormal(float x, float y, float z, short outOct[2]);
+	static XMFLOAT3 decodeNormal(const short oct[2]);
+
+private:
+	// Private constructors/destructors, i.e. you cannot create and instance of this class
+	TerrainVertexPacker() {};
+	~TerrainVertexPacker() {};
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,187 @@
+/*
+ * This is the Thermal Erosion class it handles:
+ *		- Running a thermal (talus) erosion pass, where material slides from a point to its lower neighbours
+ *		  wherever the slope between them is steeper than the talus angle
+ *
+ * Each iteration reads only the last iteration's heights and writes to a second buffer (Jacobi style),
+ * so the result doesn't depend on the order points are visited in, and the rows can be split between
+ * threads with no locking and the same result every time.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "ThermalErosion.h"
+#include "ParallelFor.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The Von Neumann neighbourhood, the same 4 neighbours the smoothing uses
+const int NEIGHBOUR_X[4] = { -1, 1, 0, 0 };
+const int NEIGHBOUR_Z[4] = { 0, 0, -1, 1 };
+
+const float DEGREES_TO_RADIANS = 3.14159265f / 180.0f;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+ThermalErosion::ThermalErosion(int& res, HeightMap& heightmp) : resolution(res), heightmap(heightmp)
+{
+	// Default values
+	talusAngle = 35.0f;
+	erosionRate = 0.25f;
+	talusHeight = 0.0f;
+}
+
+ThermalErosion::~ThermalErosion()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void ThermalErosion::erodeTerrain(int iterations, float gridScale)
+{
+	// Ref:
+	// Musgrave, F. K., Kolb, C. E. and Mace, R. S. (1989) The synthesis and rendering of eroded fractal terrains
+	// https://dl.acm.org/doi/10.1145/74334.74337
+
+	if (iterations <= 0)
+	{
+		return;
+	}
+
+	talusHeight = tanf(talusAngle * DEGREES_TO_RADIANS) * gridScale;
+
+	// Both buffers use the height map's layout, so they can be copied straight to and from it
+	const int storageSize = heightmap.getStorageSize();
+	heightsA.assign(heightmap.data(), heightmap.data() + storageSize);
+	heightsB = heightsA;
+	outflow.resize(storageSize);
+
+	float* src = heightsA.data();
+	float* dst = heightsB.data();
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		// All the outflows have to be known before any point can gather what flows into it
+		ParallelFor::run(resolution, [this, src](int startZ, int endZ)
+		{
+			findOutflow(src, startZ, endZ);
+		});
+
+		ParallelFor::run(resolution, [this, src, dst](int startZ, int endZ)
+		{
+			moveMaterial(src, dst, startZ, endZ);
+		});
+
+		std::swap(src, dst);
+	}
+
+	// src holds the last iteration's heights after the swap
+	memcpy(heightmap.data(), src, storageSize * sizeof(float));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThermalErosion::findOutflow(const float* src, int startZ, int endZ)
+{
+	for (int z = startZ; z < endZ; ++z)
+	{
+		for (int x = 0; x < resolution; ++x)
+		{
+			const float height = src[heightmap.index(x, z)];
+			float steepest = 0.0f;
+			float totalExcess = 0.0f;
+
+			for (int n = 0; n < 4; ++n)
+			{
+				int nx = x + NEIGHBOUR_X[n];
+				int nz = z + NEIGHBOUR_Z[n];
+
+				// The edges only have the neighbours that are on the map
+				if (nx < 0 || nz < 0 || nx >= resolution || nz >= resolution)
+				{
+					continue;
+				}
+
+				float drop = height - src[heightmap.index(nx, nz)];
+
+				if (drop > talusHeight)
+				{
+					totalExcess += drop - talusHeight;
+					steepest = drop > steepest ? drop : steepest;
+				}
+			}
+
+			// The amount moved is a share of the steepest drop's excess, split between the lower neighbours by their excess,
+			// so per unit of a neighbour's excess that's rate * (steepest - talus) / total excess
+			outflow[heightmap.index(x, z)] = totalExcess > 0.0f ? erosionRate * (steepest - talusHeight) / totalExcess : 0.0f;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThermalErosion::moveMaterial(const float* src, float* dst, int startZ, int endZ)
+{
+	for (int z = startZ; z < endZ; ++z)
+	{
+		for (int x = 0; x < resolution; ++x)
+		{
+			const int index = heightmap.index(x, z);
+			const float height = src[index];
+			float change = 0.0f;
+
+			for (int n = 0; n < 4; ++n)
+			{
+				int nx = x + NEIGHBOUR_X[n];
+				int nz = z + NEIGHBOUR_Z[n];
+
+				if (nx < 0 || nz < 0 || nx >= resolution || nz >= resolution)
+				{
+					continue;
+				}
+
+				const int neighbour = heightmap.index(nx, nz);
+				float drop = height - src[neighbour];
+
+				// Down to the neighbour it's our outflow, up to it it's the neighbour's, so whatever leaves one point arrives at the other
+				if (drop > talusHeight)
+				{
+					change -= outflow[index] * (drop - talusHeight);
+				}
+				else if (-drop > talusHeight)
+				{
+					change += outflow[neighbour] * (-drop - talusHeight);
+				}
+			}
+
+			dst[index] = height + change;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThermalErosion::setTalusAngle(float degrees)
+{
+	talusAngle = degrees;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThermalErosion::setErosionRate(float rate)
+{
+	erosionRate = rate < 0.0f ? 0.0f : (rate > 0.5f ? 0.5f : rate);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
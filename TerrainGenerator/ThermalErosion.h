@@ -0,0 +1,56 @@
+/*
+ * This is the Thermal Erosion class it handles:
+ *		- Running a thermal (talus) erosion pass, where material slides from a point to its lower neighbours
+ *		  wherever the slope between them is steeper than the talus angle
+ *
+ * Each iteration reads only the last iteration's heights and writes to a second buffer (Jacobi style),
+ * so the result doesn't depend on the order points are visited in, and the rows can be split between
+ * threads with no locking and the same result every time.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <vector>
+#include "HeightMap.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ThermalErosion
+{
+public:
+	ThermalErosion(int& res, HeightMap& heightmp);
+	~ThermalErosion();
+
+	// gridScale is the world space distance between neighbouring grid points, so the talus angle is the same at any resolution
+	void erodeTerrain(int iterations, float gridScale);
+	// The steepest slope material can rest at, in degrees
+	void setTalusAngle(float degrees);
+	// How much of the material over the talus angle moves each iteration, 0 -> 0.5, any more and it overshoots
+	void setErosionRate(float rate);
+
+private:
+	// How much of each unit of over-steep height difference leaves each point, from the heights in src
+	void findOutflow(const float* src, int startZ, int endZ);
+	// Each point's new height, what it had, less what flows out, plus what flows in from its neighbours
+	void moveMaterial(const float* src, float* dst, int startZ, int endZ);
+
+	int& resolution;
+	HeightMap& heightmap;
+
+	float talusAngle;
+	float erosionRate;
+	float talusHeight;			// The talus angle as a height difference between neighbours
+
+	// The two height buffers, and each point's outflow from findOutflow()
+	std::vector<float> heightsA;
+	std::vector<float> heightsB;
+	std::vector<float> outflow;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,85 @@
+/*
+ * This is the Tree Mesh class it handles:
+ *		- Setting up buffers for a whole tree's worth of geometry at once, i.e. every branch or every leaf merged together
+ *
+ * The vertices are the same as every other mesh's, the tree shader draws them once per instance in the forest.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TreeMesh.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+TreeMesh::TreeMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const std::vector<Vertex>& vertices, const std::vector<unsigned long>& indices)
+{
+	init(device, vertices, indices);
+}
+
+// Release resources.
+TreeMesh::~TreeMesh()
+{
+	// Run parent deconstructor
+	BaseMesh::~BaseMesh();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void TreeMesh::initBuffers(ID3D11Device* device)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The geometry's already been built, it just needs copying into the buffers
+void TreeMesh::init(ID3D11Device* device, const std::vector<Vertex>& vertices, const std::vector<unsigned long>& indices)
+{
+	// A tree with no leaves yet is still a valid mesh, it just never draws anything
+	if (vertices.empty() || indices.empty())
+	{
+		return;
+	}
+
+	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
+	D3D11_SUBRESOURCE_DATA vertexData, indexData;
+
+	// Set up the description of the static vertex buffer.
+	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	vertexBufferDesc.ByteWidth = sizeof(VertexType) * (UINT)vertices.size();
+	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDesc.CPUAccessFlags = 0;
+	vertexBufferDesc.MiscFlags = 0;
+	vertexBufferDesc.StructureByteStride = 0;
+	// Give the subresource structure a pointer to the vertex data.
+	vertexData.pSysMem = vertices.data();
+	vertexData.SysMemPitch = 0;
+	vertexData.SysMemSlicePitch = 0;
+	// Now create the vertex buffer.
+	device->CreateBuffer(&vertexBufferDesc, &vertexData, &vertexBuffer);
+
+	// Set up the description of the static index buffer.
+	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	indexBufferDesc.ByteWidth = sizeof(unsigned long) * (UINT)indices.size();
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDesc.CPUAccessFlags = 0;
+	indexBufferDesc.MiscFlags = 0;
+	indexBufferDesc.StructureByteStride = 0;
+	// Give the subresource structure a pointer to the index data.
+	indexData.pSysMem = indices.data();
+	indexData.SysMemPitch = 0;
+	indexData.SysMemSlicePitch = 0;
+	// Create the index buffer.
+	device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
+
+	vertexCount = (int)vertices.size();
+	indexCount = (int)indices.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,40 @@
+/*
+ * This is the Tree Mesh class it handles:
+ *		- Setting up buffers for a whole tree's worth of geometry at once, i.e. every branch or every leaf merged together
+ *
+ * The vertices are the same as every other mesh's, the tree shader draws them once per instance in the forest.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include "BaseMesh.h"
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace DirectX;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TreeMesh : public BaseMesh
+{
+public:
+	// So the geometry can be put together before there's a mesh to put it in
+	typedef VertexType Vertex;
+
+	TreeMesh(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const std::vector<Vertex>& vertices, const std::vector<unsigned long>& indices);
+	~TreeMesh();
+
+protected:
+	void initBuffers(ID3D11Device* device);
+
+	void init(ID3D11Device* device, const std::vector<Vertex>& vertices, const std::vector<unsigned long>& indices);
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,335 @@
+/*
+ * This is the Tree Shader class it handles:
+ *		- Init the Light buffer
+ *		- Init the matrix buffer
+ *		- Init a tree buffer holding the scale every placed tree is drawn at
+ *		- Init the texture sampler
+ *		- Init the instanced tree shader files, one vertex shader with the light (bark) and leaf pixel shaders
+ *		- Keeping the placed trees in an instance buffer, so each tree variant's trees are drawn with one call
+ *
+ * The instance buffer holds VegetationInstances as they are, 16 bytes a tree, the vertex shader turns each one into
+ * its transform the same way TreeTemplateCache::getInstanceTransform does.
+ *
+ * Original @author Abertay University.
+ * Updated by @author D. Green.
+ * 
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TreeShader.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+TreeShader::TreeShader(ID3D11Device* device, HWND hwnd) : BaseShader(device, hwnd)
+{
+	// Default values
+	matrixBuffer = 0;
+	lightBuffer = 0;
+	treeBuffer = 0;
+	sampleState = 0;
+	leafPixelShader = 0;
+	barkPixelShader = 0;
+	drawLeaves = false;
+	instanceBuffer = 0;
+	instanceCapacity = 0;
+
+	initShader(L"tree_vs.cso", L"light_ps.cso");
+}
+
+TreeShader::~TreeShader()
+{
+	// Release the instance buffer.
+	if (instanceBuffer)
+	{
+		instanceBuffer->Release();
+		instanceBuffer = 0;
+	}
+
+	// Release the leaf pixel shader, the bark one is released by the base shader.
+	if (leafPixelShader)
+	{
+		leafPixelShader->Release();
+		leafPixelShader = 0;
+	}
+
+	// Release the sampler state.
+	if (sampleState)
+	{
+		sampleState->Release();
+		sampleState = 0;
+	}
+
+	// Release the matrix constant buffer.
+	if (matrixBuffer)
+	{
+		matrixBuffer->Release();
+		matrixBuffer = 0;
+	}
+
+	// Release the layout.
+	if (layout)
+	{
+		layout->Release();
+		layout = 0;
+	}
+
+	// Release the light constant buffer.
+	if (lightBuffer)
+	{
+		lightBuffer->Release();
+		lightBuffer = 0;
+	}
+
+	// Release the tree constant buffer.
+	if (treeBuffer)
+	{
+		treeBuffer->Release();
+		treeBuffer = 0;
+	}
+
+	//Release base shader components
+	BaseShader::~BaseShader();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void TreeShader::initShader(const wchar_t* vsFilename, const wchar_t* psFilename)
+{
+	D3D11_BUFFER_DESC matrixBufferDesc;
+	D3D11_SAMPLER_DESC samplerDesc;
+	D3D11_BUFFER_DESC lightBufferDesc;
+	D3D11_BUFFER_DESC treeBufferDesc;
+
+	// Load (+ compile) shader files
+	// The leaf pixel shader is loaded first and kept aside, then the bark (light) one is left as the base shader's
+	loadTreeVertexShader(vsFilename);
+	loadPixelShader(L"leaf_ps.cso");
+	leafPixelShader = pixelShader;
+	pixelShader = 0;
+	loadPixelShader(psFilename);
+	barkPixelShader = pixelShader;
+
+	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader.
+	matrixBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	matrixBufferDesc.ByteWidth = sizeof(MatrixBufferType);
+	matrixBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	matrixBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	matrixBufferDesc.MiscFlags = 0;
+	matrixBufferDesc.StructureByteStride = 0;
+	renderer->CreateBuffer(&matrixBufferDesc, NULL, &matrixBuffer);
+
+	// Setup the description of the tree constant buffer that is in the vertex shader.
+	treeBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	treeBufferDesc.ByteWidth = sizeof(TreeBufferType);
+	treeBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	treeBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	treeBufferDesc.MiscFlags = 0;
+	treeBufferDesc.StructureByteStride = 0;
+	renderer->CreateBuffer(&treeBufferDesc, NULL, &treeBuffer);
+
+	// Create a texture sampler state description.
+	samplerDesc.Filter = D3D11_FILTER_ANISOTROPIC;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.MipLODBias = 0.0f;
+	samplerDesc.MaxAnisotropy = 1;
+	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+	samplerDesc.MinLOD = 0;
+	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+	renderer->CreateSamplerState(&samplerDesc, &sampleState);
+
+	// Setup light buffer
+	// Setup the description of the light dynamic constant buffer that is in the pixel shader.
+	// Note that ByteWidth always needs to be a multiple of 16 if using D3D11_BIND_CONSTANT_BUFFER or CreateBuffer will fail.
+	lightBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	lightBufferDesc.ByteWidth = sizeof(LightBufferType);
+	lightBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	lightBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	lightBufferDesc.MiscFlags = 0;
+	lightBufferDesc.StructureByteStride = 0;
+	renderer->CreateBuffer(&lightBufferDesc, NULL, &lightBuffer);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TreeShader::loadTreeVertexShader(const wchar_t* filename)
+{
+	ID3DBlob* vertexShaderBuffer;
+
+	unsigned int numElements;
+
+	vertexShaderBuffer = 0;
+
+	// Reads compiled shader into buffer (bytecode).
+	HRESULT result = D3DReadFileToBlob(filename, &vertexShaderBuffer);
+	if (result != S_OK)
+	{
+		MessageBox(NULL, filename, L"File ERROR", MB_OK);
+		exit(0);
+	}
+
+	// Create the vertex shader from the buffer.
+	renderer->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader);
+
+	// Create the vertex input layout description.
+	// Slot 0 is the tree mesh's VertexType, slot 1 is one VegetationInstance per tree, these need to match
+	// VegetationScatter.h and the shader.
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[] = {
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "INSTANCEPOSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "INSTANCEROTATION", 0, DXGI_FORMAT_R16_UINT, 1, 12, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "INSTANCESCALE", 0, DXGI_FORMAT_R8_UINT, 1, 14, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+	};
+
+	// Get a count of the elements in the layout.
+	numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
+
+	// Create the vertex input layout.
+	renderer->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &layout);
+
+	// Release the vertex shader buffer since it is no longer needed.
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TreeShader::setInstances(ID3D11DeviceContext* deviceContext, const std::vector<VegetationInstance>& instances)
+{
+	if (instances.empty())
+	{
+		return;
+	}
+
+	// Grow to fit with some to spare, so a few more trees coming into view doesn't remake the buffer every frame
+	if ((int)instances.size() > instanceCapacity)
+	{
+		if (instanceBuffer)
+		{
+			instanceBuffer->Release();
+			instanceBuffer = 0;
+		}
+
+		instanceCapacity = (int)instances.size() + (int)instances.size() / 2;
+
+		D3D11_BUFFER_DESC instanceBufferDesc;
+		instanceBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+		instanceBufferDesc.ByteWidth = sizeof(VegetationInstance) * instanceCapacity;
+		instanceBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		instanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		instanceBufferDesc.MiscFlags = 0;
+		instanceBufferDesc.StructureByteStride = 0;
+
+		if (FAILED(renderer->CreateBuffer(&instanceBufferDesc, NULL, &instanceBuffer)))
+		{
+			instanceBuffer = 0;
+			instanceCapacity = 0;
+			return;
+		}
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+	if (FAILED(deviceContext->Map(instanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
+	{
+		return;
+	}
+
+	memcpy(mappedResource.pData, instances.data(), sizeof(VegetationInstance) * instances.size());
+	deviceContext->Unmap(instanceBuffer, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TreeShader::setShaderParameters(ID3D11DeviceContext* deviceContext,
+	const XMMATRIX& worldMatrix,
+	const XMMATRIX& viewMatrix,
+	const XMMATRIX& projectionMatrix,
+	ID3D11ShaderResourceView* texture,
+	Light* light,
+	float treeScale,
+	bool leaves)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	MatrixBufferType* dataPtr;
+
+	XMMATRIX tworld, tview, tproj;
+
+	// Transpose the matrices to prepare them for the shader.
+	tworld = XMMatrixTranspose(worldMatrix);
+	tview = XMMatrixTranspose(viewMatrix);
+	tproj = XMMatrixTranspose(projectionMatrix);
+	result = deviceContext->Map(matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	dataPtr = (MatrixBufferType*)mappedResource.pData;
+	dataPtr->world = tworld;// worldMatrix;
+	dataPtr->view = tview;
+	dataPtr->projection = tproj;
+	deviceContext->Unmap(matrixBuffer, 0);
+	deviceContext->VSSetConstantBuffers(0, 1, &matrixBuffer);
+
+	// Send the tree scale to the vertex shader
+	TreeBufferType* treePtr;
+	deviceContext->Map(treeBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	treePtr = (TreeBufferType*)mappedResource.pData;
+	treePtr->treeScale = treeScale;
+	treePtr->padding = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	deviceContext->Unmap(treeBuffer, 0);
+	deviceContext->VSSetConstantBuffers(1, 1, &treeBuffer);
+
+	//Additional
+	// Send light data to pixel shader
+	LightBufferType* lightPtr;
+	deviceContext->Map(lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	lightPtr = (LightBufferType*)mappedResource.pData;
+	lightPtr->diffuse = light->getDiffuseColour();
+	lightPtr->direction = light->getDirection();
+	lightPtr->padding = 0.0f;
+	deviceContext->Unmap(lightBuffer, 0);
+	deviceContext->PSSetConstantBuffers(0, 1, &lightBuffer);
+
+	// Set shader texture resource in the pixel shader.
+	deviceContext->PSSetShaderResources(0, 1, &texture);
+	deviceContext->PSSetSamplers(0, 1, &sampleState);
+
+	drawLeaves = leaves;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TreeShader::renderInstances(ID3D11DeviceContext* deviceContext, int indexCount, int instanceCount, int firstInstance)
+{
+	if (!instanceBuffer || instanceCount <= 0)
+	{
+		return;
+	}
+
+	unsigned int stride = sizeof(VegetationInstance);
+	unsigned int offset = 0;
+
+	// The mesh's own vertices stay on slot 0 from sendData, the instances go alongside on slot 1
+	deviceContext->IASetVertexBuffers(1, 1, &instanceBuffer, &stride, &offset);
+
+	// Set the vertex input layout.
+	deviceContext->IASetInputLayout(layout);
+
+	// Set the vertex and pixel shaders that will be used to render.
+	deviceContext->VSSetShader(vertexShader, NULL, 0);
+	deviceContext->PSSetShader(drawLeaves ? leafPixelShader : barkPixelShader, NULL, 0);
+	deviceContext->CSSetShader(NULL, NULL, 0);
+	deviceContext->HSSetShader(NULL, NULL, 0);
+	deviceContext->DSSetShader(NULL, NULL, 0);
+	deviceContext->GSSetShader(NULL, NULL, 0);
+
+	// Render the variant's trees.
+	deviceContext->DrawIndexedInstanced(indexCount, instanceCount, 0, 0, firstInstance);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
@@ -0,0 +1,88 @@
+/*
+ * This is the Tree Shader class it handles:
+ *		- Init the Light buffer
+ *		- Init the matrix buffer
+ *		- Init a tree buffer holding the scale every placed tree is drawn at
+ *		- Init the texture sampler
+ *		- Init the instanced tree shader files, one vertex shader with the light (bark) and leaf pixel shaders
+ *		- Keeping the placed trees in an instance buffer, so each tree variant's trees are drawn with one call
+ *
+ * The instance buffer holds VegetationInstances as they are, 16 bytes a tree, the vertex shader turns each one into
+ * its transform the same way TreeTemplateCache::getInstanceTransform does.
+ *
+ * Original @author Abertay University.
+ * Updated by @author D. Green.
+ * 
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include "DXF.h"
+#include "VegetationScatter.h"
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+using namespace DirectX;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TreeShader : public BaseShader
+{
+private:
+	struct LightBufferType
+	{
+		XMFLOAT4 diffuse;
+		XMFLOAT3 direction;
+		float padding;
+	};
+
+	struct TreeBufferType
+	{
+		float treeScale;
+		XMFLOAT3 padding;
+	};
+
+public:
+	TreeShader(ID3D11Device* device, HWND hwnd);
+	~TreeShader();
+
+	// Copies the instances into the instance buffer, growing it if it's too small, the draws each use a run of them
+	void setInstances(ID3D11DeviceContext* deviceContext, const std::vector<VegetationInstance>& instances);
+
+	// The world matrix takes the terrain's local space (where the trees are placed) to the world
+	// Leaves are drawn with the leaf pixel shader, bark with the light one
+	void setShaderParameters(ID3D11DeviceContext* deviceContext,
+		const XMMATRIX& world,
+		const XMMATRIX& view,
+		const XMMATRIX& projection,
+		ID3D11ShaderResourceView* texture,
+		Light* light,
+		float treeScale,
+		bool leaves);
+
+	// Draws the mesh last sent once for each instance from firstInstance on, in place of BaseShader::render
+	void renderInstances(ID3D11DeviceContext* deviceContext, int indexCount, int instanceCount, int firstInstance);
+
+private:
+	void initShader(const wchar_t* vs, const wchar_t* ps);
+	void loadTreeVertexShader(const wchar_t* filename);
+
+private:
+	ID3D11Buffer* matrixBuffer;
+	ID3D11Buffer* lightBuffer;
+	ID3D11Buffer* treeBuffer;
+	ID3D11SamplerState* sampleState;
+
+	ID3D11PixelShader* leafPixelShader;
+	ID3D11PixelShader* barkPixelShader;
+	bool drawLeaves;
+
+	ID3D11Buffer* instanceBuffer;
+	int instanceCapacity;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,370 @@
+/*
+ * This is the Tree Template Cache class it handles:
+ *		- Growing a handful of tree variants from the L-system once, each from its own seed rather than rand()
+ *		- Merging each variant's branches into one mesh and its leaves into another, reordered for the vertex cache
+ *		- Keeping each variant's bounds, so a placed tree can be culled without looking at its geometry
+ *		- Handing out a variant by its ID, i.e. a VegetationInstance's variant, with the transform to place it
+ *
+ * Each variant is grown the same way "Build Entire Tree" grows the single tree, every iteration's branches added on
+ * top of the last's, with the same spread of random angles and leaves, so a template looks like one of those trees.
+ * However many trees are placed, only the variants are ever grown or have buffers, a placed tree is just an ID and
+ * a transform, and each variant's trees can all be drawn with its buffers set once.
+ *
+ * Everything is in the tree's own space, the trunk starts at the origin going up y and is 1 unit long.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TreeTemplateCache.h"
+#include "LSystem.h"
+#include "MeshOptimiser.h"
+#include "ParallelFor.h"
+#include "ErosionRandom.h"
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <stack>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The same as the single tree, see App1::buildCyl3DTree and App1::addLeaf
+const float BRANCH_LENGTH_SCALE = 0.68f;
+const float BRANCH_RADIUS_SCALE = 0.60f;
+const float TRUNK_BOTTOM_RADIUS = 0.1f;
+const float TRUNK_TOP_RADIUS = 0.05f;
+const int BRANCH_SLICES = 6;
+const float LEAF_SCALE = 0.02f;
+const int FIRST_LEAF_ITERATION = 4;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+TreeTemplateCache::TreeTemplateCache()
+{
+	// Default values
+	vertexCount = 0;
+	branchCount = 0;
+}
+
+TreeTemplateCache::~TreeTemplateCache()
+{
+	clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void TreeTemplateCache::build(ID3D11Device* device, ID3D11DeviceContext* deviceContext, int count, unsigned int seed, int iterations)
+{
+	clear();
+
+	std::vector<std::vector<TreeMesh::Vertex>> barkVertices(count), leafVertices(count);
+	std::vector<std::vector<unsigned long>> barkIndices(count), leafIndices(count);
+
+	// Growing and reordering is all CPU work, the buffers have to be made on this thread afterwards
+	ParallelFor::run(count, [&](int start, int end)
+	{
+		for (int i = start; i < end; ++i)
+		{
+			growTree(seed + i, iterations, barkVertices[i], barkIndices[i], leafVertices[i], leafIndices[i]);
+
+			if (!barkIndices[i].empty())
+			{
+				MeshOptimiser::optimiseVertexCache(barkIndices[i].data(), (int)barkIndices[i].size());
+			}
+
+			if (!leafIndices[i].empty())
+			{
+				MeshOptimiser::optimiseVertexCache(leafIndices[i].data(), (int)leafIndices[i].size());
+			}
+		}
+	}, 1);
+
+	for (int i = 0; i < count; ++i)
+	{
+		TreeTemplate tree;
+		tree.bark = new TreeMesh(device, deviceContext, barkVertices[i], barkIndices[i]);
+		tree.leaves = new TreeMesh(device, deviceContext, leafVertices[i], leafIndices[i]);
+		tree.branchCount = (int)barkIndices[i].size() / (BRANCH_SLICES * 6);
+		tree.leafCount = (int)leafIndices[i].size() / 6;
+
+		// Everything the tree draws, leaves and all
+		tree.boundsMin = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+		tree.boundsMax = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+		for (int part = 0; part < 2; ++part)
+		{
+			const std::vector<TreeMesh::Vertex>& vertices = part == 0 ? barkVertices[i] : leafVertices[i];
+
+			for (int v = 0; v < (int)vertices.size(); ++v)
+			{
+				const XMFLOAT3& position = vertices[v].position;
+				tree.boundsMin = XMFLOAT3(fminf(tree.boundsMin.x, position.x), fminf(tree.boundsMin.y, position.y), fminf(tree.boundsMin.z, position.z));
+				tree.boundsMax = XMFLOAT3(fmaxf(tree.boundsMax.x, position.x), fmaxf(tree.boundsMax.y, position.y), fmaxf(tree.boundsMax.z, position.z));
+			}
+		}
+
+		vertexCount += (int)(barkVertices[i].size() + leafVertices[i].size());
+		branchCount += tree.branchCount;
+		templates.push_back(tree);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TreeTemplateCache::clear()
+{
+	for (int i = 0; i < (int)templates.size(); ++i)
+	{
+		delete templates[i].bark;
+		templates[i].bark = nullptr;
+
+		delete templates[i].leaves;
+		templates[i].leaves = nullptr;
+	}
+
+	templates.clear();
+	vertexCount = 0;
+	branchCount = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TreeTemplateCache::getTemplateCount() const
+{
+	return (int)templates.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const TreeTemplate& TreeTemplateCache::getTemplate(int id) const
+{
+	return templates[id % templates.size()];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+XMMATRIX TreeTemplateCache::getInstanceTransform(const VegetationInstance& instance, float scale)
+{
+	float treeScale = instance.getScale() * scale;
+
+	return XMMatrixScaling(treeScale, treeScale, treeScale) * XMMatrixRotationY(instance.getRotation()) * XMMatrixTranslation(instance.x, instance.y, instance.z);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TreeTemplateCache::buildInstanceBounds(const std::vector<VegetationInstance>& instances, float scale, const XMMATRIX& terrainTransform, BoundingBoxList& bounds) const
+{
+	bounds.clear();
+
+	if (templates.empty())
+	{
+		return;
+	}
+
+	bounds.reserve((int)instances.size());
+
+	for (int i = 0; i < (int)instances.size(); ++i)
+	{
+		const TreeTemplate& tree = getTemplate(instances[i].variant);
+		XMFLOAT3 worldMin, worldMax;
+
+		Frustum::transformBox(getInstanceTransform(instances[i], scale) * terrainTransform, tree.boundsMin, tree.boundsMax, worldMin, worldMax);
+		bounds.add(worldMin, worldMax);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TreeTemplateCache::getVertexCount() const
+{
+	return vertexCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TreeTemplateCache::getBranchCount() const
+{
+	return branchCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TreeTemplateCache::growTree(unsigned int seed, int iterations, std::vector<TreeMesh::Vertex>& barkVertices, std::vector<unsigned long>& barkIndices,
+	std::vector<TreeMesh::Vertex>& leafVertices, std::vector<unsigned long>& leafIndices)
+{
+	struct TurtleState
+	{
+		XMVECTOR position;
+		XMMATRIX rotation;
+		float length;
+		float bottomRadius;
+		float topRadius;
+	};
+
+	LSystem system("FA");
+	std::map<std::string, bool> systems;
+	systems.emplace("3DCylTree", true);
+
+	ErosionRandom random(seed);
+
+	// Like "Build Entire Tree", each iteration's tree is added on top of the last's, then the system is iterated
+	for (int iteration = 0; iteration < iterations; ++iteration)
+	{
+		const std::string systemString = system.GetCurrentSystem();
+
+		const XMVECTOR left = XMVectorSet(-1, 0, 0, 0);
+		const XMVECTOR dir = XMVectorSet(0, 1, 0, 0);
+		XMVECTOR pos = XMVectorSet(0, 0, 0, 1);
+		XMMATRIX currRot = XMMatrixIdentity();
+		float branchLengthMult = 1.0f;
+		float btmRad = TRUNK_BOTTOM_RADIUS;
+		float topRad = TRUNK_TOP_RADIUS;
+
+		std::stack<TurtleState> saved;
+
+		for (int i = 0; i < (int)systemString.length(); ++i)
+		{
+			// The same spread of angles as the single tree, 40 -> 120 degrees around and 12.5 -> 35 degrees of pitch
+			float randomMultiplier = random.nextFloat();
+			randomMultiplier += randomMultiplier < 0.5f ? 0.5f : 0.0f;
+
+			switch (systemString[i])
+			{
+			case 'A':
+				// No leaves low down the trunk, then a 50/50 chance of one
+				if (iteration >= FIRST_LEAF_ITERATION && (random.next() & 1))
+				{
+					addLeaf(pos, leafVertices, leafIndices);
+				}
+
+				break;
+			case 'F':
+			{
+				XMVECTOR newBranchLength = XMVectorScale(dir, branchLengthMult);
+				addBranch(currRot * XMMatrixTranslationFromVector(pos), branchLengthMult, btmRad, topRad, barkVertices, barkIndices);
+				pos += XMVector3TransformNormal(newBranchLength, currRot);
+				break;
+			}
+			case '[':				// Save
+			{
+				TurtleState state = { pos, currRot, branchLengthMult, btmRad, topRad };
+				saved.push(state);
+
+				branchLengthMult *= BRANCH_LENGTH_SCALE;
+				btmRad = topRad;
+				topRad *= BRANCH_RADIUS_SCALE;
+				break;
+			}
+			case ']':				// Restore
+				pos = saved.top().position;
+				currRot = saved.top().rotation;
+				branchLengthMult = saved.top().length;
+				btmRad = saved.top().bottomRadius;
+				topRad = saved.top().topRadius;
+				saved.pop();
+				break;
+			case '&':				// Pitch
+			{
+				float pitch = (float)(random.next() % 10 + 25) * randomMultiplier;
+				currRot *= XMMatrixRotationAxis(XMVector3TransformNormal(left, currRot), XMConvertToRadians(pitch));
+				break;
+			}
+			case '>':				// Rotate right
+			case '<':				// Rotate left
+			{
+				float theta = (float)(random.next() % 40 + 80) * randomMultiplier;
+				theta = systemString[i] == '>' ? -theta : theta;
+				currRot *= XMMatrixRotationAxis(XMVector3TransformNormal(dir, currRot), XMConvertToRadians(theta));
+				break;
+			}
+			}
+		}
+
+		system.Iterate(systems);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TreeTemplateCache::addBranch(const XMMATRIX& transform, float length, float bottomRadius, float topRadius, std::vector<TreeMesh::Vertex>& vertices, std::vector<unsigned long>& indices)
+{
+	// The same as a CylinderMesh with 1 stack, but already moved into place
+	const unsigned long first = (unsigned long)vertices.size();
+	const unsigned long ringVertexCount = BRANCH_SLICES + 1;
+	const float dTheta = 2.0f * XM_PI / BRANCH_SLICES;
+
+	for (int i = 0; i < 2; ++i)
+	{
+		float y = i * length;
+		float r = i == 0 ? bottomRadius : topRadius;
+
+		for (int j = 0; j <= BRANCH_SLICES; ++j)
+		{
+			float c = cosf(j * dTheta);
+			float s = sinf(j * dTheta);
+
+			TreeMesh::Vertex vertex;
+			XMStoreFloat3(&vertex.position, XMVector3Transform(XMVectorSet(r * c, y, r * s, 1.0f), transform));
+			XMStoreFloat3(&vertex.normal, XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(c, 0.0f, s, 0.0f), transform)));
+			vertex.texture = XMFLOAT2((float)j / BRANCH_SLICES, 1.0f - i);
+
+			vertices.push_back(vertex);
+		}
+	}
+
+	for (unsigned long j = 0; j < BRANCH_SLICES; ++j)
+	{
+		indices.push_back(first + j);
+		indices.push_back(first + ringVertexCount + j + 1);
+		indices.push_back(first + ringVertexCount + j);
+
+		indices.push_back(first + j);
+		indices.push_back(first + j + 1);
+		indices.push_back(first + ringVertexCount + j + 1);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TreeTemplateCache::addLeaf(const XMVECTOR& position, std::vector<TreeMesh::Vertex>& vertices, std::vector<unsigned long>& indices)
+{
+	// The quad is built around the position then turned about it, the same as the single tree's leaves are drawn
+	XMMATRIX turn = XMMatrixIdentity();
+
+	if (XMVectorGetX(XMVector3LengthSq(position)) > 1e-12f)
+	{
+		turn = XMMatrixRotationAxis(position, -5.0f);
+	}
+
+	const unsigned long first = (unsigned long)vertices.size();
+	const float cornersX[4] = { -1.0f, -1.0f, 1.0f, 1.0f };		// Bottom left, top left, top right, bottom right
+	const float cornersY[4] = { -1.0f, 1.0f, 1.0f, -1.0f };
+	const XMFLOAT2 uvs[4] = { XMFLOAT2(0.0f, 1.0f), XMFLOAT2(0.0f, 0.0f), XMFLOAT2(1.0f, 0.0f), XMFLOAT2(1.0f, 1.0f) };
+
+	for (int i = 0; i < 4; ++i)
+	{
+		XMVECTOR corner = XMVectorAdd(position, XMVectorSet(cornersX[i] * LEAF_SCALE, cornersY[i] * LEAF_SCALE, 0.0f, 0.0f));
+
+		TreeMesh::Vertex vertex;
+		XMStoreFloat3(&vertex.position, XMVector3Transform(corner, turn));
+		XMStoreFloat3(&vertex.normal, XMVector3TransformNormal(XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f), turn));
+		vertex.texture = uvs[i];
+
+		vertices.push_back(vertex);
+	}
+
+	const unsigned long quad[6] = { 0, 2, 1, 0, 3, 2 };
+
+	for (int i = 0; i < 6; ++i)
+	{
+		indices.push_back(first + quad[i]);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,84 @@
+/*
+ * This is the Tree Template Cache class it handles:
+ *		- Growing a handful of tree variants from the L-system once, each from its own seed rather than rand()
+ *		- Merging each variant's branches into one mesh and its leaves into another, reordered for the vertex cache
+ *		- Keeping each variant's bounds, so a placed tree can be culled without looking at its geometry
+ *		- Handing out a variant by its ID, i.e. a VegetationInstance's variant, with the transform to place it
+ *
+ * Each variant is grown the same way "Build Entire Tree" grows the single tree, every iteration's branches added on
+ * top of the last's, with the same spread of random angles and leaves, so a template looks like one of those trees.
+ * However many trees are placed, only the variants are ever grown or have buffers, a placed tree is just an ID and
+ * a transform, and each variant's trees can all be drawn with its buffers set once.
+ *
+ * Everything is in the tree's own space, the trunk starts at the origin going up y and is 1 unit long.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <DirectXMath.h>
+#include <vector>
+#include "TreeMesh.h"
+#include "VegetationScatter.h"
+#include "FrustumCulling.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace DirectX;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct TreeTemplate
+{
+	TreeMesh* bark;
+	TreeMesh* leaves;
+	XMFLOAT3 boundsMin;
+	XMFLOAT3 boundsMax;
+	int branchCount;
+	int leafCount;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TreeTemplateCache
+{
+public:
+	TreeTemplateCache();
+	~TreeTemplateCache();
+
+	// Replaces any variants already built, variant i is always grown from the same seed, seed + i
+	void build(ID3D11Device* device, ID3D11DeviceContext* deviceContext, int count, unsigned int seed, int iterations);
+	void clear();
+
+	int getTemplateCount() const;
+	// Out of range IDs wrap around, so instances scattered for more variants than were built still get a tree
+	// There MUST be at least one variant built
+	const TreeTemplate& getTemplate(int id) const;
+
+	// Tree space to the terrain's local space, grown from the instance's position, turned and scaled by it and by scale
+	static XMMATRIX getInstanceTransform(const VegetationInstance& instance, float scale);
+	// One box per instance, in the space terrainTransform takes the terrain's local space to, i.e. the world
+	void buildInstanceBounds(const std::vector<VegetationInstance>& instances, float scale, const XMMATRIX& terrainTransform, BoundingBoxList& bounds) const;
+
+	// Totals over all the variants, for the GUI
+	int getVertexCount() const;
+	int getBranchCount() const;
+
+private:
+	// All on the CPU, so the variants can be grown on all threads, the geometry is only turned into meshes once it's finished
+	static void growTree(unsigned int seed, int iterations, std::vector<TreeMesh::Vertex>& barkVertices, std::vector<unsigned long>& barkIndices,
+		std::vector<TreeMesh::Vertex>& leafVertices, std::vector<unsigned long>& leafIndices);
+	static void addBranch(const XMMATRIX& transform, float length, float bottomRadius, float topRadius, std::vector<TreeMesh::Vertex>& vertices, std::vector<unsigned long>& indices);
+	static void addLeaf(const XMVECTOR& position, std::vector<TreeMesh::Vertex>& vertices, std::vector<unsigned long>& indices);
+
+	std::vector<TreeTemplate> templates;
+	int vertexCount;
+	int branchCount;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
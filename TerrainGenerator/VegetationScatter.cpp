@@ -0,0 +1,372 @@
+/*
+ * This is the Vegetation Scatter class it handles:
+ *		- Scattering trees over the terrain with Poisson-disk sampling, so no two are ever closer than the spacing
+ *		- Thinning them out by slope, by height (a band, i.e. above the water and below the snow) and by where the droplet
+ *		  erosion's water flowed
+ *		- Packing each tree into a 16 byte instance, with its position, rotation, scale and which tree variant it is
+ *
+ * The map is split into tiles, a few dozen trees across, and filled a quarter of the tiles at a time, every other tile
+ * in x and z, so the tiles being filled at the same time are never next to each other. Each tile grows its own points
+ * out from a random first one (Bridson's algorithm), checking against a grid covering the whole map that already holds
+ * the points of any neighbouring tile filled before it. Every tile has its own random generator, seeded from the seed
+ * and the tile, so the same seed always gives the same trees, in the same order, however many threads there are.
+ *
+ * The thinning happens after the sampling, so thinned out areas keep the same spacing, there's just less of it used.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "VegetationScatter.h"
+#include "ParallelFor.h"
+#include "ErosionRandom.h"
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Bridson's algorithm, how many points around an existing one are tried before giving up on it
+const int CANDIDATES_PER_POINT = 30;
+
+// How many random first points a tile tries, and tries again with once its points stop growing, so a tile hemmed in
+// by its neighbours' points still has its gaps found
+const int TILE_SEED_THROWS = 16;
+
+// Grid cells (each spacing / root 2 across, so they can only ever hold 1 point) along a tile's side
+const int CELLS_PER_TILE = 16;
+
+// Keeps the grid to a sensible size however small the spacing is set
+const int MAX_GRID_WIDTH = 4096;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+VegetationScatter::VegetationScatter()
+{
+	// Default values
+	params.seed = 0;
+	params.spacing = 2.0f;
+	params.maxSlope = 35.0f;
+	params.lowHeight = 3.0f;
+	params.highHeight = 7.0f;
+	params.bandFade = 1.0f;
+	params.flowWeight = 0.0f;
+	params.minScale = 0.75f;
+	params.maxScale = 1.25f;
+	params.variants = 1;
+
+	candidateCount = 0;
+	gridScale = 1.0f;
+	mapSize = 0.0f;
+	spacing = 0.0f;
+	cellSize = 0.0f;
+	gridWidth = 0;
+	flowScale = 0.0f;
+}
+
+VegetationScatter::~VegetationScatter()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void VegetationScatter::setParams(const Params& newParams)
+{
+	params = newParams;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const VegetationScatter::Params& VegetationScatter::getParams() const
+{
+	return params;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VegetationScatter::scatter(const HeightMapSampler& heights, const HeightMap* flow, float newGridScale, std::vector<VegetationInstance>& instances)
+{
+	instances.clear();
+	candidateCount = 0;
+
+	const int resolution = heights.getResolution();
+
+	if (resolution < 2)
+	{
+		return;
+	}
+
+	gridScale = newGridScale;
+	mapSize = (resolution - 1) * gridScale;
+
+	// Every cell fits inside a circle the spacing across, so no cell can hold more than 1 point
+	spacing = params.spacing > mapSize / MAX_GRID_WIDTH ? params.spacing : mapSize / MAX_GRID_WIDTH;
+	cellSize = spacing / sqrtf(2.0f);
+	gridWidth = (int)ceilf(mapSize / cellSize);
+	gridX.assign((size_t)gridWidth * gridWidth, -1.0f);
+	gridZ.assign((size_t)gridWidth * gridWidth, -1.0f);
+
+	// The flow is scaled on a log scale, like the erosion map texture, the main channels carry far more than the rest
+	flowScale = 0.0f;
+
+	if (flow && flow->getResolution() == resolution && params.flowWeight != 0.0f)
+	{
+		float largest = 0.0f;
+
+		for (int i = 0; i < flow->getStorageSize(); ++i)
+		{
+			largest = (*flow)[i] > largest ? (*flow)[i] : largest;
+		}
+
+		flowScale = largest > 0.0f ? 1.0f / logf(1.0f + largest) : 0.0f;
+	}
+
+	const int tilesWide = (gridWidth + CELLS_PER_TILE - 1) / CELLS_PER_TILE;
+	std::vector<std::vector<VegetationInstance>> tileTrees((size_t)tilesWide * tilesWide);
+	std::vector<int> tileCandidates((size_t)tilesWide * tilesWide, 0);
+
+	// A quarter of the tiles at a time, none of them touching, and always in the same order
+	for (int pass = 0; pass < 4; ++pass)
+	{
+		std::vector<int> tiles;
+
+		for (int tileZ = pass >> 1; tileZ < tilesWide; tileZ += 2)
+		{
+			for (int tileX = pass & 1; tileX < tilesWide; tileX += 2)
+			{
+				tiles.push_back(tileZ * tilesWide + tileX);
+			}
+		}
+
+		ParallelFor::run((int)tiles.size(), [&](int start, int end)
+		{
+			for (int t = start; t < end; ++t)
+			{
+				int tile = tiles[t];
+				fillTile(tile % tilesWide, tile / tilesWide, heights, flow, tileTrees[tile], tileCandidates[tile]);
+			}
+		}, 1);
+	}
+
+	// Put together in tile order, so trees close together on the map are close together in the buffer too
+	size_t treeCount = 0;
+
+	for (int tile = 0; tile < (int)tileTrees.size(); ++tile)
+	{
+		treeCount += tileTrees[tile].size();
+		candidateCount += tileCandidates[tile];
+	}
+
+	instances.reserve(treeCount);
+
+	for (int tile = 0; tile < (int)tileTrees.size(); ++tile)
+	{
+		instances.insert(instances.end(), tileTrees[tile].begin(), tileTrees[tile].end());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int VegetationScatter::getCandidateCount() const
+{
+	return candidateCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VegetationScatter::fillTile(int tileX, int tileZ, const HeightMapSampler& heights, const HeightMap* flow, std::vector<VegetationInstance>& trees, int& candidates)
+{
+	// Nearby seeds start off alike, so the first few numbers are thrown away
+	ErosionRandom random(params.seed ^ ((unsigned int)(tileZ * 4099 + tileX) * 0x85EBCA6Bu));
+
+	for (int i = 0; i < 8; ++i)
+	{
+		random.next();
+	}
+
+	const float startX = tileX * CELLS_PER_TILE * cellSize;
+	const float startZ = tileZ * CELLS_PER_TILE * cellSize;
+	const float endX = fminf(startX + CELLS_PER_TILE * cellSize, mapSize);
+	const float endZ = fminf(startZ + CELLS_PER_TILE * cellSize, mapSize);
+
+	std::vector<float> pointX, pointZ;
+	std::vector<int> active;
+	int throws = 0;
+
+	while (!active.empty() || throws < TILE_SEED_THROWS)
+	{
+		float x, z;
+		bool found = false;
+		int parent = -1;
+
+		if (active.empty())
+		{
+			x = startX + random.nextFloat() * (endX - startX);
+			z = startZ + random.nextFloat() * (endZ - startZ);
+			found = fitsInGrid(x, z);
+			++throws;
+		}
+		else
+		{
+			// Try points between 1 and 2 spacings away from one that's still growing
+			parent = (int)(random.next() % active.size());
+
+			for (int c = 0; c < CANDIDATES_PER_POINT && !found; ++c)
+			{
+				float angle = random.nextFloat() * 6.28318530718f;
+				float distance = spacing * (1.0f + random.nextFloat());
+
+				x = pointX[active[parent]] + cosf(angle) * distance;
+				z = pointZ[active[parent]] + sinf(angle) * distance;
+				found = x >= startX && x < endX && z >= startZ && z < endZ && fitsInGrid(x, z);
+			}
+		}
+
+		if (found)
+		{
+			// Only this tile writes to its own cells, and the tiles being filled alongside it are too far away to read them
+			size_t cell = (size_t)(int)(z / cellSize) * gridWidth + (int)(x / cellSize);
+			gridX[cell] = x;
+			gridZ[cell] = z;
+
+			active.push_back((int)pointX.size());
+			pointX.push_back(x);
+			pointZ.push_back(z);
+		}
+		else if (parent >= 0)
+		{
+			active[parent] = active.back();
+			active.pop_back();
+		}
+	}
+
+	candidates = (int)pointX.size();
+
+	if (pointX.empty())
+	{
+		return;
+	}
+
+	// All of the tile's heights and slopes at once, in grid units
+	std::vector<float> sampleX(pointX.size()), sampleZ(pointX.size());
+	std::vector<float> sampleHeights(pointX.size()), gradientX(pointX.size()), gradientZ(pointX.size());
+
+	for (size_t i = 0; i < pointX.size(); ++i)
+	{
+		sampleX[i] = pointX[i] / gridScale;
+		sampleZ[i] = pointZ[i] / gridScale;
+	}
+
+	heights.sample(sampleX.data(), sampleZ.data(), (int)pointX.size(), sampleHeights.data(), gradientX.data(), gradientZ.data());
+
+	const int lastPoint = heights.getResolution() - 1;
+	const int variants = params.variants < 1 ? 1 : (params.variants > 256 ? 256 : params.variants);
+
+	for (size_t i = 0; i < pointX.size(); ++i)
+	{
+		float flowHere = 0.0f;
+
+		if (flowScale > 0.0f)
+		{
+			int nearestX = (int)(sampleX[i] + 0.5f);
+			int nearestZ = (int)(sampleZ[i] + 0.5f);
+			flowHere = logf(1.0f + flow->at(nearestX < lastPoint ? nearestX : lastPoint, nearestZ < lastPoint ? nearestZ : lastPoint)) * flowScale;
+		}
+
+		// Always drawn, kept or not, so a tree's rotation and scale don't depend on its neighbours
+		float keep = random.nextFloat();
+		float rotation = random.nextFloat();
+		float scale = params.minScale + random.nextFloat() * (params.maxScale - params.minScale);
+		unsigned int variant = random.next() % variants;
+
+		if (keep >= findDensity(sampleHeights[i], gradientX[i] / gridScale, gradientZ[i] / gridScale, flowHere))
+		{
+			continue;
+		}
+
+		VegetationInstance tree;
+		tree.x = pointX[i];
+		tree.y = sampleHeights[i];
+		tree.z = pointZ[i];
+		tree.rotation = (unsigned short)(rotation * 65536.0f);
+		tree.scale = (unsigned char)fminf(fmaxf(scale * 64.0f + 0.5f, 1.0f), 255.0f);
+		tree.variant = (unsigned char)variant;
+
+		trees.push_back(tree);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VegetationScatter::fitsInGrid(float x, float z) const
+{
+	int cellX = (int)(x / cellSize);
+	int cellZ = (int)(z / cellSize);
+
+	if (cellX < 0 || cellZ < 0 || cellX >= gridWidth || cellZ >= gridWidth)
+	{
+		return false;
+	}
+
+	// A point closer than the spacing can be at most 2 cells away
+	for (int z2 = cellZ - 2; z2 <= cellZ + 2; ++z2)
+	{
+		for (int x2 = cellX - 2; x2 <= cellX + 2; ++x2)
+		{
+			if (x2 < 0 || z2 < 0 || x2 >= gridWidth || z2 >= gridWidth)
+			{
+				continue;
+			}
+
+			size_t cell = (size_t)z2 * gridWidth + x2;
+
+			if (gridX[cell] < 0.0f)
+			{
+				continue;
+			}
+
+			float dx = gridX[cell] - x;
+			float dz = gridZ[cell] - z;
+
+			if (dx * dx + dz * dz < spacing * spacing)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float VegetationScatter::findDensity(float height, float gradientX, float gradientZ, float flow) const
+{
+	// Full density up to half the max slope, then down to nothing at it
+	float slope = atanf(sqrtf(gradientX * gradientX + gradientZ * gradientZ)) * (180.0f / 3.14159265f);
+	float density = fminf(fmaxf((params.maxSlope - slope) / (params.maxSlope * 0.5f), 0.0f), 1.0f);
+
+	// Fading in above the bottom of the band and out below the top
+	float fade = params.bandFade > 0.0001f ? params.bandFade : 0.0001f;
+	density *= fminf(fmaxf((height - params.lowHeight) / fade, 0.0f), 1.0f);
+	density *= fminf(fmaxf((params.highHeight - height) / fade, 0.0f), 1.0f);
+
+	// Only where the water went at full density, or everywhere but there
+	if (params.flowWeight > 0.0f)
+	{
+		density *= 1.0f - params.flowWeight + params.flowWeight * flow;
+	}
+	else
+	{
+		density *= 1.0f + params.flowWeight * flow;
+	}
+
+	return density;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
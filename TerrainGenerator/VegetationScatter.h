@@ -0,0 +1,105 @@
+/*
+ * This is the Vegetation Scatter class it handles:
+ *		- Scattering trees over the terrain with Poisson-disk sampling, so no two are ever closer than the spacing
+ *		- Thinning them out by slope, by height (a band, i.e. above the water and below the snow) and by where the droplet
+ *		  erosion's water flowed
+ *		- Packing each tree into a 16 byte instance, with its position, rotation, scale and which tree variant it is
+ *
+ * The map is split into tiles, a few dozen trees across, and filled a quarter of the tiles at a time, every other tile
+ * in x and z, so the tiles being filled at the same time are never next to each other. Each tile grows its own points
+ * out from a random first one (Bridson's algorithm), checking against a grid covering the whole map that already holds
+ * the points of any neighbouring tile filled before it. Every tile has its own random generator, seeded from the seed
+ * and the tile, so the same seed always gives the same trees, in the same order, however many threads there are.
+ *
+ * The thinning happens after the sampling, so thinned out areas keep the same spacing, there's just less of it used.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include <vector>
+#include "HeightMap.h"
+#include "HeightMapSampler.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// One tree, in the terrain's local space
+struct VegetationInstance
+{
+	float x;
+	float y;
+	float z;
+	unsigned short rotation;	// Around y, 0 -> 65535 for 0 -> 2 pi
+	unsigned char scale;		// In 64ths, so up to 4 times the tree's own size
+	unsigned char variant;		// Which tree variant, 0 -> the scatter's variant count - 1
+
+	inline float getRotation() const
+	{
+		return rotation * (6.28318530718f / 65536.0f);
+	}
+
+	inline float getScale() const
+	{
+		return scale * (1.0f / 64.0f);
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class VegetationScatter
+{
+public:
+	// Everything that changes where the trees go, distances and heights are in the terrain's local units
+	struct Params
+	{
+		unsigned int seed;
+		float spacing;				// The closest two trees can ever be
+		float maxSlope;				// In degrees, thinning out from half of this, and none any steeper
+		float lowHeight;			// The band the trees grow in, i.e. from the water's upper bound...
+		float highHeight;			// ...to the grass's upper bound
+		float bandFade;				// How far in from either edge of the band they take to reach full density
+		float flowWeight;			// -1 -> 1, above 0 favours where the water flowed, below 0 keeps out of the channels
+		float minScale;
+		float maxScale;
+		int variants;				// 1 -> 256
+	};
+
+	VegetationScatter();
+	~VegetationScatter();
+
+	void setParams(const Params& newParams);
+	const Params& getParams() const;
+
+	// flow can be nullptr, or all 0, to leave it out, otherwise it MUST be the sampler's resolution
+	// Any trees already in instances are replaced
+	void scatter(const HeightMapSampler& heights, const HeightMap* flow, float gridScale, std::vector<VegetationInstance>& instances);
+
+	// How many Poisson-disk points the last scatter() had before the thinning
+	int getCandidateCount() const;
+
+private:
+	// 0 -> 1, how likely a tree is to be kept
+	float findDensity(float height, float gradientX, float gradientZ, float flow) const;
+	bool fitsInGrid(float x, float z) const;
+	void fillTile(int tileX, int tileZ, const HeightMapSampler& heights, const HeightMap* flow, std::vector<VegetationInstance>& trees, int& candidates);
+
+	Params params;
+	int candidateCount;
+
+	// Set up by scatter() for the tiles to share
+	float gridScale;
+	float mapSize;
+	float spacing;
+	float cellSize;
+	int gridWidth;
+	float flowScale;
+	std::vector<float> gridX;			// -1 where a cell has no point
+	std::vector<float> gridZ;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,357 @@
+/*
+ * This is the Worley (cellular) Noise class it handles:
+ *		- Scattering one feature point in each cell of a jittered grid, hashed from the cell coords
+ *		- Finding the distance to the closest (F1) and second closest (F2) feature points
+ *		- Adding F1, F2 or F2 - F1 to the height map, with a Euclidean, Manhattan or Chebyshev distance
+ *		- Building the map across several threads, 4 points at a time with SSE
+ *
+ * The feature points are never stored, any cell's point can be worked out from its hash,
+ * so each sample only has to look at the cells around it no matter how big the map is.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "WorleyNoise.h"
+#include "ParallelFor.h"
+#include <emmintrin.h>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The furthest ring of cells ever searched, the points are within their cells so F2 is always found well before this
+const int MAX_RING = 3;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// CONSTRUCTOR / DESTRUCTOR
+WorleyNoise::WorleyNoise(int& res, HeightMap& heightmp) : resolution(res), heightmap(heightmp)
+{
+	// Default values
+	frequency = 0.05f;
+	amplitude = 5.0f;
+	jitter = 1.0f;
+	metric = EUCLIDEAN;
+	feature = F1;
+	seed = 0;
+}
+
+WorleyNoise::~WorleyNoise()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void WorleyNoise::buildWorleyNoise()
+{
+	// Ref:
+	// Worley, S. (1996) A Cellular Texture Basis Function
+	// https://dl.acm.org/doi/10.1145/237170.237267
+
+	// Every row only writes to itself, so the rows can be split between threads with no locking
+	ParallelFor::run(resolution, [this](int startZ, int endZ)
+	{
+		buildRows(startZ, endZ);
+	});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WorleyNoise::buildRows(int startZ, int endZ)
+{
+	float values[4];
+
+	for (int z = startZ; z < endZ; z++)
+	{
+		int x = 0;
+
+		for (; x + 4 <= resolution; x += 4)
+		{
+			sampleRow4(x, z, values);
+
+			for (int k = 0; k < 4; k++)
+			{
+				heightmap.at(x + k, z) += amplitude * values[k];
+			}
+		}
+
+		// Whatever is left over if the resolution isn't a multiple of 4
+		for (; x < resolution; x++)
+		{
+			heightmap.at(x, z) += amplitude * sample((float)x, (float)z);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float WorleyNoise::sample(float xPos, float zPos)
+{
+	float posX = xPos * frequency;
+	float posZ = zPos * frequency;
+	int cellX = (int)floorf(posX);
+	int cellZ = (int)floorf(posZ);
+
+	// How close the point is to the edge of its cell, nothing in ring r can be closer than (r - 1) + this
+	float edge = std::min(std::min(posX - cellX, 1.0f - (posX - cellX)), std::min(posZ - cellZ, 1.0f - (posZ - cellZ)));
+
+	float f1 = FLT_MAX;
+	float f2 = FLT_MAX;
+
+	// Work out from the cell a ring at a time, until no cell in the next ring could beat F2
+	// The 3x3 cells are nearly always enough, but not quite always, especially for F2 or the Manhattan metric
+	for (int ring = 0; ring <= MAX_RING; ring++)
+	{
+		if (ring > 0 && ringBound(ring, edge) >= f2)
+		{
+			break;
+		}
+
+		for (int cz = cellZ - ring; cz <= cellZ + ring; cz++)
+		{
+			// Only the cells on the ring's border, the inside has already been done
+			int stepX = (cz == cellZ - ring || cz == cellZ + ring) ? 1 : 2 * ring;
+
+			for (int cx = cellX - ring; cx <= cellX + ring; cx += std::max(stepX, 1))
+			{
+				float pointX, pointZ;
+				featurePoint(cx, cz, pointX, pointZ);
+
+				float d = distance(pointX - posX, pointZ - posZ);
+				f2 = std::min(f2, std::max(f1, d));
+				f1 = std::min(f1, d);
+			}
+		}
+	}
+
+	if (metric == EUCLIDEAN)
+	{
+		// distance() leaves these squared
+		f1 = sqrtf(f1);
+		f2 = sqrtf(f2);
+	}
+
+	return selectFeature(f1, f2);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WorleyNoise::sampleRow4(int xPos, int zPos, float result[4])
+{
+	/*
+	* 4 neighbouring points along a row, one in each SSE lane.
+	* Each feature point is tested against all 4 lanes at once, the rings are worked out from the cells the 4 are in,
+	* which is usually 1 cell or 2 when they cross a cell boundary, and stop once no lane could find a closer point.
+	* Every lane still checks every cell sample() would, so the results are the same.
+	*/
+
+	float xs[4] = { (float)xPos, (float)(xPos + 1), (float)(xPos + 2), (float)(xPos + 3) };
+	__m128 posX = _mm_mul_ps(_mm_loadu_ps(xs), _mm_set1_ps(frequency));
+	float posZScalar = zPos * frequency;
+	__m128 posZ = _mm_set1_ps(posZScalar);
+
+	int firstCellX = (int)floorf(xPos * frequency);
+	int lastCellX = (int)floorf((xPos + 3) * frequency);
+	int cellZ = (int)floorf(posZScalar);
+
+	// Each lane's distance to the edge of its own cell, as in sample()
+	alignas(16) float laneX[4];
+	alignas(16) float edges[4];
+	_mm_store_ps(laneX, posX);
+
+	for (int k = 0; k < 4; k++)
+	{
+		float cellX = floorf(laneX[k]);
+		edges[k] = std::min(std::min(laneX[k] - cellX, 1.0f - (laneX[k] - cellX)), std::min(posZScalar - cellZ, 1.0f - (posZScalar - cellZ)));
+	}
+
+	__m128 edge = _mm_load_ps(edges);
+
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 f1 = _mm_set1_ps(FLT_MAX);
+	__m128 f2 = _mm_set1_ps(FLT_MAX);
+
+	for (int ring = 0; ring <= MAX_RING; ring++)
+	{
+		if (ring > 0)
+		{
+			// Stop once every lane is done
+			__m128 bound = _mm_add_ps(edge, _mm_set1_ps((float)(ring - 1)));
+
+			if (metric == EUCLIDEAN)
+			{
+				bound = _mm_mul_ps(bound, bound);
+			}
+
+			if (_mm_movemask_ps(_mm_cmplt_ps(bound, f2)) == 0)
+			{
+				break;
+			}
+		}
+
+		for (int cz = cellZ - ring; cz <= cellZ + ring; cz++)
+		{
+			int stepX = (cz == cellZ - ring || cz == cellZ + ring) ? 1 : (lastCellX - firstCellX) + 2 * ring;
+
+			for (int cx = firstCellX - ring; cx <= lastCellX + ring; cx += std::max(stepX, 1))
+			{
+				float pointX, pointZ;
+				featurePoint(cx, cz, pointX, pointZ);
+
+				__m128 dx = _mm_sub_ps(_mm_set1_ps(pointX), posX);
+				__m128 dz = _mm_sub_ps(_mm_set1_ps(pointZ), posZ);
+				__m128 d;
+
+				if (metric == EUCLIDEAN)
+				{
+					d = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+				}
+				else if (metric == MANHATTAN)
+				{
+					d = _mm_add_ps(_mm_and_ps(dx, absMask), _mm_and_ps(dz, absMask));
+				}
+				else
+				{
+					d = _mm_max_ps(_mm_and_ps(dx, absMask), _mm_and_ps(dz, absMask));
+				}
+
+				// Keep the 2 smallest, if d is the new closest the old closest becomes the second
+				f2 = _mm_min_ps(f2, _mm_max_ps(f1, d));
+				f1 = _mm_min_ps(f1, d);
+			}
+		}
+	}
+
+	if (metric == EUCLIDEAN)
+	{
+		f1 = _mm_sqrt_ps(f1);
+		f2 = _mm_sqrt_ps(f2);
+	}
+
+	if (feature == F1)
+	{
+		_mm_storeu_ps(result, f1);
+	}
+	else if (feature == F2)
+	{
+		_mm_storeu_ps(result, f2);
+	}
+	else
+	{
+		_mm_storeu_ps(result, _mm_sub_ps(f2, f1));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float WorleyNoise::ringBound(int ring, float edge)
+{
+	// Every metric is at least the Chebyshev distance, which this is a bound on
+	float bound = (ring - 1) + edge;
+
+	return metric == EUCLIDEAN ? bound * bound : bound;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WorleyNoise::featurePoint(int cellX, int cellZ, float& pointX, float& pointZ)
+{
+	// Mix the cell coords and the seed into 32 well scrambled bits, 16 for each axis
+	unsigned int hash = ((unsigned int)cellX * 0x8da6b343u) ^ ((unsigned int)cellZ * 0xd8163841u) ^ (seed * 0xcb1ab31fu);
+	hash ^= hash >> 16;
+	hash *= 0x7feb352du;
+	hash ^= hash >> 15;
+	hash *= 0x846ca68bu;
+	hash ^= hash >> 16;
+
+	float randX = (hash & 0xffff) / 65536.0f;
+	float randZ = (hash >> 16) / 65536.0f;
+
+	pointX = cellX + 0.5f + jitter * (randX - 0.5f);
+	pointZ = cellZ + 0.5f + jitter * (randZ - 0.5f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float WorleyNoise::distance(float dx, float dz)
+{
+	if (metric == MANHATTAN)
+	{
+		return fabsf(dx) + fabsf(dz);
+	}
+	else if (metric == CHEBYSHEV)
+	{
+		return std::max(fabsf(dx), fabsf(dz));
+	}
+
+	// Squared, the square root is only taken of the 2 that are kept
+	return dx * dx + dz * dz;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+float WorleyNoise::selectFeature(float f1, float f2)
+{
+	if (feature == F2)
+	{
+		return f2;
+	}
+	else if (feature == F2_MINUS_F1)
+	{
+		return f2 - f1;
+	}
+
+	return f1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WorleyNoise::setFrequency(float freq)
+{
+	frequency = freq;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WorleyNoise::setAmplitude(float amp)
+{
+	amplitude = amp;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WorleyNoise::setJitter(float jit)
+{
+	jitter = jit;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WorleyNoise::setMetric(Metric newMetric)
+{
+	metric = newMetric;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WorleyNoise::setFeature(Feature newFeature)
+{
+	feature = newFeature;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void WorleyNoise::setSeed(unsigned int newSeed)
+{
+	seed = newSeed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,75 @@
+/*
+ * This is the Worley (cellular) Noise class it handles:
+ *		- Scattering one feature point in each cell of a jittered grid, hashed from the cell coords
+ *		- Finding the distance to the closest (F1) and second closest (F2) feature points
+ *		- Adding F1, F2 or F2 - F1 to the height map, with a Euclidean, Manhattan or Chebyshev distance
+ *		- Building the map across several threads, 4 points at a time with SSE
+ *
+ * The feature points are never stored, any cell's point can be worked out from its hash,
+ * so each sample only has to look at the cells around it no matter how big the map is.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include "HeightMap.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class WorleyNoise
+{
+public:
+	enum Metric
+	{
+		EUCLIDEAN = 0,
+		MANHATTAN,
+		CHEBYSHEV
+	};
+
+	enum Feature
+	{
+		F1 = 0,
+		F2,
+		F2_MINUS_F1
+	};
+
+	WorleyNoise(int& res, HeightMap& heightmp);
+	~WorleyNoise();
+
+	void buildWorleyNoise();
+	// The chosen feature at grid point (x, z), in cells, before the amplitude is applied
+	float sample(float xPos, float zPos);
+
+	void setFrequency(float freq);
+	void setAmplitude(float amp);
+	void setJitter(float jit);
+	void setMetric(Metric newMetric);
+	void setFeature(Feature newFeature);
+	void setSeed(unsigned int newSeed);
+
+private:
+	void buildRows(int startZ, int endZ);
+	void sampleRow4(int xPos, int zPos, float result[4]);
+	void featurePoint(int cellX, int cellZ, float& pointX, float& pointZ);
+	float distance(float dx, float dz);
+	// The closest any point in the given ring of cells could be, in the same units as distance()
+	float ringBound(int ring, float edge);
+	float selectFeature(float f1, float f2);
+
+	int& resolution;
+	HeightMap& heightmap;
+
+	float frequency;		// Cells per grid point
+	float amplitude;
+	float jitter;			// 0 = every point in the middle of its cell (a regular grid), 1 = anywhere in the cell
+	Metric metric;
+	Feature feature;
+	unsigned int seed;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
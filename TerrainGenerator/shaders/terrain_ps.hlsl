@@ -4,6 +4,7 @@
 Texture2D snowTex : register(t0);
 Texture2D grassTex : register(t1);
 Texture2D waterTex : register(t2);
+Texture2D erosionMapTex : register(t3);     // r = flow, g = eroded, b = deposited
 SamplerState sampler0 : register(s0);
 
 cbuffer LightBuffer : register(b0)
@@ -16,7 +17,8 @@ cbuffer LightBuffer : register(b0)
 cbuffer NoiseStyleBuffer : register(b1)
 {
     float noiseStyle;
-    float3 noisePadding;
+    float erosionMapStrength;   // 0 for height based texturing only
+    float2 noisePadding;
 };
 
 cbuffer TextureBoundsBuffer : register(b2)
@@ -40,6 +42,7 @@ struct InputType
     float2 tex : TEXCOORD0;
     float3 normal : NORMAL;
     float3 worldPos : TEXCOORD1;
+    float2 mapTex : TEXCOORD2;
 };
 
 // Calculate lighting intensity based on direction and normal. Combine with light colour.
@@ -146,6 +149,24 @@ float4 doRidgedHeightTexturing(float height, float4 snowTexCol, float4 grassTexC
     return saturate(lightCol) * snowTexCol;
 }
 
+// Splat from what the erosion actually did, rather than from the height alone
+float4 doErosionMapTexturing(float4 heightCol, float2 mapTex, float4 grassTexCol, float4 waterTexCol, float4 lightCol)
+{
+    float3 erosion = erosionMapTex.Sample(sampler0, mapTex).rgb * erosionMapStrength;
+    float4 litCol = heightCol;
+    
+    // Sediment settles into fertile flats, the main channels run wet
+    litCol = lerp(litCol, saturate(lightCol) * grassTexCol, saturate(erosion.b));
+    litCol = lerp(litCol, saturate(lightCol) * waterTexCol, saturate(erosion.r * erosion.r));
+    
+    // Where the most was eroded the bare rock shows through, darker and greyer
+    float rock = saturate(erosion.g);
+    float grey = dot(litCol.rgb, float3(0.3f, 0.59f, 0.11f));
+    litCol.rgb = lerp(litCol.rgb, grey * 0.6f, rock);
+    
+    return litCol;
+}
+
 float4 main(InputType input) : SV_TARGET
 {
     float4 snowTexCol = snowTex.Sample(sampler0, input.tex);
@@ -157,19 +178,30 @@ float4 main(InputType input) : SV_TARGET
     // Input world position height will always be in the range of 0 - max amplitude set on CPU side
     float height = input.worldPos.y;
     
+    float4 heightCol;
+    
     // Check style of noise, this is required for the height based texturing to work
     // as ridged noise is inverted.
     if (noiseStyle == 1)
     {
         // Do ridged height based texturing
-        return doRidgedHeightTexturing(height, snowTexCol, grassTexCol, waterTexCol, lightCol);
+        heightCol = doRidgedHeightTexturing(height, snowTexCol, grassTexCol, waterTexCol, lightCol);
         
         // For Debug
         //return float4(input.normal, 1.0f);
     }
+    else
+    {
+        // Do normal height based texturing for both normal noise and terraced noise
+        heightCol = doNormalHeightTexturing(height, snowTexCol, grassTexCol, waterTexCol, lightCol);
+    }
+    
+    if (erosionMapStrength > 0.0f)
+    {
+        return doErosionMapTexturing(heightCol, input.mapTex, grassTexCol, waterTexCol, lightCol);
+    }
     
-    // Do normal height based texturing for both normal noise and terraced noise
-    return doNormalHeightTexturing(height, snowTexCol, grassTexCol, waterTexCol, lightCol);
+    return heightCol;
     
     // For Debug
     //return float4(input.normal, 1.0f);
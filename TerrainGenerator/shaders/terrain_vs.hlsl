@@ -1,5 +1,5 @@
 // Terrain vertex shader
-// Standard issue vertex shader, apply matrices, pass info to pixel shader
+// Rebuild the grid position and UVs from the vertex ID, decode the normal, apply matrices, pass info to pixel shader
 cbuffer MatrixBuffer : register(b0)
 {
     matrix worldMatrix;
@@ -7,11 +7,19 @@ cbuffer MatrixBuffer : register(b0)
     matrix projectionMatrix;
 };
 
+cbuffer GridBuffer : register(b1)
+{
+    uint resolution;
+    float gridScale;
+    float uvIncrement;
+    float gridPadding;
+};
+
+// Must match TerrainVertexType in TerrainVertex.h
 struct InputType
 {
-    float4 position : POSITION;
-    float2 tex : TEXCOORD0;
-    float3 normal : NORMAL;
+    float height : HEIGHT;
+    float2 octNormal : NORMAL;
 };
 
 struct OutputType
@@ -20,25 +28,48 @@ struct OutputType
     float2 tex : TEXCOORD0;
     float3 normal : NORMAL;
     float3 worldPos : TEXCOORD1;
+    float2 mapTex : TEXCOORD2;
 };
 
-OutputType main(InputType input)
+// Must match TerrainVertexPacker::decodeNormal
+float3 decodeOctNormal(float2 oct)
+{
+    float3 n = float3(oct.x, 1.0f - abs(oct.x) - abs(oct.y), oct.y);
+
+    // Unfold the lower hemisphere
+    float t = saturate(-n.y);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.z += n.z >= 0.0f ? -t : t;
+
+    return normalize(n);
+}
+
+OutputType main(InputType input, uint vertexID : SV_VertexID)
 {
     OutputType output;
 
+    // The vertices are laid out row by row, so the grid coords come straight from the vertex ID
+    uint i = vertexID % resolution;
+    uint j = vertexID / resolution;
+
+    float4 position = float4(i * gridScale, input.height, j * gridScale, 1.0f);
+
 	// Calculate the position of the vertex against the world, view, and projection matrices.
-    output.position = mul(input.position, worldMatrix);
+    output.position = mul(position, worldMatrix);
     output.position = mul(output.position, viewMatrix);
     output.position = mul(output.position, projectionMatrix);
 
 	// Store the texture coordinates for the pixel shader.
-    output.tex = input.tex;
+    output.tex = float2(i, j) * uvIncrement;
+
+    // The erosion maps have one texel per grid point, so sample each at its centre
+    output.mapTex = (float2(i, j) + 0.5f) / resolution;
 
 	// Calculate the normal vector against the world matrix only and normalise.
-    output.normal = mul(input.normal, (float3x3) worldMatrix);
+    output.normal = mul(decodeOctNormal(input.octNormal), (float3x3) worldMatrix);
     output.normal = normalize(output.normal);
-	
-    output.worldPos = mul(input.position, worldMatrix).xyz;
+
+    output.worldPos = mul(position, worldMatrix).xyz;
 
     return output;
-}
\ No newline at end of file
+}
@@ -0,0 +1,69 @@
+// Instanced tree vertex shader
+// Every tree of one variant is drawn at once, each instance is a VegetationInstance placing the variant on the terrain
+cbuffer MatrixBuffer : register(b0)
+{
+    matrix worldMatrix;
+    matrix viewMatrix;
+    matrix projectionMatrix;
+};
+
+cbuffer TreeBuffer : register(b1)
+{
+    float treeScale;
+    float3 treePadding;
+};
+
+struct InputType
+{
+    float4 position : POSITION;
+    float2 tex : TEXCOORD0;
+    float3 normal : NORMAL;
+
+    // Per instance, this must match VegetationInstance in VegetationScatter.h and the layout in TreeShader
+    float3 instancePosition : INSTANCEPOSITION;
+    uint instanceRotation : INSTANCEROTATION;
+    uint instanceScale : INSTANCESCALE;
+};
+
+struct OutputType
+{
+    float4 position : SV_POSITION;
+    float2 tex : TEXCOORD0;
+    float3 normal : NORMAL;
+    float3 worldPos : TEXCOORD1;
+};
+
+// The same as TreeTemplateCache::getInstanceTransform, scale, then turn around y, then move to the instance
+float3 placeInTerrain(float3 position, float s, float c, float scale, float3 origin)
+{
+    position *= scale;
+
+    return float3(position.x * c + position.z * s, position.y, position.z * c - position.x * s) + origin;
+}
+
+OutputType main(InputType input)
+{
+    OutputType output;
+
+    float s, c;
+    sincos(input.instanceRotation * (6.28318530718f / 65536.0f), s, c);
+    float scale = input.instanceScale * (1.0f / 64.0f) * treeScale;
+
+    // Into the terrain's local space, then the world matrix takes it the rest of the way like the terrain
+    float4 position = float4(placeInTerrain(input.position.xyz, s, c, scale, input.instancePosition), 1.0f);
+
+	// Calculate the position of the vertex against the world, view, and projection matrices.
+    output.position = mul(position, worldMatrix);
+    output.worldPos = output.position.xyz;
+    output.position = mul(output.position, viewMatrix);
+    output.position = mul(output.position, projectionMatrix);
+
+	// Store the texture coordinates for the pixel shader.
+    output.tex = input.tex;
+
+	// The scale is the same on every axis, so the normal only needs turning
+    output.normal = placeInTerrain(input.normal, s, c, 1.0f, float3(0.0f, 0.0f, 0.0f));
+    output.normal = normalize(mul(output.normal, (float3x3) worldMatrix));
+
+    return output;
+}
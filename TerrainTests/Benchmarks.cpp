@@ -0,0 +1,375 @@
+/*
+ * These are the terrain benchmarks, each one:
+ *		- Builds the inputs from a fixed seed, so every run times the same work
+ *		- Times the module one way and then the other, and prints the timings
+ *
+ * The tests check the results are the same, these only time them.
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TerrainTests.h"
+#include "TestData.h"
+#include "TerrainVertex.h"
+#include "FrustumCulling.h"
+#include "HeightMap.h"
+#include "ShallowWaterErosion.h"
+#include "ParallelFor.h"
+#include "HydraulicErosion.h"
+#include "ErosionBrushCache.h"
+#include "ErosionRandom.h"
+#include "HeightMapSampler.h"
+#include "Smoothing.h"
+#include "PerlinNoise.h"
+#include "PyramidErosion.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The same block of inputs is used over and over, so making them isn't part of the timing
+const int blockSize = 65536;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Packing one vertex at a time with encodeNormal against the SSE packer
+void benchmarkVertexPacking(long long vertices)
+{
+	const int blocks = (int)((vertices + blockSize - 1) / blockSize);
+
+	std::vector<float> heights, normalX, normalY, normalZ;
+	TestData::makeHeights(blockSize, 1, heights);
+	TestData::makeNormals(blockSize, 2, normalX, normalY, normalZ);
+
+	std::vector<TerrainVertexType> scalarVertices(blockSize), sseVertices(blockSize);
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (int b = 0; b < blocks; ++b)
+	{
+		for (int i = 0; i < blockSize; ++i)
+		{
+			scalarVertices[i].height = heights[i];
+			TerrainVertexPacker::encodeNormal(normalX[i], normalY[i], normalZ[i], scalarVertices[i].octNormal);
+		}
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	float scalarMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+	start = std::chrono::high_resolution_clock::now();
+
+	for (int b = 0; b < blocks; ++b)
+	{
+		TerrainVertexPacker::packVertices(heights.data(), normalX.data(), normalY.data(), normalZ.data(), blockSize, sseVertices.data());
+	}
+
+	end = std::chrono::high_resolution_clock::now();
+	float sseMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+	printf("Vertex packing, %lld vertices\tOne at a Time: %.0f ms\tSSE: %.0f ms\n", (long long)blocks * blockSize, scalarMs, sseMs);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+// Testing boxes one at a time with isBoxVisible against cullBoxes testing them 4 at a time, the same boxes every pass
+void benchmarkFrustumCulling(int boxCount, int passes)
+{
+	const float terrainSize = 250.0f;
+
+	BoundingBoxList boxes;
+	TestData::makeBoxes(boxCount, 5, terrainSize, boxes);
+
+	Frustum frustum;
+	frustum.extractPlanes(TestData::makeViewProjection(terrainSize));
+
+	std::vector<char> scalarVisible(boxCount);
+	std::vector<int> visibleIndices;
+	visibleIndices.reserve(boxCount + 4);
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (int p = 0; p < passes; ++p)
+	{
+		for (int i = 0; i < boxCount; ++i)
+		{
+			scalarVisible[i] = frustum.isBoxVisible(XMFLOAT3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]), XMFLOAT3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]));
+		}
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	float scalarMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+	start = std::chrono::high_resolution_clock::now();
+
+	for (int p = 0; p < passes; ++p)
+	{
+		frustum.cullBoxes(boxes, visibleIndices);
+	}
+
+	end = std::chrono::high_resolution_clock::now();
+	float sseMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+	printf("Frustum culling, %d boxes x %d passes, %d visible\tOne at a Time: %.3f ms a pass\tSSE: %.3f ms a pass\n", boxCount, passes,
+		(int)visibleIndices.size(), scalarMs / passes, sseMs / passes);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The same shallow water erosion on 1 thread, then 2, and so on up to one per core, from the same starting heights
+void benchmarkShallowWaterScaling(int resolution, int iterations)
+{
+	const int threads = ParallelFor::getThreadCount();
+	const float gridScale = 250.0f / resolution;
+
+	HeightMap heightMap;
+	heightMap.resize(resolution, HeightMap::ROW_MAJOR);
+	TestData::makeHills(heightMap);
+
+	std::vector<float> originalHeights(resolution * resolution);
+	heightMap.copyToRowMajor(originalHeights.data());
+
+	ShallowWaterErosion shallowWaterErosion(resolution, heightMap);
+	float oneThreadMs = 0.0f;
+
+	printf("Shallow water erosion, %d time steps at %d x %d\n", iterations, resolution, resolution);
+
+	for (int t = 1; t <= threads; ++t)
+	{
+		heightMap.copyFromRowMajor(originalHeights.data());
+		ParallelFor::setThreadLimit(t);
+
+		auto start = std::chrono::high_resolution_clock::now();
+		shallowWaterErosion.erodeTerrain(iterations, gridScale);
+		auto end = std::chrono::high_resolution_clock::now();
+		float ms = std::chrono::duration<float, std::milli>(end - start).count();
+
+		oneThreadMs = t == 1 ? ms : oneThreadMs;
+		printf("\t%d Threads: %.0f ms\tSpeed Up: %.2fx\n", t, ms, oneThreadMs / ms);
+	}
+
+	ParallelFor::setThreadLimit(0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The droplets' own one at a time sampler against the batched one, on this thread and then on all of them
+void benchmarkHeightSampler(int resolution, long long samples)
+{
+	const int blocks = (int)((samples + blockSize - 1) / blockSize);
+
+	HeightMap heightMap;
+	heightMap.resize(resolution, HeightMap::ROW_MAJOR);
+	TestData::makeHills(heightMap);
+
+	ErosionBrushCache brushes;
+	HydraulicErosion hydraulicErosion(resolution, heightMap, brushes);
+
+	HeightMapSampler heightSampler;
+	heightSampler.update(heightMap);
+
+	std::vector<float> posX(blockSize), posZ(blockSize);
+	std::vector<float> heights(blockSize), gradientX(blockSize), gradientZ(blockSize);
+	ErosionRandom random(0);
+
+	// Inside the map, the droplets' sampler reads 0 past the last row and column
+	for (int i = 0; i < blockSize; ++i)
+	{
+		posX[i] = random.nextFloat() * (resolution - 1);
+		posZ[i] = random.nextFloat() * (resolution - 1);
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (int b = 0; b < blocks; ++b)
+	{
+		for (int i = 0; i < blockSize; ++i)
+		{
+			HeightAndGradient result = hydraulicErosion.calculateHeightAndGradient(posX[i], posZ[i]);
+			heights[i] = result.height;
+			gradientX[i] = result.gradientX;
+			gradientZ[i] = result.gradientZ;
+		}
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	float scalarMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+	start = std::chrono::high_resolution_clock::now();
+
+	for (int b = 0; b < blocks; ++b)
+	{
+		heightSampler.sample(posX.data(), posZ.data(), blockSize, heights.data(), gradientX.data(), gradientZ.data());
+	}
+
+	end = std::chrono::high_resolution_clock::now();
+	float batchedMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+	start = std::chrono::high_resolution_clock::now();
+
+	ParallelFor::run(blocks, [&](int startBlock, int endBlock)
+	{
+		std::vector<float> blockHeights(blockSize), blockGradientX(blockSize), blockGradientZ(blockSize);
+
+		for (int b = startBlock; b < endBlock; ++b)
+		{
+			heightSampler.sample(posX.data(), posZ.data(), blockSize, blockHeights.data(), blockGradientX.data(), blockGradientZ.data());
+		}
+	}, 1);
+
+	end = std::chrono::high_resolution_clock::now();
+	float threadedMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+	printf("Height sampler, %lld samples at %d x %d\tOne at a Time: %.0f ms\tBatched: %.0f ms\tBatched on %d Threads: %.0f ms\n",
+		(long long)blocks * blockSize, resolution, resolution, scalarMs, batchedMs, ParallelFor::getThreadCount(), threadedMs);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The same smoothing passes (a full map neighbourhood sweep) and erosion droplets (random neighbourhood lookups)
+// with each layout, starting from the same heights each time
+void benchmarkHeightMapLayouts(int resolution, int smoothingPasses, int erosionDroplets)
+{
+	const int terrainSize = 250;
+	const HeightMap::Layout layouts[2] = { HeightMap::ROW_MAJOR, HeightMap::TILED };
+	const char* layoutNames[2] = { "Row-Major", "Tiled" };
+
+	HeightMap heightMap;
+	ErosionBrushCache brushes;
+	Smoothing smoothing(resolution, heightMap, terrainSize);
+	HydraulicErosion hydraulicErosion(resolution, heightMap, brushes);
+
+	printf("Height map layouts at %d x %d\n", resolution, resolution);
+
+	for (int l = 0; l < 2; ++l)
+	{
+		heightMap.resize(resolution, layouts[l]);
+		TestData::makeHills(heightMap);
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		for (int p = 0; p < smoothingPasses; ++p)
+		{
+			smoothing.smoothTerrain();
+		}
+
+		auto end = std::chrono::high_resolution_clock::now();
+		float smoothingMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+		// Both layouts get the same droplets
+		TestData::makeHills(heightMap);
+		HydraulicErosion::DropletParams params = hydraulicErosion.getParams();
+		ErosionRandom random(0);
+
+		start = std::chrono::high_resolution_clock::now();
+
+		for (int d = 0; d < erosionDroplets; ++d)
+		{
+			hydraulicErosion.simulateDroplet(random, params, nullptr, nullptr, nullptr);
+		}
+
+		end = std::chrono::high_resolution_clock::now();
+		float erosionMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+		printf("\t%s\t%d Smoothing Passes: %.2f ms\t%d Erosion Droplets: %.2f ms\n", layoutNames[l], smoothingPasses, smoothingMs, erosionDroplets, erosionMs);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The same fBm the auto-generate button runs, with each noise algorithm, from a flat map each time
+void benchmarkNoiseAlgorithms(int resolution, int octaves)
+{
+	const int terrainSize = 250;
+	const char algorithms[3] = { 'O', 'I', 'S' };
+	const char* algorithmNames[3] = { "Old PN", "Improved PN", "Simplex" };
+
+	HeightMap heightMap;
+	heightMap.resize(resolution, HeightMap::ROW_MAJOR);
+
+	printf("Noise algorithms, %d octaves of fBm at %d x %d\n", octaves, resolution, resolution);
+
+	for (int a = 0; a < 3; ++a)
+	{
+		// A new one each time, fBm halves/doubles the amplitude and frequency as it goes
+		PerlinNoise perlinNoise(resolution, heightMap, terrainSize);
+		perlinNoise.setPerlinAlgorithm(algorithms[a]);
+		heightMap.fill(0.0f);
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		for (int o = 0; o < octaves; ++o)
+		{
+			perlinNoise.fracBrownianMotion();
+		}
+
+		auto end = std::chrono::high_resolution_clock::now();
+
+		printf("\t%s: %.1f ms\n", algorithmNames[a], std::chrono::duration<float, std::milli>(end - start).count());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Single level erosion against pyramid erosion from the same starting heights, each building its own brushes
+void benchmarkPyramidErosion(int resolution, int singleLevelDroplets, int levels, int dropletsPerLevel, int fineDroplets)
+{
+	HeightMap heightMap;
+	heightMap.resize(resolution, HeightMap::ROW_MAJOR);
+	TestData::makeHills(heightMap);
+
+	float singleLevelMs;
+	float pyramidMs;
+
+	{
+		ErosionBrushCache brushes;
+		HydraulicErosion hydraulicErosion(resolution, heightMap, brushes);
+		HydraulicErosion::DropletParams params = hydraulicErosion.getParams();
+		ErosionRandom random(0);
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		for (int d = 0; d < singleLevelDroplets; ++d)
+		{
+			hydraulicErosion.simulateDroplet(random, params, nullptr, nullptr, nullptr);
+		}
+
+		auto end = std::chrono::high_resolution_clock::now();
+		singleLevelMs = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	TestData::makeHills(heightMap);
+
+	{
+		ErosionBrushCache brushes;
+		HydraulicErosion hydraulicErosion(resolution, heightMap, brushes);
+		PyramidErosion pyramidErosion(resolution, heightMap, brushes);
+		HydraulicErosion::DropletParams params = hydraulicErosion.getParams();
+		ErosionRandom random(0);
+
+		// The large scale drainage first, then the fine detail the coarse levels can't hold
+		auto start = std::chrono::high_resolution_clock::now();
+
+		pyramidErosion.erodeCoarseLevels(levels, dropletsPerLevel, 0, params);
+
+		for (int d = 0; d < fineDroplets; ++d)
+		{
+			hydraulicErosion.simulateDroplet(random, params, nullptr, nullptr, nullptr);
+		}
+
+		auto end = std::chrono::high_resolution_clock::now();
+		pyramidMs = std::chrono::duration<float, std::milli>(end - start).count();
+	}
+
+	printf("Pyramid erosion at %d x %d\t%d Droplets, Single Level: %.0f ms\t%d Levels of %d Droplets + %d, Pyramid: %.0f ms\n", resolution, resolution,
+		singleLevelDroplets, singleLevelMs, levels, dropletsPerLevel, fineDroplets, pyramidMs);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
\ No newline at end of file
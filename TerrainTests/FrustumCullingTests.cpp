@@ -0,0 +1,101 @@
+/*
+ * These are the frustum culling tests, they check:
+ *		- cullBoxes, 4 boxes at a time with SSE, keeps exactly the boxes isBoxVisible does, in order
+ *		- Boxes clearly inside, outside and across the frustum's planes are kept or culled as they should be
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TerrainTests.h"
+#include "TestRunner.h"
+#include "TestData.h"
+#include "FrustumCulling.h"
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const float cullingTerrainSize = 250.0f;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void sseMatchesIsBoxVisible()
+{
+	// Not a multiple of 4, so the last partial block is checked too
+	const int boxCount = 65537;
+
+	BoundingBoxList boxes;
+	TestData::makeBoxes(boxCount, 5, cullingTerrainSize, boxes);
+
+	Frustum frustum;
+	frustum.extractPlanes(TestData::makeViewProjection(cullingTerrainSize));
+
+	std::vector<int> expected;
+
+	for (int i = 0; i < boxCount; ++i)
+	{
+		if (frustum.isBoxVisible(XMFLOAT3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]), XMFLOAT3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i])))
+		{
+			expected.push_back(i);
+		}
+	}
+
+	std::vector<int> visibleIndices;
+	int visibleCount = frustum.cullBoxes(boxes, visibleIndices);
+
+	TEST_CHECK(visibleCount == (int)visibleIndices.size());
+	TEST_CHECK(visibleIndices == expected);
+
+	// Some of each, or the comparison isn't saying much
+	TEST_CHECK(!expected.empty() && (int)expected.size() < boxCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void knownBoxes()
+{
+	// The camera is above the middle of the near edge, looking in and down at the centre
+	Frustum frustum;
+	frustum.extractPlanes(TestData::makeViewProjection(cullingTerrainSize));
+
+	BoundingBoxList boxes;
+	boxes.add(XMFLOAT3(120.0f, -5.0f, 120.0f), XMFLOAT3(130.0f, 5.0f, 130.0f));		// At the centre
+	boxes.add(XMFLOAT3(120.0f, 35.0f, -45.0f), XMFLOAT3(130.0f, 45.0f, -40.0f));	// Behind the camera
+	boxes.add(XMFLOAT3(120.0f, -5.0f, 600.0f), XMFLOAT3(130.0f, 5.0f, 610.0f));		// Past the far plane
+	boxes.add(XMFLOAT3(-400.0f, -5.0f, 0.0f), XMFLOAT3(-390.0f, 5.0f, 10.0f));		// Off to the left
+	boxes.add(XMFLOAT3(-400.0f, -5.0f, 120.0f), XMFLOAT3(600.0f, 5.0f, 130.0f));	// Right across the view
+	boxes.add(XMFLOAT3(120.0f, 35.0f, -35.0f), XMFLOAT3(130.0f, 45.0f, -25.0f));	// Around the camera, across the near plane
+
+	const bool visible[6] = { true, false, false, false, true, true };
+
+	std::vector<int> visibleIndices;
+	frustum.cullBoxes(boxes, visibleIndices);
+
+	std::vector<int> expected;
+
+	for (int i = 0; i < boxes.size(); ++i)
+	{
+		TEST_CHECK(frustum.isBoxVisible(XMFLOAT3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]), XMFLOAT3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i])) == visible[i]);
+
+		if (visible[i])
+		{
+			expected.push_back(i);
+		}
+	}
+
+	TEST_CHECK(visibleIndices == expected);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void runFrustumCullingTests()
+{
+	TestRunner::run("FrustumCulling: SSE culling matches isBoxVisible", sseMatchesIsBoxVisible);
+	TestRunner::run("FrustumCulling: known boxes kept and culled", knownBoxes);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
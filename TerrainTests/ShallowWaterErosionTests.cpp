@@ -0,0 +1,80 @@
+/*
+ * These are the shallow water erosion tests, they check:
+ *		- Splitting the rows over more threads doesn't change the eroded terrain at all
+ *		- The water does erode the terrain, and not by more than the hills are high
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TerrainTests.h"
+#include "TestRunner.h"
+#include "TestData.h"
+#include "HeightMap.h"
+#include "ShallowWaterErosion.h"
+#include "ParallelFor.h"
+#include <cmath>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const int shallowWaterResolution = 129;
+const int shallowWaterSteps = 50;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void sameTerrainOnEveryThreadCount()
+{
+	int resolution = shallowWaterResolution;
+
+	HeightMap heightMap;
+	heightMap.resize(resolution, HeightMap::ROW_MAJOR);
+	TestData::makeHills(heightMap);
+
+	std::vector<float> originalHeights(resolution * resolution);
+	heightMap.copyToRowMajor(originalHeights.data());
+
+	ShallowWaterErosion shallowWaterErosion(resolution, heightMap);
+
+	std::vector<float> firstHeights(resolution * resolution);
+	std::vector<float> erodedHeights(resolution * resolution);
+
+	// The limit is how many blocks run() splits into, so this splits the rows the same way on any machine
+	for (int t = 1; t <= 4; ++t)
+	{
+		heightMap.copyFromRowMajor(originalHeights.data());
+		ParallelFor::setThreadLimit(t);
+
+		shallowWaterErosion.erodeTerrain(shallowWaterSteps, 250.0f / resolution);
+
+		// Each point only ever writes to itself, so how the rows are split mustn't change anything
+		heightMap.copyToRowMajor(t == 1 ? firstHeights.data() : erodedHeights.data());
+		TEST_CHECK(t == 1 || firstHeights == erodedHeights);
+	}
+
+	ParallelFor::setThreadLimit(0);
+
+	// And it did erode something
+	float largestChange = 0.0f;
+
+	for (int i = 0; i < resolution * resolution; ++i)
+	{
+		largestChange = fmaxf(largestChange, fabsf(firstHeights[i] - originalHeights[i]));
+	}
+
+	TEST_CHECK(largestChange > 0.0f);
+	TEST_CHECK(largestChange < 10.0f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void runShallowWaterErosionTests()
+{
+	TestRunner::run("ShallowWaterErosion: same terrain on every thread count", sameTerrainOnEveryThreadCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,161 @@
+/*
+ * These are the terrain quadtree tests, they check:
+ *		- The exact draw list, chunk and LOD, for a fixed camera over a fixed tree
+ *		- Every chunk is drawn exactly once, and neighbouring chunks never differ by more than one LOD
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TerrainTests.h"
+#include "TestRunner.h"
+#include "TestData.h"
+#include "TerrainQuadtree.h"
+#include <cstdlib>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const float quadtreeViewportHeight = 720.0f;
+const float quadtreeFovY = XM_PI / 4.0f;
+const float quadtreeMaxPixelError = 2.0f;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void checkDrawList(const TerrainQuadtree& quadtree, const std::vector<TerrainDrawItem>& drawList)
+{
+	const int chunksX = quadtree.getChunksX();
+	const int chunksZ = quadtree.getChunksZ();
+
+	std::vector<int> chunkLODs(quadtree.getChunkCount(), -1);
+
+	TEST_CHECK((int)drawList.size() == quadtree.getChunkCount());
+
+	for (int i = 0; i < (int)drawList.size(); ++i)
+	{
+		TEST_CHECK(chunkLODs[drawList[i].chunk] == -1);
+		TEST_CHECK(drawList[i].lod >= 0 && drawList[i].lod <= quadtree.getMaxLOD());
+
+		chunkLODs[drawList[i].chunk] = drawList[i].lod;
+	}
+
+	// Only the east and south neighbours, the west and north ones have already been compared the other way round
+	for (int cz = 0; cz < chunksZ; ++cz)
+	{
+		for (int cx = 0; cx < chunksX; ++cx)
+		{
+			int lod = chunkLODs[cz * chunksX + cx];
+
+			if (cx + 1 < chunksX)
+			{
+				TEST_CHECK(abs(lod - chunkLODs[cz * chunksX + cx + 1]) <= 1);
+			}
+
+			if (cz + 1 < chunksZ)
+			{
+				TEST_CHECK(abs(lod - chunkLODs[(cz + 1) * chunksX + cx]) <= 1);
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void exactDrawList()
+{
+	/*
+	* Flat apart from the inside of chunk 5, which is a checkerboard of 0s and 1s, with the camera just above it.
+	* Chunk 5 has to be LOD 0 and the flat chunks would all be the max LOD (4), the neighbour rule steps them down
+	* so each chunk's LOD is its distance in chunks (across + down) from chunk 5.
+	*
+	*	 0  1  2  3			2 1 2 3
+	*	 4 [5] 6  7		->	1 0 1 2
+	*	 8  9 10 11			2 1 2 3
+	*	12 13 14 15			3 2 3 4
+	*/
+
+	const int resolution = 129;
+
+	std::vector<float> heights(resolution * resolution, 0.0f);
+
+	for (int z = 33; z < 64; ++z)
+	{
+		for (int x = 33; x < 64; ++x)
+		{
+			heights[z * resolution + x] = (float)((x + z) & 1);
+		}
+	}
+
+	TerrainQuadtree quadtree;
+	quadtree.build(heights.data(), resolution, 1.0f, 32);
+
+	TEST_CHECK(quadtree.getChunksX() == 4 && quadtree.getChunksZ() == 4);
+	TEST_CHECK(quadtree.getMaxLOD() == 4);
+
+	std::vector<TerrainDrawItem> drawList;
+	quadtree.selectLOD(XMFLOAT3(48.0f, 10.0f, 48.0f), quadtreeViewportHeight, quadtreeFovY, quadtreeMaxPixelError, drawList);
+
+	// In tree order, each quarter of the terrain in turn
+	const TerrainDrawItem expected[16] =
+	{
+		{ 0, 2 }, { 1, 1 }, { 4, 1 }, { 5, 0 },
+		{ 2, 2 }, { 3, 3 }, { 6, 1 }, { 7, 2 },
+		{ 8, 2 }, { 9, 1 }, { 12, 3 }, { 13, 2 },
+		{ 10, 2 }, { 11, 3 }, { 14, 3 }, { 15, 4 }
+	};
+
+	TEST_CHECK(drawList.size() == 16);
+
+	for (int i = 0; i < 16 && i < (int)drawList.size(); ++i)
+	{
+		TEST_CHECK(drawList[i].chunk == expected[i].chunk && drawList[i].lod == expected[i].lod);
+	}
+
+	checkDrawList(quadtree, drawList);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void neighboursWithinOneLOD()
+{
+	const int resolution = 257;
+
+	HeightMap heightMap;
+	heightMap.resize(resolution, HeightMap::ROW_MAJOR);
+	TestData::makeHills(heightMap);
+
+	std::vector<float> heights(resolution * resolution);
+	heightMap.copyToRowMajor(heights.data());
+
+	TerrainQuadtree quadtree;
+	quadtree.build(heights.data(), resolution, 1.0f, 32);
+
+	// Low down in a corner, in the middle, high up and off the edge
+	const XMFLOAT3 cameras[4] = { XMFLOAT3(4.0f, 12.0f, 4.0f), XMFLOAT3(128.0f, 10.0f, 128.0f), XMFLOAT3(128.0f, 150.0f, 128.0f), XMFLOAT3(128.0f, 30.0f, -20.0f) };
+	const float pixelErrors[3] = { 0.5f, quadtreeMaxPixelError, 8.0f };
+
+	std::vector<TerrainDrawItem> drawList;
+
+	for (int c = 0; c < 4; ++c)
+	{
+		for (int e = 0; e < 3; ++e)
+		{
+			quadtree.selectLOD(cameras[c], quadtreeViewportHeight, quadtreeFovY, pixelErrors[e], drawList);
+			checkDrawList(quadtree, drawList);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void runTerrainQuadtreeTests()
+{
+	TestRunner::run("TerrainQuadtree: exact draw list for a fixed camera", exactDrawList);
+	TestRunner::run("TerrainQuadtree: neighbouring chunks within one LOD", neighboursWithinOneLOD);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
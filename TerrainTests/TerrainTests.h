@@ -0,0 +1,33 @@
+/*
+ * These are the terrain tests and benchmarks, they run without D3D:
+ *		- Each test suite runs its tests through the test runner
+ *		- Each benchmark times one of the terrain's modules and prints the timings
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Test suites
+void runTerrainVertexTests();
+void runFrustumCullingTests();
+void runShallowWaterErosionTests();
+void runTerrainQuadtreeTests();
+
+// Benchmarks
+void benchmarkVertexPacking(long long vertices);
+void benchmarkFrustumCulling(int boxCount, int passes);
+void benchmarkShallowWaterScaling(int resolution, int iterations);
+void benchmarkHeightSampler(int resolution, long long samples);
+void benchmarkHeightMapLayouts(int resolution, int smoothingPasses, int erosionDroplets);
+void benchmarkNoiseAlgorithms(int resolution, int octaves);
+void benchmarkPyramidErosion(int resolution, int singleLevelDroplets, int levels, int dropletsPerLevel, int fineDroplets);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,170 @@
+/*
+ * These are the terrain vertex tests, they check:
+ *		- The SSE packer packs the same vertices as encodeNormal, one at a time
+ *		- A packed normal decodes back to where it started, over the whole sphere
+ *		- The axes, the corners of the octahedron, come back exactly
+ *		- The folded lower hemisphere comes back below the equator
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TerrainTests.h"
+#include "TestRunner.h"
+#include "TestData.h"
+#include "TerrainVertex.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Not a multiple of 4, so the packer's one at a time tail is checked too
+const int normalCount = 65539;
+
+// 16 bit snorm octahedral normals are good to around 0.005 degrees
+const double maxErrorDegrees = 0.01;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The angle between two unit vectors in degrees, from the cross and dot products as acos loses too much near 0
+static double angleBetween(const XMFLOAT3& a, float x, float y, float z)
+{
+	double crossX = (double)a.y * z - (double)a.z * y;
+	double crossY = (double)a.z * x - (double)a.x * z;
+	double crossZ = (double)a.x * y - (double)a.y * x;
+	double dot = (double)a.x * x + (double)a.y * y + (double)a.z * z;
+
+	return atan2(sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ), dot) * 180.0 / 3.14159265358979;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void packedMatchesEncodeNormal()
+{
+	std::vector<float> heights, normalX, normalY, normalZ;
+	TestData::makeHeights(normalCount, 1, heights);
+	TestData::makeNormals(normalCount, 2, normalX, normalY, normalZ);
+
+	std::vector<TerrainVertexType> packed(normalCount);
+	TerrainVertexPacker::packVertices(heights.data(), normalX.data(), normalY.data(), normalZ.data(), normalCount, packed.data());
+
+	int heightMismatches = 0;
+	int normalMismatches = 0;
+
+	for (int i = 0; i < normalCount; ++i)
+	{
+		short oct[2];
+		TerrainVertexPacker::encodeNormal(normalX[i], normalY[i], normalZ[i], oct);
+
+		// The SSE packer rounds halves to even and roundf rounds them away from 0, so they can be 1 apart and still agree
+		heightMismatches += packed[i].height != heights[i] ? 1 : 0;
+		normalMismatches += abs(packed[i].octNormal[0] - oct[0]) > 1 || abs(packed[i].octNormal[1] - oct[1]) > 1 ? 1 : 0;
+	}
+
+	TEST_CHECK(heightMismatches == 0);
+	TEST_CHECK(normalMismatches == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void decodeRoundTrip()
+{
+	std::vector<float> normalX, normalY, normalZ;
+	TestData::makeNormals(normalCount, 3, normalX, normalY, normalZ);
+
+	double maxError = 0.0;
+
+	for (int i = 0; i < normalCount; ++i)
+	{
+		short oct[2];
+		TerrainVertexPacker::encodeNormal(normalX[i], normalY[i], normalZ[i], oct);
+
+		double error = angleBetween(TerrainVertexPacker::decodeNormal(oct), normalX[i], normalY[i], normalZ[i]);
+		maxError = error > maxError ? error : maxError;
+	}
+
+	TEST_CHECK(maxError < maxErrorDegrees);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void axesRoundTrip()
+{
+	const float axes[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	const float heights[8] = { 0.0f, 1.0f, -1.0f, 10.0f, -10.0f, 0.5f, 0.0f, 0.0f };
+	float normalX[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+	float normalY[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+	float normalZ[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+	for (int a = 0; a < 6; ++a)
+	{
+		normalX[a] = axes[a][0];
+		normalY[a] = axes[a][1];
+		normalZ[a] = axes[a][2];
+	}
+
+	// Through the SSE path as well, all 6 fit in two groups of 4
+	TerrainVertexType packed[8];
+	TerrainVertexPacker::packVertices(heights, normalX, normalY, normalZ, 8, packed);
+
+	for (int a = 0; a < 6; ++a)
+	{
+		short oct[2];
+		TerrainVertexPacker::encodeNormal(axes[a][0], axes[a][1], axes[a][2], oct);
+
+		XMFLOAT3 decoded = TerrainVertexPacker::decodeNormal(oct);
+		XMFLOAT3 decodedPacked = TerrainVertexPacker::decodeNormal(packed[a].octNormal);
+
+		TEST_CHECK(decoded.x == axes[a][0] && decoded.y == axes[a][1] && decoded.z == axes[a][2]);
+		TEST_CHECK(decodedPacked.x == axes[a][0] && decodedPacked.y == axes[a][1] && decodedPacked.z == axes[a][2]);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void lowerHemisphereRoundTrip()
+{
+	std::vector<float> normalX, normalY, normalZ;
+	TestData::makeNormals(normalCount, 4, normalX, normalY, normalZ);
+
+	int wrongHalf = 0;
+	double maxError = 0.0;
+
+	for (int i = 0; i < normalCount; ++i)
+	{
+		// Only the ones clearly below the equator, right on it they can round to either side
+		if (normalY[i] > -0.001f)
+		{
+			continue;
+		}
+
+		short oct[2];
+		TerrainVertexPacker::encodeNormal(normalX[i], normalY[i], normalZ[i], oct);
+
+		XMFLOAT3 decoded = TerrainVertexPacker::decodeNormal(oct);
+		double error = angleBetween(decoded, normalX[i], normalY[i], normalZ[i]);
+
+		wrongHalf += decoded.y < 0.0f ? 0 : 1;
+		maxError = error > maxError ? error : maxError;
+	}
+
+	TEST_CHECK(wrongHalf == 0);
+	TEST_CHECK(maxError < maxErrorDegrees);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void runTerrainVertexTests()
+{
+	TestRunner::run("TerrainVertex: SSE packer matches encodeNormal", packedMatchesEncodeNormal);
+	TestRunner::run("TerrainVertex: decoded normals round trip", decodeRoundTrip);
+	TestRunner::run("TerrainVertex: axes round trip exactly", axesRoundTrip);
+	TestRunner::run("TerrainVertex: lower hemisphere round trips", lowerHemisphereRoundTrip);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,120 @@
+/*
+ * This is the Test Data class it handles:
+ *		- Making the same random inputs for the tests and the benchmarks every run, from a seed
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TestData.h"
+#include "ErosionRandom.h"
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void TestData::makeNormals(int count, unsigned int seed, std::vector<float>& normalX, std::vector<float>& normalY, std::vector<float>& normalZ)
+{
+	normalX.resize(count);
+	normalY.resize(count);
+	normalZ.resize(count);
+
+	ErosionRandom random(seed);
+
+	for (int i = 0; i < count; ++i)
+	{
+		float x, y, z, length;
+
+		do
+		{
+			x = random.nextFloat() * 2.0f - 1.0f;
+			y = random.nextFloat() * 2.0f - 1.0f;
+			z = random.nextFloat() * 2.0f - 1.0f;
+
+			y = i % 16 == 0 ? 0.0f : y;
+			length = sqrtf(x * x + y * y + z * z);
+		}
+		while (length < 0.01f);
+
+		normalX[i] = x / length;
+		normalY[i] = y / length;
+		normalZ[i] = z / length;
+	}
+
+	const float axes[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+	for (int i = 0; i < 6 && i < count; ++i)
+	{
+		normalX[i] = axes[i][0];
+		normalY[i] = axes[i][1];
+		normalZ[i] = axes[i][2];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TestData::makeHeights(int count, unsigned int seed, std::vector<float>& heights)
+{
+	heights.resize(count);
+
+	ErosionRandom random(seed);
+
+	for (int i = 0; i < count; ++i)
+	{
+		heights[i] = (random.nextFloat() - 0.5f) * 100.0f;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TestData::makeBoxes(int count, unsigned int seed, float terrainSize, BoundingBoxList& boxes)
+{
+	boxes.clear();
+	boxes.reserve(count);
+
+	ErosionRandom random(seed);
+
+	for (int i = 0; i < count; ++i)
+	{
+		XMFLOAT3 centre(random.nextFloat() * terrainSize, random.nextFloat() * 60.0f - 20.0f, random.nextFloat() * terrainSize);
+		XMFLOAT3 halfSize(0.5f + random.nextFloat() * 8.0f, 0.5f + random.nextFloat() * 8.0f, 0.5f + random.nextFloat() * 8.0f);
+
+		boxes.add(XMFLOAT3(centre.x - halfSize.x, centre.y - halfSize.y, centre.z - halfSize.z),
+			XMFLOAT3(centre.x + halfSize.x, centre.y + halfSize.y, centre.z + halfSize.z));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+XMMATRIX TestData::makeViewProjection(float terrainSize)
+{
+	XMVECTOR eye = XMVectorSet(terrainSize * 0.5f, 40.0f, -30.0f, 1.0f);
+	XMVECTOR target = XMVectorSet(terrainSize * 0.5f, 0.0f, terrainSize * 0.5f, 1.0f);
+	XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+
+	return XMMatrixLookAtLH(eye, target, up) * XMMatrixPerspectiveFovLH(XM_PI / 4.0f, 16.0f / 9.0f, 0.1f, 400.0f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TestData::makeHills(HeightMap& heightMap)
+{
+	const int resolution = heightMap.getResolution();
+
+	// Scaled to the resolution, so the hills are the same shape whatever size the map is
+	const float scale = 256.0f / resolution;
+
+	for (int z = 0; z < resolution; ++z)
+	{
+		for (int x = 0; x < resolution; ++x)
+		{
+			heightMap.at(x, z) = 10.0f * sinf(x * scale * 0.05f) * cosf(z * scale * 0.04f) + z * scale * 0.05f;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
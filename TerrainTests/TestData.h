@@ -0,0 +1,41 @@
+/*
+ * This is the Test Data class it handles:
+ *		- Making the same random inputs for the tests and the benchmarks every run, from a seed
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+#include "FrustumCulling.h"
+#include "HeightMap.h"
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TestData
+{
+public:
+	// Unit normals spread over the whole sphere, every 16th one on the equator (y = 0) where the two halves meet,
+	// and the first 6 are the axes, the corners of the octahedron
+	static void makeNormals(int count, unsigned int seed, std::vector<float>& normalX, std::vector<float>& normalY, std::vector<float>& normalZ);
+	// -50 -> 50
+	static void makeHeights(int count, unsigned int seed, std::vector<float>& heights);
+	// Boxes scattered over a terrain of the given size, from chunk sized down to tree sized, in its local space
+	static void makeBoxes(int count, unsigned int seed, float terrainSize, BoundingBoxList& boxes);
+	// Looking across the terrain from above one edge, what the app's camera sees, in the terrain's local space
+	static XMMATRIX makeViewProjection(float terrainSize);
+	// Rolling hills sloping down one way, so water gathers and runs off, the map must already be its resolution
+	static void makeHills(HeightMap& heightMap);
+
+private:
+	// Private constructors/destructors, i.e. you cannot create and instance of this class
+	TestData() {};
+	~TestData() {};
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
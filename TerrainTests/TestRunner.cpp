@@ -0,0 +1,62 @@
+/*
+ * This is the Test Runner class it handles:
+ *		- Running each test, and printing whether it passed
+ *		- Counting the checks that failed, and printing where they are and what they were checking
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TestRunner.h"
+#include <cstdio>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int testCount = 0;
+int failedTestCount = 0;
+int failedChecks = 0;		// In the test that's running
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// FUNCTIONS
+void TestRunner::run(const char* name, void (*test)())
+{
+	failedChecks = 0;
+	test();
+
+	++testCount;
+	failedTestCount += failedChecks > 0 ? 1 : 0;
+
+	printf("%s %s\n", failedChecks > 0 ? "FAILED" : "passed", name);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TestRunner::check(bool passed, const char* condition, const char* file, int line)
+{
+	if (!passed)
+	{
+		++failedChecks;
+		printf("    %s(%d): check failed: %s\n", file, line, condition);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TestRunner::getTestCount()
+{
+	return testCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TestRunner::getFailedTestCount()
+{
+	return failedTestCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,38 @@
+/*
+ * This is the Test Runner class it handles:
+ *		- Running each test, and printing whether it passed
+ *		- Counting the checks that failed, and printing where they are and what they were checking
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A failed check is printed and counted, the test carries on so every failure in it is seen
+#define TEST_CHECK(condition) TestRunner::check((condition), #condition, __FILE__, __LINE__)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TestRunner
+{
+public:
+	static void run(const char* name, void (*test)());
+	static void check(bool passed, const char* condition, const char* file, int line);
+
+	static int getTestCount();
+	static int getFailedTestCount();
+
+private:
+	// Private constructors/destructors, i.e. you cannot create and instance of this class
+	TestRunner() {};
+	~TestRunner() {};
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
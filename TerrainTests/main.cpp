@@ -0,0 +1,46 @@
+/*
+ * This is the terrain tests' entry point it handles:
+ *		- Running every test suite, the exit code is the number of tests that failed
+ *		- Running the benchmarks afterwards, if it's run with "benchmark"
+ *
+ * Original @author D. Green.
+ *
+ *  D. Green. 2022.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// INCLUDES
+#include "TerrainTests.h"
+#include "TestRunner.h"
+#include <cstdio>
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+	runTerrainVertexTests();
+	runFrustumCullingTests();
+	runShallowWaterErosionTests();
+	runTerrainQuadtreeTests();
+
+	printf("\n%d of %d tests passed\n", TestRunner::getTestCount() - TestRunner::getFailedTestCount(), TestRunner::getTestCount());
+
+	// The timings are only worth anything in Release
+	if (argc > 1 && strcmp(argv[1], "benchmark") == 0)
+	{
+		printf("\n");
+		benchmarkVertexPacking(100000000);
+		benchmarkFrustumCulling(100000, 1000);
+		benchmarkShallowWaterScaling(512, 500);
+		benchmarkHeightSampler(512, 100000000);
+		benchmarkHeightMapLayouts(512, 10, 50000);
+		benchmarkNoiseAlgorithms(512, 8);
+		benchmarkPyramidErosion(512, 300000, 2, 75000, 75000);
+	}
+
+	return TestRunner::getFailedTestCount();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////